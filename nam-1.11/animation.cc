@@ -43,6 +43,7 @@
 
 unsigned int Animation::LASTID_ = 0;
 Tcl_HashTable *Animation::AniHash_ = 0;
+unsigned int Animation::layout_ = 0;
 unsigned int Animation::nAniHash_ = 0;
 
 // Static method
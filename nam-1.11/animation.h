@@ -64,6 +64,7 @@ const int ClassTagID = 		ClassLanID + 1;
 const int ClassTrafficSourceID = ClassTagID + 1;
 const int ClassLossModelID = ClassTrafficSourceID + 1;
 const int ClassQueueHandleID = ClassLossModelID + 1;
+const int ClassBPacketID = ClassQueueHandleID + 1;
 
 const int AnimationTagIncrement = 5;
 
@@ -116,8 +117,18 @@ public:
 	inline int paint() const { return (paint_); }
 	inline Animation* next() const { return (next_); }
 	inline Animation** prev() const { return (prev_); }
+	// Call after recomputing bb_, which was old
+	inline void moved(const BBox &old) {
+		if ((old.xmin != bb_.xmin) || (old.ymin != bb_.ymin) ||
+		    (old.xmax != bb_.xmax) || (old.ymax != bb_.ymax))
+			layout_++;
+	}
 
 	static unsigned int LASTID_;
+	// Bumped whenever a node, link, LAN, queue handle or tag changes
+	// its bounding box (see moved()), so indexes of them know to
+	// rebuild.
+	static unsigned int layout_;
 	static Tcl_HashTable* AniHash_;
 	static unsigned int nAniHash_;
 	static Animation* find(unsigned int id);
@@ -169,6 +169,8 @@ Edge::setupDefaults() {
 	packets_ = NULL;
 	no_of_packets_ = 0;
 	last_packet_ = NULL;
+	Tcl_InitHashTable(&pkthash_, TCL_ONE_WORD_KEYS);
+	pktdups_ = 0;
 	marked_ = 0;
 	visible_ = 1;
 	dlabel_ = NULL;
@@ -191,6 +193,7 @@ Edge::~Edge() {
   if (queue_handle_) {
     delete queue_handle_;
   }
+  Tcl_DeleteHashTable(&pkthash_);
 }
 
 //----------------------------------------------------------------------
@@ -322,6 +325,7 @@ void Edge::place(double x0, double y0, double x1, double y1)
 	matrix_.rotate((180 / M_PI) * atan2(dy, dx));
 	matrix_.translate(x0, y0);
 
+	BBox old = bb_;
  	if (x1>x0) {
  		bb_.xmin = x0; bb_.xmax = x1;
 	} else {
@@ -332,6 +336,7 @@ void Edge::place(double x0, double y0, double x1, double y1)
  	} else {
  		bb_.ymin = y1; bb_.ymax = y0;
  	}
+	moved(old);
 	eb_.xmin = -0.1 * start_->size();
 	eb_.xmax = sqrt(dx*dx+dy*dy) + 0.1*neighbor_->size(); 
 	eb_.ymin = -0.1 * start_->size();
@@ -355,7 +360,14 @@ void Edge::AddPacket(Packet *p)
 	if (last_packet_==NULL)
 		last_packet_=p;
 	no_of_packets_++;
-#define PARANOID
+
+	int newEntry;
+	Tcl_HashEntry *he = Tcl_CreateHashEntry(&pkthash_, 
+						(const char *)p->id(), 
+						&newEntry);
+	if (!newEntry)
+		pktdups_++;
+	Tcl_SetHashValue(he, (ClientData)p);
 #ifdef PARANOID
 	int ctr=0;
 	for(Packet *tp=packets_;tp!=NULL;tp=tp->next()) {
@@ -369,7 +381,6 @@ void Edge::AddPacket(Packet *p)
 	printf("AddPacket: %d->%d OK\n", src_, dst_);
 #endif
 #endif
-#undef PARANOID
 }
 
 void Edge::arrive_packet(Packet *p, double atime)
@@ -413,7 +424,25 @@ void Edge::DeletePacket(Packet *p)
 				tp->next()->prev(tp->prev());
 		}
 	}
-#define PARANOID
+
+	Tcl_HashEntry *he = Tcl_FindHashEntry(&pkthash_, (const char *)p->id());
+	if ((he != NULL) && ((Packet *)Tcl_GetHashValue(he) == p)) {
+		/* 
+		 * Another packet with this id may still be on the link,
+		 * e.g. a retransmission; the newest one takes its place.
+		 */
+		Packet *tp;
+		for (tp = (pktdups_ > 0) ? packets_ : NULL; tp != NULL; 
+		     tp = tp->next())
+			if (tp->id() == p->id())
+				break;
+		if (tp != NULL) {
+			Tcl_SetHashValue(he, (ClientData)tp);
+			pktdups_--;
+		} else
+			Tcl_DeleteHashEntry(he);
+	} else if (pktdups_ > 0)
+		pktdups_--;
 #ifdef PARANOID
 	int ctr=0;
 	for(Packet *tp=packets_;tp!=NULL;tp=tp->next()) {
@@ -425,7 +454,21 @@ void Edge::DeletePacket(Packet *p)
 	printf("DeletePacket: %d->%d OK\n", src_, dst_);
 #endif
 #endif
-#undef PARANOID
+}
+
+//----------------------------------------------------------------------
+// Packet *
+// Edge::lookupPacket(int id)
+//   - the newest packet with this id on the link, as found by walking
+//     packets_ from the front
+//----------------------------------------------------------------------
+Packet * Edge::lookupPacket(int id) const
+{
+	Tcl_HashEntry *he = Tcl_FindHashEntry((Tcl_HashTable *)&pkthash_, 
+					      (const char *)id);
+	if (he == NULL)
+		return NULL;
+	return (Packet *)Tcl_GetHashValue(he);
 }
 
 void Edge::dlabel(const char* name)
@@ -518,6 +561,9 @@ void Edge::reset(double)
 	no_of_packets_=0;
 	packets_=NULL;
 	last_packet_=NULL;
+	Tcl_DeleteHashTable(&pkthash_);
+	Tcl_InitHashTable(&pkthash_, TCL_ONE_WORD_KEYS);
+	pktdups_ = 0;
 }
 
 int Edge::inside(double, float px, float py) const
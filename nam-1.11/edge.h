@@ -129,6 +129,7 @@ public:
 
 	void AddPacket(Packet *);
 	void DeletePacket(Packet *);
+	Packet* lookupPacket(int id) const;
 	void arrive_packet(Packet *, double atime);
 	void dlabel(const char* name);
 	void direction(const char* name);
@@ -172,6 +173,9 @@ private:
 	Packet* packets_;       /*newest packet to be added*/
 	int no_of_packets_;
 	Packet* last_packet_;   /*oldest packet - normally first to arrive*/
+	Tcl_HashTable pkthash_; /* packets_ by id (the newest, if several) */
+	int pktdups_;           /* packets added while one with the same id
+				   was on the link */
 
 	int marked_;
 	int visible_;
@@ -107,6 +107,7 @@ EditorNetModel::addNode(Node * node) {
 		node->next_ = nodes_;
 		nodes_ = node;
 		node->Animation::insert(&drawables_);
+		enterNode(node);
 		return node;
 	}
 	return NULL;
@@ -1075,6 +1076,7 @@ void EditorNetModel::removeNode(Node *n) {
 		previous = run;
 	}
 	run->next_ = NULL;
+	forgetNode(run);
 
 	// Remove it from list of drawables
 	run->detach();	
@@ -0,0 +1,439 @@
+/*
+ * Random access to gzip-compressed trace files; see gzindex.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "gzindex.h"
+
+#ifdef NAM_GZINDEX
+
+//----------------------------------------------------------------------
+// int
+// GzIndex::build(FILE *in, FILE *out, long size, long mtime)
+//   - Decompress all of in, writing an access point to out at the
+//     first block boundary after every GZINDEX_SPAN bytes of output.
+//----------------------------------------------------------------------
+int
+GzIndex::build(FILE *in, FILE *out, long size, long mtime)
+{
+	unsigned char input[GZINDEX_CHUNK];
+	unsigned char window[GZINDEX_WINSIZE];
+	unsigned char flat[GZINDEX_WINSIZE];
+	unsigned char *packed = new unsigned char[compressBound(GZINDEX_WINSIZE)];
+	long totin = 0, totout = 0, last = 0, member = 0;
+	int ret = Z_OK;
+	z_stream strm;
+
+	memset(&strm, 0, sizeof(strm));
+	if (inflateInit2(&strm, 47) != Z_OK) {	// gzip header
+		delete [] packed;
+		return (0);
+	}
+	fprintf(out, "# nam gzindex %d %ld %ld %d\n", GZINDEX_VERSION, size,
+		mtime, GZINDEX_SPAN);
+	strm.avail_out = 0;
+	for (;;) {
+		strm.avail_in = fread(input, 1, GZINDEX_CHUNK, in);
+		if (ferror(in)) {
+			ret = Z_ERRNO;
+			break;
+		}
+		if (strm.avail_in == 0)
+			break;
+		strm.next_in = input;
+		do {
+			if (strm.avail_out == 0) {
+				strm.avail_out = GZINDEX_WINSIZE;
+				strm.next_out = window;
+			}
+			totin += strm.avail_in;
+			totout += strm.avail_out;
+			ret = inflate(&strm, Z_BLOCK);
+			totin -= strm.avail_in;
+			totout -= strm.avail_out;
+			if (ret == Z_NEED_DICT)
+				ret = Z_DATA_ERROR;
+			if (ret == Z_DATA_ERROR && member == totout &&
+			    totout > 0) {
+				// junk after the last member, as gzread allows
+				ret = Z_STREAM_END;
+				goto done;
+			}
+			if (ret == Z_MEM_ERROR || ret == Z_DATA_ERROR)
+				goto done;
+			if (ret == Z_STREAM_END) {
+				// another member may follow
+				member = totout;
+				inflateReset(&strm);
+				continue;
+			}
+			if ((strm.data_type & 128) && !(strm.data_type & 64) &&
+			    totout - last > GZINDEX_SPAN) {
+				// the window is circular; straighten it out
+				int n = strm.avail_out;
+				if (n > 0)
+					memcpy(flat, window + GZINDEX_WINSIZE - n, n);
+				if (n < GZINDEX_WINSIZE)
+					memcpy(flat + n, window,
+					       GZINDEX_WINSIZE - n);
+				uLongf plen = compressBound(GZINDEX_WINSIZE);
+				if (compress2(packed, &plen, flat,
+					      GZINDEX_WINSIZE, 1) != Z_OK) {
+					ret = Z_MEM_ERROR;
+					goto done;
+				}
+				fprintf(out, "A %ld %ld %d %lu\n", totout, totin,
+					strm.data_type & 7, (unsigned long)plen);
+				fwrite(packed, 1, plen, out);
+				last = totout;
+			}
+		} while (strm.avail_in != 0);
+	}
+ done:
+	inflateEnd(&strm);
+	delete [] packed;
+	if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR)
+		return (0);
+	fprintf(out, "E %ld\n", totout);
+	return (fflush(out) == 0 && !ferror(out));
+}
+
+//----------------------------------------------------------------------
+// GzIndex *
+// GzIndex::open(const char *fn)
+//   - Return the access points of the gzip file fn, building them if
+//     there is no index or the file has changed since.  Returns NULL
+//     if fn is not gzip-compressed or cannot be decompressed.
+//----------------------------------------------------------------------
+GzIndex *
+GzIndex::open(const char *fn)
+{
+	struct stat st;
+	if (stat(fn, &st) < 0)
+		return (NULL);
+	FILE *in = fopen(fn, "rb");
+	if (in == NULL)
+		return (NULL);
+	if (getc(in) != 0x1f || getc(in) != 0x8b) {
+		// compress(1) output, or not compressed at all
+		fclose(in);
+		return (NULL);
+	}
+
+	char *name = new char[strlen(fn) + 5];
+	sprintf(name, "%s.gzi", fn);
+	FILE *fp = fopen(name, "rb");
+	if (fp != NULL) {
+		GzIndex *ix = new GzIndex(fp);
+		if (ix->load(st.st_size, st.st_mtime)) {
+			fclose(in);
+			delete [] name;
+			return (ix);
+		}
+		delete ix;
+	}
+
+	fp = NULL;
+	if (st.st_size >= GZINDEX_MINSIZE) {
+		fprintf(stderr, "nam: indexing %s ...\n", fn);
+		fp = fopen(name, "wb+");
+	}
+	delete [] name;
+	if (fp == NULL && (fp = tmpfile()) == NULL) {
+		fclose(in);
+		return (NULL);
+	}
+	::rewind(in);
+	int ok = build(in, fp, st.st_size, st.st_mtime);
+	fclose(in);
+	if (!ok) {
+		fclose(fp);
+		return (NULL);
+	}
+	::rewind(fp);
+	GzIndex *ix = new GzIndex(fp);
+	if (!ix->load(st.st_size, st.st_mtime)) {
+		delete ix;
+		return (NULL);
+	}
+	return (ix);
+}
+
+GzIndex::GzIndex(FILE *fp) :
+	fp_(fp), pt_(0), npt_(0), maxpt_(0), length_(-1)
+{
+}
+
+GzIndex::~GzIndex()
+{
+	delete [] pt_;
+	if (fp_ != NULL)
+		fclose(fp_);
+}
+
+void
+GzIndex::addPoint(const GzAccessPoint& p)
+{
+	if (npt_ == maxpt_) {
+		maxpt_ = maxpt_ ? 2 * maxpt_ : 256;
+		GzAccessPoint *pt = new GzAccessPoint[maxpt_];
+		memcpy(pt, pt_, npt_ * sizeof(GzAccessPoint));
+		delete [] pt_;
+		pt_ = pt;
+	}
+	pt_[npt_++] = p;
+}
+
+//----------------------------------------------------------------------
+// int
+// GzIndex::load(long size, long mtime)
+//   - Read the access points, checking that they were built for a
+//     file of this size and modification time.  The windows are left
+//     in the file.
+//----------------------------------------------------------------------
+int
+GzIndex::load(long size, long mtime)
+{
+	char buf[128];
+	int version, span;
+	long isize, imtime;
+
+	if (fgets(buf, sizeof(buf), fp_) == NULL ||
+	    sscanf(buf, "# nam gzindex %d %ld %ld %d", &version, &isize,
+		   &imtime, &span) != 4 ||
+	    version != GZINDEX_VERSION || isize != size || imtime != mtime)
+		return (0);
+
+	while (fgets(buf, sizeof(buf), fp_) != NULL) {
+		if (buf[0] == 'A') {
+			GzAccessPoint p;
+			if (sscanf(buf, "A %ld %ld %d %d", &p.out, &p.in,
+				   &p.bits, &p.wlen) != 4)
+				return (0);
+			p.woff = ftell(fp_);
+			if (fseek(fp_, p.wlen, SEEK_CUR) < 0)
+				return (0);
+			addPoint(p);
+		} else if (buf[0] == 'E') {
+			return (sscanf(buf, "E %ld", &length_) == 1);
+		} else
+			return (0);
+	}
+	// no end record: the index was not finished
+	return (0);
+}
+
+//----------------------------------------------------------------------
+// int
+// GzIndex::find(long off)
+//   - The last access point at or before uncompressed offset off, or
+//     -1 if off comes before the first one.
+//----------------------------------------------------------------------
+int
+GzIndex::find(long off) const
+{
+	int lo = -1, hi = npt_ - 1;
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (pt_[mid].out <= off)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return (lo);
+}
+
+// The GZINDEX_WINSIZE bytes before access point i, into win.
+int
+GzIndex::window(int i, unsigned char *win)
+{
+	unsigned char *packed = new unsigned char[pt_[i].wlen];
+	uLongf len = GZINDEX_WINSIZE;
+	int ok = (fseek(fp_, pt_[i].woff, SEEK_SET) == 0 &&
+		  fread(packed, 1, pt_[i].wlen, fp_) == (size_t)pt_[i].wlen &&
+		  uncompress(win, &len, packed, pt_[i].wlen) == Z_OK &&
+		  len == GZINDEX_WINSIZE);
+	delete [] packed;
+	return (ok);
+}
+
+//----------------------------------------------------------------------
+// GzInflater
+//----------------------------------------------------------------------
+GzInflater::GzInflater(FILE *fp, GzIndex *ix) :
+	fp_(fp), ix_(ix), live_(0), raw_(0), member_(0), end_(0), out_(0)
+{
+	memset(&strm_, 0, sizeof(strm_));
+}
+
+GzInflater::~GzInflater()
+{
+	if (live_)
+		inflateEnd(&strm_);
+}
+
+// Restart decompression at access point i, or at the beginning if -1.
+int
+GzInflater::start(int i)
+{
+	if (live_)
+		inflateEnd(&strm_);
+	live_ = end_ = 0;
+	memset(&strm_, 0, sizeof(strm_));
+	if (i < 0) {
+		if (fseek(fp_, 0, SEEK_SET) < 0 ||
+		    inflateInit2(&strm_, 47) != Z_OK)
+			return (-1);
+		raw_ = 0;
+		member_ = 1;
+		out_ = 0;
+		live_ = 1;
+		return (0);
+	}
+
+	const GzAccessPoint& p = ix_->point(i);
+	unsigned char win[GZINDEX_WINSIZE];
+	if (!ix_->window(i, win) ||
+	    fseek(fp_, p.in - (p.bits ? 1 : 0), SEEK_SET) < 0 ||
+	    inflateInit2(&strm_, -15) != Z_OK)
+		return (-1);
+	live_ = 1;
+	if (p.bits) {
+		int c = getc(fp_);
+		if (c == EOF ||
+		    inflatePrime(&strm_, p.bits, c >> (8 - p.bits)) != Z_OK)
+			return (-1);
+	}
+	if (inflateSetDictionary(&strm_, win, GZINDEX_WINSIZE) != Z_OK)
+		return (-1);
+	raw_ = 1;
+	member_ = 0;
+	out_ = p.out;
+	return (0);
+}
+
+int
+GzInflater::input()
+{
+	strm_.next_in = in_;
+	strm_.avail_in = fread(in_, 1, GZINDEX_CHUNK, fp_);
+	return (ferror(fp_) ? -1 : (int)strm_.avail_in);
+}
+
+// Pass over n bytes of compressed input.
+int
+GzInflater::skipin(int n)
+{
+	while (n > 0) {
+		if (strm_.avail_in == 0 && input() <= 0)
+			return (-1);
+		int k = (int)strm_.avail_in < n ? (int)strm_.avail_in : n;
+		strm_.next_in += k;
+		strm_.avail_in -= k;
+		n -= k;
+	}
+	return (0);
+}
+
+//----------------------------------------------------------------------
+// int
+// GzInflater::read(unsigned char *buf, int len)
+//   - Up to len bytes of uncompressed data.  Returns 0 at the end of
+//     the data, -1 on error.
+//----------------------------------------------------------------------
+int
+GzInflater::read(unsigned char *buf, int len)
+{
+	int have = 0;
+
+	if (!live_ && start(-1) < 0)
+		return (-1);
+	while (have < len && !end_) {
+		if (strm_.avail_in == 0) {
+			int n = input();
+			if (n < 0)
+				return (-1);
+			if (n == 0) {
+				end_ = 1;
+				break;
+			}
+		}
+		strm_.next_out = buf + have;
+		strm_.avail_out = len - have;
+		int ret = inflate(&strm_, Z_NO_FLUSH);
+		int n = len - have - strm_.avail_out;
+		have += n;
+		out_ += n;
+		if (n > 0)
+			member_ = 0;
+		if (ret == Z_STREAM_END) {
+			if (raw_) {
+				/*
+				 * Started at an access point: skip the gzip
+				 * trailer and read any following member with
+				 * its header, keeping the input read so far.
+				 */
+				if (skipin(8) < 0) {
+					end_ = 1;
+					break;
+				}
+				Bytef *next = strm_.next_in;
+				uInt avail = strm_.avail_in;
+				inflateEnd(&strm_);
+				live_ = 0;
+				if (inflateInit2(&strm_, 47) != Z_OK)
+					return (-1);
+				live_ = 1;
+				strm_.next_in = next;
+				strm_.avail_in = avail;
+				raw_ = 0;
+			} else
+				inflateReset(&strm_);
+			member_ = 1;
+			continue;
+		}
+		if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR ||
+		    ret == Z_MEM_ERROR || ret == Z_STREAM_ERROR) {
+			if (member_ && out_ > 0) {
+				// junk after the last member
+				end_ = 1;
+				break;
+			}
+			return (-1);
+		}
+	}
+	return (have);
+}
+
+//----------------------------------------------------------------------
+// int
+// GzInflater::seek(long off)
+//   - Position at uncompressed offset off, going on from where we are
+//     if no access point lies between here and there.
+//----------------------------------------------------------------------
+int
+GzInflater::seek(long off)
+{
+	if (off < 0 || off > ix_->length())
+		return (-1);
+	int i = ix_->find(off);
+	if (!live_ || off < out_ || (i >= 0 && ix_->point(i).out > out_))
+		if (start(i) < 0)
+			return (-1);
+
+	unsigned char junk[8192];
+	while (out_ < off) {
+		long n = off - out_;
+		if (n > (long)sizeof(junk))
+			n = sizeof(junk);
+		if (read(junk, (int)n) <= 0)
+			return (-1);
+	}
+	return (0);
+}
+
+#endif /* NAM_GZINDEX */
@@ -0,0 +1,100 @@
+/*
+ * Random access to gzip-compressed trace files.
+ *
+ * A gzip stream can only be decompressed from its beginning, so
+ * seeking in one, let alone reading it backwards, used to mean
+ * decompressing everything up to the target.  Instead, one pass over
+ * the file records an access point about every GZINDEX_SPAN bytes of
+ * uncompressed data, at a deflate block boundary: the compressed and
+ * uncompressed offsets there and the 32K of data before it, which is
+ * all the decompressor needs to start at that block (the approach of
+ * zlib's examples/zran.c).  A seek then costs at most GZINDEX_SPAN
+ * bytes of decompression wherever it lands.
+ *
+ * The access points of traces of GZINDEX_MINSIZE bytes or more are
+ * kept next to the trace as "<trace>.gzi", with the windows compressed,
+ * and are rebuilt whenever the trace changes.  Smaller traces get a
+ * temporary index for the session.
+ *
+ * Requires zlib 1.2.3 or later, for inflatePrime().
+ */
+
+#ifndef nam_gzindex_h
+#define nam_gzindex_h
+
+#ifdef HAVE_ZLIB_H
+#include <stdio.h>
+#include <zlib.h>
+
+#if defined(ZLIB_VERNUM) && ZLIB_VERNUM >= 0x1230
+#define NAM_GZINDEX
+
+#define GZINDEX_VERSION 1
+#define GZINDEX_SPAN (1 << 20)		/* uncompressed bytes per point */
+#define GZINDEX_MINSIZE (1 << 20)	/* smaller traces: temporary index */
+#define GZINDEX_WINSIZE 32768		/* deflate window */
+#define GZINDEX_CHUNK 16384		/* compressed bytes read at once */
+
+struct GzAccessPoint {
+	long out;		// uncompressed offset
+	long in;		// compressed offset of the first whole byte
+	int bits;		// bits of the byte before 'in' that belong here
+	long woff;		// index file offset of the compressed window
+	int wlen;
+};
+
+class GzIndex {
+ public:
+	static GzIndex* open(const char *fn);
+	~GzIndex();
+
+	long length() const { return length_; }
+	int find(long off) const;
+	const GzAccessPoint& point(int i) const { return pt_[i]; }
+	int window(int i, unsigned char *win);
+
+ private:
+	GzIndex(FILE *fp);
+	static int build(FILE *in, FILE *out, long size, long mtime);
+	int load(long size, long mtime);
+	void addPoint(const GzAccessPoint&);
+
+	FILE *fp_;
+	GzAccessPoint *pt_;
+	int npt_;
+	int maxpt_;
+	long length_;		// uncompressed length of the trace
+};
+
+/*
+ * A decompressor that can be positioned anywhere in the uncompressed
+ * data, restarting from the nearest access point when the target is
+ * behind it or farther ahead than the next one.
+ */
+class GzInflater {
+ public:
+	GzInflater(FILE *fp, GzIndex *ix);
+	~GzInflater();
+	int seek(long off);
+	int read(unsigned char *buf, int len);
+	long tell() const { return out_; }
+
+ private:
+	int start(int i);
+	int input();
+	int skipin(int n);
+
+	FILE *fp_;
+	GzIndex *ix_;
+	z_stream strm_;
+	int live_;		// strm_ is initialized
+	int raw_;		// raw deflate, started at an access point
+	int member_;		// at the start of a gzip member
+	int end_;		// no more data
+	long out_;		// uncompressed offset of the next byte
+	unsigned char in_[GZINDEX_CHUNK];
+};
+
+#endif /* ZLIB_VERNUM */
+#endif /* HAVE_ZLIB_H */
+#endif
@@ -179,10 +179,12 @@ void Lan::add_link(Edge *e) {
 void Lan::update_bb() {
 	double s,c;
 	SINCOSPI(angle_,&s,&c);
+	BBox old = bb_;
 	bb_.xmin = x_ - size_*c;
         bb_.xmax = x_+size_*c*(2*max_+1);
 	bb_.ymin = y_ - size_*s;
         bb_.ymax = y_+size_*s*(2*max_+1);
+	moved(old);
 }
 
 //----------------------------------------------------------------------
@@ -31,6 +31,9 @@
 #include <tclcl.h>
 #include "trace.h"
 #include "nam_stream.h"
+#include "gzindex.h"
+
+#define GZSTREAM_BUFSIZE (256 << 10)	/* uncompressed bytes buffered */
 
 
 /**********************************************************************/
@@ -242,7 +245,9 @@ NamStreamFile::read(char *buf, int size)
  * nam *requires* zlib-1.1.3, as we trip over bugs in 1.1.2's gz* functions.
  */
 
-NamStreamCompressedFile::NamStreamCompressedFile(const char *fn) : NamStream(fn)
+NamStreamCompressedFile::NamStreamCompressedFile(const char *fn) :
+	NamStream(fn), file_(NULL), index_(NULL), inflater_(NULL), fp_(NULL),
+	buf_(NULL), bufoff_(0), buflen_(0), pos_(0), length_(0), eof_(0)
 {
 #ifndef ZLIB_VERSION
 	die("zlib version not specified.\n");
@@ -256,26 +261,106 @@ NamStreamCompressedFile::NamStreamCompressedFile(const char *fn) : NamStream(fn)
 		die("zlib version is too old, nam requires 1.1.3.\n");
 #endif
 
+#ifdef NAM_GZINDEX
+	index_ = GzIndex::open(fn);
+	if (index_ != NULL) {
+		fp_ = fopen(fn, "rb");
+		if (fp_ != NULL) {
+			inflater_ = new GzInflater(fp_, index_);
+			buf_ = new char[GZSTREAM_BUFSIZE];
+			length_ = index_->length();
+			is_open_ = 1;
+			return;
+		}
+		delete index_;
+		index_ = NULL;
+	}
+#endif
 	file_ = gzopen(fn, "r");
 	is_open_ = (NULL != file_);
 }
 
+/*
+ * Load the buffer with the data around uncompressed offset off.  When
+ * we are stepping back over the start of the buffer, as rgets does,
+ * the buffer is made to end at off so the next steps back are in it.
+ */
+int
+NamStreamCompressedFile::fill(long off)
+{
+#ifdef NAM_GZINDEX
+	long start = off;
+	if (off < bufoff_ && off >= bufoff_ - TRACE_LINE_MAXLEN) {
+		start = off + 1 - GZSTREAM_BUFSIZE;
+		if (start < 0)
+			start = 0;
+	}
+	buflen_ = 0;
+	if (off >= length_ || inflater_->seek(start) < 0)
+		return 0;
+	int n = inflater_->read((unsigned char *)buf_, GZSTREAM_BUFSIZE);
+	if (n < 0)
+		return 0;
+	bufoff_ = start;
+	buflen_ = n;
+	return (off < bufoff_ + buflen_);
+#else
+	return 0;
+#endif
+}
+
 char *
 NamStreamCompressedFile::gets(char *buf, int len)
 {
-	char *b = gzgets(file_, buf, len);
-	return b;
+	if (inflater_ == NULL) {
+		char *b = gzgets(file_, buf, len);
+		return b;
+	}
+
+	int n = 0;
+	while (n < len - 1) {
+		if ((pos_ < bufoff_ || pos_ >= bufoff_ + buflen_) &&
+		    !fill(pos_)) {
+			eof_ = 1;
+			break;
+		}
+		char c = buf_[pos_++ - bufoff_];
+		buf[n++] = c;
+		if (c == '\n')
+			break;
+	}
+	buf[n] = 0;
+	return (n > 0 ? buf : NULL);
 }
 
-char 
+char
 NamStreamCompressedFile::get_char()
 {
-	return gzgetc(file_);
+	if (inflater_ == NULL)
+		return gzgetc(file_);
+
+	if ((pos_ < bufoff_ || pos_ >= bufoff_ + buflen_) && !fill(pos_)) {
+		eof_ = 1;
+		return EOF;
+	}
+	return buf_[pos_++ - bufoff_];
 }
 
 off_t
 NamStreamCompressedFile::seek(off_t offset, int whence)
 {
+	if (inflater_ != NULL) {
+		long off = offset;
+		if (whence == SEEK_CUR)
+			off += pos_;
+		else if (whence == SEEK_END)
+			off += length_;
+		if (off < 0 || off > length_)
+			return -1;
+		pos_ = off;
+		eof_ = 0;
+		return pos_;
+	}
 	if (whence == SEEK_END) {
 		/*
 		 * zlib doesn't support SEEK_END :-<
@@ -307,28 +392,65 @@ NamStreamCompressedFile::seek(off_t offset, int whence)
 off_t
 NamStreamCompressedFile::tell()
 {
+	if (inflater_ != NULL)
+		return pos_;
 	return gztell(file_);
 }
 
 int
 NamStreamCompressedFile::close()
 {
-	int e = gzclose(file_);
+	int e = 0;
+
+#ifdef NAM_GZINDEX
+	delete inflater_;
+	delete index_;
+#endif
+	inflater_ = NULL;
+	index_ = NULL;
+	delete [] buf_;
+	buf_ = NULL;
+	if (fp_ != NULL)
+		e = fclose(fp_);
+	fp_ = NULL;
+	if (file_ != NULL)
+		e = gzclose(file_);
 	file_ = NULL;
+	is_open_ = 0;
 	return e;
 }
 
 int
 NamStreamCompressedFile::eof()
 {
+	if (file_ == NULL)
+		return (inflater_ == NULL || eof_);
 	return gzeof(file_);
 }
 
 int
 NamStreamCompressedFile::read(char *buf, int size)
 {
-	int e = gzread(file_, buf, size);
-	return e;
+	if (inflater_ == NULL) {
+		int e = gzread(file_, buf, size);
+		return e;
+	}
+
+	int n = 0;
+	while (n < size) {
+		if ((pos_ < bufoff_ || pos_ >= bufoff_ + buflen_) &&
+		    !fill(pos_)) {
+			eof_ = 1;
+			break;
+		}
+		int k = bufoff_ + buflen_ - pos_;
+		if (k > size - n)
+			k = size - n;
+		memcpy(buf + n, buf_ + (pos_ - bufoff_), k);
+		n += k;
+		pos_ += k;
+	}
+	return n;
 }
 
 
@@ -79,13 +79,33 @@ class NamStreamFile : public NamStream {
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 
+class GzIndex;
+class GzInflater;
+
+/*
+ * gzip files are read through an index of access points (gzindex.h),
+ * which makes them seekable; anything else zlib reads is read
+ * sequentially with gzread.
+ */
 class NamStreamCompressedFile : public NamStream {
 	gzFile file_;
 
+	GzIndex *index_;
+	GzInflater *inflater_;
+	FILE *fp_;
+	char *buf_;		// uncompressed data from bufoff_ on
+	long bufoff_;
+	int buflen_;
+	long pos_;
+	long length_;
+	int eof_;
+
+	int fill(long off);
+
  public:
 	NamStreamCompressedFile(const char *fn);
 
-	virtual int seekable() { return 0; }
+	virtual int seekable() { return (inflater_ != NULL); }
 
 	virtual char *gets(char *buf, int len);
 	virtual char get_char();
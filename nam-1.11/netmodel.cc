@@ -68,6 +68,7 @@
 #include "editview.h"
 #include "address.h"
 #include "animator.h"
+#include "quadtree.h"
 
 #include <float.h>
 
@@ -91,6 +92,9 @@ NetModel::NetModel(const char *animator) :
 	TraceHandler(animator),
 	drawables_(0),
 	animations_(0),
+	drawtree_(0),
+	drawlayout_(0),
+	drawhead_(0),
 	queues_(0),
 	views_(0),
 	nodes_(0),
@@ -153,6 +157,12 @@ NetModel::NetModel(const char *animator) :
 
 	addrHash_ = new Tcl_HashTable;
 	Tcl_InitHashTable(addrHash_, TCL_ONE_WORD_KEYS);
+	nodeHash_ = new Tcl_HashTable;
+	Tcl_InitHashTable(nodeHash_, TCL_ONE_WORD_KEYS);
+	lanHash_ = new Tcl_HashTable;
+	Tcl_InitHashTable(lanHash_, TCL_ONE_WORD_KEYS);
+	agentHash_ = new Tcl_HashTable;
+	Tcl_InitHashTable(agentHash_, TCL_ONE_WORD_KEYS);
 	grpHash_ = new Tcl_HashTable;
 	Tcl_InitHashTable(grpHash_, TCL_ONE_WORD_KEYS);
 	tagHash_ = new Tcl_HashTable;
@@ -188,6 +198,14 @@ NetModel::~NetModel()
 		delete a;
 	}
 
+	delete drawtree_;
+
+	Tcl_DeleteHashTable(nodeHash_);
+	delete nodeHash_;
+	Tcl_DeleteHashTable(lanHash_);
+	delete lanHash_;
+	Tcl_DeleteHashTable(agentHash_);
+	delete agentHash_;
 	Tcl_DeleteHashTable(grpHash_);
 	delete grpHash_;
 	Tcl_DeleteHashTable(tagHash_);
@@ -238,22 +256,105 @@ NetModel::reset(double now) {
 		q->reset(now);
 }
 
+//----------------------------------------------------------------------
+// void
+// NetModel::purge()
+//   - Remove all packets from links and link queues.  Packet
+//     animations delete themselves when updated to a time before
+//     they were sent.
+//----------------------------------------------------------------------
+void
+NetModel::purge() {
+	Animation *a, *n;
+	for (int i = 0; i < EDGE_HASH_SIZE; i++)
+		for (EdgeHashNode* h = hashtab_[i]; h != 0; h = h->next)
+			if (h->queue != 0)
+				h->queue->reset(now_);
+	for (a = animations_; a != 0; a = n) {
+		n = a->next();
+		if (a->classid() == ClassPacketID ||
+		    a->classid() == ClassBPacketID)
+			a->update(TIME_BOF);
+	}
+}
+
+//----------------------------------------------------------------------
+// QuadTree *
+// NetModel::drawTree()
+//   - The spatial index of drawables_.  Nodes, links and lans only
+//     move when the layout changes, so the tree is rebuilt then, or
+//     when something has been added to or removed from the front of
+//     drawables_ (insert() always puts things there).  Objects removed
+//     from further down are deleted too, and the tree skips them.
+//----------------------------------------------------------------------
+QuadTree *
+NetModel::drawTree() {
+	if (drawtree_ == 0)
+		drawtree_ = new QuadTree;
+	else if (drawlayout_ == Animation::layout_ && drawhead_ == drawables_)
+		return (drawtree_);
+	drawtree_->build(drawables_);
+	drawlayout_ = Animation::layout_;
+	drawhead_ = drawables_;
+	return (drawtree_);
+}
+
+//----------------------------------------------------------------------
+// void
+// NetModel::visibleArea(View * view, BBox & bb)
+//   - The part of the world shown in view, with some slack for labels
+//     and arrows drawn outside the bounding boxes of their objects.
+//----------------------------------------------------------------------
+void
+NetModel::visibleArea(View* view, BBox &bb) const {
+	float x0 = 0, y0 = 0;
+	float x1 = view->width(), y1 = view->height();
+	view->imap(x0, y0);
+	view->imap(x1, y1);
+	bb.xmin = x0, bb.ymin = y0;
+	bb.xmax = x1, bb.ymax = y1;
+	bb.adjust();
+
+	float dx = 0.25 * bb.width() + 4 * node_size_;
+	float dy = 0.25 * bb.height() + 4 * node_size_;
+	bb.xmin -= dx, bb.xmax += dx;
+	bb.ymin -= dy, bb.ymax += dy;
+}
+
 //----------------------------------------------------------------------
 // void
 // NetModel::render(View * view)
 //   - Draw this NetModel's drawables, animations, and monitors.
 //     (tags, nodes, edges, packets, queues, etc.)
+//   - Only objects in or near the visible part of the world are drawn.
 //----------------------------------------------------------------------
 void
 NetModel::render(View* view) {
 	Animation *a;
 	Monitor *m;
+	BBox bb;
 
-	for (a = drawables_; a != 0; a = a->next()) 
-	  a->draw(view, now_);
+	visibleArea(view, bb);
 
-	for (a = animations_; a != 0; a = a->next())
+	QuadTree *t = drawTree();
+	int n = t->query(bb);
+	for (int i = 0; i < n; i++) {
+	  a = t->result(i);
+	  // detached from drawables_ but not (yet) deleted
+	  if (a->prev() == 0)
+	    continue;
 	  a->draw(view, now_);
+	}
+
+	// Packets and the like move, so just check their bounding boxes.
+	// Those without one (e.g. broadcast packets) are always drawn.
+	for (a = animations_; a != 0; a = a->next()) {
+	  const BBox &ab = a->bbox();
+	  if (ab.xmin > ab.xmax || ab.ymin > ab.ymax ||
+	      !(ab.xmin > bb.xmax || ab.xmax < bb.xmin ||
+		ab.ymin > bb.ymax || ab.ymax < bb.ymin))
+	    a->draw(view, now_);
+	}
 
 	for ( m = monitors_; m != NULL; m = m->next())
 	  m->draw_monitor(view, nymin_, nymax_);
@@ -1472,6 +1573,7 @@ NetModel::addNode(const TraceEvent &e)  {
     n->next_ = nodes_;
     nodes_ = n;
     n->Animation::insert(&drawables_);
+    enterNode(n);
 
     // Set Packet size to be running average of the last 5 nodes (25% of node size)
     packet_size_ = (4.0 * packet_size_ + e.ne.size*0.25)/5.0;
@@ -1567,10 +1669,56 @@ void NetModel::addView(NetView* p)
 //----------------------------------------------------------------------
 Node *
 NetModel::lookupNode(int nn) const {
-  for (Node* n = nodes_; n != 0; n = n->next_)
-    if (n->num() == nn)
-      return (n);
-  return NULL;
+  Tcl_HashEntry *he = Tcl_FindHashEntry(nodeHash_, (const char *)(long)nn);
+  if (he == NULL)
+    return NULL;
+  return (Node *)Tcl_GetHashValue(he);
+}
+
+//----------------------------------------------------------------------
+// void
+// NetModel::enterNode(Node *n)
+//   - make n the node returned by lookupNode(n->num()).  Call after
+//     putting it on nodes_; a node defined twice hides the first one.
+//----------------------------------------------------------------------
+void
+NetModel::enterNode(Node *n) {
+  int newEntry;
+  Tcl_HashEntry *he = Tcl_CreateHashEntry(nodeHash_, (const char *)(long)n->num(),
+                                          &newEntry);
+  Tcl_SetHashValue(he, (ClientData)n);
+}
+
+//----------------------------------------------------------------------
+// void
+// NetModel::forgetNode(Node *n)
+//   - n is no longer on nodes_; look up any node it was hiding instead
+//----------------------------------------------------------------------
+void
+NetModel::forgetNode(Node *n) {
+  Tcl_HashEntry *he = Tcl_FindHashEntry(nodeHash_, (const char *)(long)n->num());
+  if ((he == NULL) || ((Node *)Tcl_GetHashValue(he) != n))
+    return;
+  Node *p;
+  for (p = nodes_; p != 0; p = p->next_)
+    if ((p != n) && (p->num() == n->num()))
+      break;
+  if (p != 0)
+    Tcl_SetHashValue(he, (ClientData)p);
+  else
+    Tcl_DeleteHashEntry(he);
+}
+
+//----------------------------------------------------------------------
+// void
+// NetModel::enterLan(Lan *l)
+//----------------------------------------------------------------------
+void
+NetModel::enterLan(Lan *l) {
+  int newEntry;
+  Tcl_HashEntry *he = Tcl_CreateHashEntry(lanHash_, (const char *)(long)l->num(),
+                                          &newEntry);
+  Tcl_SetHashValue(he, (ClientData)l);
 }
 
 
@@ -1597,23 +1745,45 @@ void NetModel::removeNode(Node *n)
 		nodes_ = p->next_;
 	else
 		q->next_ = p->next_;
+	forgetNode(p);
 	delete p;
 }
 
+//----------------------------------------------------------------------
+// Agent *
+// NetModel::lookupAgent(int id) const
+//   - Agents come and go with their nodes and can be renumbered, so
+//     agentHash_ only remembers the Animation id of the last agent
+//     found for a number.  It is checked before use.
+//----------------------------------------------------------------------
 Agent *NetModel::lookupAgent(int id) const
 {
+	Tcl_HashEntry *he = Tcl_FindHashEntry(agentHash_, (const char *)(long)id);
+	if (he != NULL) {
+		Animation *p = Animation::find((long)Tcl_GetHashValue(he));
+		if ((p != NULL) && (p->classid() == ClassAgentID) &&
+		    (((Agent *)p)->number() == id))
+			return ((Agent *)p);
+	}
+
 	for (Node* n = nodes_; n != 0; n = n->next_) 
 		for(Agent* a= n->agents(); a != 0; a = a->next_) 
-			if (a->number() == id) 
+			if (a->number() == id) {
+				int newEntry;
+				he = Tcl_CreateHashEntry(agentHash_, 
+							 (const char *)(long)id,
+							 &newEntry);
+				Tcl_SetHashValue(he, (ClientData)(long)a->id());
 				return (a);
+			}
 	return (0); 
 }
 
 Lan *NetModel::lookupLan(int nn) const
 {
-	for (Lan* l = lans_; l != 0; l = l->next_)
-		if (l->num() == nn)
-			return (l);
+	Tcl_HashEntry *he = Tcl_FindHashEntry(lanHash_, (const char *)(long)nn);
+	if (he != NULL)
+		return ((Lan *)Tcl_GetHashValue(he));
 	/* XXX */
 	//fprintf(stderr, "nam: no such lan %d\n", nn);
 	//exit(1);
@@ -1636,19 +1806,8 @@ Packet *NetModel::lookupPacket(int src, int dst, int id) const
   EdgeHashNode *h = lookupEdgeHashNode(src, dst);
   if (h == 0)
     return NULL;
-  int ctr=0;
-  for (Packet *p=h->edge->packets(); p!=NULL; p=p->next())
-    {
-#define PARANOID
-#ifdef PARANOID
-      ctr++;
-      if (ctr>h->edge->no_of_packets()) abort();
-#endif
-      if (p->id() == id)
-	return p;
-    }
   /*have to fail silent or we can't cope with link drops when doing settime*/
-  return 0;
+  return h->edge->lookupPacket(id);
 }
 
 /* Do not delete groups, because they are not explicitly deleted */
@@ -2271,11 +2430,13 @@ int NetModel::command(int argc, const char *const *argv) {
 			l->next_ = lans_;
 			lans_ = l;
 			l->insert(&drawables_);
+			enterLan(l);
 
 			Node *n = l->virtual_node();
 			n->next_ = nodes_;
 
 			nodes_ = n;
+			enterNode(n);
 			return (TCL_OK);
 		}
 
@@ -2995,45 +3156,53 @@ error:
 Animation* NetModel::findClosest(float dx, float dy, double halo)
 {
 	double closestDist;
-	Animation *startPtr, *closestPtr, *itemPtr;
+	Animation *closestPtr, *itemPtr;
 	BBox bb;
 
-	startPtr = animations_;
-	itemPtr = startPtr;
-	if (itemPtr == NULL) {
+	closestPtr = animations_;
+	if (closestPtr == NULL) {
 		return NULL;
 	}
-	closestDist = itemPtr->distance(dx, dy) - halo;
+	closestDist = closestPtr->distance(dx, dy) - halo;
 
 	if (closestDist < 0.0) {
 		closestDist = 0.0;
 	}
+	/*
+	 * Search for items that beat the current closest one, first
+	 * the animations, then the drawables.  Only items overlapping
+	 * the box around the closest one so far can, so ask the
+	 * quadtree for the drawables in that box.  Either way, items
+	 * are tried in list order and a later one wins a tie.
+	 */
+	QuadTree *t = NULL;
+	int i = 0, n = 0;
+	itemPtr = closestPtr;
 	while (1) {
 		double newDist;
 		/*
-		 * Update the bounding box using itemPtr, which is the
+		 * Update the bounding box using closestPtr, which is the
 		 * new closest item.
 		 */
 		bb.xmin = dx - closestDist - halo - 1,
 		bb.ymin = dy - closestDist - halo - 1,
 		bb.xmax = dx + closestDist + halo + 1,
 		bb.ymax = dy + closestDist + halo + 1;
-		closestPtr = itemPtr;
-		/*
-		 * Search for an item that beats the current closest 
-		 * one.
-		 * Work circularly through the canvas's item list until
-		 * getting back to the starting item.
-		 */
+
 		while (1) {
-			itemPtr = itemPtr->next();
-			if (itemPtr == NULL) {
-				if (startPtr == animations_) {
-					startPtr = drawables_;
-					itemPtr = startPtr;
-				} else 
-					return closestPtr;
-			}
+			if (t == NULL) {
+				itemPtr = itemPtr->next();
+				if (itemPtr == NULL) {
+					t = drawTree();
+					n = t->query(bb);
+					continue;
+				}
+			} else if (i < n) {
+				itemPtr = t->result(i++);
+				if (itemPtr->prev() == 0)
+					continue;
+			} else
+				return closestPtr;
 			if (itemPtr->isTagged()|| !itemPtr->bbox().overlap(bb))
 				continue;
 			newDist = itemPtr->distance(dx, dy)-halo;
@@ -3042,6 +3211,7 @@ Animation* NetModel::findClosest(float dx, float dy, double halo)
 			}
 			if (newDist <= closestDist) {
 				closestDist = newDist;
+				closestPtr = itemPtr;
 				break;
 			}
 		}
@@ -3085,21 +3255,32 @@ int NetModel::tagArea(BBox &bb, Tag *tag, int bEnclosed)
 			if (!p->isTagged() && p->bbox().overlap(bb) 
 			    && (p != tag))
 				tagObject(tag, p);
-		for (p = drawables_; p != NULL; p = p->next())
-			if (!p->isTagged() && p->bbox().overlap(bb)
-			    && (p != tag))
-				tagObject(tag, p);
 	} else {
 		// enclosed only
 		for (p = animations_; p != NULL; p = p->next()) 
 			if (!p->isTagged() && bb.inside(p->bbox())
 			    && (p != tag))
 				tagObject(tag, p);
-		for (p = drawables_; p != NULL; p = p->next())
-			if (!p->isTagged() && bb.inside(p->bbox())
-			    && (p != tag))
-				tagObject(tag, p);
 	}
+
+	// Drawables in either case are among those the quadtree finds
+	// touching the area.  Tagging changes the layout, so collect
+	// them all before tagging any.
+	BBox area = bb;
+	area.adjust();
+	QuadTree *t = drawTree();
+	int n = t->query(area);
+	Animation **found = new Animation*[n + 1];
+	for (int i = 0; i < n; i++)
+		found[i] = t->result(i);
+	for (int i = 0; i < n; i++) {
+		p = found[i];
+		if ((p->prev() == 0) || p->isTagged() || (p == tag))
+			continue;
+		if (bEnclosed ? bb.inside(p->bbox()) : p->bbox().overlap(bb))
+			tagObject(tag, p);
+	}
+	delete [] found;
 	return TCL_OK;
 }
 
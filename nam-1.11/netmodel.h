@@ -60,6 +60,7 @@ class Group;
 class Tag;
 struct BBox;
 class EditView;
+class QuadTree;
 
 #include "trace.h"
 #include "monitor.h"
@@ -88,6 +89,7 @@ public:
   virtual void update(double);
   void reset(double);
   void handle(const TraceEvent&, double now, int direction);
+  void purge();
 
   virtual void BoundingBox(BBox&);
   void addView(NetView*);
@@ -155,6 +157,9 @@ protected:
 
   int addr2id(int addr) const;
   int addAddress(int id, int addr) const;
+  void enterNode(Node *n);
+  void forgetNode(Node *n);
+  void enterLan(Lan *l);
   void removeNode(Node *n);
   Agent* lookupAgent(int id) const;
   Lan* lookupLan(int nn) const;
@@ -177,6 +182,11 @@ protected:
 
   Tcl_HashTable *addrHash_;
 
+  // Map node, lan and agent numbers to the objects
+  Tcl_HashTable *nodeHash_;
+  Tcl_HashTable *lanHash_;
+  Tcl_HashTable *agentHash_;	// cache of Animation ids, see lookupAgent
+
   EdgeHashNode * lookupEdgeHashNode(int source, int destination) const;
   void enterEdge(Edge* e);
   void removeEdge(Edge* e);
@@ -184,6 +194,14 @@ protected:
 
   Animation *drawables_;  // List of objects to draw
   Animation *animations_; // List of objects to draw
+
+  // Spatial index of drawables_, rebuilt when the layout or the list
+  // changes; see drawTree()
+  QuadTree *drawtree_;
+  unsigned int drawlayout_;
+  Animation *drawhead_;
+  QuadTree *drawTree();
+  void visibleArea(View *v, BBox &bb) const;
   Queue *queues_;
   View* views_;
   Node* nodes_;
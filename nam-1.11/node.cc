@@ -491,10 +491,12 @@ void Node::update_bb()
 	if (nMark_ > 0) 
 		off += nMark_ * NodeMarkScale * size_;
 	/*XXX*/
+	BBox old = bb_;
 	bb_.xmin = x_ - off;
 	bb_.ymin = y_ - off;
 	bb_.xmax = x_ + off;
 	bb_.ymax = y_ + off;
+	moved(old);
 }
 
 
@@ -121,6 +121,7 @@ public:
    virtual int inside(float px, float py) const;
    void monitor(Monitor *m, double now, char *result, int len);
    MonState *monitor_state();
+   virtual int classid() const { return ClassBPacketID; }
 private:
    double x_ ;
    double y_ ;
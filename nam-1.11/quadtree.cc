@@ -0,0 +1,227 @@
+/*
+ * Spatial index of animation objects; see quadtree.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "animation.h"
+#include "quadtree.h"
+
+// Like BBox::overlap(), but boxes that only touch, or have no area,
+// count as overlapping.
+static inline int
+touches(const BBox &a, const BBox &b)
+{
+	return !(b.xmin > a.xmax || b.xmax < a.xmin ||
+		 b.ymin > a.ymax || b.ymax < a.ymin);
+}
+
+static int
+intcmp(const void *a, const void *b)
+{
+	return (*(const int *)a - *(const int *)b);
+}
+
+QuadTree::QuadTree() :
+	ent_(0), nent_(0), maxent_(0), slot_(0), quad_(0), nquad_(0),
+	maxquad_(0), hit_(0), res_(0), nres_(0), always_(0)
+{
+	bounds_.clear();
+}
+
+QuadTree::~QuadTree()
+{
+	delete [] ent_;
+	delete [] slot_;
+	delete [] quad_;
+	delete [] hit_;
+	delete [] res_;
+}
+
+int
+QuadTree::newQuad(const BBox &bb)
+{
+	if (nquad_ == maxquad_) {
+		maxquad_ = maxquad_ ? 2 * maxquad_ : 64;
+		Quad *q = new Quad[maxquad_];
+		memcpy(q, quad_, nquad_ * sizeof(Quad));
+		delete [] quad_;
+		quad_ = q;
+	}
+	quad_[nquad_].bb = bb;
+	quad_[nquad_].child = -1;
+	quad_[nquad_].first = 0;
+	quad_[nquad_].n = 0;
+	return (nquad_++);
+}
+
+//----------------------------------------------------------------------
+// void
+// QuadTree::build(Animation *list)
+//   - Index the animations on list (linked by next()).
+//----------------------------------------------------------------------
+void
+QuadTree::build(Animation *list)
+{
+	Animation *a;
+	int n = 0;
+
+	for (a = list; a != 0; a = a->next())
+		n++;
+	if (n > maxent_) {
+		delete [] ent_;
+		delete [] slot_;
+		delete [] hit_;
+		delete [] res_;
+		maxent_ = n;
+		ent_ = new Entry[maxent_];
+		slot_ = new int[maxent_];
+		hit_ = new int[maxent_];
+		res_ = new Animation*[maxent_];
+	}
+	nent_ = n;
+	nquad_ = 0;
+	bounds_.clear();
+
+	// objects with no extent yet go first and are always returned
+	int i = 0, j = n;
+	always_ = 0;
+	for (a = list; a != 0; a = a->next(), i++) {
+		Entry &e = ent_[i];
+		e.bb = a->bbox();
+		e.a = a;
+		e.id = a->id();
+		if (e.bb.xmin > e.bb.xmax || e.bb.ymin > e.bb.ymax)
+			slot_[always_++] = i;
+		else {
+			slot_[--j] = i;
+			bounds_.merge(e.bb);
+		}
+	}
+	if (always_ < n) {
+		int root = newQuad(bounds_);
+		split(root, always_, n - always_, 0);
+	}
+}
+
+//----------------------------------------------------------------------
+// void
+// QuadTree::split(int q, int first, int n, int depth)
+//   - Make quadrant q hold the n objects in slot_[first..], pushing
+//     those that fit in one of its quarters down into that quarter.
+//----------------------------------------------------------------------
+void
+QuadTree::split(int q, int first, int n, int depth)
+{
+	quad_[q].first = first;
+	quad_[q].n = n;
+	if (n <= QT_LEAF || depth >= QT_DEPTH)
+		return;
+
+	BBox bb = quad_[q].bb;
+	float mx = (bb.xmin + bb.xmax) / 2;
+	float my = (bb.ymin + bb.ymax) / 2;
+
+	// quarter of each object, 4 if it straddles
+	int count[5] = { 0, 0, 0, 0, 0 };
+	int *where = new int[n];
+	for (int k = 0; k < n; k++) {
+		const BBox &e = ent_[slot_[first + k]].bb;
+		int w;
+		if (e.xmax < mx)
+			w = 0;
+		else if (e.xmin > mx)
+			w = 1;
+		else
+			w = 4;
+		if (w != 4) {
+			if (e.ymax < my)
+				;
+			else if (e.ymin > my)
+				w += 2;
+			else
+				w = 4;
+		}
+		where[k] = w;
+		count[w]++;
+	}
+	if (count[4] == n) {
+		delete [] where;
+		return;
+	}
+
+	// regroup: straddling objects, then quarters 0-3
+	int start[5];
+	start[4] = first;
+	start[0] = first + count[4];
+	for (int w = 1; w < 4; w++)
+		start[w] = start[w - 1] + count[w - 1];
+	int *tmp = new int[n];
+	memcpy(tmp, slot_ + first, n * sizeof(int));
+	int pos[5];
+	memcpy(pos, start, sizeof(pos));
+	for (int k = 0; k < n; k++)
+		slot_[pos[where[k]]++] = tmp[k];
+	delete [] tmp;
+	delete [] where;
+
+	quad_[q].n = count[4];
+	BBox cb[4];
+	for (int w = 0; w < 4; w++) {
+		cb[w].xmin = (w & 1) ? mx : bb.xmin;
+		cb[w].xmax = (w & 1) ? bb.xmax : mx;
+		cb[w].ymin = (w & 2) ? my : bb.ymin;
+		cb[w].ymax = (w & 2) ? bb.ymax : my;
+	}
+	// children are consecutive; newQuad() may move quad_
+	int c = newQuad(cb[0]);
+	for (int w = 1; w < 4; w++)
+		newQuad(cb[w]);
+	quad_[q].child = c;
+	for (int w = 0; w < 4; w++)
+		split(c + w, start[w], count[w], depth + 1);
+}
+
+void
+QuadTree::collect(int q, const BBox &bb)
+{
+	const Quad &qd = quad_[q];
+	for (int k = 0; k < qd.n; k++) {
+		int i = slot_[qd.first + k];
+		if (touches(ent_[i].bb, bb))
+			hit_[nres_++] = i;
+	}
+	if (qd.child < 0)
+		return;
+	for (int w = 0; w < 4; w++)
+		if (touches(quad_[qd.child + w].bb, bb))
+			collect(qd.child + w, bb);
+}
+
+//----------------------------------------------------------------------
+// int
+// QuadTree::query(const BBox &bb)
+//   - Find the objects whose bounding boxes touch bb, and those with
+//     no bounding box.  Returns how many; they are result(0), ...,
+//     in the order of the list the tree was built from.
+//----------------------------------------------------------------------
+int
+QuadTree::query(const BBox &bb)
+{
+	nres_ = 0;
+	for (int k = 0; k < always_; k++)
+		hit_[nres_++] = slot_[k];
+	if (nquad_ > 0 && touches(quad_[0].bb, bb))
+		collect(0, bb);
+	qsort(hit_, nres_, sizeof(int), intcmp);
+
+	int n = 0;
+	for (int k = 0; k < nres_; k++) {
+		const Entry &e = ent_[hit_[k]];
+		// skip objects deleted since the tree was built
+		if (Animation::find(e.id) == e.a)
+			res_[n++] = e.a;
+	}
+	return (n);
+}
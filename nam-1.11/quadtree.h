@@ -0,0 +1,67 @@
+/*
+ * Spatial index of animation objects by bounding box.
+ *
+ * The tree is built in one go from a list of animations and answers
+ * "which of them overlap this box" in time proportional to the size
+ * of the answer rather than of the list.  Objects that straddle the
+ * split lines of a quadrant stay in the quadrant above, so every
+ * object is kept once.
+ *
+ * The tree records object ids rather than trusting its pointers: an
+ * object deleted since the tree was built is skipped by query().
+ * Objects that move are not followed; the owner rebuilds the tree.
+ */
+
+#ifndef nam_quadtree_h
+#define nam_quadtree_h
+
+#include "bbox.h"
+
+class Animation;
+
+#define QT_LEAF 16		/* objects in a quadrant before it splits */
+#define QT_DEPTH 16		/* deepest quadrant */
+
+class QuadTree {
+ public:
+	QuadTree();
+	~QuadTree();
+
+	void build(Animation *list);
+	int query(const BBox &bb);
+	Animation* result(int i) const { return res_[i]; }
+	const BBox& bounds() const { return bounds_; }
+	int size() const { return nent_; }
+
+ private:
+	struct Entry {
+		BBox bb;
+		Animation *a;
+		unsigned int id;
+	};
+	struct Quad {
+		BBox bb;		// area of the quadrant
+		int child;		// first of 4 children, -1 if a leaf
+		int first;		// objects of this quadrant in slot_
+		int n;
+	};
+
+	void split(int q, int first, int n, int depth);
+	int newQuad(const BBox &bb);
+	void collect(int q, const BBox &bb);
+
+	Entry *ent_;		// objects, in list order
+	int nent_;
+	int maxent_;
+	int *slot_;		// entry indices, grouped by quadrant
+	Quad *quad_;
+	int nquad_;
+	int maxquad_;
+	BBox bounds_;
+	int *hit_;		// entry indices found by query()
+	Animation **res_;
+	int nres_;
+	int always_;		// entries with no bounding box yet
+};
+
+#endif
@@ -184,10 +184,12 @@ void QueueHandle::size(double s) {
 //----------------------------------------------------------------------
 //----------------------------------------------------------------------
 void QueueHandle::update_bb() {
+  BBox old = bb_;
   bb_.xmin = x_;
   bb_.ymin = y_;
   bb_.xmax = x_ + width_;
   bb_.ymax = y_ + height_;
+  moved(old);
 }
 
 //----------------------------------------------------------------------
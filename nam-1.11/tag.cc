@@ -152,6 +152,7 @@ void Tag::update_bb(void)
 	Tcl_HashSearch hs;
 	Animation *a;
 
+	BBox old = bb_;
 	bb_.clear();
 	for (he = Tcl_FirstHashEntry(mbrHash_, &hs);
 	     he != NULL;
@@ -159,6 +160,7 @@ void Tag::update_bb(void)
 		a = (Animation *) Tcl_GetHashValue(he);
 		a->merge(bb_);
 	}
+	moved(old);
 }
 
 void Tag::reset(double /*now*/)
@@ -33,6 +33,10 @@ set ANIMATOR_CONTROL_CLASS AnimControl
 # Class variables
 Animator set id_ 0
 
+Trace set indexHorizon_ 1s
+	;# Longest a packet is kept on a link in the snapshots of a trace
+	;# index (see nam(1)).  Overwrite this in .nam.tcl for slower links.
+
 AnimControl set instance_ 	""
 AnimControl set INIT_PORT_ 	20000	;# Arbitrary value
 AnimControl set PORT_FILE_ 	"[lindex [glob ~] 0]/.nam-port"
@@ -52,6 +52,7 @@
 #include "packet.h"
 #include "address.h"
 #include "nam_stream.h"
+#include "traceindex.h"
 
 extern double time_atof(const char*);
 
@@ -86,9 +87,14 @@ Trace::Trace(const char *fname, const char *animator) :
   handlers_(0),
   nam_(0),
   skipahead_mode_(0),
-  count_(0) {
+  count_(0),
+  parse_table_(0),
+  index_(0),
+  persisted_(0),
+  replay_table_(0) {
   
   last_event_time_ = 0.0;
+  bind_time("indexHorizon_", &indexHorizon_);
 
   // Connect to nam animator
   nam_ = (NetworkAnimator *)TclObject::lookup(animator);
@@ -123,6 +129,13 @@ Trace::Trace(const char *fname, const char *animator) :
 
   // Initialize ParseTable
   parse_table_ = new ParseTable(&pending_);
+
+  // Large traces get a time index for seeking (see traceindex.h)
+  if (nam_stream_->seekable()) {
+    index_ = TraceIndex::open(fileName_, indexHorizon_);
+    if (index_ != NULL)
+      replay_table_ = new ParseTable(&replay_);
+  }
 }
 
 //----------------------------------------------------------------------
@@ -130,6 +143,8 @@ Trace::Trace(const char *fname, const char *animator) :
 //----------------------------------------------------------------------
 Trace::~Trace() {
   delete parse_table_;
+  delete replay_table_;
+  delete index_;
 }
 
 //----------------------------------------------------------------------
@@ -387,7 +402,8 @@ void Trace::findLastLine() {
   /*
    * This next check is bogus, but zlib fails it.
    * Go figure.
-   * Fortunately compressed files should not be seekable.
+   * Fortunately compressed files are only seekable through
+   * their index (gzindex.h), which passes it.
    */
   pos = nam_stream_->tell();
   assert(pos != -1);
@@ -447,13 +463,70 @@ void Trace::addHandler(TraceHandler* th)
   handlers_ = p;
 }
 
+//----------------------------------------------------------------------
+// void
+// Trace::replay(const char *line, double now, int direction)
+//   - Pass one trace line from the index to all trace handlers.
+//----------------------------------------------------------------------
+void Trace::replay(const char *line, double now, int direction) {
+  strncpy(replay_.image, line, sizeof(replay_.image) - 1);
+  replay_.image[sizeof(replay_.image) - 1] = 0;
+  replay_.offset = 0;
+  if (!replay_table_->parseLine(replay_.image))
+    return;
+  for (TraceHandlerList* p = handlers_; p != 0; p = p->next)
+    p->th->handle(replay_, now, direction);
+}
+
+//----------------------------------------------------------------------
+// void
+// Trace::jump(int checkpoint, double now)
+//   - Restore the animation state at an index checkpoint and position
+//     the trace there, so that settime() only has to read on from the
+//     checkpoint to 'now'.  Persistent events between where we are
+//     and the checkpoint are redone or undone; packets come from the
+//     checkpoint's snapshot.
+//----------------------------------------------------------------------
+void Trace::jump(int checkpoint, double now) {
+  const IndexCheckpoint& cp = index_->checkpoint(checkpoint);
+  char line[TRACE_LINE_MAXLEN + 2];
+
+  while (persisted_ < cp.npersist)
+    replay(index_->persist(persisted_++), now, FORWARDS);
+  while (persisted_ > cp.npersist)
+    replay(index_->persist(--persisted_), now, BACKWARDS);
+
+  for (TraceHandlerList* p = handlers_; p != 0; p = p->next)
+    p->th->purge();
+  index_->snapshot(checkpoint);
+  while (index_->snapline(line, sizeof(line)) != NULL)
+    replay(line, now, FORWARDS);
+
+  direction_ = FORWARDS;
+  last_event_time_ = 0.0;
+  rewind(cp.offset);
+}
+
 //----------------------------------------------------------------------
 // void
 // Trace::settime(double now, int timeSliderClicked)
 //   - Set the current trace time to 'now'.
 //----------------------------------------------------------------------
 void Trace::settime(double now, int timeSliderClicked) {
-  if (now < now_) {
+  /*
+   * With an index, go backwards or skip more than a checkpoint ahead
+   * by jumping to the checkpoint before 'now' and reading on from
+   * there.
+   */
+  int k = -1;
+  if (index_ != NULL) {
+    k = index_->find(now);
+    if (now >= now_ && k <= index_->find(now_) + 1)
+      k = -1;
+  }
+  if (k >= 0) {
+    jump(k, now);
+  } else if (now < now_) {
 #ifdef OLDWAY
     for (TraceHandlerList* p = handlers_; p != 0; p = p->next)
       p->th->reset(now);
@@ -498,6 +571,8 @@ void Trace::settime(double now, int timeSliderClicked) {
     // Find Handler for this pending event?
     for (TraceHandlerList* p = handlers_; p != 0; p = p->next)
       p->th->handle(e, now, direction_);
+    if (TraceIndex::persistent(e.tt))
+      persisted_ += direction_;
 
     if (e.tt == 'h' && (e.pe.src == 0 || e.pe.dst == 0)) {
       sprintf(event, "%d %d %.6f %d/", e.pe.src, e.pe.dst, 
@@ -40,6 +40,7 @@
 #include "animator.h"
 #include "parser.h"
 class NamStream;
+class TraceIndex;
 //class ParseTable;
 
 #define TRACE_LINE_MAXLEN 256
@@ -298,6 +299,8 @@ public:
   virtual void update(double) = 0;
   virtual void reset(double) = 0;
   virtual void handle(const TraceEvent&, double now, int direction) = 0;
+  // Forget packets in flight and in queues before a seek.
+  virtual void purge() {}
   inline NetworkAnimator* nam() { return nam_; }
 protected:
   NetworkAnimator *nam_;
@@ -330,6 +333,8 @@ class Trace : public TclObject {
 	void addHandler(TraceHandler*);
 	void settime(double now, int timeSliderClicked);
 	void findLastLine();
+	void jump(int checkpoint, double now);
+	void replay(const char *line, double now, int direction);
 
 	TraceHandlerList* handlers_;
 	int lineno_;
@@ -347,6 +352,12 @@ class Trace : public TclObject {
 	int count_;
   
 	ParseTable * parse_table_;
+
+	TraceIndex *index_;	// NULL if the trace is not indexed
+	double indexHorizon_;	// longest a packet stays on a link (bound)
+	int persisted_;		// persistent events (see TraceIndex) applied
+	TraceEvent replay_;
+	ParseTable *replay_table_;
 };
 
 #endif
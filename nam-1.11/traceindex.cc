@@ -0,0 +1,419 @@
+/*
+ * Time index of a nam trace file; see traceindex.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <tcl.h>
+
+#include "trace.h"
+#include "nam_stream.h"
+#include "traceindex.h"
+
+//----------------------------------------------------------------------
+// Packets that are queued or on a link while the index is built,
+// kept in the order they got there and hashed on "src dst id".
+//----------------------------------------------------------------------
+struct LivePacket {
+	char *line;
+	double time;
+	Tcl_HashEntry *he;
+	LivePacket *prev;
+	LivePacket *next;
+};
+
+class LiveSet {
+ public:
+	LiveSet() : head_(0), tail_(0) {
+		Tcl_InitHashTable(&hash_, TCL_STRING_KEYS);
+	}
+	~LiveSet() {
+		while (head_ != 0)
+			remove(head_);
+		Tcl_DeleteHashTable(&hash_);
+	}
+	void add(const char *key, const char *line, double time);
+	void remove(const char *key);
+	void expire(double time);
+	int write(FILE *out);
+	int size() const { return (hash_.numEntries); }
+ private:
+	void remove(LivePacket *p);
+	Tcl_HashTable hash_;
+	LivePacket *head_;
+	LivePacket *tail_;
+};
+
+void LiveSet::add(const char *key, const char *line, double time)
+{
+	int isnew;
+	Tcl_HashEntry *he = Tcl_CreateHashEntry(&hash_, key, &isnew);
+	if (!isnew)
+		remove((LivePacket *)Tcl_GetHashValue(he));
+	he = Tcl_CreateHashEntry(&hash_, key, &isnew);
+	LivePacket *p = new LivePacket;
+	p->line = strdup(line);
+	p->time = time;
+	p->he = he;
+	p->next = 0;
+	p->prev = tail_;
+	if (tail_ != 0)
+		tail_->next = p;
+	else
+		head_ = p;
+	tail_ = p;
+	Tcl_SetHashValue(he, (ClientData)p);
+}
+
+void LiveSet::remove(LivePacket *p)
+{
+	if (p->prev != 0)
+		p->prev->next = p->next;
+	else
+		head_ = p->next;
+	if (p->next != 0)
+		p->next->prev = p->prev;
+	else
+		tail_ = p->prev;
+	Tcl_DeleteHashEntry(p->he);
+	free(p->line);
+	delete p;
+}
+
+void LiveSet::remove(const char *key)
+{
+	Tcl_HashEntry *he = Tcl_FindHashEntry(&hash_, key);
+	if (he != 0)
+		remove((LivePacket *)Tcl_GetHashValue(he));
+}
+
+// Forget packets that got there before 'time'.
+void LiveSet::expire(double time)
+{
+	while (head_ != 0 && head_->time < time)
+		remove(head_);
+}
+
+int LiveSet::write(FILE *out)
+{
+	int n = 0;
+	for (LivePacket *p = head_; p != 0; p = p->next, n++)
+		fprintf(out, "S %s", p->line);
+	return (n);
+}
+
+//----------------------------------------------------------------------
+// int
+// lineinfo(const char *line, double &time, char *key)
+//   - Pick the time and, for packet events, the "src dst id" key out
+//     of a trace line.  Returns 0 if the line is not a timed event.
+//----------------------------------------------------------------------
+static int
+lineinfo(const char *line, double &time, char *key)
+{
+	int src = -1, dst = -1, id = -1, timed = 0;
+
+	if (*line == '#' || isspace(*line) || *line == 0)
+		return (0);
+	for (const char *cp = line + 1; *cp != 0 && *cp != '{'; cp++) {
+		if (cp[-1] != ' ' || cp[0] != '-' || cp[1] == 0 ||
+		    (cp[2] != ' ' && cp[2] != '\t'))
+			continue;
+		const char *v = cp + 3;
+		while (*v == ' ' || *v == '\t')
+			v++;
+		switch (cp[1]) {
+		case 't':
+			if (*v == '*')
+				return (0);
+			time = atof(v);
+			timed = 1;
+			break;
+		case 's':
+			src = atoi(v);
+			break;
+		case 'd':
+			dst = atoi(v);
+			break;
+		case 'i':
+			id = atoi(v);
+			break;
+		}
+	}
+	sprintf(key, "%d %d %d", src, dst, id);
+	return (timed);
+}
+
+//----------------------------------------------------------------------
+// int
+// TraceIndex::persistent(int tt)
+//   - Events of type tt leave state behind that is not kept in the
+//     checkpoint snapshots, so seeks replay or undo them all.
+//----------------------------------------------------------------------
+int
+TraceIndex::persistent(int tt)
+{
+	return (strchr("h+-dr#T", tt) == 0);
+}
+
+//----------------------------------------------------------------------
+// int
+// TraceIndex::build(NamStream *in, FILE *out, long size, long mtime,
+//                    double horizon)
+//   - Write the index of the trace read from in to out.  Offsets are
+//     those of the stream, so for a compressed trace they are offsets
+//     in the uncompressed data.  Packets on a link for longer than
+//     horizon seconds are left out of the snapshots.
+//----------------------------------------------------------------------
+int
+TraceIndex::build(NamStream *in, FILE *out, long size, long mtime,
+		  double horizon)
+{
+	// Lines are read as Trace::nextLine() reads them.
+	char line[TRACE_LINE_MAXLEN];
+	char key[64];
+	LiveSet queued, onlink;
+	double time, last = -1.;
+	long off = 0, cpoff = 0;
+	int npersist = 0;
+
+	fprintf(out, "# nam index %d %ld %ld %d %.17g\n", INDEX_VERSION, size,
+		mtime, INDEX_SPAN, horizon);
+	fprintf(out, "C -1 0 0 0\n");
+	in->seek(0, SEEK_SET);
+	while (in->gets(line, sizeof(line)) != NULL) {
+		long end = off + strlen(line);
+		if (!lineinfo(line, time, key)) {
+			off = end;
+			continue;
+		}
+		if (line[end - off - 1] != '\n') {
+			// nam will not parse a split line either
+			off = end;
+			continue;
+		}
+		if (time > last && off - cpoff >= INDEX_SPAN) {
+			onlink.expire(time - horizon);
+			fprintf(out, "C %.17g %ld %d %d\n", time, off, npersist,
+				queued.size() + onlink.size());
+			queued.write(out);
+			onlink.write(out);
+			cpoff = off;
+		}
+		switch (line[0]) {
+		case '+':
+			queued.add(key, line, time);
+			break;
+		case '-':
+		case 'd':
+			queued.remove(key);
+			break;
+		case 'h':
+			onlink.add(key, line, time);
+			break;
+		case 'r':
+			onlink.remove(key);
+			break;
+		default:
+			if (persistent(line[0])) {
+				fprintf(out, "P %s", line);
+				npersist++;
+			}
+			break;
+		}
+		if (time > last)
+			last = time;
+		off = end;
+	}
+	return (fflush(out) == 0 && !ferror(out));
+}
+
+//----------------------------------------------------------------------
+// TraceIndex *
+// TraceIndex::open(const char *tracefile, double horizon)
+//   - Return the index of tracefile, building it if there is none or
+//     the trace or the horizon has changed since.  Returns NULL if
+//     the trace is too small to need one or no index could be built.
+//----------------------------------------------------------------------
+TraceIndex *
+TraceIndex::open(const char *tracefile, double horizon)
+{
+	struct stat st;
+	if (stat(tracefile, &st) < 0)
+		return (NULL);
+
+	// the size that matters is that of the (uncompressed) trace
+	NamStream *in = NamStream::open(tracefile);
+	if (in == NULL)
+		return (NULL);
+	if (!in->is_ok() || !in->seekable() ||
+	    in->seek(0, SEEK_END) < INDEX_MINSIZE) {
+		in->close();
+		delete in;
+		return (NULL);
+	}
+
+	char *name = new char[strlen(tracefile) + 5];
+	sprintf(name, "%s.idx", tracefile);
+	FILE *fp = fopen(name, "r");
+	if (fp != NULL) {
+		TraceIndex *ti = new TraceIndex(fp);
+		if (ti->load(st.st_size, st.st_mtime, horizon)) {
+			in->close();
+			delete in;
+			delete [] name;
+			return (ti);
+		}
+		delete ti;
+	}
+
+	fprintf(stderr, "nam: indexing %s ...\n", tracefile);
+	fp = fopen(name, "w+");
+	delete [] name;
+	if (fp == NULL)
+		fp = tmpfile();
+	int ok = (fp != NULL &&
+		  build(in, fp, st.st_size, st.st_mtime, horizon));
+	in->close();
+	delete in;
+	if (!ok) {
+		if (fp != NULL)
+			fclose(fp);
+		return (NULL);
+	}
+	::rewind(fp);
+	TraceIndex *ti = new TraceIndex(fp);
+	if (!ti->load(st.st_size, st.st_mtime, horizon)) {
+		delete ti;
+		return (NULL);
+	}
+	return (ti);
+}
+
+TraceIndex::TraceIndex(FILE *fp) :
+	fp_(fp), cp_(0), ncp_(0), maxcp_(0), pe_(0), npe_(0), maxpe_(0),
+	snapleft_(0)
+{
+}
+
+TraceIndex::~TraceIndex()
+{
+	for (int i = 0; i < npe_; i++)
+		free(pe_[i]);
+	delete [] pe_;
+	delete [] cp_;
+	if (fp_ != NULL)
+		fclose(fp_);
+}
+
+void
+TraceIndex::addCheckpoint(const IndexCheckpoint& c)
+{
+	if (ncp_ == maxcp_) {
+		maxcp_ = maxcp_ ? 2 * maxcp_ : 256;
+		IndexCheckpoint *cp = new IndexCheckpoint[maxcp_];
+		memcpy(cp, cp_, ncp_ * sizeof(IndexCheckpoint));
+		delete [] cp_;
+		cp_ = cp;
+	}
+	cp_[ncp_++] = c;
+}
+
+void
+TraceIndex::addPersist(const char *line)
+{
+	if (npe_ == maxpe_) {
+		maxpe_ = maxpe_ ? 2 * maxpe_ : 256;
+		char **pe = new char*[maxpe_];
+		memcpy(pe, pe_, npe_ * sizeof(char*));
+		delete [] pe_;
+		pe_ = pe;
+	}
+	pe_[npe_++] = strdup(line);
+}
+
+//----------------------------------------------------------------------
+// int
+// TraceIndex::load(long size, long mtime, double horizon)
+//   - Read the index, checking that it was built for a trace of this
+//     size and modification time, and with this horizon.  Snapshots are left in the file.
+//----------------------------------------------------------------------
+int
+TraceIndex::load(long size, long mtime, double horizon)
+{
+	char buf[TRACE_LINE_MAXLEN + 64];
+	int version, span;
+	long isize, imtime;
+	double ihorizon;
+
+	if (fgets(buf, sizeof(buf), fp_) == NULL ||
+	    sscanf(buf, "# nam index %d %ld %ld %d %lg", &version, &isize,
+		   &imtime, &span, &ihorizon) != 5 ||
+	    version != INDEX_VERSION || isize != size || imtime != mtime ||
+	    ihorizon != horizon)
+		return (0);
+
+	while (fgets(buf, sizeof(buf), fp_) != NULL) {
+		if (buf[0] == 'C') {
+			IndexCheckpoint c;
+			if (sscanf(buf, "C %lg %ld %d %d", &c.time, &c.offset,
+				   &c.npersist, &c.nsnap) != 4)
+				return (0);
+			c.snapoff = ftell(fp_);
+			addCheckpoint(c);
+			for (int i = 0; i < c.nsnap; i++)
+				if (fgets(buf, sizeof(buf), fp_) == NULL)
+					return (0);
+		} else if (buf[0] == 'P' && buf[1] == ' ') {
+			addPersist(buf + 2);
+		} else
+			return (0);
+	}
+	return (ncp_ > 0);
+}
+
+//----------------------------------------------------------------------
+// int
+// TraceIndex::find(double t)
+//   - The last checkpoint at or before time t.  Checkpoint 0 is the
+//     beginning of the trace.
+//----------------------------------------------------------------------
+int
+TraceIndex::find(double t) const
+{
+	int lo = 0, hi = ncp_ - 1;
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (cp_[mid].time <= t)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+	return (lo);
+}
+
+// Start reading the snapshot of checkpoint i with snapline().
+int
+TraceIndex::snapshot(int i)
+{
+	if (fseek(fp_, cp_[i].snapoff, SEEK_SET) < 0) {
+		snapleft_ = 0;
+		return (-1);
+	}
+	snapleft_ = cp_[i].nsnap;
+	return (snapleft_);
+}
+
+char *
+TraceIndex::snapline(char *buf, int len)
+{
+	if (snapleft_ <= 0 || fgets(buf, len, fp_) == NULL)
+		return (NULL);
+	snapleft_--;
+	// drop the "S "
+	memmove(buf, buf + 2, strlen(buf + 2) + 1);
+	return (buf);
+}
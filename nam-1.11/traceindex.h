@@ -0,0 +1,86 @@
+/*
+ * Time index of a nam trace file, for seeking without replaying the
+ * whole trace.
+ *
+ * The index is kept next to the trace as "<trace>.idx" and is built
+ * by one pass over the trace the first time a large trace is opened
+ * (or whenever the trace has changed since).  Compressed traces are
+ * indexed as well, by offsets in the uncompressed trace, once they can
+ * be seeked (gzindex.h).  It holds
+ *
+ *  - checkpoints, about every INDEX_SPAN bytes of trace: the time
+ *    and file offset of an event such that every earlier event
+ *    happened strictly before that time;
+ *
+ *  - for each checkpoint, a snapshot of the animation state that
+ *    comes and goes with packets: the '+' lines of packets sitting
+ *    in link queues and the 'h' lines of packets still on a link at
+ *    that time.  A packet whose 'r' line is missing would stay on
+ *    the link forever, so 'h' lines older than a horizon (Trace's
+ *    indexHorizon_, 1s by default; raise it for links slower than
+ *    that) are left out of the snapshots;
+ *
+ *  - every other timed event ("persistent" events: node, link,
+ *    agent, feature, route, group, ... changes), in trace order.
+ *
+ * A seek to time t then undoes or redoes the persistent events
+ * between the current position and the last checkpoint before t,
+ * loads that checkpoint's snapshot and replays the trace from the
+ * checkpoint to t, so its cost is bounded by INDEX_SPAN bytes of
+ * trace plus the snapshot, wherever t is.
+ */
+
+#ifndef nam_traceindex_h
+#define nam_traceindex_h
+
+#include <stdio.h>
+
+class NamStream;
+
+#define INDEX_VERSION 2
+#define INDEX_SPAN (1 << 20)		/* bytes of trace per checkpoint */
+#define INDEX_MINSIZE (4 << 20)		/* smaller traces are not indexed */
+
+struct IndexCheckpoint {
+	double time;
+	long offset;		// trace offset of the first event at time
+	int npersist;		// persistent events before offset
+	int nsnap;		// snapshot lines
+	long snapoff;		// index file offset of the snapshot
+};
+
+class TraceIndex {
+ public:
+	static TraceIndex* open(const char *tracefile, double horizon);
+	~TraceIndex();
+
+	static int persistent(int tt);
+
+	int find(double t) const;
+	const IndexCheckpoint& checkpoint(int i) const { return cp_[i]; }
+	int ncheckpoints() const { return ncp_; }
+	const char* persist(int i) const { return pe_[i]; }
+	int npersist() const { return npe_; }
+
+	int snapshot(int i);
+	char* snapline(char *buf, int len);
+
+ private:
+	TraceIndex(FILE *fp);
+	static int build(NamStream *in, FILE *out, long size, long mtime,
+			 double horizon);
+	int load(long size, long mtime, double horizon);
+	void addCheckpoint(const IndexCheckpoint&);
+	void addPersist(const char *line);
+
+	FILE *fp_;
+	IndexCheckpoint *cp_;
+	int ncp_;
+	int maxcp_;
+	char **pe_;		// persistent events, in trace order
+	int npe_;
+	int maxpe_;
+	int snapleft_;		// snapshot lines not read yet
+};
+
+#endif
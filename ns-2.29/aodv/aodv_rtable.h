@@ -36,6 +36,7 @@ The AODV code developed by the CMU/MONARCH group was optimized and tuned by Sami
 #include <config.h>
 #include <lib/bsd-list.h>
 #include <scheduler.h>
+#include "mem-account.h"
 
 #define CURRENT_TIME    Scheduler::instance().clock()
 #define INFINITY2        0xff
@@ -47,6 +48,7 @@ class AODV_Neighbor {
         friend class AODV;
         friend class aodv_rt_entry;
  public:
+        MEM_ACCOUNT(MEM_ROUTE)
         AODV_Neighbor(u_int32_t a) { nb_addr = a; }
 
  protected:
@@ -64,6 +66,7 @@ class AODV_Precursor {
         friend class AODV;
         friend class aodv_rt_entry;
  public:
+        MEM_ACCOUNT(MEM_ROUTE)
         AODV_Precursor(u_int32_t a) { pc_addr = a; }
 
  protected:
@@ -83,6 +86,7 @@ class aodv_rt_entry {
         friend class AODV;
 	friend class LocalRepairTimer;
  public:
+        MEM_ACCOUNT(MEM_ROUTE)
         aodv_rt_entry();
         ~aodv_rt_entry();
 
@@ -65,6 +65,7 @@ struct hdr_rtp {
 
 class RTPSource : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	RTPSource* next;
 
 	RTPSource(u_int32_t srcid);
@@ -44,11 +44,25 @@ int AddressClassifier::classify(Packet *p) {
 	return mshift(iph->daddr());
 };
 
+void AddressClassifier::recv(Packet* p, Handler* h)
+{
+	if (direct_) {
+		int cl = mshift(hdr_ip::access(p)->daddr());
+		NsObject* node;
+		if (cl >= 0 && cl < nslot_ && (node = slot_[cl]) != 0) {
+			node->recv(p, h);
+			return;
+		}
+	}
+	Classifier::recv(p, h);
+}
+
 static class AddressClassifierClass : public TclClass {
 public:
 	AddressClassifierClass() : TclClass("Classifier/Addr") {}
 	TclObject* create(int, const char*const*) {
-		return (new AddressClassifier());
+		// subclasses with their own classify() leave direct_ 0
+		return (new AddressClassifier(1));
 	}
 } class_address_classifier;
 
@@ -38,8 +38,12 @@
 #define BCAST_ADDR_MASK	mask_
 
 class AddressClassifier : public Classifier {
+public:
+	AddressClassifier(int direct = 0) : direct_(direct) {}
+	virtual void recv(Packet* p, Handler* h);
 protected:
 	virtual int classify(Packet * p);
+	int direct_;	// classify() is ours: index slot_ in recv()
 };
 
 /* addr. classifier that enforces reserved ports */
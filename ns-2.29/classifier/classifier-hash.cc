@@ -55,6 +55,7 @@ extern "C" {
 #include "ip.h"
 #include "classifier.h"
 #include "classifier-hash.h"
+#include "classifier-port.h"
 
 /****************** HashClassifier Methods ************/
 
@@ -135,6 +136,7 @@ int HashClassifier::command(int argc, const char*const* argv)
 			if (ep) {
 				long slot = (long)Tcl_GetHashValue(ep);
 				Tcl_DeleteHashEntry(ep);
+				changed();
 				tcl.resultf("%lu", slot);
 				return (TCL_OK);
 			}
@@ -179,6 +181,92 @@ public:
 
 
 // DestHashClassifier methods
+DestHashClassifier::DestHashClassifier() :
+	HashClassifier(TCL_ONE_WORD_KEYS), dirty_(1), direct_(0), ndirect_(0),
+	maxdirect_(0), dmux_(0), dmuxkey_(-1)
+{
+}
+
+DELAY_BIND_BEGIN(DestHashClassifier, HashClassifier)
+	DELAY_BIND_BOOL("direct_", usedirect_),
+DELAY_BIND_END
+
+DestHashClassifier::~DestHashClassifier()
+{
+	delete [] direct_;
+}
+
+/*
+ * Index the hash table by destination.  Destinations are node ids
+ * under flat addressing, so the table is dense; when it is not, the
+ * array is cut short and the rest is left to the hash table.
+ */
+void DestHashClassifier::rebuild()
+{
+	Tcl_HashEntry *ep;
+	Tcl_HashSearch hs;
+	long key, maxkey = -1;
+	int n = 0;
+
+	dirty_ = 0;
+	for (ep = Tcl_FirstHashEntry(&ht_, &hs); ep != 0;
+	     ep = Tcl_NextHashEntry(&hs)) {
+		key = (long)Tcl_GetHashKey(&ht_, ep);
+		if (key > maxkey)
+			maxkey = key;
+		n++;
+	}
+	// at most four times as many entries as routes
+	ndirect_ = maxkey + 1;
+	if (ndirect_ > 4 * n + 64)
+		ndirect_ = 4 * n + 64;
+	if (ndirect_ > maxdirect_) {
+		delete [] direct_;
+		maxdirect_ = ndirect_;
+		direct_ = new NsObject*[maxdirect_];
+	}
+	memset(direct_, 0, ndirect_ * sizeof(NsObject*));
+	dmux_ = 0;
+	dmuxkey_ = -1;
+
+	for (ep = Tcl_FirstHashEntry(&ht_, &hs); ep != 0;
+	     ep = Tcl_NextHashEntry(&hs)) {
+		key = (long)Tcl_GetHashKey(&ht_, ep);
+		long slot = (long)Tcl_GetHashValue(ep);
+		// what find() would return, if it returns a slot
+		if (key < 0 || key >= ndirect_ || slot < 0 || slot > maxslot_)
+			continue;
+		direct_[key] = slot_[slot];
+		PortClassifier *pc = dynamic_cast<PortClassifier*>(slot_[slot]);
+		if (pc != 0 && dmux_ == 0) {
+			dmux_ = pc;
+			dmuxkey_ = key;
+		}
+	}
+}
+
+void DestHashClassifier::recv(Packet* p, Handler* h)
+{
+	if (usedirect_) {
+		if (dirty_)
+			rebuild();
+		int key = mshift(hdr_ip::access(p)->daddr());
+		if (key >= 0 && key < ndirect_) {
+			NsObject *node = direct_[key];
+			if (key == dmuxkey_) {
+				NsObject *agent = dmux_->lookup(p);
+				if (agent != 0)
+					node = agent;
+			}
+			if (node != 0) {
+				node->recv(p, h);
+				return;
+			}
+		}
+	}
+	Classifier::recv(p, h);
+}
+
 int DestHashClassifier::classify(Packet *p)
 {
 	int slot= lookup(p);
@@ -64,6 +64,14 @@ public:
 		return lookup(p);
 	};
 	void set_default(int slot) { default_ = slot; } 
+	virtual void install(int slot, NsObject* p) {
+		Classifier::install(slot, p);
+		changed();
+	}
+	virtual void clear(int slot) {
+		Classifier::clear(slot);
+		changed();
+	}
 	int do_set_hash(nsaddr_t src, nsaddr_t dst, int fid, int slot) {
 		return (set_hash(src,dst,fid,slot));
 	}
@@ -98,7 +106,10 @@ protected:
 	void reset() {
 		Tcl_DeleteHashTable(&ht_);
 		Tcl_InitHashTable(&ht_, keylen_);
+		changed();
 	}
+	// called whenever the table or the slots change
+	virtual void changed() {}
 
 	virtual const char* hashkey(nsaddr_t, nsaddr_t, int)=0; 
 
@@ -109,6 +120,7 @@ protected:
 						       &newEntry); 
 		if (ep) {
 			Tcl_SetHashValue(ep, slot);
+			changed();
 			return slot;
 		}
 		return -1;
@@ -168,16 +180,41 @@ protected:
 	}
 };
 
+class PortClassifier;
+
+/*
+ * The routing table of a flat node.  Besides the hash table, routes
+ * are kept in an array indexed by destination (direct_), built from
+ * the hash table the first time a packet arrives after a route
+ * changed.  A packet for a destination found there goes straight to
+ * its next hop, or, when that is the node's own port demultiplexer,
+ * straight to the agent on its port.  Anything else (no route,
+ * default routes, addresses too sparse to index) takes the usual
+ * path through find().
+ */
 class DestHashClassifier : public HashClassifier {
 public:
-	DestHashClassifier() : HashClassifier(TCL_ONE_WORD_KEYS) {}
+	DestHashClassifier();
+	~DestHashClassifier();
 	virtual int command(int argc, const char*const* argv);
 	int classify(Packet *p);
 	virtual void do_install(char *dst, NsObject *target);
+	virtual void recv(Packet* p, Handler* h);
+	DELAY_BIND_TABLE
 protected:
 	const char* hashkey(nsaddr_t, nsaddr_t dst, int) {
 		long key = mshift(dst);
 		return (const char*) key;
 	}
+	virtual void changed() { dirty_ = 1; }
+	void rebuild();
+
+	int usedirect_;		// use direct_ at all (for comparison)
+	int dirty_;
+	NsObject** direct_;	// next hop by mshift(daddr), 0 if not known
+	int ndirect_;
+	int maxdirect_;
+	PortClassifier* dmux_;	// a port classifier found in direct_ ...
+	int dmuxkey_;		// ... and its index there, -1 if none
 };
 
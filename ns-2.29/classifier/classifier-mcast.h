@@ -58,6 +58,11 @@ public:
 	MCastClassifier();
 	~MCastClassifier();
 	static const char STARSYM[]; //"source" field for shared trees
+	// the replicator installed for <src,dst>, or 0
+	NsObject* lookup_rep(nsaddr_t src, nsaddr_t dst) {
+		hashnode* p = lookup(src, dst);
+		return (p != 0 ? slot(p->slot) : 0);
+	}
 protected:
 	virtual int command(int argc, const char*const* argv);
 	virtual int classify(Packet *p);
@@ -50,6 +50,7 @@ static const char rcsid[] =
 #endif
 
 #include "classifier.h"
+#include "ip.h"
 
 class MultiPathForwarder : public Classifier {
 public:
@@ -74,3 +75,127 @@ public:
 		return (new MultiPathForwarder());
 	}
 } class_multipath;
+
+/*
+ * Equal-cost multipath by flow: the slot is picked by hashing the
+ * addresses, ports and packet type, so a flow keeps to one path and
+ * is not reordered.  seed_ varies the hash from one classifier to the
+ * next, so that the switches of a fat-tree do not all make the same
+ * choice.  The bytes and packets sent to each slot are counted.
+ */
+class HashMultiPathForwarder : public Classifier {
+public:
+	HashMultiPathForwarder() : active_(0), nactive_(0), bytes_(0),
+				   pkts_(0), ncount_(0), seed_(0) {}
+	~HashMultiPathForwarder() {
+		delete [] active_;
+		delete [] bytes_;
+		delete [] pkts_;
+	}
+	virtual int classify(Packet* p) {
+		if (nactive_ == 0)
+			return (-1);
+		hdr_ip* ih = hdr_ip::access(p);
+		unsigned int h = mix(seed_ ^ ih->saddr());
+		h = mix(h ^ ih->daddr());
+		h = mix(h ^ (ih->sport() << 16) ^ (ih->dport() & 0xffff));
+		h = mix(h ^ hdr_cmn::access(p)->ptype());
+		int cl = active_[h % nactive_];
+		bytes_[cl] += hdr_cmn::access(p)->size();
+		pkts_[cl]++;
+		return (cl);
+	}
+	virtual void install(int slot, NsObject* p) {
+		Classifier::install(slot, p);
+		rebuild();
+	}
+	virtual void clear(int slot) {
+		Classifier::clear(slot);
+		rebuild();
+	}
+	DELAY_BIND_TABLE
+protected:
+	int command(int argc, const char*const* argv);
+	static unsigned int mix(unsigned int h) {
+		h ^= h >> 16;
+		h *= 0x85ebca6b;
+		h ^= h >> 13;
+		h *= 0xc2b2ae35;
+		h ^= h >> 16;
+		return (h);
+	}
+	void rebuild();
+	int* active_;		// slots in use
+	int nactive_;
+	double* bytes_;		// sent to each slot
+	double* pkts_;
+	int ncount_;		// of bytes_ and pkts_
+	int seed_;
+};
+
+void HashMultiPathForwarder::rebuild()
+{
+	int i;
+	if (ncount_ < nslot_) {
+		double* b = new double[nslot_];
+		double* n = new double[nslot_];
+		for (i = 0; i < nslot_; i++) {
+			b[i] = i < ncount_ ? bytes_[i] : 0;
+			n[i] = i < ncount_ ? pkts_[i] : 0;
+		}
+		delete [] bytes_;
+		delete [] pkts_;
+		bytes_ = b;
+		pkts_ = n;
+		ncount_ = nslot_;
+		delete [] active_;
+		active_ = new int[nslot_];
+	}
+	nactive_ = 0;
+	for (i = 0; i <= maxslot_; i++)
+		if (slot_[i] != 0)
+			active_[nactive_++] = i;
+}
+
+int HashMultiPathForwarder::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		/*
+		 * $cl bytes, $cl packets: what has been sent to each
+		 * slot, as a list of slot and count.
+		 */
+		if (strcmp(argv[1], "bytes") == 0 ||
+		    strcmp(argv[1], "packets") == 0) {
+			double* c = argv[1][0] == 'b' ? bytes_ : pkts_;
+			Tcl_Obj* l = Tcl_NewListObj(0, 0);
+			for (int i = 0; i <= maxslot_; i++) {
+				if (slot_[i] == 0)
+					continue;
+				Tcl_ListObjAppendElement(0, l, Tcl_NewIntObj(i));
+				Tcl_ListObjAppendElement(0, l,
+							 Tcl_NewDoubleObj(c[i]));
+			}
+			tcl.result(l);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "reset-counts") == 0) {
+			for (int i = 0; i < ncount_; i++)
+				bytes_[i] = pkts_[i] = 0;
+			return (TCL_OK);
+		}
+	}
+	return (Classifier::command(argc, argv));
+}
+
+DELAY_BIND_BEGIN(HashMultiPathForwarder, Classifier)
+	DELAY_BIND("seed_", seed_),
+DELAY_BIND_END
+
+static class HashMultiPathClass : public TclClass {
+public:
+	HashMultiPathClass() : TclClass("Classifier/MultiPath/Hash") {}
+	TclObject* create(int, const char*const*) {
+		return (new HashMultiPathForwarder());
+	}
+} class_hash_multipath;
@@ -62,6 +62,16 @@ int PortClassifier::classify(Packet *p)
 	return iph->dport();
 };
 
+void PortClassifier::recv(Packet* p, Handler* h)
+{
+	NsObject* node = lookup(p);
+	if (node == 0) {
+		Classifier::recv(p, h);
+		return;
+	}
+	node->recv(p, h);
+}
+
 static class PortClassifierClass : public TclClass {
 public:
 	PortClassifierClass() : TclClass("Classifier/Port") {}
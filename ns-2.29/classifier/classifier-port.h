@@ -57,6 +57,15 @@
 #include "classifier.h"
 
 class PortClassifier : public Classifier {
+public:
+	virtual void recv(Packet* p, Handler* h);
+	// the agent on the packet's port, or 0 if find() has to decide
+	inline NsObject* lookup(Packet* p) {
+		int port = hdr_ip::access(p)->dport();
+		if (port >= 0 && port < nslot_)
+			return slot_[port];
+		return 0;
+	}
 protected:
 	int classify(Packet *p);
 // 	void clear(int slot);
@@ -55,12 +55,14 @@ Classifier::Classifier() :
 	slot_(0), nslot_(0), maxslot_(-1), shift_(0), mask_(0xffffffff), nsize_(0)
 {
 	default_target_ = 0;
-
-	bind("offset_", &offset_);
-	bind("shift_", &shift_);
-	bind("mask_", &mask_);
 }
 
+DELAY_BIND_BEGIN(Classifier, NsObject)
+	DELAY_BIND("offset_", offset_),
+	DELAY_BIND("shift_", shift_),
+	DELAY_BIND("mask_", mask_),
+DELAY_BIND_END
+
 int Classifier::classify(Packet *p)
 {
 	return (mshift(*((int*) p->access(offset_))));
@@ -68,7 +70,7 @@ int Classifier::classify(Packet *p)
 
 Classifier::~Classifier()
 {
-	delete [] slot_;
+	mem_delete(slot_);
 }
 
 void Classifier::set_table_size(int nn)
@@ -91,11 +93,11 @@ void Classifier::alloc(int slot)
 		}
 	while (nslot_ <= slot) 
 		nslot_ <<= 1;
-	slot_ = new NsObject*[nslot_];
+	slot_ = mem_new<NsObject*>(MEM_ROUTE, nslot_);
 	memset(slot_, 0, nslot_ * sizeof(NsObject*));
 	for (int i = 0; i < n; ++i)
 		slot_[i] = old[i];
-	delete [] old;
+	mem_delete(old);
 }
 
 
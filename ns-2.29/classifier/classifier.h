@@ -75,6 +75,7 @@ public:
 	virtual void set_table_size(int level, int nn) {}
 
 	int allocPort (NsObject *);	
+	DELAY_BIND_TABLE
 protected:
 	virtual int getnxt(NsObject *);
 	virtual int command(int argc, const char*const* argv);
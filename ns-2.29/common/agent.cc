@@ -74,35 +74,17 @@ Agent::Agent(packet_t pkttype) :
 {
 }
 
-void
-Agent::delay_bind_init_all()
-{
-	delay_bind_init_one("agent_addr_");
-	delay_bind_init_one("agent_port_");
-	delay_bind_init_one("dst_addr_");
-	delay_bind_init_one("dst_port_");
-	delay_bind_init_one("fid_");
-	delay_bind_init_one("prio_");
-	delay_bind_init_one("flags_");
-	delay_bind_init_one("ttl_");
-	delay_bind_init_one("class_");
-	Connector::delay_bind_init_all();
-}
-
-int
-Agent::delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer)
-{
-	if (delay_bind(varName, localName, "agent_addr_", (int*)&(here_.addr_), tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "agent_port_", (int*)&(here_.port_), tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "dst_addr_", (int*)&(dst_.addr_), tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "dst_port_", (int*)&(dst_.port_), tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "fid_", (int*)&fid_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "prio_", (int*)&prio_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "flags_", (int*)&flags_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "ttl_", &defttl_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "class_", (int*)&fid_, tracer)) return TCL_OK;
-	return Connector::delay_bind_dispatch(varName, localName, tracer);
-}
+DELAY_BIND_BEGIN(Agent, Connector)
+	DELAY_BIND("agent_addr_", here_.addr_),
+	DELAY_BIND("agent_port_", here_.port_),
+	DELAY_BIND("dst_addr_", dst_.addr_),
+	DELAY_BIND("dst_port_", dst_.port_),
+	DELAY_BIND("fid_", fid_),
+	DELAY_BIND("prio_", prio_),
+	DELAY_BIND("flags_", flags_),
+	DELAY_BIND("ttl_", defttl_),
+	DELAY_BIND("class_", fid_),
+DELAY_BIND_END
 
 
 Agent::~Agent()
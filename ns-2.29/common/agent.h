@@ -105,8 +105,7 @@ class Agent : public Connector {
 
  protected:
 	int command(int argc, const char*const* argv);
-	virtual void delay_bind_init_all();
-	virtual int delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer);
+	DELAY_BIND_TABLE
 
 	virtual void recvBytes(int bytes);
 	virtual void idle();
@@ -0,0 +1,388 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Checkpoints of a running simulation; see checkpoint.h.
+ *
+ * The process that keeps a checkpoint (the server) forks a monitor
+ * for each "ns --restore".  The monitor takes the request, forks the
+ * restored run and waits for it; it sends its pid to the "ns
+ * --restore", which passes signals on to it, and then its exit
+ * status.  The restored run returns from the checkpoint command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+
+#include "config.h"
+#include "checkpoint.h"
+
+#ifndef WIN32
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <limits.h>
+#ifndef PATH_MAX
+#define PATH_MAX 1024
+#endif
+
+// sent with the standard input, output and error of the caller
+struct RestoreHeader {
+	int argc;
+	int len;	// of the working directory and arguments that follow
+};
+
+static int
+sun_init(sockaddr_un* sa, const char* path)
+{
+	if (strlen(path) >= sizeof(sa->sun_path)) {
+		errno = ENAMETOOLONG;
+		return (-1);
+	}
+	memset(sa, 0, sizeof(*sa));
+	sa->sun_family = AF_UNIX;
+	strcpy(sa->sun_path, path);
+	return (0);
+}
+
+static int
+readn(int fd, void* buf, int n)
+{
+	char* p = (char*)buf;
+	while (n > 0) {
+		int cc = read(fd, p, n);
+		if (cc < 0 && errno == EINTR)
+			continue;
+		if (cc <= 0)
+			return (-1);
+		p += cc;
+		n -= cc;
+	}
+	return (0);
+}
+
+static int
+writen(int fd, const void* buf, int n)
+{
+	const char* p = (const char*)buf;
+	while (n > 0) {
+		int cc = write(fd, p, n);
+		if (cc < 0 && errno == EINTR)
+			continue;
+		if (cc <= 0)
+			return (-1);
+		p += cc;
+		n -= cc;
+	}
+	return (0);
+}
+
+class CheckpointCommand : public TclCommand {
+public:
+	CheckpointCommand() : TclCommand("ns-checkpoint") {}
+	virtual int command(int argc, const char*const* argv);
+protected:
+	void serve(int lfd, const char* path);
+	void monitor(int fd);
+	void restored(int fd, const RestoreHeader& h, int* fds, char* buf);
+};
+
+/*
+ * The server: returns only in a restored run.
+ */
+void
+CheckpointCommand::serve(int lfd, const char* path)
+{
+	struct stat st0, st;
+	if (stat(path, &st0) < 0)
+		_exit(1);
+	setsid();
+	signal(SIGPIPE, SIG_IGN);
+	signal(SIGHUP, SIG_IGN);
+	int null = open("/dev/null", O_RDWR);
+	if (null >= 0) {
+		dup2(null, 0);
+		dup2(null, 1);
+		dup2(null, 2);
+		if (null > 2)
+			close(null);
+	}
+	for (;;) {
+		pollfd p;
+		p.fd = lfd;
+		p.events = POLLIN;
+		p.revents = 0;
+		int n = poll(&p, 1, 1000);
+		while (waitpid(-1, 0, WNOHANG) > 0)
+			;
+		// gone, or taken over by a newer checkpoint
+		if (stat(path, &st) < 0 || st.st_ino != st0.st_ino ||
+		    st.st_dev != st0.st_dev)
+			_exit(0);
+		if (n <= 0)
+			continue;
+		int fd = accept(lfd, 0, 0);
+		if (fd < 0)
+			continue;
+		pid_t pid = fork();
+		if (pid == 0) {
+			close(lfd);
+			monitor(fd);
+			return;
+		}
+		close(fd);
+	}
+}
+
+void
+CheckpointCommand::monitor(int fd)
+{
+	RestoreHeader h;
+	int fds[3];
+	char cbuf[CMSG_SPACE(sizeof(fds))];
+	iovec iov;
+	iov.iov_base = &h;
+	iov.iov_len = sizeof(h);
+	msghdr mh;
+	memset(&mh, 0, sizeof(mh));
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = cbuf;
+	mh.msg_controllen = sizeof(cbuf);
+	int cc;
+	while ((cc = recvmsg(fd, &mh, MSG_WAITALL)) < 0 && errno == EINTR)
+		;
+	cmsghdr* cm = CMSG_FIRSTHDR(&mh);
+	if (cc != sizeof(h) || cm == 0 || cm->cmsg_type != SCM_RIGHTS ||
+	    cm->cmsg_len != CMSG_LEN(sizeof(fds)) ||
+	    h.argc < 0 || h.len <= 0 || h.len > 1024 * 1024)
+		_exit(1);
+	memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+	char* buf = new char[h.len + 1];
+	if (readn(fd, buf, h.len) < 0)
+		_exit(1);
+	buf[h.len] = 0;
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		restored(fd, h, fds, buf);
+		return;
+	}
+	int status = 1;
+	if (pid > 0) {
+		int pv = pid;
+		writen(fd, &pv, sizeof(pv));
+		while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+			;
+		if (WIFEXITED(status))
+			status = WEXITSTATUS(status);
+		else if (WIFSIGNALED(status))
+			status = 128 + WTERMSIG(status);
+	}
+	writen(fd, &status, sizeof(status));
+	_exit(0);
+}
+
+void
+CheckpointCommand::restored(int fd, const RestoreHeader& h, int* fds,
+			    char* buf)
+{
+	close(fd);
+	signal(SIGPIPE, SIG_DFL);
+	signal(SIGHUP, SIG_DFL);
+	for (int i = 0; i < 3; i++) {
+		dup2(fds[i], i);
+		if (fds[i] > 2)
+			close(fds[i]);
+	}
+	char* p = buf;
+	char* end = buf + h.len;
+	if (chdir(p) < 0)
+		fprintf(stderr, "ns: restore: can't chdir to %s: %s\n", p,
+			strerror(errno));
+	p += strlen(p) + 1;
+
+	Tcl& tcl = Tcl::instance();
+	Tcl_Obj* l = Tcl_NewListObj(0, 0);
+	int argc = 0;
+	for (; argc < h.argc && p < end; argc++) {
+		Tcl_ListObjAppendElement(0, l, Tcl_NewStringObj(p, -1));
+		p += strlen(p) + 1;
+	}
+	Tcl_SetVar2Ex(tcl.interp(), "argv", 0, l, TCL_GLOBAL_ONLY);
+	Tcl_SetVar2Ex(tcl.interp(), "argc", 0, Tcl_NewIntObj(argc),
+		      TCL_GLOBAL_ONLY);
+	delete [] buf;
+}
+
+/*
+ * ns-checkpoint file
+ *
+ * Simulator instproc checkpoint checks the scheduler, flushes and
+ * lists the open channels and calls this.
+ */
+int
+CheckpointCommand::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc != 2) {
+		tcl.resultf("usage: %s file", argv[0]);
+		return (TCL_ERROR);
+	}
+	const char* path = argv[1];
+	sockaddr_un sa;
+	if (sun_init(&sa, path) < 0) {
+		tcl.resultf("checkpoint: %s: %s", path, strerror(errno));
+		return (TCL_ERROR);
+	}
+	// an old checkpoint at path goes away; anything else stays
+	struct stat st;
+	if (lstat(path, &st) == 0) {
+		if (!S_ISSOCK(st.st_mode)) {
+			tcl.resultf("checkpoint: %s exists and is not a "
+				    "checkpoint", path);
+			return (TCL_ERROR);
+		}
+		unlink(path);
+	}
+	int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (lfd < 0 || bind(lfd, (sockaddr*)&sa, sizeof(sa)) < 0 ||
+	    listen(lfd, 16) < 0) {
+		tcl.resultf("checkpoint: %s: %s", path, strerror(errno));
+		if (lfd >= 0)
+			close(lfd);
+		return (TCL_ERROR);
+	}
+	fflush(0);
+	pid_t pid = fork();
+	if (pid < 0) {
+		tcl.resultf("checkpoint: fork: %s", strerror(errno));
+		close(lfd);
+		unlink(path);
+		return (TCL_ERROR);
+	}
+	if (pid > 0) {
+		close(lfd);
+		tcl.result("0");
+		return (TCL_OK);
+	}
+	serve(lfd, path);
+	tcl.result("1");
+	return (TCL_OK);
+}
+
+static pid_t restored_pid;
+
+static void
+forward(int sig)
+{
+	if (restored_pid > 0)
+		kill(restored_pid, sig);
+}
+
+int
+ns_restore(int argc, char** argv)
+{
+	if (argc < 1) {
+		fprintf(stderr, "usage: ns --restore file ?arg ...?\n");
+		return (1);
+	}
+	const char* path = argv[0];
+	sockaddr_un sa;
+	int fd = -1;
+	if (sun_init(&sa, path) < 0 ||
+	    (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0 ||
+	    connect(fd, (sockaddr*)&sa, sizeof(sa)) < 0) {
+		fprintf(stderr, "ns: --restore: no checkpoint at %s: %s\n",
+			path, strerror(errno));
+		return (1);
+	}
+	char cwd[PATH_MAX];
+	if (getcwd(cwd, sizeof(cwd)) == 0)
+		strcpy(cwd, "/");
+
+	RestoreHeader h;
+	h.argc = argc - 1;
+	h.len = strlen(cwd) + 1;
+	int i;
+	for (i = 1; i < argc; i++)
+		h.len += strlen(argv[i]) + 1;
+	char* buf = new char[h.len];
+	char* p = buf;
+	strcpy(p, cwd);
+	p += strlen(cwd) + 1;
+	for (i = 1; i < argc; i++) {
+		strcpy(p, argv[i]);
+		p += strlen(argv[i]) + 1;
+	}
+
+	int fds[3] = { 0, 1, 2 };
+	char cbuf[CMSG_SPACE(sizeof(fds))];
+	memset(cbuf, 0, sizeof(cbuf));
+	iovec iov;
+	iov.iov_base = &h;
+	iov.iov_len = sizeof(h);
+	msghdr mh;
+	memset(&mh, 0, sizeof(mh));
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = cbuf;
+	mh.msg_controllen = sizeof(cbuf);
+	cmsghdr* cm = CMSG_FIRSTHDR(&mh);
+	cm->cmsg_level = SOL_SOCKET;
+	cm->cmsg_type = SCM_RIGHTS;
+	cm->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+	if (sendmsg(fd, &mh, 0) != sizeof(h) || writen(fd, buf, h.len) < 0) {
+		fprintf(stderr, "ns: --restore: %s: %s\n", path,
+			strerror(errno));
+		return (1);
+	}
+	delete [] buf;
+
+	// the restored run is not in our session: pass signals on
+	int pv;
+	if (readn(fd, &pv, sizeof(pv)) == 0) {
+		restored_pid = pv;
+		signal(SIGINT, forward);
+		signal(SIGTERM, forward);
+		signal(SIGHUP, forward);
+		signal(SIGQUIT, forward);
+	}
+	int status;
+	if (readn(fd, &status, sizeof(status)) < 0) {
+		fprintf(stderr, "ns: --restore: checkpoint %s went away\n",
+			path);
+		return (1);
+	}
+	return (status);
+}
+
+void
+init_checkpoint(void)
+{
+	(void)new CheckpointCommand;
+}
+
+#else /* WIN32 */
+
+int
+ns_restore(int, char**)
+{
+	fprintf(stderr, "ns: --restore is not supported on this system\n");
+	return (1);
+}
+
+void
+init_checkpoint(void)
+{
+}
+
+#endif /* WIN32 */
@@ -0,0 +1,38 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Checkpoints of a running simulation.
+ *
+ * "$ns checkpoint file" keeps the whole simulation as it stands (the
+ * event queue, packets in flight, every agent, queue and MAC, the RNG
+ * streams and traced variables) in a process of its own: ns forks,
+ * and the copy waits on a Unix socket named file.  The simulation
+ * carries on, and checkpoint returns 0.
+ *
+ * "ns --restore file ?arg ...?" asks for a copy of that state.  In it
+ * the checkpoint command returns 1, with argv, argc and the standard
+ * input, output and error and working directory of the "ns --restore",
+ * and the simulation goes on from there; the exit status of the copy
+ * is that of the "ns --restore".  Any number of runs may be restored,
+ * one after another or at the same time.  Removing file stops the
+ * process that keeps the checkpoint.
+ *
+ * A checkpoint is a process snapshot, not a serialization: nothing is
+ * written out, so it dies with the process that keeps it and can't
+ * outlive a reboot or move to another host.  Nor is any class asked
+ * whether it can be copied.  Files open at the checkpoint stay open,
+ * and are shared, in every restored run: checkpoint lists them on
+ * stderr, and scripts should open trace files after it.
+ * Scheduler/RealTime and its subclasses are refused; other objects
+ * bound to the outside world (emulation taps and the like) are not
+ * detected.  Every restored run starts with the same random streams;
+ * a run that should differ picks a substream from its arguments.
+ */
+
+#ifndef ns_checkpoint_h
+#define ns_checkpoint_h
+
+// "ns --restore file ?arg ...?": argc and argv start at file
+int ns_restore(int argc, char** argv);
+void init_checkpoint(void);
+
+#endif
@@ -0,0 +1,324 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Event profiler for the scheduler; see evprof.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
+
+#include "config.h"
+#include "evprof.h"
+
+static const char* const dist_names[EP_NDIST] = {
+	"0", "<1us", "<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s",
+	"<10s", ">=10s"
+};
+
+EventProfiler::EventProfiler() :
+	active_(0), objects_(0), lasth_(0), lastt_(0), laste_(0),
+	nevents_(0), nreported_(0), c0_(0), t0_(0), cycles_(0), nsec_(0),
+	json_(0), file_(0)
+{
+	Tcl_InitHashTable(&ht_, TCL_ONE_WORD_KEYS);
+	Tcl_CreateExitHandler(exitproc, (ClientData)this);
+}
+
+EventProfiler::~EventProfiler()
+{
+	Tcl_DeleteExitHandler(exitproc, (ClientData)this);
+	clear();
+	Tcl_DeleteHashTable(&ht_);
+	delete [] file_;
+}
+
+unsigned long long
+EventProfiler::nsec()
+{
+#ifdef __linux__
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#else
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return (tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL);
+#endif
+}
+
+void
+EventProfiler::clear()
+{
+	Tcl_HashEntry* he;
+	Tcl_HashSearch hs;
+	for (he = Tcl_FirstHashEntry(&ht_, &hs); he != 0;
+	     he = Tcl_NextHashEntry(&hs)) {
+		Entry* e = (Entry*)Tcl_GetHashValue(he);
+		delete [] e->name;
+		delete e;
+	}
+	Tcl_DeleteHashTable(&ht_);
+	Tcl_InitHashTable(&ht_, TCL_ONE_WORD_KEYS);
+	lasth_ = 0;
+	lastt_ = 0;
+	laste_ = 0;
+	nevents_ = nreported_ = 0;
+	cycles_ = nsec_ = 0;
+}
+
+void
+EventProfiler::start(int objects)
+{
+	if (objects != objects_) {
+		if (active_)
+			stop();
+		clear();
+		objects_ = objects;
+	}
+	if (active_)
+		return;
+	active_ = 1;
+	c0_ = cycles();
+	t0_ = nsec();
+}
+
+void
+EventProfiler::stop()
+{
+	if (!active_)
+		return;
+	active_ = 0;
+	cycles_ += cycles() - c0_;
+	nsec_ += nsec() - t0_;
+}
+
+/*
+ * Handlers that are TclObjects are charged by object when objects_
+ * is set: the key is the handler itself.  Everything else is charged
+ * to its type.  An object deleted while profiling shares its line
+ * with a later object of the same type at the same address.
+ */
+EventProfiler::Entry*
+EventProfiler::lookup(Handler* h, const std::type_info* t)
+{
+	TclObject* o = objects_ ? dynamic_cast<TclObject*>(h) : 0;
+	const char* key = o ? (const char*)h : (const char*)t;
+	int isnew;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(&ht_, key, &isnew);
+	if (!isnew)
+		return ((Entry*)Tcl_GetHashValue(he));
+
+	Entry* e = new Entry;
+	memset(e, 0, sizeof(*e));
+	const char* tn = t->name();
+#ifdef __GNUC__
+	int status;
+	char* dm = abi::__cxa_demangle(tn, 0, 0, &status);
+	if (dm != 0)
+		tn = dm;
+#endif
+	const char* on = o ? o->name() : 0;
+	int n = strlen(tn) + (on ? strlen(on) + 1 : 0) + 1;
+	e->name = new char[n];
+	if (on)
+		sprintf(e->name, "%s %s", tn, on);
+	else
+		strcpy(e->name, tn);
+#ifdef __GNUC__
+	free(dm);
+#endif
+	Tcl_SetHashValue(he, (ClientData)e);
+	return (e);
+}
+
+static int
+entry_cmp(const void* a, const void* b)
+{
+	const EventProfiler::Entry* x = *(const EventProfiler::Entry**)a;
+	const EventProfiler::Entry* y = *(const EventProfiler::Entry**)b;
+	if (x->cycles != y->cycles)
+		return (x->cycles < y->cycles ? 1 : -1);
+	if (x->events != y->events)
+		return (x->events < y->events ? 1 : -1);
+	return (strcmp(x->name, y->name));
+}
+
+static void
+json_string(FILE* f, const char* s)
+{
+	putc('"', f);
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\')
+			putc('\\', f);
+		putc(*s, f);
+	}
+	putc('"', f);
+}
+
+void
+EventProfiler::write(FILE* f, int json)
+{
+	unsigned long long cyc = cycles_, ns = nsec_;
+	if (active_) {
+		cyc += cycles() - c0_;
+		ns += nsec() - t0_;
+	}
+	double secs = ns * 1e-9;
+	// seconds per tick of the cycle counter, measured over the run
+	double spc = cyc > 0 ? secs / cyc : 0;
+
+	int n = 0;
+	Tcl_HashEntry* he;
+	Tcl_HashSearch hs;
+	for (he = Tcl_FirstHashEntry(&ht_, &hs); he != 0;
+	     he = Tcl_NextHashEntry(&hs))
+		n++;
+	Entry** v = new Entry*[n > 0 ? n : 1];
+	n = 0;
+	for (he = Tcl_FirstHashEntry(&ht_, &hs); he != 0;
+	     he = Tcl_NextHashEntry(&hs))
+		v[n++] = (Entry*)Tcl_GetHashValue(he);
+	qsort(v, n, sizeof(Entry*), entry_cmp);
+
+	int i, j;
+	if (json) {
+		fprintf(f, "{\"events\": %lu, \"seconds\": %.6f, "
+			"\"by\": \"%s\",\n \"distance\": [",
+			nevents_, secs, objects_ ? "object" : "type");
+		for (j = 0; j < EP_NDIST; j++)
+			fprintf(f, "%s\"%s\"", j ? ", " : "", dist_names[j]);
+		fprintf(f, "],\n \"handlers\": [");
+		for (i = 0; i < n; i++) {
+			Entry* e = v[i];
+			fprintf(f, "%s\n  {\"name\": ", i ? "," : "");
+			json_string(f, e->name);
+			fprintf(f, ", \"events\": %lu, \"seconds\": %.6f, "
+				"\"scheduled\": %lu, \"distance\": [",
+				e->events, e->cycles * spc, e->scheduled);
+			for (j = 0; j < EP_NDIST; j++)
+				fprintf(f, "%s%lu", j ? ", " : "", e->dist[j]);
+			fprintf(f, "]}");
+		}
+		fprintf(f, "\n ]}\n");
+	} else {
+		fprintf(f, "# event profile: %lu events in %.3f s, by %s\n",
+			nevents_, secs, objects_ ? "object" : "type");
+		fprintf(f, "#%11s %7s %10s %6s %9s  %s\n", "events",
+			"%events", "seconds", "%time", "us/event", "handler");
+		for (i = 0; i < n; i++) {
+			Entry* e = v[i];
+			if (e->events == 0)
+				continue;
+			double s = e->cycles * spc;
+			fprintf(f, "%12lu %7.2f %10.3f %6.2f %9.3f  %s\n",
+				e->events, 100.0 * e->events / nevents_, s,
+				secs > 0 ? 100 * s / secs : 0,
+				1e6 * s / e->events, e->name);
+		}
+		fprintf(f, "# events scheduled, by how far ahead\n#%11s",
+			"scheduled");
+		for (j = 0; j < EP_NDIST; j++)
+			fprintf(f, " %8s", dist_names[j]);
+		fprintf(f, "  handler\n");
+		for (i = 0; i < n; i++) {
+			Entry* e = v[i];
+			if (e->scheduled == 0)
+				continue;
+			fprintf(f, "%12lu", e->scheduled);
+			for (j = 0; j < EP_NDIST; j++)
+				fprintf(f, " %8lu", e->dist[j]);
+			fprintf(f, "  %s\n", e->name);
+		}
+	}
+	delete [] v;
+}
+
+void
+EventProfiler::report()
+{
+	FILE* f = stdout;
+	if (file_ != 0 && (f = fopen(file_, "w")) == 0) {
+		fprintf(stderr, "ns: profile-events: can't write %s\n", file_);
+		return;
+	}
+	write(f, json_);
+	if (f != stdout)
+		fclose(f);
+	else
+		fflush(f);
+	nreported_ = nevents_;
+}
+
+void
+EventProfiler::exitproc(ClientData cd)
+{
+	EventProfiler* p = (EventProfiler*)cd;
+	if (p->pending())
+		p->report();
+}
+
+/*
+ * $sched profile-events on ?-objects?
+ * $sched profile-events off
+ * $sched profile-events output ?-json? ?file?
+ * $sched profile-events dump ?-json? ?file?
+ */
+int
+EventProfiler::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc < 3)
+		goto usage;
+	if (strcmp(argv[2], "on") == 0) {
+		if (argc > 4 || (argc == 4 && strcmp(argv[3], "-objects") != 0))
+			goto usage;
+		start(argc == 4);
+		return (TCL_OK);
+	}
+	if (strcmp(argv[2], "off") == 0) {
+		stop();
+		return (TCL_OK);
+	}
+	if (strcmp(argv[2], "output") == 0 || strcmp(argv[2], "dump") == 0) {
+		int json = 0;
+		const char* file = 0;
+		for (int i = 3; i < argc; i++) {
+			if (strcmp(argv[i], "-json") == 0)
+				json = 1;
+			else if (file == 0)
+				file = argv[i];
+			else
+				goto usage;
+		}
+		if (argv[2][0] == 'o') {
+			json_ = json;
+			delete [] file_;
+			file_ = 0;
+			if (file != 0) {
+				file_ = new char[strlen(file) + 1];
+				strcpy(file_, file);
+			}
+			return (TCL_OK);
+		}
+		FILE* f = stdout;
+		if (file != 0 && (f = fopen(file, "w")) == 0) {
+			tcl.resultf("can't write %s", file);
+			return (TCL_ERROR);
+		}
+		write(f, json);
+		if (f != stdout)
+			fclose(f);
+		else
+			fflush(f);
+		nreported_ = nevents_;
+		return (TCL_OK);
+	}
+usage:
+	tcl.resultf("usage: %s profile-events on ?-objects? | off | "
+		    "output ?-json? ?file? | dump ?-json? ?file?", argv[0]);
+	return (TCL_ERROR);
+}
@@ -0,0 +1,115 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Event profiler for the scheduler.
+ *
+ * "$ns profile-events on" makes Scheduler::dispatch() charge every
+ * event to the handler it goes to: the number of events, the time
+ * spent in handle() (read from the cycle counter), and a histogram of
+ * how far ahead the events were scheduled.  Handlers are grouped by
+ * C++ type, or with "on -objects" each TclObject separately (other
+ * handlers, such as timers, still by type).  The report is a table
+ * sorted by time, or JSON, and is written at "$ns halt", when the
+ * event queue runs dry, and at exit.
+ *
+ *	$ns profile-events on ?-objects?
+ *	$ns profile-events off
+ *	$ns profile-events output ?-json? ?file?   where the report goes
+ *	$ns profile-events dump ?-json? ?file?     write a report now
+ */
+
+#ifndef ns_evprof_h
+#define ns_evprof_h
+
+extern "C" {
+#include <tcl.h>
+}
+#include <stdio.h>
+#include <typeinfo>
+#include "scheduler.h"
+
+#define EP_NDIST 10	/* histogram of scheduling distance, by decade */
+
+class EventProfiler {
+public:
+	EventProfiler();
+	~EventProfiler();
+
+	struct Entry {
+		char* name;
+		unsigned long events;
+		unsigned long long cycles;
+		unsigned long scheduled;
+		unsigned long dist[EP_NDIST];
+	};
+
+	inline int active() const { return (active_); }
+	void start(int objects);
+	void stop();
+	// an event for h, delay seconds from now
+	inline void scheduled(Handler* h, double delay) {
+		Entry* e = entry(h);
+		e->scheduled++;
+		e->dist[bucket(delay)]++;
+	}
+	inline Entry* entry(Handler* h) {
+		const std::type_info* t = &typeid(*h);
+		if (h != lasth_ || t != lastt_) {
+			laste_ = lookup(h, t);
+			lasth_ = h;
+			lastt_ = t;
+		}
+		return (laste_);
+	}
+	inline void dispatched(Entry* e, unsigned long long cycles) {
+		e->events++;
+		e->cycles += cycles;
+		nevents_++;
+	}
+	// events dispatched since the last report
+	inline int pending() const { return (nevents_ != nreported_); }
+	void report();
+	int command(int argc, const char*const* argv);
+
+	static inline unsigned long long cycles() {
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+		unsigned int lo, hi;
+		__asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+		return (((unsigned long long)hi << 32) | lo);
+#else
+		return (nsec());
+#endif
+	}
+
+protected:
+	static unsigned long long nsec();
+	// 0, then under 1us, 10us, ... 10s, then the rest
+	static inline int bucket(double delay) {
+		if (delay <= 0)
+			return (0);
+		int b = 1;
+		for (double d = 1e-6; b < EP_NDIST - 1 && delay >= d; d *= 10)
+			b++;
+		return (b);
+	}
+	Entry* lookup(Handler* h, const std::type_info* t);
+	void write(FILE* f, int json);
+	void clear();
+	static void exitproc(ClientData);
+
+	int active_;
+	int objects_;		// a line per TclObject rather than per type
+	Tcl_HashTable ht_;
+	Handler* lasth_;	// one-entry cache in front of ht_
+	const std::type_info* lastt_;
+	Entry* laste_;
+	unsigned long nevents_;
+	unsigned long nreported_;
+	unsigned long long c0_;	// cycle counter and clock ...
+	unsigned long long t0_;	// ... when profiling started
+	unsigned long long cycles_;	// cycles and time profiled ...
+	unsigned long long nsec_;	// ... before the last stop()
+	int json_;		// report as JSON
+	char* file_;		// report here, stdout if 0
+};
+
+#endif
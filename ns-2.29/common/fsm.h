@@ -82,6 +82,7 @@ public:
 
 class FSM : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	FSM() {};
 	inline FSMState* start_state() {	// starting state
 		return (start_state_);
@@ -40,9 +40,11 @@
 
 #include <assert.h>
 #include "config.h"
+#include "mem-account.h"
 
 class Location : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Location(double x, double y, double z) {
 		X = x;
 		Y = y;
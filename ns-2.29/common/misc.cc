@@ -48,6 +48,7 @@ static const char rcsid[] =
 #include "config.h"
 #include "scheduler.h"
 #include "random.h"
+#include "gzchan.h"
 
 #if defined(HAVE_INT64)
 class Add64Command : public TclCommand {
@@ -232,6 +233,7 @@ void init_misc(void)
 	(void)new TimeAtofCommand;
 	(void)new HasInt64Command;
 	(void)new HasSTLCommand;
+	(void)new GzOpenCommand;
 #if defined(HAVE_INT64)
 	(void)new Add64Command;
 	(void)new Mult64Command;
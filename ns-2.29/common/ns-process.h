@@ -55,6 +55,7 @@
 #include <assert.h>
 #include <string.h>
 #include "config.h"
+#include "mem-account.h"
 
 // Application-level data unit types
 enum AppDataType {
@@ -114,6 +115,7 @@ public:
 // (2) pass data to another entity, (3) request data from another entity.
 class Process : public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 	Process() : target_(0) {}
 	inline Process*& target() { return target_; }
 
@@ -53,19 +53,9 @@ NsObject::NsObject()
 	debug_ = 0;
 }
 
-void
-NsObject::delay_bind_init_all()
-{
-	delay_bind_init_one("debug_");
-}
-
-int
-NsObject::delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer)
-{
-	if (delay_bind_bool(varName, localName, "debug_", &debug_, tracer)) 
-		return TCL_OK;
-	return TclObject::delay_bind_dispatch(varName, localName, tracer);
-}
+DELAY_BIND_BEGIN(NsObject, TclObject)
+	DELAY_BIND_BOOL("debug_", debug_),
+DELAY_BIND_END
 
 void NsObject::reset()
 {
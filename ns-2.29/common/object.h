@@ -38,6 +38,7 @@
 #define ns_object_h
 
 #include "scheduler.h"
+#include "mem-account.h"
 
 #define NOW Scheduler::instance().clock()
 
@@ -45,6 +46,7 @@ class Packet;
 
 class NsObject : public TclObject, public Handler {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	NsObject();
 	virtual ~NsObject();
 	virtual void recv(Packet*, Handler* callback = 0) = 0;
@@ -56,8 +58,7 @@ public:
 	virtual void recvOnly(Packet *) {};
 
 	virtual int command(int argc, const char*const* argv);
-	virtual void delay_bind_init_all();
-	virtual int delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer);
+	DELAY_BIND_TABLE
 	inline int isdebug() const { return debug_; }
 	virtual void debug(const char *fmt, ...);
 protected:
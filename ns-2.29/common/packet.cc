@@ -44,6 +44,7 @@ p_info packet_info;
 char* p_info::name_[PT_NTYPE+1];
 
 int Packet::hdrlen_ = 0;		// size of a packet's header
+int Packet::allocated_ = 0;		// packets created so far
 Packet* Packet::free_;			// free list
 int hdr_cmn::offset_;			// static offset of common header
 int hdr_flags::offset_;			// static offset of flags header
@@ -133,9 +134,21 @@ public:
 /* manages active packet header types */
 class PacketHeaderManager : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	PacketHeaderManager() {
 		bind("hdrlen_", &Packet::hdrlen_);
 	}
+	int command(int argc, const char*const* argv) {
+		/*
+		 * Headers cannot be added once packets of the old size
+		 * exist; see finish-packetformat in ns-packet.tcl.
+		 */
+		if (argc == 2 && strcmp(argv[1], "packets-allocated") == 0) {
+			Tcl::instance().resultf("%d", Packet::allocated_);
+			return (TCL_OK);
+		}
+		return (TclObject::command(argc, argv));
+	}
 };
 
 static class PacketHeaderManagerClass : public TclClass {
@@ -334,6 +334,10 @@ private:
 //Monarch ext
 typedef void (*FailureCallback)(Packet *,void *);
 
+// header blocks start on a cache line; the hot headers are laid out
+// from offset 0 by create_packetformat (tcl/lib/ns-packet.tcl)
+#define NS_CACHELINE 64
+
 class Packet : public Event {
 private:
 	unsigned char* bits_;	// header bits
@@ -348,6 +352,7 @@ protected:
 public:
 	Packet* next_;		// for queues and the free list
 	static int hdrlen_;
+	static int allocated_;	// # of packets ever created
 
 	Packet() : bits_(0), data_(0), ref_count_(0), next_(0) { }
 	inline unsigned char* const bits() { return (bits_); }
@@ -543,12 +548,19 @@ inline Packet* Packet::alloc()
 		assert(p->data_ == 0);
 		p->uid_ = 0;
 		p->time_ = 0;
+		MemAccount::release(MEM_POOL,
+				    sizeof(Packet) + hdrlen_ + NS_CACHELINE-1);
 	} else {
 		p = new Packet;
-		p->bits_ = new unsigned char[hdrlen_];
-		if (p == 0 || p->bits_ == 0)
+		unsigned char* b = new unsigned char[hdrlen_+NS_CACHELINE-1];
+		if (p == 0 || b == 0)
 			abort();
+		p->bits_ = (unsigned char*)(((unsigned long)b + NS_CACHELINE-1)
+					    & ~(unsigned long)(NS_CACHELINE-1));
+		++allocated_;
 	}
+	MemAccount::alloc(MEM_PACKET, sizeof(Packet));
+	MemAccount::alloc(MEM_HEADER, hdrlen_ + NS_CACHELINE-1);
 	init(p); // Initialize bits_[]
 	(HDR_CMN(p))->next_hop_ = -2; // -1 reserved for IP_BROADCAST
 	(HDR_CMN(p))->last_hop_ = -2; // -1 reserved for IP_BROADCAST
@@ -601,6 +613,11 @@ inline void Packet::free(Packet* p)
 			p->next_ = free_;
 			free_ = p;
 			p->fflag_ = FALSE;
+			MemAccount::release(MEM_PACKET, sizeof(Packet));
+			MemAccount::release(MEM_HEADER,
+					    hdrlen_ + NS_CACHELINE-1);
+			MemAccount::alloc(MEM_POOL,
+					  sizeof(Packet) + hdrlen_ + NS_CACHELINE-1);
 		} else {
 			--p->ref_count_;
 		}
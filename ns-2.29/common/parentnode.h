@@ -54,6 +54,7 @@
 #include "address.h"
 #include "classifier-addr.h"
 #include "rtmodule.h"
+#include "mem-account.h"
 
 class NsObject;
 
@@ -61,6 +62,7 @@ class NsObject;
 
 class ParentNode : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	ParentNode() : nodeid_(-1), address_(-1) {} 
 	/*virtual int command(int argc, const char*const* argv) {}*/
 	virtual inline int address() { return address_;}
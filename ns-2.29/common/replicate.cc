@@ -0,0 +1,267 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Replications of a simulation in forked processes.
+ *
+ * "ns-replicate n jobs cmd" runs "cmd r" for r = 0 .. n-1, each in a
+ * process forked from this one, at most jobs at a time.  The children
+ * share the state built so far copy-on-write.  A child sends back the
+ * result of cmd, or what it gave "ns-replicate-report" if it calls
+ * that first (say because the script exits from within the
+ * simulation), and then exits.  ns-replicate returns a list of the
+ * results in order of r, with an empty element for a replication
+ * that failed.
+ *
+ * Simulator instproc replicate uses these; see ns-lib.tcl.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "config.h"
+
+#ifndef WIN32
+
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+static int report_fd = -1;	// in a child: where its result goes
+
+static void
+report(const char* s)
+{
+	if (report_fd < 0)
+		return;
+	int n = strlen(s);
+	while (n > 0) {
+		int cc = write(report_fd, s, n);
+		if (cc < 0 && errno == EINTR)
+			continue;
+		if (cc <= 0)
+			break;
+		s += cc;
+		n -= cc;
+	}
+	close(report_fd);
+	report_fd = -1;
+}
+
+class ReplicateCommand : public TclCommand {
+public:
+	ReplicateCommand() : TclCommand("ns-replicate") {}
+	virtual int command(int argc, const char*const* argv);
+protected:
+	struct Job {
+		pid_t pid;
+		int fd;
+		int r;
+	};
+	void child(int r, int fd, Job* jobs, int njobs, const char* cmd);
+	void kill_all(Job* jobs, int njobs);
+};
+
+void
+ReplicateCommand::child(int r, int fd, Job* jobs, int njobs,
+			const char* cmd)
+{
+	for (int i = 0; i < njobs; i++)
+		if (jobs[i].pid > 0)
+			close(jobs[i].fd);
+	report_fd = fd;
+
+	Tcl& tcl = Tcl::instance();
+	char buf[32];
+	sprintf(buf, " %d", r);
+	Tcl_DString ds;
+	Tcl_DStringInit(&ds);
+	Tcl_DStringAppend(&ds, cmd, -1);
+	Tcl_DStringAppend(&ds, buf, -1);
+	int st = Tcl_Eval(tcl.interp(), Tcl_DStringValue(&ds));
+	if (st != TCL_OK) {
+		const char* info = Tcl_GetVar(tcl.interp(), "errorInfo",
+					      TCL_GLOBAL_ONLY);
+		fprintf(stderr, "ns: replication %d: %s\n", r,
+			info ? info : tcl.result());
+		Tcl_Exit(1);
+	}
+	report(tcl.result());
+	Tcl_Exit(0);
+}
+
+/* Give up on the replications still running. */
+void
+ReplicateCommand::kill_all(Job* jobs, int njobs)
+{
+	for (int i = 0; i < njobs; i++) {
+		if (jobs[i].pid <= 0)
+			continue;
+		kill(jobs[i].pid, SIGKILL);
+		close(jobs[i].fd);
+		while (waitpid(jobs[i].pid, 0, 0) < 0 && errno == EINTR)
+			;
+		fprintf(stderr, "ns: replication %d killed\n", jobs[i].r);
+		jobs[i].pid = 0;
+	}
+}
+
+int
+ReplicateCommand::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	int n, njobs;
+	if (argc != 4 || (n = atoi(argv[1])) < 0 ||
+	    (njobs = atoi(argv[2])) < 1) {
+		tcl.resultf("usage: %s n jobs cmd", argv[0]);
+		return (TCL_ERROR);
+	}
+	if (njobs > n)
+		njobs = n > 0 ? n : 1;
+
+	Tcl_DString* out = new Tcl_DString[n > 0 ? n : 1];
+	int* ok = new int[n > 0 ? n : 1];
+	Job* jobs = new Job[njobs];
+	pollfd* pfd = new pollfd[njobs];
+	int* pj = new int[njobs];	// job of each pfd
+	int i, next = 0, running = 0, err = 0;
+	for (i = 0; i < n; i++) {
+		Tcl_DStringInit(&out[i]);
+		ok[i] = 0;
+	}
+	for (i = 0; i < njobs; i++)
+		jobs[i].pid = 0;
+	fflush(0);
+
+	while (running > 0 || (next < n && !err)) {
+		for (i = 0; i < njobs && next < n && !err; i++) {
+			if (jobs[i].pid > 0)
+				continue;
+			int p[2];
+			if (pipe(p) < 0) {
+				tcl.resultf("replicate: pipe: %s",
+					    strerror(errno));
+				err = 1;
+				break;
+			}
+			pid_t pid = fork();
+			if (pid == 0) {
+				close(p[0]);
+				child(next, p[1], jobs, njobs, argv[3]);
+			}
+			close(p[1]);
+			if (pid < 0) {
+				close(p[0]);
+				tcl.resultf("replicate: fork: %s",
+					    strerror(errno));
+				err = 1;
+				break;
+			}
+			jobs[i].pid = pid;
+			jobs[i].fd = p[0];
+			jobs[i].r = next++;
+			running++;
+		}
+		int np = 0;
+		for (i = 0; i < njobs; i++) {
+			if (jobs[i].pid <= 0)
+				continue;
+			pfd[np].fd = jobs[i].fd;
+			pfd[np].events = POLLIN;
+			pfd[np].revents = 0;
+			pj[np++] = i;
+		}
+		if (np == 0)
+			break;
+		if (poll(pfd, np, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			tcl.resultf("replicate: poll: %s",
+				    strerror(errno));
+			err = 1;
+			kill_all(jobs, njobs);
+			break;
+		}
+		for (int k = 0; k < np; k++) {
+			if (pfd[k].revents == 0)
+				continue;
+			Job& j = jobs[pj[k]];
+			char buf[4096];
+			int cc = read(j.fd, buf, sizeof(buf));
+			if (cc < 0 && errno == EINTR)
+				continue;
+			if (cc > 0) {
+				Tcl_DStringAppend(&out[j.r], buf, cc);
+				continue;
+			}
+			int status;
+			close(j.fd);
+			while (waitpid(j.pid, &status, 0) < 0 &&
+			       errno == EINTR)
+				;
+			if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+				ok[j.r] = 1;
+			else if (Tcl_DStringLength(&out[j.r]) > 0) {
+				// exited with an error after reporting
+				ok[j.r] = 1;
+				fprintf(stderr, "ns: replication %d exited "
+					"with status %d\n", j.r,
+					WIFEXITED(status) ?
+					WEXITSTATUS(status) :
+					128 + WTERMSIG(status));
+			} else
+				fprintf(stderr, "ns: replication %d "
+					"failed\n", j.r);
+			j.pid = 0;
+			running--;
+		}
+	}
+
+	if (!err) {
+		Tcl_Obj* l = Tcl_NewListObj(0, 0);
+		for (i = 0; i < n; i++)
+			Tcl_ListObjAppendElement(0, l,
+				Tcl_NewStringObj(ok[i] ?
+					Tcl_DStringValue(&out[i]) : "", -1));
+		tcl.result(l);
+	}
+	for (i = 0; i < n; i++)
+		Tcl_DStringFree(&out[i]);
+	delete [] out;
+	delete [] ok;
+	delete [] jobs;
+	delete [] pfd;
+	delete [] pj;
+	return (err ? TCL_ERROR : TCL_OK);
+}
+
+class ReplicateReportCommand : public TclCommand {
+public:
+	ReplicateReportCommand() : TclCommand("ns-replicate-report") {}
+	virtual int command(int argc, const char*const* argv) {
+		if (argc != 2) {
+			Tcl::instance().resultf("usage: %s result", argv[0]);
+			return (TCL_ERROR);
+		}
+		report(argv[1]);
+		return (TCL_OK);
+	}
+};
+
+void
+init_replicate(void)
+{
+	(void)new ReplicateCommand;
+	(void)new ReplicateReportCommand;
+}
+
+#else /* WIN32 */
+
+void
+init_replicate(void)
+{
+}
+
+#endif /* WIN32 */
@@ -89,6 +89,7 @@ void MapScheduler::cancel(Event* p)
 	if (eIT != EventQueue_.end()) {
 		EventQueue_.erase(eIT);
 		p->uid_ = -p->uid_; // Negate the uid for reuse
+		MemAccount::release(MEM_EVENT, sizeof(Event));
 	}
 }
 
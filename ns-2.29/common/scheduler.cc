@@ -46,6 +46,7 @@ static const char rcsid[] =
 #include "config.h"
 #include "scheduler.h"
 #include "packet.h"
+#include "evprof.h"
 
 
 #ifdef MEMDEBUG_SIMULATIONS
@@ -60,11 +61,13 @@ scheduler_uid_t Scheduler::uid_ = 1;
 // 	char* proc_;
 // };
 
-Scheduler::Scheduler() : clock_(SCHED_START), halted_(0)
+Scheduler::Scheduler() : clock_(SCHED_START), halted_(0), prof_(0),
+	ndispatched_(0)
 {
 }
 
 Scheduler::~Scheduler(){
+	delete prof_;
 	instance_ = NULL ;
 }
 
@@ -112,6 +115,9 @@ Scheduler::schedule(Handler* h, Event* e, double delay)
 	double t = clock_ + delay;
 
 	e->time_ = t;
+	MemAccount::alloc(MEM_EVENT, sizeof(Event));
+	if (prof_ != 0 && prof_->active())
+		prof_->scheduled(h, delay);
 	insert(e);
 }
 
@@ -147,6 +153,16 @@ Scheduler::dispatch(Event* p, double t)
 
 	clock_ = t;
 	p->uid_ = -p->uid_;	// being dispatched
+	++ndispatched_;
+	MemAccount::release(MEM_EVENT, sizeof(Event));
+	if (prof_ != 0 && prof_->active()) {
+		// the handler may free p, and itself
+		EventProfiler::Entry* pe = prof_->entry(p->handler_);
+		unsigned long long c = EventProfiler::cycles();
+		p->handler_->handle(p);
+		prof_->dispatched(pe, EventProfiler::cycles() - c);
+		return;
+	}
 	p->handler_->handle(p);	// dispatch
 }
 
@@ -191,11 +207,76 @@ Scheduler::command(int argc, const char*const* argv)
 	Tcl& tcl = Tcl::instance();
 	if (instance_ == 0)
 		instance_ = this;
+	if (argc >= 2 && strcmp(argv[1], "profile-events") == 0) {
+		if (prof_ == 0)
+			prof_ = new EventProfiler;
+		return (prof_->command(argc, argv));
+	}
+	if (argc <= 3 && strcmp(argv[1], "mem-usage") == 0) {
+		/*
+		 * $sched mem-usage: {tag bytes peak objects peak} of each tag
+		 * $sched mem-usage tag: {bytes peak objects peak} of one
+		 */
+		int tag = argc == 3 ? MemAccount::lookup(argv[2]) : 0;
+		if (tag < 0) {
+			tcl.resultf("unknown memory tag %s", argv[2]);
+			return (TCL_ERROR);
+		}
+		Tcl_Obj* l = Tcl_NewListObj(0, 0);
+		for (; tag < MEM_NTAGS; tag++) {
+			const MemAccount::Usage& u = MemAccount::usage(tag);
+			Tcl_Obj* v[5];
+			int n = 0;
+			if (argc == 2)
+				v[n++] = Tcl_NewStringObj(MemAccount::name(tag), -1);
+			v[n++] = Tcl_NewLongObj(u.bytes);
+			v[n++] = Tcl_NewLongObj(u.peak);
+			v[n++] = Tcl_NewLongObj(u.objects);
+			v[n++] = Tcl_NewLongObj(u.maxobjects);
+			if (argc == 3) {
+				Tcl_SetListObj(l, n, v);
+				break;
+			}
+			Tcl_ListObjAppendElement(0, l, Tcl_NewListObj(n, v));
+		}
+		tcl.result(l);
+		return (TCL_OK);
+	}
 	if (argc == 2) {
+		/*
+		 * $sched run-stats: events dispatched and packets allocated
+		 * so far, CPU seconds and peak resident set size in bytes,
+		 * as a list of names and values
+		 */
+		if (strcmp(argv[1], "run-stats") == 0) {
+			double utime = 0, stime = 0, maxrss = 0;
+#ifdef HAVE_GETRUSAGE
+			struct rusage ru;
+			if (getrusage(RUSAGE_SELF, &ru) == 0) {
+				utime = ru.ru_utime.tv_sec +
+					ru.ru_utime.tv_usec * 1e-6;
+				stime = ru.ru_stime.tv_sec +
+					ru.ru_stime.tv_usec * 1e-6;
+#ifdef __APPLE__
+				maxrss = ru.ru_maxrss;	// in bytes
+#else
+				maxrss = ru.ru_maxrss * 1024.0;
+#endif
+			}
+#endif
+			tcl.resultf("events %.0f packets %.0f utime %.3f "
+				    "stime %.3f maxrss %.0f",
+				    (double)ndispatched_,
+				    (double)MemAccount::usage(MEM_PACKET).total,
+				    utime, stime, maxrss);
+			return (TCL_OK);
+		}
 		if (strcmp(argv[1], "run") == 0) {
 			/* set global to 0 before calling object reset methods */
 			reset();	// sets clock to zero
 			run();
+			if (prof_ != 0 && prof_->pending())
+				prof_->report();
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "now") == 0) {
 			sprintf(tcl.buffer(), "%.17g", clock());
@@ -204,6 +285,8 @@ Scheduler::command(int argc, const char*const* argv)
 		} else if (strcmp(argv[1], "resume") == 0) {
 			halted_ = 0;
 			run();
+			if (prof_ != 0 && prof_->pending())
+				prof_->report();
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "halt") == 0) {
 			halted_ = 1;
@@ -328,6 +411,7 @@ ListScheduler::cancel(Event* e)
 
 	*p = (*p)->next_;
 	e->uid_ = - e->uid_;
+	MemAccount::release(MEM_EVENT, sizeof(Event));
 }
 
 Event* 
@@ -539,22 +623,146 @@ public:
 	}
 } class_heap_sched;
 
-Event* 
-HeapScheduler::lookup(scheduler_uid_t uid)
+/*
+ * The children of slot i are 4i+1 ... 4i+4.  keys_ starts three keys
+ * past a cache line boundary, so that with 16-byte keys each group
+ * of four children fills exactly one 64-byte line.
+ */
+#define	HS_PARENT(i)	(((i) - 1) >> 2)
+#define	HS_CHILD(i)	(((i) << 2) + 1)
+#define	HS_ALIGN	64
+
+HeapScheduler::HeapScheduler() :
+	mem_(0), keys_(0), ev_(0), size_(0), maxsize_(0), seq_(0)
 {
-	Event* e;
-	
-	for (e = (Event*) hp_->heap_iter_init(); e;
-	     e = (Event*) hp_->heap_iter())
-		if (e->uid_ == uid)
+	grow();
+}
+
+HeapScheduler::~HeapScheduler()
+{
+	MemAccount::release(MEM_EVENT, maxsize_ * (sizeof(Key) + sizeof(Event*)), 0);
+	delete [] mem_;
+	delete [] ev_;
+}
+
+void
+HeapScheduler::grow()
+{
+	unsigned int n = maxsize_ ? 2 * maxsize_ : 1024;
+	char* mem = new char[(n + 3) * sizeof(Key) + HS_ALIGN];
+	unsigned long a = ((unsigned long)mem + HS_ALIGN - 1) &
+		~(unsigned long)(HS_ALIGN - 1);
+	Key* keys = (Key*)a + 3;
+	Event** ev = new Event*[n];
+	if (size_ > 0) {
+		memcpy(keys, keys_, size_ * sizeof(Key));
+		memcpy(ev, ev_, size_ * sizeof(Event*));
+	}
+	delete [] mem_;
+	delete [] ev_;
+	MemAccount::release(MEM_EVENT, maxsize_ * (sizeof(Key) + sizeof(Event*)), 0);
+	MemAccount::alloc(MEM_EVENT, n * (sizeof(Key) + sizeof(Event*)), 0);
+	mem_ = mem;
+	keys_ = keys;
+	ev_ = ev;
+	maxsize_ = n;
+}
+
+/* Put <k, e> in the hole at slot i, moving the hole up as needed. */
+void
+HeapScheduler::up(unsigned int i, const Key& k, Event* e)
+{
+	while (i > 0) {
+		unsigned int p = HS_PARENT(i);
+		if (!less(k, keys_[p]))
 			break;
-	return e;
+		keys_[i] = keys_[p];
+		ev_[i] = ev_[p];
+		ev_[i]->pos_ = i;
+		i = p;
+	}
+	keys_[i] = k;
+	ev_[i] = e;
+	e->pos_ = i;
+}
+
+/* Put <k, e> in the hole at slot i, moving the hole down as needed. */
+void
+HeapScheduler::down(unsigned int i, const Key& k, Event* e)
+{
+	for (;;) {
+		unsigned int c = HS_CHILD(i);
+		if (c >= size_)
+			break;
+		unsigned int end = c + 4 < size_ ? c + 4 : size_;
+		unsigned int m = c;
+		for (++c; c < end; ++c)
+			if (less(keys_[c], keys_[m]))
+				m = c;
+		if (!less(keys_[m], k))
+			break;
+		keys_[i] = keys_[m];
+		ev_[i] = ev_[m];
+		ev_[i]->pos_ = i;
+		i = m;
+	}
+	keys_[i] = k;
+	ev_[i] = e;
+	e->pos_ = i;
+}
+
+void
+HeapScheduler::insert(Event* e)
+{
+	if (size_ == maxsize_)
+		grow();
+	Key k;
+	k.time = e->time_;
+	k.seq = seq_++;
+	up(size_++, k, e);
 }
 
 Event*
 HeapScheduler::deque()
 {
-	return ((Event*) hp_->heap_extract_min());
+	if (size_ == 0)
+		return (0);
+	Event* e = ev_[0];
+	if (--size_ > 0)
+		down(0, keys_[size_], ev_[size_]);
+	e->pos_ = -1;
+	return (e);
+}
+
+void
+HeapScheduler::cancel(Event* e)
+{
+	if (e->uid_ <= 0)	// not scheduled
+		return;
+	e->uid_ = - e->uid_;
+	unsigned int i = e->pos_;
+	if (e->pos_ < 0 || i >= size_ || ev_[i] != e)
+		return;
+	MemAccount::release(MEM_EVENT, sizeof(Event));
+	e->pos_ = -1;
+	if (i == --size_)
+		return;
+	// fill the hole with the last event, which may belong above or below
+	Key k = keys_[size_];
+	Event* last = ev_[size_];
+	if (i > 0 && less(k, keys_[HS_PARENT(i)]))
+		up(i, k, last);
+	else
+		down(i, k, last);
+}
+
+Event* 
+HeapScheduler::lookup(scheduler_uid_t uid)
+{
+	for (unsigned int i = 0; i < size_; i++)
+		if (ev_[i]->uid_ == uid)
+			return (ev_[i]);
+	return (0);
 }
 
 /*
@@ -587,6 +795,7 @@ CalendarScheduler::CalendarScheduler() : cal_clock_(clock_) {
 CalendarScheduler::~CalendarScheduler() {
 	// XXX free events?
 	delete [] buckets_;
+	MemAccount::release(MEM_EVENT, sizeof(Bucket) * nbuckets_, 0);
 	qsize_ = 0;
 	stat_qsize_ = 0;
 }
@@ -806,6 +1015,7 @@ void
 CalendarScheduler::reinit(int nbuck, double bwidth, double start)
 {
 	buckets_ = new Bucket[nbuck];
+	MemAccount::alloc(MEM_EVENT, sizeof(Bucket) * nbuck, 0);
 
 	memset(buckets_, 0, sizeof(Bucket)*nbuck); //faster than ctor
 
@@ -857,6 +1067,7 @@ CalendarScheduler::resize(int newsize, double start)
 		}
 	}
 	delete [] oldb;
+	MemAccount::release(MEM_EVENT, sizeof(Bucket) * oldn, 0);
 }
 
 // take samples from the most populated bucket.
@@ -925,6 +1136,7 @@ CalendarScheduler::cancel(Event* e)
 
 	e->uid_ = -e->uid_;
 	e->next_ = e->prev_ = NULL;
+	MemAccount::release(MEM_EVENT, sizeof(Event));
 
 	--qsize_;
 
@@ -951,6 +1163,11 @@ CalendarScheduler::lookup(scheduler_uid_t uid)
 #ifndef WIN32
 #include <sys/time.h>
 #endif
+#ifdef __linux__
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#endif
 
 class RealTimeScheduler : public CalendarScheduler {
 public:
@@ -960,7 +1177,7 @@ public:
 	virtual void reset();
 protected:
 	void sync() { clock_ = tod(); }
-	double tod();
+	virtual double tod();
 	double slop_;	// allowed drift between real-time and virt time
 	double start_;	// starting time
 };
@@ -1042,3 +1259,203 @@ RealTimeScheduler::run()
 	}
 	// we reach here only if halted
 }
+
+/*
+ * Real-time scheduler for high packet rates.  It differs from
+ * Scheduler/RealTime in that
+ *  - time comes from the monotonic clock at nanosecond resolution
+ *    rather than from gettimeofday(), so it never jumps;
+ *  - on Linux it sleeps on a timerfd armed for the next event (and
+ *    registered with the Tcl notifier, so I/O still wakes it up)
+ *    instead of rounding the wait to a select() timeout, and it
+ *    busy-polls for I/O when the next event is closer than spin_;
+ *  - it handles all pending I/O events on each pass instead of one;
+ *  - it keeps lag statistics: how late events were dispatched
+ *    relative to real time, and how many were later than maxslop_.
+ */
+class HiResRealTimeScheduler : public RealTimeScheduler {
+public:
+	HiResRealTimeScheduler();
+	virtual ~HiResRealTimeScheduler();
+	virtual void run();
+	virtual void reset();
+protected:
+	int command(int argc, const char*const* argv);
+	virtual double tod();
+	double mono();
+	void wait(const Event* p);
+	inline void lag(double late) {
+		nevents_++;
+		if (late > 0) {
+			sumlag_ += late;
+			if (late > maxlag_)
+				maxlag_ = late;
+			if (late > slop_)
+				noverrun_++;
+		}
+	}
+	static void timerproc(ClientData, int);
+
+	double spin_;		// busy-poll if the next event is this close
+	int maxio_;		// max I/O events handled per pass
+	double nevents_;	// events dispatched
+	double noverrun_;	// events dispatched more than slop_ late
+	double sumlag_;
+	double maxlag_;
+	int tfd_;		// timerfd, or -1
+};
+
+static class HiResRealTimeSchedulerClass : public TclClass {
+public:
+	HiResRealTimeSchedulerClass() : TclClass("Scheduler/RealTime/HighRes") {}
+	TclObject* create(int /* argc */, const char*const* /* argv */) {
+		return (new HiResRealTimeScheduler);
+	}
+} class_hires_realtime_sched;
+
+HiResRealTimeScheduler::HiResRealTimeScheduler() : nevents_(0),
+	noverrun_(0), sumlag_(0), maxlag_(0), tfd_(-1)
+{
+	bind_time("spin_", &spin_);
+	bind("maxio_", &maxio_);
+#ifdef __linux__
+	tfd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	if (tfd_ >= 0)
+		Tcl_CreateFileHandler(tfd_, TCL_READABLE, timerproc, 0);
+#endif
+}
+
+HiResRealTimeScheduler::~HiResRealTimeScheduler()
+{
+#ifdef __linux__
+	if (tfd_ >= 0) {
+		Tcl_DeleteFileHandler(tfd_);
+		close(tfd_);
+	}
+#endif
+}
+
+// absolute monotonic time in seconds
+double
+HiResRealTimeScheduler::mono()
+{
+#ifdef __linux__
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec + 1e-9 * ts.tv_nsec);
+#else
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return (tv.tv_sec + 1e-6 * tv.tv_usec);
+#endif
+}
+
+double
+HiResRealTimeScheduler::tod()
+{
+	return (mono() - start_);
+}
+
+void
+HiResRealTimeScheduler::reset()
+{
+	clock_ = SCHED_START;
+	start_ = mono();
+	nevents_ = noverrun_ = 0;
+	sumlag_ = maxlag_ = 0;
+}
+
+// the timer only has to wake Tcl_WaitForEvent up; drain it
+void
+HiResRealTimeScheduler::timerproc(ClientData, int)
+{
+#ifdef __linux__
+	HiResRealTimeScheduler* s = (HiResRealTimeScheduler*)&instance();
+	u_int64_t expirations;
+	(void)read(s->tfd_, &expirations, sizeof(expirations));
+#endif
+}
+
+/*
+ * Block until the next event p is due or I/O arrives (p == 0: until
+ * I/O arrives).
+ */
+void
+HiResRealTimeScheduler::wait(const Event* p)
+{
+	if (p == 0) {
+		Tcl_WaitForEvent(0);
+		return;
+	}
+	double diff = p->time_ - clock_;
+	if (diff <= spin_)
+		return;		// keep polling
+#ifdef __linux__
+	if (tfd_ >= 0) {
+		double at = start_ + p->time_;
+		itimerspec its;
+		memset(&its, 0, sizeof(its));
+		its.it_value.tv_sec = (time_t)at;
+		its.it_value.tv_nsec = (long)(1e9 * (at - its.it_value.tv_sec));
+		if (timerfd_settime(tfd_, TFD_TIMER_ABSTIME, &its, 0) == 0) {
+			Tcl_WaitForEvent(0);
+			return;
+		}
+	}
+#endif
+	Tcl_Time to;
+	to.sec = long(diff);
+	to.usec = long(1e6*(diff - to.sec));
+	Tcl_WaitForEvent(&to);
+}
+
+void 
+HiResRealTimeScheduler::run()
+{ 
+	const Event *p;
+
+	/*XXX*/
+	instance_ = this;
+
+	while (!halted_) {
+		clock_ = tod();
+		p = head();
+		while (p && p->time_ <= clock_) {
+			lag(clock_ - p->time_);
+			dispatch(deque(), clock_);
+			if (halted_)
+				return;
+			p = head();
+			clock_ = tod();
+		}
+		wait(p);
+		for (int i = 0; i < maxio_; i++)
+			if (!Tcl_DoOneEvent(TCL_DONT_WAIT))
+				break;
+	}
+	// we reach here only if halted
+}
+
+int
+HiResRealTimeScheduler::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		/*
+		 * $sched lag-stats: events dispatched, events later than
+		 * maxslop_, mean and maximum lateness in seconds
+		 */
+		if (strcmp(argv[1], "lag-stats") == 0) {
+			tcl.resultf("%.0f %.0f %g %g", nevents_, noverrun_,
+				    nevents_ > 0 ? sumlag_ / nevents_ : 0.,
+				    maxlag_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "reset-lag-stats") == 0) {
+			nevents_ = noverrun_ = 0;
+			sumlag_ = maxlag_ = 0;
+			return (TCL_OK);
+		}
+	}
+	return (RealTimeScheduler::command(argc, argv));
+}
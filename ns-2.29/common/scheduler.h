@@ -38,6 +38,7 @@
 #define ns_scheduler_h
 
 #include "config.h"
+#include "mem-account.h"
 
 // Make use of 64 bit integers if available.
 #ifdef HAVE_INT64
@@ -60,7 +61,8 @@ public:
 	Handler* handler_;	/* handler to call when event ready */
 	double time_;		/* time at which event is ready */
 	scheduler_uid_t uid_;	/* unique ID */
-	Event() : time_(0), uid_(0) {}
+	int pos_;		/* slot in the HeapScheduler, -1 if none */
+	Event() : time_(0), uid_(0), pos_(-1) {}
 };
 
 /*
@@ -76,8 +78,11 @@ class Handler {
 
 #define	SCHED_START	0.0	/* start time (secs) */
 
+class EventProfiler;
+
 class Scheduler : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_EVENT)
 	static Scheduler& instance() {
 		return (*instance_);		// general access to scheduler
 	}
@@ -105,6 +110,8 @@ protected:
 	int command(int argc, const char*const* argv);
 	double clock_;
 	int halted_;
+	EventProfiler* prof_;	// $ns profile-events, 0 if never used
+	int64_t ndispatched_;	// events dispatched so far
 	static Scheduler* instance_;
 	static scheduler_uid_t uid_;
 };
@@ -122,25 +129,41 @@ protected:
 	Event* queue_;
 };
 
-#include "heap.h"
-
+/*
+ * An indexed 4-ary heap.  Each event records its slot in the heap
+ * (Event::pos_), so that cancel() takes O(log n) steps instead of a
+ * search through the whole heap.  The keys live in an array of their
+ * own, apart from the events, with the four children of a slot in one
+ * cache line.  Events due at the same time come out in the order they
+ * were inserted.
+ */
 class HeapScheduler : public Scheduler {
 public:
-	HeapScheduler() { hp_ = new Heap; } 
-	void cancel(Event* e) {
-		if (e->uid_ <= 0)
-			return;
-		e->uid_ = - e->uid_;
-		hp_->heap_delete((void*) e);
-	}
-	void insert(Event* e) {
-		hp_->heap_insert(e->time_, (void*) e);
-	}
+	HeapScheduler();
+	~HeapScheduler();
+	void cancel(Event*);
+	void insert(Event*);
 	Event* lookup(scheduler_uid_t uid);
 	Event* deque();
-	const Event* head() { return (const Event *)hp_->heap_min(); }
+	const Event* head() { return (size_ > 0 ? ev_[0] : 0); }
 protected:
-	Heap* hp_;
+	struct Key {
+		double time;
+		unsigned long seq;	// insertion order, breaks ties
+	};
+	static int less(const Key& a, const Key& b) {
+		return (a.time < b.time || (a.time == b.time && a.seq < b.seq));
+	}
+	void grow();
+	void up(unsigned int i, const Key& k, Event* e);
+	void down(unsigned int i, const Key& k, Event* e);
+
+	char* mem_;		// keys_ lives in here, cache aligned
+	Key* keys_;
+	Event** ev_;
+	unsigned int size_;
+	unsigned int maxsize_;
+	unsigned long seq_;
 };
 
 class CalendarScheduler : public Scheduler {
@@ -48,6 +48,9 @@
 #include "node.h"
 #include "address.h"
 #include "object.h"
+#include "bulk-topo.h"
+#include "route.h"
+#include "classifier.h"
 
 //class ParentNode;
 
@@ -177,13 +180,30 @@ void Simulator::populate_flat_classifiers() {
 	// Updating nodelist_ (total no of connected nodes)
 	// size since size_ maybe smaller than nn_ (total no of nodes)
 	check(nn_);    
+	int k = rtobject_->mpath();
+	int* nhs = k > 1 ? new int[k] : NULL;
+	if (nhs != NULL)
+		mpath_check(nn_);
 	for (int i=0; i<nn_; i++) {
 		if (nodelist_[i] == NULL) {
 			i++; 
 			continue;
 		}
 		nodelist_[i]->set_table_size(nn_);
+		int unrouted = 0;
 		for (int j=0; j<nn_; j++) {
+			if (i != j && nhs != NULL) {
+				int n = rtobject_->lookup_multi(i, j, nhs);
+				if (n > 1) {
+					NsObject* mc = multipath_classifier(i,
+						     nhs, n, mpsets_[i]);
+					sprintf(tmp, "%d", j);
+					nodelist_[i]->add_route(tmp, mc);
+					continue;
+				}
+				if (n <= 0)
+					unrouted = 1;
+			}
 			if (i != j) {
 				int nh = -1;
 				nh = rtobject_->lookup_flat(i, j);
@@ -194,6 +214,86 @@ void Simulator::populate_flat_classifiers() {
 				}
 			}  
 		}
+		if (nhs != NULL)
+			mpath_sweep(mpsets_[i], unrouted, 1);
+	}
+	delete [] nhs;
+}
+
+/*
+ * The classifier that spreads packets from node i over the next hops
+ * nh: one for each set of next hops at a node, shared by all the
+ * destinations reached through it, made as the route logic says and
+ * seeded with the node id.  The classifiers outlive a population, so
+ * that routes recomputed to the same next hops keep theirs.
+ */
+NsObject* Simulator::multipath_classifier(int i, int* nh, int n,
+					  MultiPathSet*& sets)
+{
+	MultiPathSet* s;
+	for (s = sets; s != NULL; s = s->next_)
+		if (s->n_ == n && memcmp(s->nh_, nh, n * sizeof(int)) == 0)
+			break;
+	if (s != NULL) {
+		s->used_ = 1;
+		return (s->classifier_);
+	}
+	Tcl& tcl = Tcl::instance();
+	tcl.evalf("new %s", rtobject_->mpath_class());
+	Classifier* c = (Classifier*)TclObject::lookup(tcl.result());
+	if (c == NULL) {
+		fprintf(stderr, "ns: can't make a %s for multipath\n",
+			rtobject_->mpath_class());
+		exit(1);
+	}
+	tcl.evalf("%s set seed_ %d", c->name(), i);
+	for (int m = 0; m < n; m++)
+		c->install_next(get_link_head(nodelist_[i], nh[m]));
+	s = new MultiPathSet;
+	s->n_ = n;
+	s->nh_ = new int[n];
+	memcpy(s->nh_, nh, n * sizeof(int));
+	s->classifier_ = c;
+	s->used_ = 1;
+	s->next_ = sets;
+	sets = s;
+	return (c);
+}
+
+void Simulator::mpath_check(int n)
+{
+	if (n <= mpsize_)
+		return;
+	MultiPathSet** sets = new MultiPathSet*[n];
+	for (int i = 0; i < n; i++)
+		sets[i] = i < mpsize_ ? mpsets_[i] : NULL;
+	delete [] mpsets_;
+	mpsets_ = sets;
+	mpsize_ = n;
+}
+
+/*
+ * Forget the sets the last population did not install, and delete
+ * their classifiers if drop is set.  A node with a destination it can
+ * no longer reach keeps them all (keep set): its table may still point
+ * there, as it still points to the link heads of stale routes.
+ */
+void Simulator::mpath_sweep(MultiPathSet*& sets, int keep, int drop)
+{
+	MultiPathSet** p = &sets;
+	while (*p != NULL) {
+		MultiPathSet* s = *p;
+		if (keep || (drop && s->used_)) {
+			s->used_ = 0;
+			p = &s->next_;
+			continue;
+		}
+		*p = s->next_;
+		if (drop)
+			Tcl::instance().evalf("delete %s",
+					      s->classifier_->name());
+		delete [] s->nh_;
+		delete s;
 	}
 }
 
@@ -281,6 +381,13 @@ char *Simulator::append_addr(int level, int *addr) {
 
 
 NsObject* Simulator::get_link_head(ParentNode *node, int nh) {
+	// links built by load-topology have no OTcl object to ask
+	BulkTopology* bt = BulkTopology::instance();
+	if (bt != NULL) {
+		NsObject *head = bt->head(node->nodeid(), nh);
+		if (head != NULL)
+			return head;
+	}
 	Tcl& tcl = Tcl::instance();
 	tcl.evalf("[Simulator instance] get-link-head %d %d",
 		  node->nodeid(), nh);
@@ -57,13 +57,26 @@
 class ParentNode;
 class RouteLogic;
 
+// a set of equal-cost next hops and the classifier that uses it
+struct MultiPathSet {
+	int n_;
+	int* nh_;
+	NsObject* classifier_;
+	int used_;		// installed by the current population
+	MultiPathSet* next_;
+};
+
 class Simulator : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	static Simulator& instance() { return (*instance_); }
       Simulator() : nodelist_(NULL), rtobject_(NULL), nn_(0), \
-	size_(0) {}
+	size_(0), mpsets_(NULL), mpsize_(0) {}
       ~Simulator() {
 	    delete []nodelist_; 
+	    for (int i = 0; i < mpsize_; i++)
+		    mpath_sweep(mpsets_[i], 0, 0);
+	    delete []mpsets_;
       }
 	char* macType() { return macType_; }
 	int command(int argc, const char*const* argv);
@@ -71,6 +84,10 @@ public:
 	void populate_hier_classifiers();
 	void add_node(ParentNode *node, int id);
 	NsObject* get_link_head(ParentNode *node, int nh);
+	NsObject* multipath_classifier(int i, int* nh, int n,
+				       MultiPathSet*& sets);
+	void mpath_check(int n);
+	void mpath_sweep(MultiPathSet*& sets, int keep, int drop);
 	int node_id_by_addr(int address);
 	char *append_addr(int level, int *addr);
 	void alloc(int n);
@@ -82,6 +99,8 @@ private:
 	int nn_;
 	int size_;
 	char macType_[SMALL_LEN];
+	MultiPathSet **mpsets_;	// multipath classifiers of each node
+	int mpsize_;
 	static Simulator* instance_;
 };
 
@@ -310,6 +310,7 @@ SplayScheduler::cancel(Event *e)
 	}
 	// t is the pointer to e in the parent or to root_ if e is root_
 	e->uid_ = -e->uid_;
+	MemAccount::release(MEM_EVENT, sizeof(Event));
 	--qsize_;
 
 	if (RIGHT(e) == 0) {
@@ -15,8 +15,10 @@
  */
 
 #include "config.h"
+#include "checkpoint.h"
 
 extern void init_misc(void);
+extern void init_replicate(void);
 extern EmbeddedTcl et_ns_lib;
 extern EmbeddedTcl et_ns_ptypes;
 
@@ -64,6 +66,8 @@ EXTERN int		Tcltest_Init _ANSI_ARGS_((Tcl_Interp *interp));
 int
 main(int argc, char **argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--restore") == 0)
+	return (ns_restore(argc - 2, argv + 2));
     Tcl_Main(argc, argv, Tcl_AppInit);
     return 0;			/* Needed only to prevent compiler warning. */
 }
@@ -257,6 +261,8 @@ Tcl_AppInit(Tcl_Interp *interp)
 	Tcl_SetVar(interp, "tcl_rcFileName", "~/.ns.tcl", TCL_GLOBAL_ONLY);
 	Tcl::init(interp, "ns");
 	init_misc();
+	init_checkpoint();
+	init_replicate();
         et_ns_ptypes.load();
 	et_ns_lib.load();
 
@@ -52,6 +52,7 @@
 #define ns_tpm_h
 
 #include "tp.h"
+#include "mem-account.h"
 
 // Data structure for next packet
 struct nextp_s {
@@ -76,6 +77,7 @@ private:
 
 class TPM  : public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 	TPM(); 
 	virtual ~TPM(); 
 
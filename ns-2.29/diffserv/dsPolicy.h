@@ -37,6 +37,7 @@
 #ifndef DS_POLICY_H
 #define DS_POLICY_H
 #include "dsred.h"
+#include "mem-account.h"
 
 #define ANY_HOST -1		// Add to enable point to multipoint policy
 #define FLOW_TIME_OUT 5.0      // The flow does not exist already.
@@ -91,6 +92,7 @@ struct policerTableEntry {
 // Class PolicyClassifier: keep the policy and polier tables.
 class PolicyClassifier : public TclObject {
  public:
+  MEM_ACCOUNT(MEM_OBJECT)
   PolicyClassifier();
   void addPolicyEntry(int argc, const char*const* argv);
   void addPolicerEntry(int argc, const char*const* argv);
@@ -122,6 +124,7 @@ protected:
 // Supper class Policy can't do anything useful.
 class Policy : public TclObject {
  public:
+  MEM_ACCOUNT(MEM_OBJECT)
   Policy(){};
 
   // Metering and policing methods:
@@ -40,6 +40,8 @@
 // this exception also makes it possible to release a modified version
 // which carries forward this exception.
 
+#include <algorithm>
+
 #include "filter_core.hh"
 
 #ifndef NS_DIFFUSION
@@ -267,6 +269,7 @@ void DiffusionCoreAgent::filterTimeout()
 		filter_entry->agent_, filter_entry->handle_,
 		filter_entry->priority_);
       filter_itr = filter_list_.erase(filter_itr);
+      filter_index_valid_ = false;
       delete filter_entry;
     }
     else{
@@ -545,6 +548,7 @@ FilterEntry * DiffusionCoreAgent::deleteFilter(int16_t handle, u_int16_t agent)
     filter_entry = *filter_itr;
     if (handle == filter_entry->handle_ && agent == filter_entry->agent_){
       filter_list_.erase(filter_itr);
+      filter_index_valid_ = false;
       break;
     }
     filter_entry = NULL;
@@ -574,24 +578,43 @@ bool DiffusionCoreAgent::addFilter(NRAttrVec *attrs, u_int16_t agent,
 
   // Add this filter to the filter list
   filter_list_.push_back(filter_entry);
+  filter_index_valid_ = false;
 
   return true;
 }
 
-FilterList::iterator DiffusionCoreAgent::findMatchingFilter(NRAttrVec *attrs,
-							    FilterList::iterator filter_itr)
+static inline int64_t ValueKey(NRAttribute *attr)
+{
+  return (((int64_t) attr->getKey() << 32) |
+	  *(u_int32_t *) attr->getGenericVal());
+}
+
+void DiffusionCoreAgent::buildFilterIndex()
 {
+  FilterList::iterator filter_itr;
   FilterEntry *filter_entry;
+  NRAttribute *anchor;
+  int n = 0;
+
+  key_index_.clear();
+  value_index_.clear();
+  wildcard_filters_.clear();
 
-  for (;filter_itr != filter_list_.end(); ++filter_itr){
+  for (filter_itr = filter_list_.begin();
+       filter_itr != filter_list_.end(); ++filter_itr, ++n){
     filter_entry = *filter_itr;
+    anchor = filter_entry->compiled()->anchor();
 
-    if (OneWayMatch(filter_entry->filter_attrs_, attrs)){
-      // That's a match !
-      break;
-    }
+    if (!anchor)
+      wildcard_filters_.push_back(make_pair(n, filter_entry));
+    else if (anchor->getOp() == NRAttribute::EQ &&
+	     anchor->getType() == NRAttribute::INT32_TYPE)
+      value_index_[ValueKey(anchor)].push_back(make_pair(n, filter_entry));
+    else
+      key_index_[anchor->getKey()].push_back(make_pair(n, filter_entry));
   }
-  return filter_itr;
+
+  filter_index_valid_ = true;
 }
 
 bool DiffusionCoreAgent::restoreOriginalHeader(Message *msg)
@@ -632,17 +655,60 @@ bool DiffusionCoreAgent::restoreOriginalHeader(Message *msg)
 FilterList * DiffusionCoreAgent::getFilterList(NRAttrVec *attrs)
 {
   FilterList *matching_filter_list = new FilterList;
-  FilterList::iterator known_filters_itr, filter_list_itr;
+  FilterList::iterator filter_list_itr;
   FilterEntry *matching_filter_entry, *filter_entry;
+  FilterKeyIndex::iterator key_itr;
+  FilterValueIndex::iterator value_itr;
+  IndexedFilters candidates;
+  IndexedFilters::iterator candidate_itr;
+  NRAttribute *attr;
+  int i;
+
+  if (!filter_index_valid_)
+    buildFilterIndex();
+
+  // Only filters anchored on one of the message's attributes (and
+  // those without predicates) can match, so collect those first
+  AttrIndex index(attrs);
+
+  candidates = wildcard_filters_;
+  for (i = 0; i < index.size(); i++){
+    attr = index.at(i);
+
+    if (i == 0 || attr->getKey() != index.at(i - 1)->getKey()){
+      key_itr = key_index_.find(attr->getKey());
+      if (key_itr != key_index_.end())
+	candidates.insert(candidates.end(), key_itr->second.begin(),
+			  key_itr->second.end());
+    }
+
+    if (attr->getType() == NRAttribute::INT32_TYPE){
+      value_itr = value_index_.find(ValueKey(attr));
+      if (value_itr != value_index_.end())
+	candidates.insert(candidates.end(), value_itr->second.begin(),
+			  value_itr->second.end());
+    }
+  }
+
+  // Visit them in filter list order, once each
+  sort(candidates.begin(), candidates.end());
+  candidates.erase(unique(candidates.begin(), candidates.end()),
+		   candidates.end());
+  match_skipped_ += filter_list_.size() - candidates.size();
 
   // We need to come up with a list of filters to call
   // F1 will be called before F2 if F1->priority > F2->priority
 
-  known_filters_itr = findMatchingFilter(attrs, filter_list_.begin());
+  for (candidate_itr = candidates.begin();
+       candidate_itr != candidates.end(); ++candidate_itr){
+    matching_filter_entry = candidate_itr->second;
+
+    match_attempts_++;
+    if (!matching_filter_entry->compiled()->match(&index))
+      continue;
 
-  while (known_filters_itr != filter_list_.end()){
     // We have a match !
-    matching_filter_entry = *known_filters_itr;
+    match_successes_++;
 
     for (filter_list_itr = matching_filter_list->begin();
 	 filter_list_itr != matching_filter_list->end(); ++filter_list_itr){
@@ -655,10 +721,6 @@ FilterList * DiffusionCoreAgent::getFilterList(NRAttrVec *attrs)
 
     // Insert matching filter in the list
     matching_filter_list->insert(filter_list_itr, matching_filter_entry);
-
-    // Continue the search
-    known_filters_itr++;
-    known_filters_itr = findMatchingFilter(attrs, known_filters_itr);
   }
   return matching_filter_list;
 }
@@ -1153,6 +1215,11 @@ DiffusionCoreAgent::DiffusionCoreAgent(int argc, char **argv)
   pkt_count_ = GetRand();
   random_id_ = GetRand();
 
+  filter_index_valid_ = false;
+  match_attempts_ = 0;
+  match_successes_ = 0;
+  match_skipped_ = 0;
+
   Tcl_InitHashTable(&htable_, 2);
 
   // Initialize EventQueue
@@ -55,6 +55,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <map>
 
 #include "main/timers.hh"
 #include "main/message.hh"
@@ -125,6 +126,12 @@ typedef list<NeighborEntry *> NeighborList;
 typedef list<Tcl_HashEntry *> HashList;
 typedef list<int32_t> BlackList;
 
+// Filters indexed by their anchor attribute (see CompiledAttrs), each
+// tagged with its position in the filter list
+typedef vector<pair<int, FilterEntry *> > IndexedFilters;
+typedef map<int32_t, IndexedFilters> FilterKeyIndex;
+typedef map<int64_t, IndexedFilters> FilterValueIndex;
+
 class DiffusionCoreAgent {
 public:
 #ifdef NS_DIFFUSION
@@ -167,6 +174,22 @@ protected:
   BlackList black_list_;
   HashList hash_list_;
 
+  // Filter index: a filter whose anchor is an INT32 'EQ' predicate is
+  // found through value_index_ under (key, value), other filters with
+  // predicates through key_index_ under the anchor's key, and filters
+  // without predicates are in wildcard_filters_. Rebuilt when the
+  // filter list changes
+  FilterKeyIndex key_index_;
+  FilterValueIndex value_index_;
+  IndexedFilters wildcard_filters_;
+  bool filter_index_valid_;
+
+  // Matching statistics: candidate filters matched against messages,
+  // matches found, and filters ruled out by the index
+  long match_attempts_;
+  long match_successes_;
+  long match_skipped_;
+
   // Data structures
   TimerManager *timers_manager_;
   //  EventQueue *eq_;
@@ -202,8 +225,7 @@ protected:
   FilterEntry * deleteFilter(int16_t handle, u_int16_t agent);
   bool addFilter(NRAttrVec *attrs, u_int16_t agent, int16_t handle,
 		 u_int16_t priority);
-  FilterList::iterator findMatchingFilter(NRAttrVec *attrs,
-					  FilterList::iterator filter_itr);
+  void buildFilterIndex();
   u_int16_t getNextFilterPriority(int16_t handle, u_int16_t priority,
 				  u_int16_t agent);
 
@@ -662,10 +662,13 @@ RoutingEntry * OnePhasePullFilter::findRoutingEntry(NRAttrVec *attrs)
 {
   RoutingTable::iterator routing_itr;
   RoutingEntry *routing_entry;
+  u_int32_t sig = AttrSignature(attrs);
 
+  // Entries with a different signature cannot be a perfect match
   for (routing_itr = routing_list_.begin(); routing_itr != routing_list_.end(); ++routing_itr){
     routing_entry = *routing_itr;
-    if (PerfectMatch(routing_entry->attrs_, attrs))
+    if (routing_entry->signature() == sig &&
+	PerfectMatch(routing_entry->attrs_, attrs))
       return routing_entry;
   }
   return NULL;
@@ -165,6 +165,7 @@ class RoutingEntry {
 public:
   RoutingEntry() {
     GetTime(&tv_);
+    sig_valid_ = false;
   };
 
   ~RoutingEntry() {
@@ -207,8 +208,19 @@ public:
   void getFlowsFromList(FlowIdList *msg_list, FlowIdList *flow_list);
   int32_t getNeighborFromFlow(int32_t flow_id);
 
+  // AttrSignature of attrs_, computed on first use
+  u_int32_t signature() {
+    if (!sig_valid_){
+      sig_ = AttrSignature(attrs_);
+      sig_valid_ = true;
+    }
+    return sig_;
+  };
+
   struct timeval tv_;
   NRAttrVec *attrs_;
+  u_int32_t sig_;
+  bool sig_valid_;
   RoundIdList round_ids_;
   SubscriptionList subscription_list_;
   DataNeighborList data_neighbors_;
@@ -140,6 +140,7 @@ class TppRoutingEntry {
 public:
   TppRoutingEntry() {
     GetTime(&tv_);
+    sig_valid_ = false;
   };
 
   ~TppRoutingEntry() {
@@ -177,8 +178,19 @@ public:
     data_neighbors_.clear();
   };
 
+  // AttrSignature of attrs_, computed on first use
+  u_int32_t signature() {
+    if (!sig_valid_){
+      sig_ = AttrSignature(attrs_);
+      sig_valid_ = true;
+    }
+    return sig_;
+  };
+
   struct timeval tv_;
   NRAttrVec *attrs_;
+  u_int32_t sig_;
+  bool sig_valid_;
   AgentList agents_;
   GradientList gradients_;
   AttributeList attr_list_;
@@ -43,6 +43,8 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
 
 #include "attrs.hh"
 
@@ -406,6 +408,50 @@ bool MatchAttrs(NRAttrVec *attr_vec1, NRAttrVec *attr_vec2)
   return false;
 }
 
+// OneAttrMatch returns TRUE if attribute 'b' (with operator IS)
+// satisfies the predicate in attribute 'a' (which has the same key)
+static bool OneAttrMatch(NRAttribute *a, NRAttribute *b)
+{
+  switch (a->getOp()){
+
+  case NRAttribute::EQ_ANY:
+
+    // If a's Op is "EQ_ANY" that's enough
+    return true;
+
+  case NRAttribute::EQ:
+
+    return b->isEQ(a);
+
+  case NRAttribute::GT:
+
+    return b->isGT(a);
+
+  case NRAttribute::GE:
+
+    return b->isGE(a);
+
+  case NRAttribute::LT:
+
+    return b->isLT(a);
+
+  case NRAttribute::LE:
+
+    return b->isLE(a);
+
+  case NRAttribute::NE:
+
+    return b->isNE(a);
+
+  default:
+
+    DiffPrint(DEBUG_ALWAYS, "Unknown operator found in OneWayMacth !\n");
+    break;
+  }
+
+  return false;
+}
+
 bool OneWayMatch(NRAttrVec *attr_vec1, NRAttrVec *attr_vec2)
 {
   NRAttrVec::iterator itr1, itr2;
@@ -435,72 +481,139 @@ bool OneWayMatch(NRAttrVec *attr_vec1, NRAttrVec *attr_vec2)
 	continue;
       }
 
-      // If a's Op is "EQ_ANY" that's enough   
-      if (a->getOp() == NRAttribute::EQ_ANY){
-	found_attr = true;
-	break;
-      }
-
-      found_attr = false;
+      found_attr = OneAttrMatch(a, b);
 
-      switch (a->getOp()){
-
-	 case NRAttribute::EQ:
-
-	   if (b->isEQ(a))
-	     found_attr = true;
-
-	   break;
-
-      case NRAttribute::GT:
+      if (found_attr)
+	break;
 
-	if (b->isGT(a))
-	  found_attr = true;
+      itr2++;
+    }
+  }
 
-	break;
+  // All attributes found !
+  return true;
+}
 
-      case NRAttribute::GE:
+static bool KeyLess(NRAttribute *a, NRAttribute *b)
+{
+  return (a->getKey() < b->getKey());
+}
 
-	if (b->isGE(a))
-	  found_attr = true;
+u_int32_t AttrSignature(NRAttrVec *attr_vec)
+{
+  vector<u_int32_t> hashes;
+  NRAttrVec::iterator itr;
+  NRAttribute *a;
+  u_int32_t h;
+  unsigned char *p;
+  int len, i;
+  float f;
+  double d;
 
-	break;
+  for (itr = attr_vec->begin(); itr != attr_vec->end(); ++itr){
+    a = *itr;
+    h = (a->getKey() * 31 + a->getType()) * 31 + a->getOp();
+    p = (unsigned char *) a->getGenericVal();
+    len = a->getLen();
 
-      case NRAttribute::LT:
+    // Hash the value the way isEQ compares it
+    switch (a->getType()){
+    case NRAttribute::FLOAT32_TYPE:
+      f = *(float *) p;
+      if (f == 0)
+	len = 0;	// -0 == 0
+      break;
+    case NRAttribute::FLOAT64_TYPE:
+      d = *(double *) p;
+      if (d == 0)
+	len = 0;
+      break;
+    case NRAttribute::STRING_TYPE:
+      h = h * 31 + len;
+      len = strnlen((char *) p, len);
+      break;
+    }
+    for (i = 0; i < len; i++)
+      h = h * 31 + p[i];
+    hashes.push_back(h);
+  }
 
-	if (b->isLT(a))
-	  found_attr = true;
+  // PerfectMatch compares the vectors as sets, so leave out
+  // duplicates and combine the rest in a fixed order
+  sort(hashes.begin(), hashes.end());
+  h = 1;
+  for (i = 0; i < (int) hashes.size(); i++)
+    if (i == 0 || hashes[i] != hashes[i - 1])
+      h = h * 1000003 ^ hashes[i];
+  return h;
+}
 
-	break;
+AttrIndex::AttrIndex(NRAttrVec *attr_vec)
+{
+  NRAttrVec::iterator itr;
 
-      case NRAttribute::LE:
+  for (itr = attr_vec->begin(); itr != attr_vec->end(); ++itr)
+    if ((*itr)->getOp() == NRAttribute::IS)
+      attrs_.push_back(*itr);
+  stable_sort(attrs_.begin(), attrs_.end(), KeyLess);
+}
 
-	if (b->isLE(a))
-	  found_attr = true;
+int AttrIndex::find(int32_t key)
+{
+  int lo = 0, hi = attrs_.size();
+
+  while (lo < hi){
+    int mid = (lo + hi) / 2;
+    if (attrs_[mid]->getKey() < key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < (int) attrs_.size() && attrs_[lo]->getKey() == key)
+    return lo;
+  return attrs_.size();
+}
 
-	break;
+CompiledAttrs::CompiledAttrs(NRAttrVec *attr_vec) : anchor_(NULL)
+{
+  NRAttrVec::iterator itr;
 
-      case NRAttribute::NE:
+  for (itr = attr_vec->begin(); itr != attr_vec->end(); ++itr)
+    if ((*itr)->getOp() != NRAttribute::IS)
+      preds_.push_back(*itr);
+  stable_sort(preds_.begin(), preds_.end(), KeyLess);
 
-	if (b->isNE(a))
-	  found_attr = true;
+  for (itr = preds_.begin(); itr != preds_.end(); ++itr)
+    if ((*itr)->getOp() == NRAttribute::EQ &&
+	(*itr)->getType() == NRAttribute::INT32_TYPE){
+      anchor_ = *itr;
+      break;
+    }
+  if (!anchor_ && preds_.size() > 0)
+    anchor_ = preds_[0];
+}
 
-	break;
+bool CompiledAttrs::match(AttrIndex *index)
+{
+  int i, j, first = 0, n = index->size();
+  int32_t key;
 
-      default:
+  for (i = 0; i < (int) preds_.size(); i++){
+    key = preds_[i]->getKey();
 
-	DiffPrint(DEBUG_ALWAYS, "Unknown operator found in OneWayMacth !\n");
-	break;
-      }
+    // Both sides are sorted, so the attributes with this key start
+    // at or after the ones for the previous predicate
+    while (first < n && index->at(first)->getKey() < key)
+      first++;
 
-      if (found_attr)
+    for (j = first; j < n && index->at(j)->getKey() == key; j++)
+      if (OneAttrMatch(preds_[i], index->at(j)))
 	break;
 
-      itr2++;
-    }
+    if (j == n || index->at(j)->getKey() != key)
+      return false;
   }
 
   // All attributes found !
   return true;
 }
-
@@ -112,4 +112,54 @@ bool MatchAttrs(NRAttrVec *attr_vec1, NRAttrVec *attr_vec2);
 // find a match in 'attr_vec2'
 bool OneWayMatch(NRAttrVec *attr_vec1, NRAttrVec *attr_vec2);
 
+// AttrSignature returns a hash of the attributes in 'attr_vec' that
+// does not depend on their order. If PerfectMatch(v1, v2) is TRUE,
+// both vectors have the same signature, so comparing signatures is a
+// quick way to rule out most non-matching vectors
+u_int32_t AttrSignature(NRAttrVec *attr_vec);
+
+// AttrIndex holds the 'IS' attributes of a message sorted by key,
+// so that many CompiledAttrs can be matched against the message
+// without rescanning its attribute vector. It does not copy the
+// attributes, so it must not outlive the message
+class AttrIndex {
+public:
+  AttrIndex(NRAttrVec *attr_vec);
+
+  // Returns the position of the first attribute with 'key', or
+  // size() if there is none
+  int find(int32_t key);
+
+  int size() { return attrs_.size(); };
+  NRAttribute * at(int i) { return attrs_[i]; };
+
+private:
+  NRAttrVec attrs_;
+};
+
+// CompiledAttrs is an attribute vector used as a pattern (a filter's
+// or an interest's attributes) prepared for matching against many
+// messages: the predicates (attributes with operators other than
+// 'IS') are sorted by key, so that match(AttrIndex(msg_attrs)) does
+// a single merge instead of a scan of the message per predicate. It
+// returns the same result as OneWayMatch(attr_vec, msg_attrs). The
+// attributes are not copied
+class CompiledAttrs {
+public:
+  CompiledAttrs(NRAttrVec *attr_vec);
+
+  bool match(AttrIndex *index);
+
+  // anchor returns the predicate used to index this pattern: an
+  // INT32 'EQ' predicate if there is one (most selective), else the
+  // first predicate, or NULL if the pattern has no predicates (and
+  // therefore matches every message). A message can only match if
+  // it has an 'IS' attribute with the anchor's key
+  NRAttribute * anchor() { return anchor_; };
+
+private:
+  NRAttrVec preds_;
+  NRAttribute *anchor_;
+};
+
 #endif // !_ATTRS_HH_
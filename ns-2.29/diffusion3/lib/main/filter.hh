@@ -96,17 +96,31 @@ public:
   FilterCallback *cb_;
   struct timeval tmv_;
   bool valid_;
+  CompiledAttrs *compiled_;
    
   FilterEntry(int16_t handle, u_int16_t priority, u_int16_t agent) :
     handle_(handle), priority_(priority), agent_(agent)
   {
     valid_ = true;
     cb_ = NULL;
+    filter_attrs_ = NULL;
+    compiled_ = NULL;
     GetTime(&tmv_);
   }
 
+  // compiled returns filter_attrs_ prepared for matching (see
+  // CompiledAttrs), built the first time it is needed. A filter's
+  // attributes never change once it has been added
+  CompiledAttrs * compiled()
+  {
+    if (!compiled_)
+      compiled_ = new CompiledAttrs(filter_attrs_);
+    return compiled_;
+  }
+
   ~FilterEntry()
   {
+    delete compiled_;
     if (filter_attrs_){
       ClearAttrs(filter_attrs_);
       delete filter_attrs_;
@@ -205,6 +205,15 @@ int DiffRoutingAgent::command(int argc, const char*const* argv) {
 			
 			return TCL_OK;
 		}
+		// $diffrtg match-stats: filters matched against messages,
+		// matches found, and filters the index ruled out
+		if (strcasecmp(argv[1], "match-stats")==0) {
+			Tcl::instance().resultf("%ld %ld %ld",
+						agent_->match_attempts_,
+						agent_->match_successes_,
+						agent_->match_skipped_);
+			return TCL_OK;
+		}
 		
 	}
 	else if (argc == 3) {
@@ -128,6 +128,7 @@ static int verbose_debug = 0;
 
 class Link {
 public:
+	MEM_ACCOUNT(MEM_ROUTE)
 	Link(nsaddr_t dst) {
 		ln_dst = dst;
 		ln_flags = ln_cost = 0;
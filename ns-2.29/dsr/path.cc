@@ -110,9 +110,17 @@ ID::dump() const
    0 <= len < MAX_SR_LEN
 */
 
+/* route arrays, mostly those of the route caches, count as routing memory */
+static inline ID *
+new_route()
+{
+  MemAccount::alloc(MEM_ROUTE, MAX_SR_LEN * sizeof(ID));
+  return new ID[MAX_SR_LEN];
+}
+
 Path::Path(int route_len, const ID *route)
 {
-  path = new ID[MAX_SR_LEN];
+  path = new_route();
   assert(route_len <= MAX_SR_LEN);
   //  route_len = (route == NULL : 0 ? route_len); 
   // a more cute solution, follow the above with the then clause
@@ -133,7 +141,7 @@ Path::Path(int route_len, const ID *route)
 
 Path::Path()
 {
-  path = new ID[MAX_SR_LEN];
+  path = new_route();
   len = 0;
   cur_index = 0;
 }
@@ -142,7 +150,7 @@ Path::Path()
 Path::Path(const struct sr_addr *addrs, int len)
 { /* make a path from the bits of an NS source route header */
   assert(len <= MAX_SR_LEN);
-  path = new ID[MAX_SR_LEN];
+  path = new_route();
 
   for (int i = 0 ; i < len ; i++)
     path[i] = ID(addrs[i]);
@@ -153,7 +161,7 @@ Path::Path(const struct sr_addr *addrs, int len)
 
 Path::Path(struct hdr_sr *srh)
 { /* make a path from the bits of an NS source route header */
-	path = new ID[MAX_SR_LEN];
+	path = new_route();
 
 	if (! srh->valid()) {
 		len = 0;
@@ -183,7 +191,7 @@ Path::fillSR(struct hdr_sr *srh)
 
 Path::Path(const Path& old)
 {
-  path = new ID[MAX_SR_LEN];
+  path = new_route();
   if (old.path != NULL)
     {
       for (int c = 0; c < old.len; c++)
@@ -200,6 +208,7 @@ Path::Path(const Path& old)
 
 Path::~Path()
 {
+  MemAccount::release(MEM_ROUTE, MAX_SR_LEN * sizeof(ID));
   delete[] path;
 }
 
@@ -70,11 +70,13 @@ extern "C" {
 #ifdef DSR_CACHE_STATS
 class RouteCache;
 #include <dsr/cache_stats.h>
+#include "mem-account.h"
 #endif
 
 class RouteCache : public TclObject {
 
 public:
+  MEM_ACCOUNT(MEM_ROUTE)
   RouteCache();
   ~RouteCache();
 
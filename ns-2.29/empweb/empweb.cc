@@ -348,20 +348,20 @@ void EmpWebTrafSession::launchReq(void* ClntData, int obj, int size, int reqSize
 	// size and reqSize are in the unit of bytes in fulltcp mode
 	// but in the unit of packet in halftcp mode
 	if (fulltcp_) {
-		Tcl::instance().evalf("%s launch-req-full %d %d %s %s %s %s %d %d %d %d",
+		Tcl::instance().evalf("%s launch-req-full %d %d %s %s %s %s %d %d %ld %d",
                               mgr_->name(), obj, pg->id(), 
 			      src_->name(), pg->dst()->name(),
 			      ctcp->name(),  
 			      stcp->name(),  
-			      size, reqSize, ClntData,persist);
+			      size, reqSize, (long)ClntData,persist);
 	} else {
 		assert (csnk != 0 && ssnk != 0);
-		Tcl::instance().evalf("%s launch-req %d %d %s %s %s %s %s %s %d %d %d %d",
+		Tcl::instance().evalf("%s launch-req %d %d %s %s %s %s %s %s %d %d %ld %d",
                               mgr_->name(), obj, pg->id(), 
 			      src_->name(), pg->dst()->name(),
 			      ctcp->name(), csnk->name(), 
 			      stcp->name(), ssnk->name(), 
-			      size, reqSize, ClntData,
+			      size, reqSize, (long)ClntData,
 			      persist);
 	}
 
@@ -7,6 +7,7 @@
 #include <ranvar.h>
 #include <tclcl.h>
 #include "config.h"
+#include "mem-account.h"
 
 #define IDLE 0
 #define INUSE 1
@@ -17,6 +18,7 @@
 // Abstract page pool, used for interface only
 class PagePool : public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 	PagePool() : num_pages_(0), start_time_(INT_MAX), end_time_(INT_MIN) {}
 	int num_pages() const { return num_pages_; }
 protected:
@@ -37,6 +39,7 @@ protected:
 
 class PersConn : public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 //	PersConn() : status_(IDLE), pendingReqByte_(0), pendingReplyByte_(0), ctcp_(NULL), csnk_(NULL), client_(NULL), server_(NULL) {}
 	PersConn() :  ctcp_(NULL), csnk_(NULL), client_(NULL), server_(NULL) {}
 //	inline int getStatus() { return status_ ;}
@@ -62,6 +62,7 @@ class IPTapAgent : public TapAgent {
   unsigned short in_cksum(unsigned short *,int);
   void recvpkt();
   int sendpkt(Packet*);
+  int batching() { return 0; }	/* recvpkt() drains the net already */
   int isDuplicate(unsigned short, unsigned short);
   void processpkt(Packet *, const struct timeval &);
   static void pkt_handler(void *, Packet *, const struct timeval &);
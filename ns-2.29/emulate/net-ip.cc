@@ -50,6 +50,7 @@ static const char rcsid[] =
 #else
 #include <sys/param.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/ioctl.h>
 #include <netinet/in.h>
 #include <netinet/in_systm.h>
@@ -66,6 +67,8 @@ typedef int Socket;
 #include "tclcl.h"
 #include "scheduler.h"
 
+#define NET_MAXBATCH	64	/* max datagrams per recvmmsg/sendmmsg */
+
 //#define	NIPDEBUG	1
 #ifdef NIPDEBUG
 #define NIDEBUG(x) { if (NIPDEBUG) fprintf(stderr, (x)); }
@@ -109,6 +112,8 @@ public:
 
         int send(u_char* buf, int len);			// virtual in Network
         int recv(u_char* buf, int len, sockaddr& from, double& ); // virtual in Network
+	int recvbatch(u_char**, int*, int, double*);	// virtual in Network
+	int sendbatch(u_char**, int*, int);		// virtual in Network
 
         inline in_addr& laddr() { return (localaddr_); }
         inline in_addr& dstaddr() { return (destaddr_); }
@@ -133,6 +138,9 @@ protected:
 	int loop_;			// do we want loopbacks?
 					// (system usually assumes yes)
 
+	int mrecv(u_char**, int*, int, sockaddr_in*);	// recvmmsg()
+	int msend(u_char**, int*, int, int);		// sendmmsg()
+
 	void reset(int reconfigure);			// reset + reconfig?
 	virtual int open(int mode);	// open sockets/endpoints
 	virtual void reconfigure();	// restore state after reset
@@ -147,6 +155,8 @@ public:
 
 	int send(u_char*, int);
 	int recv(u_char*, int, sockaddr&, double&);
+	int recvbatch(u_char**, int*, int, double*);
+	int sendbatch(u_char**, int*, int);
 	int open(int mode);			// mode only
 
 	int command(int argc, const char*const* argv);
@@ -312,6 +322,35 @@ UDPIPNetwork::recv(u_char* buf, int len, sockaddr& from, double& ts)
 	return (cc);	// number of bytes received
 }
 
+/*
+ * Read a burst of datagrams with one system call.  Our own multicast
+ * packets that the loopback filter would have caught are left in
+ * place with a zero length.
+ */
+int
+UDPIPNetwork::recvbatch(u_char** bufs, int* lens, int n, double* ts)
+{
+	sockaddr_in from[NET_MAXBATCH];
+	int cnt = mrecv(bufs, lens, n, from);
+	if (cnt < 0)
+		return (Network::recvbatch(bufs, lens, n, ts));
+	double now = Scheduler::instance().clock();
+	for (int i = 0; i < cnt; i++) {
+		if (!loop_ && noloopback_broken_ &&
+		    from[i].sin_addr.s_addr == localaddr_.s_addr &&
+		    from[i].sin_port == lport_)
+			lens[i] = 0;
+		ts[i] = now;
+	}
+	return (cnt);
+}
+
+int
+UDPIPNetwork::sendbatch(u_char** bufs, int* lens, int n)
+{
+	return (msend(bufs, lens, n, 0));
+}
+
 int
 UDPIPNetwork::open(int mode)
 {
@@ -563,6 +602,120 @@ IPNetwork::recv(u_char* buf, int len, sockaddr& sa, double& ts)
 	return (cc);
 }
 
+int
+IPNetwork::recvbatch(u_char** bufs, int* lens, int n, double* ts)
+{
+	if (mode_ == O_WRONLY) {
+		fprintf(stderr,
+		    "IPNetwork(%s) recv while in writeonly mode!\n",
+			name());
+		abort();
+	}
+	sockaddr_in from[NET_MAXBATCH];
+	int cnt = mrecv(bufs, lens, n, from);
+	if (cnt < 0)
+		return (Network::recvbatch(bufs, lens, n, ts));
+	double now = Scheduler::instance().clock();
+	for (int i = 0; i < cnt; i++)
+		ts[i] = now;
+	return (cnt);
+}
+
+int
+IPNetwork::sendbatch(u_char** bufs, int* lens, int n)
+{
+	return (msend(bufs, lens, n, 1));
+}
+
+/*
+ * Receive up to n datagrams from rsock_ in one system call where the
+ * system has recvmmsg(2).  Returns the number received (0 if none are
+ * waiting), or -1 if the caller should fall back to recv().
+ */
+int
+IPNetwork::mrecv(u_char** bufs, int* lens, int n, sockaddr_in* from)
+{
+#ifdef __linux__
+	mmsghdr msgs[NET_MAXBATCH];
+	iovec iov[NET_MAXBATCH];
+
+	if (n > NET_MAXBATCH)
+		n = NET_MAXBATCH;
+	memset(msgs, 0, n * sizeof(msgs[0]));
+	for (int i = 0; i < n; i++) {
+		iov[i].iov_base = bufs[i];
+		iov[i].iov_len = lens[i];
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &from[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+	}
+	int cnt = recvmmsg(rsock_, msgs, n, MSG_DONTWAIT, 0);
+	NIDEBUG5("IPNetwork(%s): recvmmsg(%d, msgs, %d) returned %d\n",
+		name(), rsock_, n, cnt);
+	if (cnt < 0) {
+		if (errno == EWOULDBLOCK || errno == EAGAIN)
+			return (0);
+		if (errno != ENOSYS)
+			perror("recvmmsg");
+		return (-1);
+	}
+	for (int i = 0; i < cnt; i++)
+		lens[i] = msgs[i].msg_len;
+	return (cnt);
+#else
+	return (-1);
+#endif
+}
+
+/*
+ * Send n datagrams on ssock_ with as few system calls as possible.
+ * With named set each one goes to the destination in its IP header
+ * (see IPNetwork::send), otherwise to the connected peer.  Whatever
+ * sendmmsg(2) does not take is handed to send() one at a time, so
+ * errors get the usual treatment.  Returns the number sent.
+ */
+int
+IPNetwork::msend(u_char** bufs, int* lens, int n, int named)
+{
+	int done = 0;
+#ifdef __linux__
+	mmsghdr msgs[NET_MAXBATCH];
+	iovec iov[NET_MAXBATCH];
+	sockaddr_in to[NET_MAXBATCH];
+
+	while (done < n) {
+		int m = n - done;
+		if (m > NET_MAXBATCH)
+			m = NET_MAXBATCH;
+		memset(msgs, 0, m * sizeof(msgs[0]));
+		for (int i = 0; i < m; i++) {
+			iov[i].iov_base = bufs[done + i];
+			iov[i].iov_len = lens[done + i];
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			if (named) {
+				memset(&to[i], 0, sizeof(to[i]));
+				to[i].sin_family = AF_INET;
+				to[i].sin_addr =
+					((struct ip*)bufs[done + i])->ip_dst;
+				msgs[i].msg_hdr.msg_name = &to[i];
+				msgs[i].msg_hdr.msg_namelen = sizeof(to[i]);
+			}
+		}
+		int cnt = sendmmsg(ssock_, msgs, m, 0);
+		NIDEBUG5("IPNetwork(%s): sendmmsg(%d, msgs, %d) returned %d\n",
+			name(), ssock_, m, cnt);
+		if (cnt <= 0)
+			break;
+		done += cnt;
+	}
+#endif
+	while (done < n && send(bufs[done], lens[done]) >= 0)
+		done++;
+	return (done);
+}
+
 //
 // we are given a "raw" IP datagram.
 // the raw interface appears to want the len and off fields
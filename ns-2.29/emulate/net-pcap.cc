@@ -119,6 +119,7 @@ public:
 	int recv(u_char *buf, int len, sockaddr&, double&); // get from net
 	int send(u_char *buf, int len);			// write to net
 	int recv(netpkt_handler callback, void *clientdata); // get from net
+	int recvbatch(u_char** bufs, int* lens, int n, double* ts);
 	void close();
 	void reset();
 
@@ -132,6 +133,7 @@ public:
 protected:
 	static void phandler(u_char* u, const pcap_pkthdr* h, const u_char* p);
 	static void phandler_callback(u_char* u, const pcap_pkthdr* h, const u_char* p);
+	static void phandler_batch(u_char* u, const pcap_pkthdr* h, const u_char* p);
 	virtual void bindvars() = 0;
 
 	char errbuf_[PCAP_ERRBUF_SIZE];		// place to put err msgs
@@ -344,6 +346,55 @@ PcapNetwork::phandler_callback(u_char* userdata, const pcap_pkthdr* ph, const u_
 	ps->callback(ps->clientdata, p, ph->ts);
 }
 
+struct pcap_batch {
+        u_char **bufs;
+        int *lens;
+        double *ts;
+        int cnt;
+        PcapNetwork *net;
+};
+
+void
+PcapNetwork::phandler_batch(u_char* userdata, const pcap_pkthdr* ph, const u_char* pkt)
+{
+	pcap_batch *pb = (pcap_batch*) userdata;
+	PcapNetwork *inst = pb->net;
+	int i = pb->cnt++;
+
+	if (++(inst->pcnt_) == 1) {
+		// mark time stamp of first pkt
+		inst->t_firstpkt_ = ph->ts.tv_sec + ph->ts.tv_usec * 0.000001;
+	}
+	int n = MIN(ph->caplen, (unsigned)pb->lens[i]);
+	pb->ts[i] = inst->gents((pcap_pkthdr*)ph);
+	int s = inst->skiphdr();	// go to IP header
+	memcpy(pb->bufs[i], pkt + s, n - s);
+	pb->lens[i] = n - s;
+}
+
+/*
+ * Like recv() above, but hands over up to n packets from a single
+ * read of the capture buffer.
+ */
+int
+PcapNetwork::recvbatch(u_char** bufs, int* lens, int n, double* ts)
+{
+	if (state_ != PNET_PSTATE_ACTIVE) {
+		fprintf(stderr, "warning: net/pcap obj(%s) read-- not active\n",
+			name());
+		return 0;
+	}
+
+	pcap_batch pb = { bufs, lens, ts, 0, this };
+	int np = pcap_dispatch(pcap_, n, phandler_batch, (u_char*) &pb);
+	if (np < 0) {
+		fprintf(stderr,
+			"PcapNetwork(%s): recvbatch: pcap_dispatch: %s\n",
+			    name(), pcap_strerror(errno));
+	}
+	return (pb.cnt);
+}
+
 int
 PcapNetwork::recv(u_char *buf, int len, sockaddr& /*fromaddr*/, double &ts)
 {
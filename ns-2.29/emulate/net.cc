@@ -108,6 +108,50 @@ int Network::command(int argc, const char*const* argv)
 	return (TclObject::command(argc, argv));
 }
 
+/*
+ * Only one recv() is safe on a descriptor that may block: the socket
+ * was readable, but nothing says a second datagram is waiting.
+ */
+int
+Network::recvbatch(u_char** bufs, int* lens, int n, double* ts)
+{
+	sockaddr from;
+	int i;
+	if (n > 1 && !isnonblock(rchannel()))
+		n = 1;
+	for (i = 0; i < n; i++) {
+		int cc = recv(bufs[i], lens[i], from, ts[i]);
+		if (cc <= 0)
+			break;
+		lens[i] = cc;
+	}
+	return (i);
+}
+
+int
+Network::sendbatch(u_char** bufs, int* lens, int n)
+{
+	int i;
+	for (i = 0; i < n; i++)
+		if (send(bufs[i], lens[i]) < 0)
+			break;
+	return (i);
+}
+
+/* is fd known to be in non-blocking mode? */
+int
+Network::isnonblock(int fd)
+{
+#ifdef WIN32
+	return (0);
+#else
+	if (fd < 0)
+		return (0);
+	int flags = fcntl(fd, F_GETFL, 0);
+	return (flags != -1 && (flags & O_NONBLOCK) != 0);
+#endif
+}
+
 int
 Network::nonblock(int fd)
 {       
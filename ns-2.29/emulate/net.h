@@ -43,6 +43,7 @@
 #include "tclcl.h"
 #include "iohandler.h"
 #include "timer.h"
+#include "mem-account.h"
 
 /* win95 #define's this...*/
 #ifdef interface
@@ -55,6 +56,7 @@ typedef void (*netpkt_handler)(void *userdata, Packet *p,
 
 class Network : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Network() : mode_(-1) { }
 	virtual int command(int argc, const char*const* argv);
 	virtual int send(u_char* buf, int len) = 0;
@@ -66,10 +68,20 @@ public:
 		   Tcl::instance().result() );
 	  return 0;
 	} // callback called for every packet
+	/*
+	 * Move up to n packets per call; lens[] holds the buffer sizes
+	 * on the way in and the packet sizes on the way out.  Both return
+	 * the number of packets moved.  The defaults loop on send/recv
+	 * (recv only once unless rchannel() is non-blocking); subclasses
+	 * that can do better (recvmmsg, pcap) override them.
+	 */
+	virtual int recvbatch(u_char** bufs, int* lens, int n, double* ts);
+	virtual int sendbatch(u_char** bufs, int* lens, int n);
 	virtual int rchannel() = 0;
 	virtual int schannel() = 0;
 	int mode() { return mode_; }
 	static int nonblock(int fd);
+	static int isnonblock(int fd);
 	static int parsemode(const char*);  // strings to mode bits
 	static char* modename(int);	    // and the reverse
 protected:
@@ -46,9 +46,25 @@ static class TapAgentClass : public TclClass {
 	}
 } class_tap_agent;
 
-TapAgent::TapAgent() : Agent(PT_LIVE), net_(NULL)
+TapAgent::TapAgent() : Agent(PT_LIVE), net_(NULL), nin_(0), nout_(0),
+	flush_timer_(this)
 {
 	bind("maxpkt_", &maxpkt_);
+	bind("maxbatch_", &maxbatch_);
+}
+
+TapAgent::~TapAgent()
+{
+	for (int i = 0; i < nin_; i++)
+		Packet::free(in_[i]);
+	for (int i = 0; i < nout_; i++)
+		Packet::free(out_[i]);
+}
+
+void
+TapFlushTimer::expire(Event*)
+{
+	a_->flush();
 }
 
 //
@@ -165,8 +181,62 @@ TapAgent::recvpkt()
 	}
 
 	TDEBUG4("%f: Tap(%s): recvpkt, cc:%d\n", now(), name(), cc);
+	inject(p, cc, tstamp);
+}
+
+/*
+ * Read as many as maxbatch_ packets with one call into the network.
+ * The packets a read leaves empty are kept for the next one, so only
+ * those that got data have to be replaced.
+ */
+void
+TapAgent::recvbatch()
+{
+	if (net_->mode() != O_RDWR && net_->mode() != O_RDONLY) {
+		fprintf(stderr,
+		  "TapAgent(%s): recvbatch called while in write-only mode!\n",
+		  name());
+		return;
+	}
+
+	u_char* bufs[TAP_MAXBATCH];
+	int lens[TAP_MAXBATCH];
+	double ts[TAP_MAXBATCH];
+	int n = (maxbatch_ < TAP_MAXBATCH) ? maxbatch_ : TAP_MAXBATCH;
+	int i;
+
+	// maxpkt_ may have changed since the spares were allocated
+	if (nin_ > 0 && in_[0]->datalen() != maxpkt_) {
+		for (i = 0; i < nin_; i++)
+			Packet::free(in_[i]);
+		nin_ = 0;
+	}
+	for (; nin_ < n; nin_++)
+		in_[nin_] = Packet::alloc(maxpkt_);
+	for (i = 0; i < n; i++) {
+		bufs[i] = in_[i]->accessdata();
+		lens[i] = maxpkt_;
+	}
+	int cnt = net_->recvbatch(bufs, lens, n, ts);
+	TDEBUG4("%f: Tap(%s): recvbatch, cnt:%d\n", now(), name(), cnt);
+	int k = 0;
+	for (i = 0; i < nin_; i++) {
+		// zero length: filtered out by the network
+		if (i < cnt && lens[i] > 0) {
+			initpkt(in_[i]);
+			inject(in_[i], lens[i], ts[i]);
+		} else
+			in_[k++] = in_[i];
+	}
+	nin_ = k;
+}
 
-	// inject into simulator
+/*
+ * Hand a packet of cc bytes read off the network to the simulation.
+ */
+void
+TapAgent::inject(Packet* p, int cc, double tstamp)
+{
 	hdr_cmn* ch = HDR_CMN(p);
 	ch->size() = cc;
 
@@ -200,15 +270,18 @@ void
 TapAgent::dispatch(int)
 {
 	/*
-	 * Just process one packet.  We could put a loop here
-	 * but instead we allow the dispatcher to call us back
-	 * if there is a queue in the socket buffer; this allows
-	 * other events to get a chance to slip in...
+	 * Just process one packet (or one batch of maxbatch_).  We
+	 * could put a loop here but instead we allow the dispatcher to
+	 * call us back if there is a queue in the socket buffer; this
+	 * allows other events to get a chance to slip in...
 	 */
 #ifdef notdef
 Scheduler::instance().sync();	// sim clock gets set to now
 #endif
-	recvpkt();
+	if (batching() && maxpkt_ > 0)
+		recvbatch();
+	else
+		recvpkt();
 }
 
 /*
@@ -222,11 +295,53 @@ Scheduler::instance().sync();	// sim clock gets set to now
 void
 TapAgent::recv(Packet* p, Handler*)
 {
+	/*
+	 * When batching, hold the packet until maxbatch_ have
+	 * collected or the simulator moves on from the current
+	 * instant, whichever comes first.
+	 */
+	if (batching() && net_ != NULL) {
+		out_[nout_++] = p;
+		if (nout_ >= maxbatch_ || nout_ >= TAP_MAXBATCH)
+			flush();
+		else if (nout_ == 1)
+			flush_timer_.resched(0);
+		return;
+	}
 	(void) sendpkt(p);
 	Packet::free(p);
 	return;
 }
 
+void
+TapAgent::flush()
+{
+	if (nout_ == 0)
+		return;
+	flush_timer_.force_cancel();
+	if (net_->mode() != O_RDWR && net_->mode() != O_WRONLY) {
+		fprintf(stderr,
+		    "TapAgent(%s): flush called while in read-only mode!\n",
+		    name());
+	} else {
+		u_char* bufs[TAP_MAXBATCH];
+		int lens[TAP_MAXBATCH];
+		for (int i = 0; i < nout_; i++) {
+			bufs[i] = out_[i]->accessdata();
+			lens[i] = HDR_CMN(out_[i])->size();
+		}
+		int cnt = net_->sendbatch(bufs, lens, nout_);
+		if (cnt < nout_)
+			fprintf(stderr,
+			    "TapAgent(%s): flush: sent %d of %d: %s\n",
+			    name(), cnt, nout_, strerror(errno));
+		TDEBUG3("TapAgent(%s): sent %d packets\n", name(), cnt);
+	}
+	for (int i = 0; i < nout_; i++)
+		Packet::free(out_[i]);
+	nout_ = 0;
+}
+
 int
 TapAgent::sendpkt(Packet* p)
 {
@@ -59,21 +59,47 @@
 #endif
 
 #include <errno.h>
+#include "timer-handler.h"
+
+#define TAP_MAXBATCH 64		/* upper bound on maxbatch_ */
+
+class TapAgent;
+
+class TapFlushTimer : public TimerHandler {
+public:
+	TapFlushTimer(TapAgent* a) : a_(a) {}
+protected:
+	virtual void expire(Event*);
+	TapAgent* a_;
+};
 
 class TapAgent : public Agent, public IOHandler {
 public:
         TapAgent();
+	~TapAgent();
 	int command(int, const char*const*);
 	void recv(Packet* p, Handler*);	/* sim->live net */  
+	void flush();		/* send out the packets held for a batch */
 private:
 	virtual int sendpkt(Packet *);
 	virtual void recvpkt();
+	void recvbatch();
 protected:
+	/* may packets be moved maxbatch_ at a time? */
+	virtual int batching() { return (maxbatch_ > 1); }
+	void inject(Packet* p, int cc, double tstamp);
 	int maxpkt_;		/* max size allocated to recv a pkt */
+	int maxbatch_;		/* max packets moved per system call */
 	void dispatch(int);	/* invoked via scheduler on I/O event */
 	int linknet();		/* establish I/O handler */
 	Network* net_;		/* live network object */
 	double now() { return Scheduler::instance().clock(); }
+
+	Packet* in_[TAP_MAXBATCH];	/* empty packets to read into */
+	int nin_;
+	Packet* out_[TAP_MAXBATCH];	/* packets waiting to be sent */
+	int nout_;
+	TapFlushTimer flush_timer_;
 };
 
 
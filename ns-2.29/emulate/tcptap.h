@@ -94,6 +94,7 @@ class TCPTapAgent : public TapAgent {
   void tcp_gen(char *, unsigned short, unsigned short, Packet *);
   void recvpkt();
   int sendpkt(Packet*);
+  int batching() { return 0; }	/* recvpkt() drains the net already */
   void processpkt(Packet *, const struct timeval &);
   static void pkt_handler(void *, Packet *, const struct timeval &);
   
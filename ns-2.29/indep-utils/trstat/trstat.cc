@@ -0,0 +1,900 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * trstat: per-flow throughput, delay and jitter, drops and routing
+ * overhead from an ns packet trace, in one pass.
+ *
+ * The trace is mapped into memory and cut into one chunk per thread at
+ * line boundaries.  Each thread parses its chunk and keeps its own
+ * tables; packets sent in one chunk and received or dropped in a later
+ * one are matched up when the chunks are merged, in order.
+ *
+ * Three trace formats are understood, as written by trace/trace.cc and
+ * trace/cmu-trace.cc:
+ *
+ *  wired ($ns trace-all):
+ *	+ 1.84 0 2 tcp 1040 ------- 1 0.0 3.0 29 199 [...]
+ *	ev time from to type size flags fid src.port dst.port seq uid
+ *
+ *  old wireless (CMU):
+ *	s 1.84 _0_ AGT  --- 199 tcp 1040 [0 0 0 0] ------- [0:0 3:0 32 0] ...
+ *	ev time _node_ layer reason uid type size [mac] ------- [ip] ...
+ *
+ *  new wireless ($ns use-newtrace):
+ *	s -t 1.84 -Hs 0 -Hd -2 -Ni 0 ... -Nl AGT -Nw --- ... -Is 0.0
+ *	-Id 3.0 -It tcp -Il 1040 -If 1 -Ii 199 -Iv 32 ...
+ *
+ * Other lines (variable traces, annotations, nam events, tagged
+ * traces) are skipped.  Addresses must be flat: the node part of a
+ * packet's destination is compared with the node it arrives at.
+ */
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#define TRSTAT_MAXLINE	4096
+#define TRSTAT_MAXTOK	128
+#define TRSTAT_MAXTHREADS 64
+
+/* where an event happened */
+enum Layer { L_LINK, L_AGT, L_RTR, L_MAC, L_IFQ, L_OTHER };
+
+/*
+ * One parsed trace line.  Wired events happen on the link from node
+ * to node to; wireless ones at node, on a layer.  Packets without an
+ * IP header (ARP, 802.11 control) have src == -1.
+ */
+struct Event {
+	char ev;		// s r f d (wireless), + - r d (wired)
+	double t;
+	int node;
+	int to;
+	int layer;
+	char type[32];
+	char why[16];		// drop reason, wireless only
+	int size;
+	int fid;
+	int src, sport;
+	int dst, dport;
+	long uid;
+	long off;		// where the line is in the trace
+};
+
+/* Routing protocol packet types; see common/packet.h */
+static const char* routing_types[] = {
+	"AODV", "DSR", "TORA", "IMEP", "message", "rtProtoDV", "rtProtoLS",
+	"tora", "imep", 0
+};
+
+static int
+is_routing(const char *type)
+{
+	for (int i = 0; routing_types[i] != 0; i++)
+		if (strcmp(type, routing_types[i]) == 0)
+			return (1);
+	return (0);
+}
+
+/*
+ * Split s in place at white space.  Returns the number of tokens.
+ */
+static int
+split(char *s, char **tok, int max)
+{
+	int n = 0;
+	for (;;) {
+		while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')
+			s++;
+		if (*s == 0 || n == max)
+			return (n);
+		tok[n++] = s;
+		while (*s != 0 && *s != ' ' && *s != '\t' && *s != '\r' &&
+		       *s != '\n')
+			s++;
+		if (*s == 0)
+			return (n);
+		*s++ = 0;
+	}
+}
+
+static void
+copy(char *dst, const char *src, int len)
+{
+	strncpy(dst, src, len - 1);
+	dst[len - 1] = 0;
+}
+
+/*
+ * Parse "node<sep>port"; the port follows the last sep.  Returns 0
+ * for anything else, including hierarchical addresses.
+ */
+static int
+parse_addr(const char *s, char sep, int &node, int &port)
+{
+	const char *p = strrchr(s, sep);
+	char *e;
+	if (p == 0)
+		return (0);
+	node = strtol(s, &e, 10);
+	if (e != p)
+		return (0);
+	port = strtol(p + 1, &e, 10);
+	return (*e == 0 || *e == ']');
+}
+
+static int
+parse_layer(const char *s)
+{
+	if (strcmp(s, "AGT") == 0)
+		return (L_AGT);
+	if (strcmp(s, "RTR") == 0)
+		return (L_RTR);
+	if (strcmp(s, "MAC") == 0)
+		return (L_MAC);
+	if (strcmp(s, "IFQ") == 0)
+		return (L_IFQ);
+	return (L_OTHER);
+}
+
+static void
+no_ip(Event &e)
+{
+	e.fid = -1;
+	e.src = e.sport = e.dst = e.dport = -1;
+}
+
+static int
+parse_wired(char **tok, int n, Event &e)
+{
+	if (n < 12 || tok[0][1] != 0 || strchr("+-rd", tok[0][0]) == 0)
+		return (0);
+	e.ev = tok[0][0];
+	e.t = atof(tok[1]);
+	e.node = atoi(tok[2]);
+	e.to = atoi(tok[3]);
+	e.layer = L_LINK;
+	copy(e.type, tok[4], sizeof(e.type));
+	e.why[0] = 0;
+	e.size = atoi(tok[5]);
+	e.fid = atoi(tok[7]);
+	if (!parse_addr(tok[8], '.', e.src, e.sport) ||
+	    !parse_addr(tok[9], '.', e.dst, e.dport))
+		no_ip(e);
+	e.uid = atol(tok[11]);
+	return (1);
+}
+
+static int
+parse_cmu(char **tok, int n, Event &e)
+{
+	if (n < 8 || tok[0][1] != 0 || strchr("srfdD", tok[0][0]) == 0)
+		return (0);
+	int i = 2;
+	e.ev = (tok[0][0] == 'D') ? 'd' : tok[0][0];
+	e.t = atof(tok[1]);
+	e.node = atoi(tok[i] + 1);
+	if (tok[i + 1][0] == '(')	// LOG_POSITION
+		i += 2;
+	if (n < i + 6)
+		return (0);
+	e.to = -1;
+	e.layer = parse_layer(tok[i + 1]);
+	copy(e.why, tok[i + 2], sizeof(e.why));
+	e.uid = atol(tok[i + 3]);
+	copy(e.type, tok[i + 4], sizeof(e.type));
+	e.size = atoi(tok[i + 5]);
+	e.fid = -1;
+
+	// the IP header is the first "[src:port" after the MAC header
+	no_ip(e);
+	for (i += 6; i + 1 < n; i++)
+		if (tok[i][0] == '[' && strchr(tok[i], ':') != 0) {
+			if (!parse_addr(tok[i] + 1, ':', e.src, e.sport) ||
+			    !parse_addr(tok[i + 1], ':', e.dst, e.dport))
+				no_ip(e);
+			break;
+		}
+	return (1);
+}
+
+static int
+parse_newtrace(char **tok, int n, Event &e)
+{
+	if (tok[0][1] != 0 || strchr("srfdD", tok[0][0]) == 0)
+		return (0);
+	e.ev = (tok[0][0] == 'D') ? 'd' : tok[0][0];
+	e.t = -1;
+	e.node = -1;
+	e.to = -1;
+	e.layer = L_OTHER;
+	e.type[0] = 0;
+	e.why[0] = 0;
+	e.size = 0;
+	e.uid = -1;
+	no_ip(e);
+
+	int ip = 0;
+	for (int i = 1; i + 1 < n; i += 2) {
+		const char *k = tok[i], *v = tok[i + 1];
+		if (k[0] != '-')
+			break;		// not -key value any more
+		switch (k[1]) {
+		case 't':
+			e.t = atof(v);
+			break;
+		case 'N':
+			if (k[2] == 'i')
+				e.node = atoi(v);
+			else if (k[2] == 'l')
+				e.layer = parse_layer(v);
+			else if (k[2] == 'w')
+				copy(e.why, v, sizeof(e.why));
+			break;
+		case 'I':
+			if (k[2] == 's')
+				ip += parse_addr(v, '.', e.src, e.sport);
+			else if (k[2] == 'd')
+				ip += parse_addr(v, '.', e.dst, e.dport);
+			else if (k[2] == 't')
+				copy(e.type, v, sizeof(e.type));
+			else if (k[2] == 'l')
+				e.size = atoi(v);
+			else if (k[2] == 'f')
+				e.fid = atoi(v);
+			else if (k[2] == 'i')
+				e.uid = atol(v);
+			break;
+		}
+	}
+	if (ip != 2)
+		no_ip(e);
+	return (e.t >= 0 && e.node >= 0);
+}
+
+static int
+parse(char *line, Event &e)
+{
+	char *tok[TRSTAT_MAXTOK];
+	int n = split(line, tok, TRSTAT_MAXTOK);
+	if (n < 3)
+		return (0);
+	if (strcmp(tok[1], "-t") == 0)
+		return (parse_newtrace(tok, n, e));
+	if (tok[2][0] == '_')
+		return (parse_cmu(tok, n, e));
+	return (parse_wired(tok, n, e));
+}
+
+/*
+ * Packets sent but not yet received, by uid.  Open addressing with
+ * linear probing; deletion shifts the rest of the run back.
+ */
+class UidTable {
+public:
+	struct Entry {
+		long uid;
+		double t;
+		int flow;
+		int used;
+	};
+
+	UidTable() : tab_(0), size_(0), n_(0) { grow(); }
+	~UidTable() { delete [] tab_; }
+
+	Entry* find(long uid) {
+		for (unsigned i = hash(uid); tab_[i].used; i = (i + 1) & mask())
+			if (tab_[i].uid == uid)
+				return (&tab_[i]);
+		return (0);
+	}
+	void insert(long uid, double t, int flow) {
+		Entry *e = find(uid);
+		if (e == 0) {
+			if (2 * (n_ + 1) > size_)
+				grow();
+			unsigned i;
+			for (i = hash(uid); tab_[i].used; i = (i + 1) & mask())
+				;
+			e = &tab_[i];
+			e->used = 1;
+			e->uid = uid;
+			n_++;
+		}
+		e->t = t;
+		e->flow = flow;
+	}
+	void erase(Entry *e) {
+		unsigned i = e - tab_, j = i;
+		tab_[i].used = 0;
+		n_--;
+		for (;;) {
+			j = (j + 1) & mask();
+			if (!tab_[j].used)
+				return;
+			unsigned k = hash(tab_[j].uid);
+			// move j back to i unless its home lies in (i, j]
+			if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+				continue;
+			tab_[i] = tab_[j];
+			tab_[j].used = 0;
+			i = j;
+		}
+	}
+	int size() const { return (size_); }
+	const Entry& at(int i) const { return (tab_[i]); }
+
+private:
+	unsigned mask() const { return (size_ - 1); }
+	unsigned hash(long uid) const {
+		return ((unsigned)(uid * 2654435761UL) & mask());
+	}
+	void grow() {
+		Entry *old = tab_;
+		int oldsize = size_;
+		size_ = size_ ? 2 * size_ : 1024;
+		tab_ = new Entry[size_];
+		memset(tab_, 0, size_ * sizeof(Entry));
+		n_ = 0;
+		for (int i = 0; i < oldsize; i++)
+			if (old[i].used)
+				insert(old[i].uid, old[i].t, old[i].flow);
+		delete [] old;
+	}
+
+	Entry *tab_;
+	int size_;
+	int n_;
+};
+
+struct FlowKey {
+	int fid, src, sport, dst, dport;
+	bool operator<(const FlowKey &k) const {
+		if (fid != k.fid) return (fid < k.fid);
+		if (src != k.src) return (src < k.src);
+		if (sport != k.sport) return (sport < k.sport);
+		if (dst != k.dst) return (dst < k.dst);
+		return (dport < k.dport);
+	}
+};
+
+struct Sample {
+	long off;		// of the receive in the trace, to sort by
+	double t;		// received
+	double delay;
+	bool operator<(const Sample &s) const { return (off < s.off); }
+};
+
+struct Flow {
+	FlowKey key;
+	long sent, sentbytes;
+	long recv, recvbytes;
+	long drops;
+	double first, last;	// first sent, last received
+	std::vector<Sample> samples;
+	std::vector<double> bins;	// bytes received per interval
+
+	Flow() : sent(0), sentbytes(0), recv(0), recvbytes(0), drops(0),
+		 first(-1), last(-1) {
+		key.fid = key.src = key.sport = key.dst = key.dport = -1;
+	}
+};
+
+struct Count {
+	long pkts, bytes;
+	Count() : pkts(0), bytes(0) {}
+};
+
+/* a receive or drop of a packet sent in an earlier chunk */
+struct Orphan {
+	long uid;
+	long off;
+	double t;
+	int flow;
+	char ev;
+};
+
+static double interval = 1.0;
+
+/*
+ * What one thread finds in its part of the trace.
+ */
+struct Chunk {
+	const char *base, *begin, *end;
+	pthread_t thread;
+
+	std::map<FlowKey, int> flowidx;
+	std::vector<Flow> flows;
+	UidTable pending;
+	std::vector<Orphan> orphans;
+	std::map<std::string, long> drops;
+	std::map<std::string, Count> routing;
+	long lines, events;
+	double tmax;
+
+	Chunk() : lines(0), events(0), tmax(0) {}
+	int flow(const Event &e);
+	void add(const Event &e);
+	void run();
+};
+
+int
+Chunk::flow(const Event &e)
+{
+	FlowKey k;
+	k.fid = e.fid;
+	k.src = e.src;
+	k.sport = e.sport;
+	k.dst = e.dst;
+	k.dport = e.dport;
+	std::map<FlowKey, int>::iterator i = flowidx.find(k);
+	if (i != flowidx.end())
+		return (i->second);
+	int n = flows.size();
+	flows.push_back(Flow());
+	flows[n].key = k;
+	flowidx[k] = n;
+	return (n);
+}
+
+void
+Chunk::add(const Event &e)
+{
+	char key[64];
+
+	events++;
+	if (e.t > tmax)
+		tmax = e.t;
+
+	if (e.ev == 'd') {
+		if (e.layer == L_LINK)
+			sprintf(key, "link %d->%d", e.node, e.to);
+		else
+			sprintf(key, "node %d %s %s", e.node,
+				(e.layer == L_AGT) ? "AGT" :
+				(e.layer == L_RTR) ? "RTR" :
+				(e.layer == L_MAC) ? "MAC" :
+				(e.layer == L_IFQ) ? "IFQ" : "-", e.why);
+		drops[key]++;
+	}
+
+	if (is_routing(e.type)) {
+		// every transmission counts, at the source or forwarded
+		if ((e.layer == L_LINK && e.ev == '-') ||
+		    (e.layer == L_RTR && (e.ev == 's' || e.ev == 'f'))) {
+			Count &c = routing[e.type];
+			c.pkts++;
+			c.bytes += e.size;
+		}
+		return;
+	}
+	if (e.src < 0)
+		return;
+
+	int sent, received;
+	if (e.layer == L_LINK) {
+		sent = (e.ev == '+' && e.node == e.src);
+		received = (e.ev == 'r' && e.to == e.dst);
+	} else if (e.layer == L_AGT) {
+		sent = (e.ev == 's' && e.node == e.src);
+		received = (e.ev == 'r' && e.node == e.dst);
+	} else
+		sent = received = 0;
+	// A packet lost at the MAC (a collision, say) is sent again with
+	// the same uid, so only drops above the MAC are final.
+	int dropped = (e.ev == 'd' && e.layer != L_MAC);
+	if (!sent && !received && !dropped)
+		return;
+
+	int f = flow(e);
+	Flow &fl = flows[f];
+	if (sent) {
+		if (pending.find(e.uid) != 0)
+			return;		// already sent, e.g. a second '+'
+		fl.sent++;
+		fl.sentbytes += e.size;
+		if (fl.first < 0)
+			fl.first = e.t;
+		pending.insert(e.uid, e.t, f);
+		return;
+	}
+
+	if (dropped)
+		fl.drops++;
+	else {
+		fl.recv++;
+		fl.recvbytes += e.size;
+		fl.last = e.t;
+		unsigned b = (unsigned)(e.t / interval);
+		if (b >= fl.bins.size())
+			fl.bins.resize(b + 1, 0.0);
+		fl.bins[b] += e.size;
+	}
+	UidTable::Entry *p = pending.find(e.uid);
+	if (p != 0) {
+		if (e.ev == 'r') {
+			Sample s;
+			s.off = e.off;
+			s.t = e.t;
+			s.delay = e.t - p->t;
+			fl.samples.push_back(s);
+		}
+		pending.erase(p);
+	} else {
+		Orphan o;
+		o.uid = e.uid;
+		o.off = e.off;
+		o.t = e.t;
+		o.flow = f;
+		o.ev = e.ev;
+		orphans.push_back(o);
+	}
+}
+
+void
+Chunk::run()
+{
+	char line[TRSTAT_MAXLINE];
+	Event e;
+
+	for (const char *p = begin; p < end; ) {
+		const char *q = (const char *)memchr(p, '\n', end - p);
+		if (q == 0)
+			q = end;
+		int len = q - p;
+		if (len >= TRSTAT_MAXLINE)
+			len = TRSTAT_MAXLINE - 1;
+		memcpy(line, p, len);
+		line[len] = 0;
+		lines++;
+		if (parse(line, e)) {
+			e.off = p - base;
+			add(e);
+		}
+		p = q + 1;
+	}
+}
+
+static void*
+chunk_thread(void *arg)
+{
+	((Chunk *)arg)->run();
+	return (0);
+}
+
+/*
+ * The merged results.
+ */
+struct Result {
+	std::map<FlowKey, int> flowidx;
+	std::vector<Flow> flows;
+	UidTable pending;
+	std::map<std::string, long> drops;
+	std::map<std::string, Count> routing;
+	long lines, events;
+	double tmax;
+
+	Result() : lines(0), events(0), tmax(0) {}
+	void merge(Chunk &c);
+};
+
+void
+Result::merge(Chunk &c)
+{
+	std::vector<int> map(c.flows.size());
+	for (unsigned i = 0; i < c.flows.size(); i++) {
+		Flow &src = c.flows[i];
+		std::map<FlowKey, int>::iterator j = flowidx.find(src.key);
+		if (j == flowidx.end()) {
+			map[i] = flows.size();
+			flowidx[src.key] = map[i];
+			flows.push_back(Flow());
+			flows[map[i]].key = src.key;
+		} else
+			map[i] = j->second;
+
+		Flow &dst = flows[map[i]];
+		dst.sent += src.sent;
+		dst.sentbytes += src.sentbytes;
+		dst.recv += src.recv;
+		dst.recvbytes += src.recvbytes;
+		dst.drops += src.drops;
+		if (dst.first < 0)
+			dst.first = src.first;
+		if (src.last >= 0)
+			dst.last = src.last;
+		dst.samples.insert(dst.samples.end(), src.samples.begin(),
+				   src.samples.end());
+		if (src.bins.size() > dst.bins.size())
+			dst.bins.resize(src.bins.size(), 0.0);
+		for (unsigned b = 0; b < src.bins.size(); b++)
+			dst.bins[b] += src.bins[b];
+		std::vector<Sample>().swap(src.samples);
+	}
+
+	// packets that left in an earlier chunk
+	for (unsigned i = 0; i < c.orphans.size(); i++) {
+		Orphan &o = c.orphans[i];
+		UidTable::Entry *p = pending.find(o.uid);
+		if (p == 0)
+			continue;
+		if (o.ev == 'r') {
+			Sample s;
+			s.off = o.off;
+			s.t = o.t;
+			s.delay = o.t - p->t;
+			flows[map[o.flow]].samples.push_back(s);
+		}
+		pending.erase(p);
+	}
+	for (int i = 0; i < c.pending.size(); i++) {
+		const UidTable::Entry &p = c.pending.at(i);
+		if (p.used)
+			pending.insert(p.uid, p.t, map[p.flow]);
+	}
+
+	std::map<std::string, long>::iterator d;
+	for (d = c.drops.begin(); d != c.drops.end(); d++)
+		drops[d->first] += d->second;
+	std::map<std::string, Count>::iterator r;
+	for (r = c.routing.begin(); r != c.routing.end(); r++) {
+		routing[r->first].pkts += r->second.pkts;
+		routing[r->first].bytes += r->second.bytes;
+	}
+	lines += c.lines;
+	events += c.events;
+	if (c.tmax > tmax)
+		tmax = c.tmax;
+}
+
+static void
+flow_name(const FlowKey &k, char *buf)
+{
+	if (k.fid >= 0)
+		sprintf(buf, "flow %d %d.%d->%d.%d", k.fid, k.src, k.sport,
+			k.dst, k.dport);
+	else
+		sprintf(buf, "flow %d.%d->%d.%d", k.src, k.sport,
+			k.dst, k.dport);
+}
+
+static FILE*
+xg_open(const char *prefix, const char *suffix, const char *title,
+	const char *xunit, const char *yunit)
+{
+	char fn[1024];
+	sprintf(fn, "%.1000s.%s", prefix, suffix);
+	FILE *fp = fopen(fn, "w");
+	if (fp == 0) {
+		fprintf(stderr, "trstat: %s: %s\n", fn, strerror(errno));
+		exit(1);
+	}
+	fprintf(fp, "TitleText: %s\n"
+		"Device: Postscript\n"
+		"BoundBox: true\n"
+		"Ticks: true\n"
+		"XUnitText: %s\n"
+		"YUnitText: %s\n", title, xunit, yunit);
+	return (fp);
+}
+
+static void
+report(Result &r, const char *title, const char *prefix, int nflows)
+{
+	char name[128];
+	long delivered = 0;
+	unsigned i;
+
+	// flows with the most packets received first
+	std::vector<std::pair<long, int> > order;
+	for (i = 0; i < r.flows.size(); i++) {
+		Flow &f = r.flows[i];
+		std::sort(f.samples.begin(), f.samples.end());
+		order.push_back(std::make_pair(-f.recv, (int)i));
+		delivered += f.recv;
+	}
+	std::sort(order.begin(), order.end());
+	if (nflows <= 0 || nflows > (int)order.size())
+		nflows = order.size();
+
+	printf("# %s: %ld lines, %ld events, %.6f seconds\n", title,
+	       r.lines, r.events, r.tmax);
+	printf("#\n# flow sent recv drops loss%% kbps "
+	       "delay_min delay_avg delay_max jitter\n");
+	for (i = 0; i < order.size(); i++) {
+		Flow &f = r.flows[order[i].second];
+		double dmin = 0, dmax = 0, dsum = 0, jsum = 0;
+		for (unsigned k = 0; k < f.samples.size(); k++) {
+			double d = f.samples[k].delay;
+			if (k == 0 || d < dmin)
+				dmin = d;
+			if (k == 0 || d > dmax)
+				dmax = d;
+			dsum += d;
+			if (k > 0)
+				jsum += fabs(d - f.samples[k - 1].delay);
+		}
+		int n = f.samples.size();
+		double dur = f.last - f.first;
+		flow_name(f.key, name);
+		printf("%s %ld %ld %ld %.2f %.3f %.6f %.6f %.6f %.6f\n", name,
+		       f.sent, f.recv, f.drops,
+		       f.sent ? 100.0 * (f.sent - f.recv) / f.sent : 0.0,
+		       dur > 0 ? 8 * f.recvbytes / dur / 1000 : 0.0,
+		       dmin, n ? dsum / n : 0.0, dmax,
+		       n > 1 ? jsum / (n - 1) : 0.0);
+	}
+
+	printf("#\n# drops: where count\n");
+	std::map<std::string, long>::iterator d;
+	for (d = r.drops.begin(); d != r.drops.end(); d++)
+		printf("%s %ld\n", d->first.c_str(), d->second);
+
+	printf("#\n# routing: type packets bytes\n");
+	long rpkts = 0;
+	std::map<std::string, Count>::iterator rt;
+	for (rt = r.routing.begin(); rt != r.routing.end(); rt++) {
+		printf("%s %ld %ld\n", rt->first.c_str(), rt->second.pkts,
+		       rt->second.bytes);
+		rpkts += rt->second.pkts;
+	}
+	if (rpkts > 0)
+		printf("# normalized routing load %.4f\n",
+		       delivered ? (double)rpkts / delivered : 0.0);
+
+	if (prefix == 0)
+		return;
+
+	FILE *tp = xg_open(prefix, "tput.xg", title, "time", "kbps");
+	FILE *dp = xg_open(prefix, "delay.xg", title, "time", "delay");
+	FILE *cp = xg_open(prefix, "cdf.xg", title, "delay", "fraction");
+	fprintf(dp, "NoLines: true\nMarkers: true\n");
+	for (int k = 0; k < nflows; k++) {
+		Flow &f = r.flows[order[k].second];
+		flow_name(f.key, name);
+		fprintf(tp, "\n\"%s\n", name);
+		for (unsigned b = 0; b < f.bins.size(); b++)
+			fprintf(tp, "%g %g\n", (b + 1) * interval,
+				8 * f.bins[b] / interval / 1000);
+		fprintf(dp, "\n\"%s\n", name);
+		for (unsigned s = 0; s < f.samples.size(); s++)
+			fprintf(dp, "%.9g %.9g\n", f.samples[s].t,
+				f.samples[s].delay);
+
+		std::vector<double> v(f.samples.size());
+		for (unsigned s = 0; s < f.samples.size(); s++)
+			v[s] = f.samples[s].delay;
+		std::sort(v.begin(), v.end());
+		fprintf(cp, "\n\"%s\n", name);
+		for (unsigned s = 0; s < v.size(); s++)
+			if (s + 1 == v.size() || v[s + 1] != v[s])
+				fprintf(cp, "%.9g %g\n", v[s],
+					(double)(s + 1) / v.size());
+	}
+	fclose(tp);
+	fclose(dp);
+	fclose(cp);
+}
+
+static void
+usage()
+{
+	fprintf(stderr,
+"usage: trstat [-j threads] [-i interval] [-n flows] [-o prefix] trace\n"
+"\n"
+"    -j threads   parse with this many threads (default: one per cpu)\n"
+"    -i interval  throughput averaging interval, seconds (default 1)\n"
+"    -n flows     plot only the flows with the most packets received\n"
+"    -o prefix    write xgraph files prefix.tput.xg, prefix.delay.xg\n"
+"                 and prefix.cdf.xg\n");
+	exit(1);
+}
+
+int
+main(int argc, char **argv)
+{
+	int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	int nflows = 0;
+	const char *prefix = 0;
+	int c;
+
+	while ((c = getopt(argc, argv, "j:i:n:o:")) != -1) {
+		switch (c) {
+		case 'j':
+			nthreads = atoi(optarg);
+			break;
+		case 'i':
+			interval = atof(optarg);
+			break;
+		case 'n':
+			nflows = atoi(optarg);
+			break;
+		case 'o':
+			prefix = optarg;
+			break;
+		default:
+			usage();
+		}
+	}
+	if (optind != argc - 1 || interval <= 0)
+		usage();
+	if (nthreads < 1)
+		nthreads = 1;
+	if (nthreads > TRSTAT_MAXTHREADS)
+		nthreads = TRSTAT_MAXTHREADS;
+
+	const char *fn = argv[optind];
+	int fd = open(fn, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		fprintf(stderr, "trstat: %s: %s\n", fn, strerror(errno));
+		exit(1);
+	}
+	size_t len = st.st_size;
+	const char *base = "";
+	if (len > 0) {
+		void *m = mmap(0, len, PROT_READ, MAP_SHARED, fd, 0);
+		if (m == MAP_FAILED) {
+			fprintf(stderr, "trstat: mmap %s: %s\n", fn,
+				strerror(errno));
+			exit(1);
+		}
+#ifdef MADV_SEQUENTIAL
+		madvise(m, len, MADV_SEQUENTIAL);
+#endif
+		base = (const char *)m;
+	}
+
+	// chunks of about the same size, cut after a newline
+	if ((size_t)nthreads > len / 65536 + 1)
+		nthreads = len / 65536 + 1;
+	std::vector<Chunk*> chunks(nthreads);
+	const char *p = base, *end = base + len;
+	for (int i = 0; i < nthreads; i++) {
+		Chunk *ck = new Chunk;
+		ck->base = base;
+		ck->begin = p;
+		if (i == nthreads - 1)
+			p = end;
+		else {
+			p = base + len / nthreads * (i + 1);
+			if (p < ck->begin)
+				p = ck->begin;
+			const char *q = (const char *)memchr(p, '\n', end - p);
+			p = q ? q + 1 : end;
+		}
+		ck->end = p;
+		chunks[i] = ck;
+	}
+	for (int i = 1; i < nthreads; i++)
+		if (pthread_create(&chunks[i]->thread, 0, chunk_thread,
+				   chunks[i]) != 0) {
+			fprintf(stderr, "trstat: can't create thread\n");
+			exit(1);
+		}
+	chunks[0]->run();
+
+	Result r;
+	for (int i = 0; i < nthreads; i++) {
+		if (i > 0)
+			pthread_join(chunks[i]->thread, 0);
+		r.merge(*chunks[i]);
+		delete chunks[i];
+	}
+	report(r, fn, prefix, nflows);
+	return (0);
+}
@@ -0,0 +1,431 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Bulk construction of large wired topologies; see bulk-topo.h.
+ */
+
+#ifndef lint
+static const char rcsid[] =
+    "@(#) $Header$";
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bulk-topo.h"
+#include "ip.h"
+#include "route.h"
+
+static class BulkTopologyClass : public TclClass {
+public:
+	BulkTopologyClass() : TclClass("BulkTopology") {}
+	TclObject* create(int, const char*const*) {
+		return (new BulkTopology);
+	}
+} class_bulk_topology;
+
+/*
+ * The edge list spells bandwidths and delays as scripts do ("10Mb",
+ * "2ms"), so they are parsed with TclObject::bw_atof() and
+ * time_atof(), as bind_bw() and bind_time() parse them.  Both copy
+ * the number into a 32-byte buffer: load() rejects longer fields.
+ */
+#define BULK_MAXFIELD 32
+
+void BulkLinkHandler::handle(Event*)
+{
+	link_.resume();
+}
+
+void BulkLinkTail::recv(Packet* p, Handler* h)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	int ttl = iph->ttl() - 1;
+	if (ttl <= 0) {
+		drop(p);
+		return;
+	}
+	iph->ttl() = ttl;
+	send(p, h);
+}
+
+BulkLink::BulkLink(int src, int dst, double bw, double delay, int limit) :
+	src_(src), dst_(dst), bandwidth_(bw), delay_(delay), qlim_(limit),
+	blocked_(0), bh_(*this), shadow_(0), next_(0),
+	arrivals_(0), departures_(0), drops_(0)
+{
+}
+
+/*
+ * Enqueue as DropTail does and start sending if the line is idle, as
+ * Queue::recv() does.
+ */
+void BulkLink::recv(Packet* p, Handler* h)
+{
+	if (shadow_ != 0) {
+		shadow_->recv(p, h);
+		return;
+	}
+	arrivals_++;
+	if (q_.length() + 1 >= qlim_) {
+		drops_++;
+		drop(p);
+		return;
+	}
+	q_.enque(p);
+	if (!blocked_) {
+		blocked_ = 1;
+		transmit(q_.deque());
+	}
+}
+
+/*
+ * As DelayLink::recv(): the packet arrives at the far end after its
+ * transmission time plus the propagation delay, and the line is free
+ * again after the transmission time.
+ */
+void BulkLink::transmit(Packet* p)
+{
+	Scheduler& s = Scheduler::instance();
+	double txt = 8. * hdr_cmn::access(p)->size() / bandwidth_;
+	departures_++;
+	s.schedule(&tail_, p, txt + delay_);
+	s.schedule(&bh_, &intr_, txt);
+}
+
+void BulkLink::resume()
+{
+	Packet* p = q_.deque();
+	if (p != 0)
+		transmit(p);
+	else
+		blocked_ = 0;
+}
+
+BulkTopology* BulkTopology::instance_;
+
+BulkTopology::BulkTopology() : edges_(0), etail_(0), out_(0), size_(0),
+	nlinks_(0), nshadows_(0), nfull_(0)
+{
+	instance_ = this;
+}
+
+/*
+ * Links may have packets scheduled at the end of a run, so they are
+ * left alone; only the index goes.
+ */
+BulkTopology::~BulkTopology()
+{
+	while (edges_ != 0) {
+		Edge* e = edges_;
+		edges_ = e->next_;
+		delete e;
+	}
+	delete [] out_;
+	if (instance_ == this)
+		instance_ = 0;
+}
+
+void BulkTopology::check(int n)
+{
+	if (n < size_)
+		return;
+	int size = (size_ > 0) ? size_ : 64;
+	while (size <= n)
+		size <<= 1;
+	BulkLink** out = new BulkLink*[size];
+	memset(out, 0, size * sizeof(BulkLink*));
+	if (out_ != 0)
+		memcpy(out, out_, size_ * sizeof(BulkLink*));
+	delete [] out_;
+	out_ = out;
+	size_ = size;
+}
+
+void BulkTopology::insert(BulkLink* l)
+{
+	check(l->src_);
+	l->next_ = out_[l->src_];
+	out_[l->src_] = l;
+	nlinks_++;
+}
+
+/* The BulkLink from src to dst, or 0 if there is none. */
+BulkLink* BulkTopology::link(int src, int dst)
+{
+	if (src < 0 || src >= size_)
+		return (0);
+	for (BulkLink* l = out_[src]; l != 0; l = l->next_)
+		if (l->dst_ == dst)
+			return (l);
+	return (0);
+}
+
+/*
+ * What a classifier at src should point to for next hop dst: the
+ * BulkLink, unless a SimpleLink has taken its place.
+ */
+NsObject* BulkTopology::head(int src, int dst)
+{
+	BulkLink* l = link(src, dst);
+	return ((l != 0 && l->shadow_ == 0) ? l : 0);
+}
+
+/*
+ * Read "src dst bandwidth delay [qtype [limit]]" lines, one duplex
+ * link each.  Blank lines and lines starting with '#' are skipped.
+ * Returns the highest node id seen, or -2 on a malformed line, in
+ * which case nothing from the file is kept.
+ */
+int BulkTopology::load(const char* file)
+{
+	Tcl& tcl = Tcl::instance();
+	FILE* fp = fopen(file, "r");
+	if (fp == 0) {
+		tcl.resultf("%s: cannot open %s", name(), file);
+		return (-2);
+	}
+	char line[256], bw[64], delay[64], qtype[64];
+	int lineno = 0, maxid = -1;
+	Edge* head = 0;
+	Edge* tail = 0;
+	while (fgets(line, sizeof(line), fp) != 0) {
+		lineno++;
+		if (strchr(line, '\n') == 0 && !feof(fp)) {
+			tcl.resultf("%s: %s:%d: line longer than %d characters",
+				    name(), file, lineno, (int)sizeof(line) - 2);
+			goto bad;
+		}
+		char* cp = line;
+		while (isspace(*cp))
+			cp++;
+		if (*cp == 0 || *cp == '#')
+			continue;
+		Edge* e = new Edge;
+		e->limit_ = -1;
+		e->next_ = 0;
+		strcpy(qtype, "DropTail");
+		int n = sscanf(cp, "%d %d %63s %63s %63s %d", &e->src_,
+			       &e->dst_, bw, delay, qtype, &e->limit_);
+		if (n < 4 || e->src_ < 0 || e->dst_ < 0 ||
+		    strlen(bw) >= BULK_MAXFIELD ||
+		    strlen(delay) >= BULK_MAXFIELD ||
+		    strlen(qtype) >= sizeof(e->qtype_)) {
+			delete e;
+			tcl.resultf("%s: %s:%d: bad edge", name(), file, lineno);
+			goto bad;
+		}
+		e->bw_ = bw_atof(bw);
+		e->delay_ = time_atof(delay);
+		strcpy(e->qtype_, qtype);
+		if (tail != 0)
+			tail->next_ = e;
+		else
+			head = e;
+		tail = e;
+		if (e->src_ > maxid)
+			maxid = e->src_;
+		if (e->dst_ > maxid)
+			maxid = e->dst_;
+	}
+	fclose(fp);
+	if (head != 0) {
+		if (etail_ != 0)
+			etail_->next_ = head;
+		else
+			edges_ = head;
+		etail_ = tail;
+	}
+	return (maxid);
+ bad:
+	fclose(fp);
+	while (head != 0) {
+		Edge* e = head;
+		head = e->next_;
+		delete e;
+	}
+	return (-2);
+}
+
+/*
+ * Build the edges read so far.  DropTail links with the stock
+ * DropTail options become BulkLinks; anything else, and every link
+ * once trace-all or namtrace-all is on, goes through "$ns
+ * duplex-link" as a script would have done.
+ */
+int BulkTopology::build(const char* ns)
+{
+	Tcl& tcl = Tcl::instance();
+	/* the default limit_ is Queue's unless a script has set DropTail's */
+	tcl.evalc("if [catch {Queue/DropTail set limit_} l] "
+		  "{Queue set limit_} {set l}");
+	int deflimit = atoi(tcl.result());
+	tcl.evalf("expr {[Queue/DropTail set drop_front_] || "
+		  "[Queue/DropTail set queue_in_bytes_] || "
+		  "[Queue/DropTail set summarystats_] || "
+		  "[Simulator set nix-routing] || [Simulator hier-addr?] || "
+		  "[%s multicast?] || "
+		  "[%s get-ns-traceall] != \"\" || "
+		  "[%s get-nam-traceall] != \"\"}", ns, ns, ns);
+	int plain = (atoi(tcl.result()) == 0);
+
+	/* node entries, looked up once per node */
+	int nentry = 0;
+	NsObject** entry = 0;
+
+	while (edges_ != 0) {
+		Edge* e = edges_;
+		edges_ = e->next_;
+		if (link(e->src_, e->dst_) != 0 ||
+		    link(e->dst_, e->src_) != 0) {
+			tcl.resultf("%s: edge %d %d given twice", name(),
+				    e->src_, e->dst_);
+			delete [] entry;
+			delete e;
+			return (TCL_ERROR);
+		}
+		if (!plain || strcmp(e->qtype_, "DropTail") != 0) {
+			tcl.evalf("%s duplex-link [%s get-node-by-id %d] "
+				  "[%s get-node-by-id %d] %.17g %.17g %s",
+				  ns, ns, e->src_, ns, e->dst_, e->bw_,
+				  e->delay_, e->qtype_);
+			if (e->limit_ >= 0)
+				tcl.evalf("%s queue-limit [%s get-node-by-id %d] "
+					  "[%s get-node-by-id %d] %d; "
+					  "%s queue-limit [%s get-node-by-id %d] "
+					  "[%s get-node-by-id %d] %d",
+					  ns, ns, e->src_, ns, e->dst_, e->limit_,
+					  ns, ns, e->dst_, ns, e->src_, e->limit_);
+			nfull_++;
+			delete e;
+			continue;
+		}
+		int m = (e->src_ > e->dst_) ? e->src_ : e->dst_;
+		if (m >= nentry) {
+			int n = (nentry > 0) ? nentry : 64;
+			while (n <= m)
+				n <<= 1;
+			NsObject** ne = new NsObject*[n];
+			memset(ne, 0, n * sizeof(NsObject*));
+			if (entry != 0)
+				memcpy(ne, entry, nentry * sizeof(NsObject*));
+			delete [] entry;
+			entry = ne;
+			nentry = n;
+		}
+		int limit = (e->limit_ >= 0) ? e->limit_ : deflimit;
+		for (int dir = 0; dir < 2; dir++) {
+			int src = dir ? e->dst_ : e->src_;
+			int dst = dir ? e->src_ : e->dst_;
+			if (entry[dst] == 0) {
+				tcl.evalf("[%s get-node-by-id %d] entry", ns, dst);
+				entry[dst] = (NsObject*)TclObject::lookup(tcl.result());
+				if (entry[dst] == 0) {
+					delete [] entry;
+					delete e;
+					tcl.resultf("%s: node %d has no entry",
+						    name(), dst);
+					return (TCL_ERROR);
+				}
+			}
+			BulkLink* l = new BulkLink(src, dst, e->bw_, e->delay_,
+						   limit);
+			l->tail_.target(entry[dst]);
+			insert(l);
+		}
+		delete e;
+	}
+	etail_ = 0;
+	delete [] entry;
+	return (TCL_OK);
+}
+
+/*
+ * Enter the links that are still BulkLinks into the route logic, at
+ * the default link cost.  Like its "insert" command, RouteLogic
+ * numbers nodes from 1.
+ */
+void BulkTopology::routes(RouteLogic* r)
+{
+	for (int i = 0; i < size_; i++)
+		for (BulkLink* l = out_[i]; l != 0; l = l->next_)
+			if (l->shadow_ == 0)
+				r->insert(l->src_ + 1, l->dst_ + 1, 1.);
+}
+
+int BulkTopology::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		/*
+		 * $bt stats: BulkLinks, how many of them have been turned
+		 * into SimpleLinks, links built as SimpleLinks directly,
+		 * and packets received, sent and dropped by BulkLinks.
+		 */
+		if (strcmp(argv[1], "stats") == 0) {
+			int arr = 0, dep = 0, drops = 0;
+			for (int i = 0; i < size_; i++)
+				for (BulkLink* l = out_[i]; l != 0; l = l->next_) {
+					arr += l->arrivals_;
+					dep += l->departures_;
+					drops += l->drops_;
+				}
+			tcl.resultf("%d %d %d %d %d %d", nlinks_, nshadows_,
+				    nfull_, arr, dep, drops);
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "load") == 0) {
+			int maxid = load(argv[2]);
+			if (maxid < -1)
+				return (TCL_ERROR);
+			tcl.resultf("%d", maxid);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "build") == 0)
+			return (build(argv[2]));
+		if (strcmp(argv[1], "routes") == 0) {
+			RouteLogic* r = (RouteLogic*)TclObject::lookup(argv[2]);
+			if (r == 0) {
+				tcl.resultf("%s: no such route logic %s",
+					    name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			routes(r);
+			return (TCL_OK);
+		}
+	} else if (argc == 4) {
+		/*
+		 * $bt spec src dst: "bandwidth delay limit" of the
+		 * BulkLink from src to dst, or "" if there is no such
+		 * link or it has already been turned into a SimpleLink.
+		 */
+		if (strcmp(argv[1], "spec") == 0) {
+			BulkLink* l = link(atoi(argv[2]), atoi(argv[3]));
+			if (l != 0 && l->shadow_ == 0)
+				tcl.resultf("%.17g %.17g %d", l->bandwidth_,
+					    l->delay_, l->qlim_);
+			return (TCL_OK);
+		}
+	} else if (argc == 5) {
+		/*
+		 * $bt shadow src dst head: from now on the BulkLink from
+		 * src to dst passes its packets to head.  Packets it
+		 * still holds drain as before.
+		 */
+		if (strcmp(argv[1], "shadow") == 0) {
+			BulkLink* l = link(atoi(argv[2]), atoi(argv[3]));
+			NsObject* h = (NsObject*)TclObject::lookup(argv[4]);
+			if (l == 0 || h == 0) {
+				tcl.resultf("%s: no link %s:%s or no object %s",
+					    name(), argv[2], argv[3], argv[4]);
+				return (TCL_ERROR);
+			}
+			if (l->shadow_ == 0)
+				nshadows_++;
+			l->shadow_ = h;
+			return (TCL_OK);
+		}
+	}
+	return (TclObject::command(argc, argv));
+}
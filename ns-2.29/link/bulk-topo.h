@@ -0,0 +1,112 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Bulk construction of large wired topologies.
+ *
+ * "$ns load-topology file" reads an edge list and builds every duplex
+ * DropTail link of it as a pair of BulkLinks: one C++ object per
+ * direction that does the work of the queue, delay element and TTL
+ * checker of a SimpleLink, with no OTcl object behind it.  Routes to
+ * and through these links are installed by the flat route computation
+ * as for any other link.
+ *
+ * A script that names one of these links ($ns link, $ns queue-limit,
+ * $ns trace-queue, ...) gets a real SimpleLink: the first reference
+ * to link_(src:dst) builds one with the same parameters and the
+ * BulkLink from then on hands its packets to that link's head.
+ */
+
+#ifndef ns_bulk_topo_h
+#define ns_bulk_topo_h
+
+#include "connector.h"
+#include "queue.h"
+
+class BulkLink;
+
+class BulkLinkHandler : public Handler {
+public:
+	BulkLinkHandler(BulkLink& l) : link_(l) {}
+	void handle(Event*);
+private:
+	BulkLink& link_;
+};
+
+/*
+ * The last stage of a link: decrement the TTL and hand the packet to
+ * the next node.  Scheduled for the arrival of each packet, as the
+ * TTLChecker behind a DelayLink is.
+ */
+class BulkLinkTail : public Connector {
+public:
+	void recv(Packet*, Handler*);
+};
+
+class BulkLink : public Connector {
+	friend class BulkTopology;
+public:
+	BulkLink(int src, int dst, double bw, double delay, int limit);
+	void recv(Packet*, Handler*);
+	void resume();
+	int src() const { return (src_); }
+	int dst() const { return (dst_); }
+protected:
+	void transmit(Packet*);
+
+	int src_;
+	int dst_;
+	double bandwidth_;		/* bps */
+	double delay_;			/* s */
+	int qlim_;
+	PacketQueue q_;
+	int blocked_;
+	Event intr_;
+	BulkLinkHandler bh_;
+	BulkLinkTail tail_;
+	NsObject* shadow_;		/* head of the SimpleLink, once built */
+	BulkLink* next_;		/* next link out of src_ */
+
+	/* counters */
+	int arrivals_;
+	int departures_;
+	int drops_;
+};
+
+class RouteLogic;
+
+class BulkTopology : public TclObject {
+public:
+	MEM_ACCOUNT(MEM_OBJECT)
+	BulkTopology();
+	~BulkTopology();
+	int command(int argc, const char*const* argv);
+	static BulkTopology* instance() { return (instance_); }
+	BulkLink* link(int src, int dst);
+	NsObject* head(int src, int dst);
+protected:
+	int load(const char* file);
+	int build(const char* ns);
+	void routes(RouteLogic* r);
+	void check(int n);
+	void insert(BulkLink* l);
+
+	static BulkTopology* instance_;
+
+	/* edges read but not built yet */
+	struct Edge {
+		int src_, dst_;
+		double bw_, delay_;
+		int limit_;			/* -1 if not given */
+		char qtype_[32];
+		Edge* next_;
+	};
+	Edge* edges_;
+	Edge* etail_;
+
+	BulkLink** out_;		/* out_[i]: links out of node i */
+	int size_;
+	int nlinks_;			/* BulkLinks */
+	int nshadows_;			/* of those, turned into SimpleLinks */
+	int nfull_;			/* edges built as SimpleLinks directly */
+};
+
+#endif
@@ -54,11 +54,14 @@ LinkDelay::LinkDelay()
 	  latest_time_(0),
 	  itq_(0)
 {
-	bind_bw("bandwidth_", &bandwidth_);
-	bind_time("delay_", &delay_);
-	bind_bool("avoidReordering_", &avoidReordering_);
 }
 
+DELAY_BIND_BEGIN(LinkDelay, Connector)
+	DELAY_BIND_BW("bandwidth_", bandwidth_),
+	DELAY_BIND_TIME("delay_", delay_),
+	DELAY_BIND_BOOL("avoidReordering_", avoidReordering_),
+DELAY_BIND_END
+
 int LinkDelay::command(int argc, const char*const* argv)
 {
 	if (argc == 2) {
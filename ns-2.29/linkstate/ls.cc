@@ -64,10 +64,13 @@
 #include "config.h"
 #ifdef HAVE_STL
 
+#include <sys/time.h>
+#include <algorithm>
 #include "ls.h"
 
 // a global variable
 LsMessageCenter LsMessageCenter::msgctr_;
+LsLsaStore LsLsaStore::store_;
 
 int LsRouting::msgSizes[LS_MESSAGE_TYPES];
 
@@ -110,41 +113,134 @@ int LsNodeIdList::appendUnique (const LsNodeIdList & x)
 }
 
 /*
-  LsTopoMap methods
+  LsLsaStore methods
 */
-LsLinkStateList * 
-LsTopoMap::insertLinkState (int nodeId, const LsLinkState& linkState)
+LsLsa* LsLsaStore::intern(int origin, const LsLinkStateList& lsl)
 {
-	LsLinkStateList* lsp = LsLinkStateListMap::findPtr(nodeId);
-	if (lsp != NULL) {
-		// there's a node with other linkState, not checking if there's
-		// duplicate
-		lsp->push_back(linkState);
-		return lsp;
+	if (origin >= (int)byOrigin_.size())
+		byOrigin_.resize(origin + 1);
+	LsLsaVector& live = byOrigin_[origin];
+	for (LsLsaVector::iterator itr = live.begin(); itr != live.end(); itr++)
+		if ((*itr)->links_ == lsl) {
+			hold(*itr);
+			return *itr;
+		}
+
+	LsLsa* lsa = new LsLsa(origin, ++version_, lsl);
+	live.push_back(lsa);
+	nrecords_++;
+	for (LsLinkStateList::const_iterator itr = lsl.begin();
+	     itr != lsl.end(); itr++) {
+		nlinks_++;
+		int nbr = (*itr).neighborId_;
+		if ((nbr < 0) || (nbr == LS_INVALID_NODE_ID))
+			continue;
+		if (nbr >= (int)in_.size())
+			in_.resize(nbr + 1);
+		// only lsa is added in this loop: no duplicates
+		if (in_[nbr].empty() || (in_[nbr].back() != lsa))
+			in_[nbr].push_back(lsa);
 	}
-	// else new node
-	LsLinkStateList lsl; // an empty one
-	iterator itr = insert(nodeId, lsl);
-	if (itr !=end()){
-		// successful
-		(*itr).second.push_back(linkState);
-		return &((*itr).second);
+	hold(lsa);
+	return lsa;
+}
+
+static void lsaErase(LsLsaVector& v, LsLsa* lsa)
+{
+	LsLsaVector::iterator itr = find(v.begin(), v.end(), lsa);
+	if (itr != v.end())
+		v.erase(itr);
+}
+
+void LsLsaStore::free(LsLsa* lsa)
+{
+	lsaErase(byOrigin_[lsa->origin_], lsa);
+	for (LsLinkStateList::iterator itr = lsa->links_.begin();
+	     itr != lsa->links_.end(); itr++) {
+		nlinks_--;
+		int nbr = (*itr).neighborId_;
+		if ((nbr >= 0) && (nbr < (int)in_.size()))
+			lsaErase(in_[nbr], lsa);
 	}
-	// else something is wrong
-	ls_error("LsTopoMap::insertLinkState failed\n"); // debug
-	return (LsLinkStateList *) NULL;
+	nrecords_--;
+	delete lsa;
+}
+
+/*
+  LsTopoMap methods
+*/
+LsTopoMap::~LsTopoMap()
+{
+	clearChanges();
+	for (LsLsaVector::iterator itr = lsa_.begin(); itr != lsa_.end(); itr++)
+		if (*itr != NULL)
+			LsLsaStore::instance().release(*itr);
+}
+
+// lsa is held on our behalf already
+void LsTopoMap::set(int nodeId, LsLsa* lsa)
+{
+	if (nodeId >= (int)lsa_.size())
+		lsa_.resize(nodeId + 1, (LsLsa *)NULL);
+	LsLsa* old = lsa_[nodeId];
+	if (old == lsa) {
+		// same content
+		LsLsaStore::instance().release(lsa);
+		return;
+	}
+	// remember the record before the first change, with its reference
+	if (changes_.findPtr(nodeId) == NULL)
+		changes_.insert(nodeId, old);
+	else if (old != NULL)
+		LsLsaStore::instance().release(old);
+	lsa_[nodeId] = lsa;
+	version_++;
+}
+
+void LsTopoMap::insert(int nodeId, const LsLinkStateList& lsl)
+{
+	set(nodeId, LsLsaStore::instance().intern(nodeId, lsl));
+}
+
+void LsTopoMap::share(int nodeId, LsLsa* lsa)
+{
+	LsLsaStore::instance().hold(lsa);
+	set(nodeId, lsa);
+}
+
+void LsTopoMap::clearChanges()
+{
+	for (ChangeMap::iterator itr = changes_.begin(); 
+	     itr != changes_.end(); itr++)
+		if ((*itr).second != NULL)
+			LsLsaStore::instance().release((*itr).second);
+	changes_.eraseAll();
+}
+
+void LsTopoMap::insertLinkState (int nodeId, const LsLinkState& linkState)
+{
+	// not checking if there's duplicate
+	const LsLinkStateList* lsp = findPtr(nodeId);
+	LsLinkStateList lsl;
+	if (lsp != NULL)
+		lsl = *lsp;
+	lsl.push_back(linkState);
+	insert(nodeId, lsl);
 }
 
 // -- update --, return true if anything's changed 
 bool LsTopoMap::update(int nodeId, 
 		       const LsLinkStateList& linkStateList)
 {
-	LsLinkStateList * LSLptr = findPtr (nodeId);
-	if (LSLptr == NULL) {
+	const LsLinkStateList * oldPtr = findPtr (nodeId);
+	if (oldPtr == NULL) {
 		insert(nodeId, linkStateList);
 		return true;
 	}
 
+	// records are shared, work on a copy
+	LsLinkStateList lsl(*oldPtr);
+	LsLinkStateList * LSLptr = &lsl;
 	bool retCode = false;
 	LsLinkStateList::iterator itrOld;
 	for (LsLinkStateList::const_iterator itrNew = linkStateList.begin();
@@ -177,6 +273,9 @@ bool LsTopoMap::update(int nodeId,
 			retCode = true;
 		}
 	}// end for new link states 
+	// sequence numbers may have changed even if nothing else has
+	if (!(lsl == *oldPtr))
+		insert(nodeId, lsl);
 	return retCode;
 }
 
@@ -530,7 +629,8 @@ void LsRouting::linkStateChanged ()
 	if (linkStateListPtr_ == NULL)
 		ls_error("LsRouting::linkStateChanged: linkStateListPtr null\n");
    
-	LsLinkStateList* oldLsPtr = linkStateDatabase_.findPtr(myNodeId_);
+	const LsLinkStateList* oldLsPtr = 
+		linkStateDatabase_.findPtr(myNodeId_);
 	if (oldLsPtr == NULL) 
 		// Should never happen,something's wrong, we didn't 
 		// initialize properly
@@ -676,7 +776,8 @@ bool LsRouting::sendLinkStates(bool buffer /* = false */)
 	if ((peerIdListPtr_ == NULL) || peerIdListPtr_->empty())
 		return false;
 
-	LsLinkStateList* myLSLptr = linkStateDatabase_.findPtr(myNodeId_);
+	const LsLinkStateList* myLSLptr = 
+		linkStateDatabase_.findPtr(myNodeId_);
 	if ((myLSLptr == NULL) || myLSLptr->empty())
 		return false;
 
@@ -686,11 +787,6 @@ bool LsRouting::sendLinkStates(bool buffer /* = false */)
 
 	u_int32_t msgId = msgPtr->messageId_;
 	u_int32_t seq = msgPtr->sequenceNumber_;
-	// update the sequence number in my own data base
-	for (LsLinkStateList::iterator itr = myLSLptr->begin();
-	     itr != myLSLptr->end(); itr++)
-		(*itr).sequenceNumber_ = seq;
-  
 	LsLinkStateList* newLSLptr = new LsLinkStateList( *myLSLptr);
 	if (newLSLptr == NULL) {
 		ls_error ("Can't get new link state list, in LsRouting::sendLinkStates\n");
@@ -698,6 +794,11 @@ bool LsRouting::sendLinkStates(bool buffer /* = false */)
 		msgctr().deleteMessage(msgId);
 		return false;
 	}
+	// update the sequence number in my own data base
+	for (LsLinkStateList::iterator itr = newLSLptr->begin();
+	     itr != newLSLptr->end(); itr++)
+		(*itr).sequenceNumber_ = seq;
+	linkStateDatabase_.insert(myNodeId_, *newLSLptr);
 
 	msgPtr->lslPtr_ = newLSLptr;
 	for (LsNodeIdList::iterator itr = peerIdListPtr_->begin();
@@ -751,38 +852,36 @@ bool LsRouting::receiveTopo(int neighborId, LsMessage * msgPtr)
 	if (msgPtr->topoPtr_ == NULL)
 		return false;
 	// Compare with my own database
-	for (LsTopoMap::const_iterator recItr = msgPtr->topoPtr_->begin();
-	     recItr != msgPtr->topoPtr_->end(); recItr++) {
-
-		if ((*recItr).first == myNodeId_)
+	const LsTopoMap* topoPtr = msgPtr->topoPtr_;
+	for (int origin = 0; origin < topoPtr->size(); origin++) {
+		LsLsa* rec = topoPtr->lsa(origin);
+		if (rec == NULL)
+			continue;
+		if (origin == myNodeId_)
 			// Don't need peer to tell me my own link state 
 			continue; 
 		// find my own record of the LSA of the node being examined
-		LsLinkStateList* myRecord = 
-			linkStateDatabase_.findPtr((*recItr).first);
+		const LsLinkStateList* myRecord = 
+			linkStateDatabase_.findPtr(origin);
 
 		if ((myRecord == NULL) || // we don't have it
 		    myRecord->empty() ||
 		    // or we have an older record
 		    ((*(myRecord->begin())).sequenceNumber_ <
-		     (*((*recItr).second.begin())).sequenceNumber_) ||
+		     (*(rec->links_.begin())).sequenceNumber_) ||
 		    ((*(myRecord->begin())).sequenceNumber_ - 
-		     (*((*recItr).second.begin())).sequenceNumber_ > 
+		     (*(rec->links_.begin())).sequenceNumber_ > 
 		     LS_WRAPAROUND_THRESHOLD)) {
 
-			// Update our database
+			// Update our database, sharing the peer's record
 			changed = true;
-			if (myRecord == NULL)
-				linkStateDatabase_.insert((*recItr).first, 
-							 (*recItr).second);
-			else 
-				*myRecord = (*recItr).second ;
+			linkStateDatabase_.share(origin, rec);
 			// Regenerate the LSA message and send to my peers, 
 			// except the sender of the topo and the 
 			// originator of the LSA
 			regenAndSend (/* to except */neighborId, 
-				      /* originator */(*recItr).first, 
-				      /* the linkstateList */(*recItr).second);
+				      /* originator */origin, 
+				      /* the linkstateList */rec->links_);
 		}
 	}
 	if (changed)
@@ -846,6 +945,391 @@ void LsRouting::sendBufferedMessages()
 	messageBuffer_.eraseAll();
 }
 
+void LsRouting::computeRoutes()
+{
+	struct timeval start, end;
+	gettimeofday(&start, 0);
+	int examined = -1;
+	bool incremental = false;
+	if (!incremental_) {
+	        if (routingTablePtr_ != NULL)
+	                delete routingTablePtr_;
+	        routingTablePtr_ = _computeRoutes();
+		examined = routingTablePtr_->size();
+	} else {
+		if (routingTablePtr_ == NULL)
+			routingTablePtr_ = new LsPaths();
+		if (spf_.valid())
+			examined = spf_.update(linkStateDatabase_, myNodeId_,
+					       *routingTablePtr_);
+		if (examined >= 0)
+			incremental = true;
+		else
+			examined = spf_.full(linkStateDatabase_, myNodeId_, 
+					     *routingTablePtr_);
+	}
+	linkStateDatabase_.clearChanges();
+	gettimeofday(&end, 0);
+	spfStats_.record(incremental, examined, 
+			 (end.tv_sec - start.tv_sec) + 
+			 1e-6 * (end.tv_usec - start.tv_usec));
+}
+
+/*
+  LsSpf methods
+*/
+enum {
+	LS_SPF_DOWN = 0x1,	// shortest path went through a worse link
+	LS_SPF_MOVED = 0x2,	// cost changed, old one in oldDist_
+	LS_SPF_DONE = 0x4,	// cost final
+	LS_SPF_QUEUED = 0x8	// queued for next hop computation
+};
+// paths costing more than this are not installed, as in _computeRoutes()
+static const int LS_SPF_INFINITY = LS_MAX_COST + 1;
+
+void LsSpf::grow(int n)
+{
+	if (n <= (int)dist_.size())
+		return;
+	dist_.resize(n, LS_SPF_INFINITY);
+	oldDist_.resize(n, LS_SPF_INFINITY);
+	nh_.resize(n);
+	flags_.resize(n, 0);
+}
+
+// lower the cost of node to d
+void LsSpf::lower(int node, int d, Heap& heap)
+{
+	if (!(flags_[node] & LS_SPF_MOVED)) {
+		oldDist_[node] = dist_[node];
+		mark(node, LS_SPF_MOVED);
+	}
+	dist_[node] = d;
+	heap.push(HeapEntry(d, node));
+}
+
+void LsSpf::relax(const LsTopoMap& db, int node, Heap& heap)
+{
+	LsLsa* lsa = db.lsa(node);
+	if (lsa == NULL)
+		return;
+	for (LsLinkStateList::const_iterator itr = lsa->links_.begin();
+	     itr != lsa->links_.end(); itr++) {
+		if ((*itr).status_ != LS_STATUS_UP)
+			continue;
+		int nbr = (*itr).neighborId_;
+		int d = dist_[node] + (*itr).cost_;
+		grow(nbr + 1);
+		if (d < dist_[nbr])
+			lower(nbr, d, heap);
+	}
+}
+
+// the first hops of all shortest paths to node
+void LsSpf::nextHops(const LsTopoMap& db, int node, NextHops& nh)
+{
+	nh.clear();
+	if (node == self_) {
+		nh.push_back(self_);
+		return;
+	}
+	const LsLsaVector* in = LsLsaStore::instance().linksTo(node);
+	if ((in == NULL) || (dist_[node] >= LS_SPF_INFINITY))
+		return;
+	for (LsLsaVector::const_iterator ritr = in->begin(); 
+	     ritr != in->end(); ritr++) {
+		LsLsa* lsa = *ritr;
+		int from = lsa->origin_;
+		if ((db.lsa(from) != lsa) || (from >= (int)dist_.size()) ||
+		    (dist_[from] >= LS_SPF_INFINITY))
+			continue;
+		for (LsLinkStateList::const_iterator itr = lsa->links_.begin();
+		     itr != lsa->links_.end(); itr++) {
+			if (((*itr).neighborId_ != node) || 
+			    ((*itr).status_ != LS_STATUS_UP) ||
+			    (dist_[from] + (*itr).cost_ != dist_[node]))
+				continue;
+			if (from == self_)
+				nh.push_back(node);
+			else
+				nh.insert(nh.end(), nh_[from].begin(), 
+					  nh_[from].end());
+		}
+	}
+	sort(nh.begin(), nh.end());
+	nh.erase(unique(nh.begin(), nh.end()), nh.end());
+}
+
+void LsSpf::install(LsPaths& paths, int node)
+{
+	if (dist_[node] >= LS_SPF_INFINITY) {
+		paths.erase(node);
+		return;
+	}
+	LsNodeIdList nhl;
+	for (NextHops::iterator itr = nh_[node].begin(); 
+	     itr != nh_[node].end(); itr++)
+		nhl.push_back(*itr);
+	LsEqualPaths* ep = paths.findPtr(node);
+	if (ep == NULL)
+		paths.insert(node, LsEqualPaths(dist_[node], nhl));
+	else {
+		ep->cost = dist_[node];
+		ep->nextHopList = nhl;
+	}
+}
+
+/*
+ * Recompute the next hops of the queued nodes, nearest first, queueing
+ * the nodes downstream of any whose next hops or cost have changed.
+ */
+void LsSpf::propagate(const LsTopoMap& db, Heap& heap, LsPaths& paths)
+{
+	NextHops nh;
+	while (!heap.empty()) {
+		int node = heap.top().second;
+		heap.pop();
+		flags_[node] &= ~LS_SPF_QUEUED;
+		nextHops(db, node, nh);
+		bool moved = (flags_[node] & LS_SPF_MOVED) && 
+			(oldDist_[node] != dist_[node]);
+		if (!moved && (nh == nh_[node]))
+			continue;
+		nh_[node].swap(nh);
+		// once is enough
+		oldDist_[node] = dist_[node];
+		install(paths, node);
+		LsLsa* lsa = db.lsa(node);
+		if ((lsa == NULL) || (dist_[node] >= LS_SPF_INFINITY))
+			continue;
+		for (LsLinkStateList::const_iterator itr = lsa->links_.begin();
+		     itr != lsa->links_.end(); itr++) {
+			int nbr = (*itr).neighborId_;
+			if (((*itr).status_ != LS_STATUS_UP) ||
+			    (dist_[node] + (*itr).cost_ != dist_[nbr]) ||
+			    (flags_[nbr] & LS_SPF_QUEUED))
+				continue;
+			mark(nbr, LS_SPF_QUEUED);
+			heap.push(HeapEntry(dist_[nbr], nbr));
+		}
+	}
+}
+
+int LsSpf::full(const LsTopoMap& db, int self, LsPaths& paths)
+{
+	self_ = self;
+	int n = db.size() > self + 1 ? db.size() : self + 1;
+	dist_.assign(n, LS_SPF_INFINITY);
+	oldDist_.assign(n, LS_SPF_INFINITY);
+	nh_.assign(n, NextHops());
+	flags_.assign(n, 0);
+	touched_.clear();
+	paths.eraseAll();
+
+	// Dijkstra
+	int examined = 0;
+	Heap heap, nhheap;
+	lower(self, 0, heap);
+	while (!heap.empty()) {
+		HeapEntry e = heap.top();
+		heap.pop();
+		int node = e.second;
+		if ((e.first != dist_[node]) || (flags_[node] & LS_SPF_DONE))
+			continue;
+		mark(node, LS_SPF_DONE | LS_SPF_QUEUED);
+		oldDist_[node] = LS_SPF_INFINITY;
+		nhheap.push(e);
+		examined++;
+		relax(db, node, heap);
+	}
+	propagate(db, nhheap, paths);
+
+	for (vector<int>::iterator itr = touched_.begin(); 
+	     itr != touched_.end(); itr++)
+		flags_[*itr] = 0;
+	touched_.clear();
+	valid_ = true;
+	return examined;
+}
+
+struct LsSpfLink {
+	int from_, to_, cost_;
+	LsSpfLink(int f, int t, int c) : from_(f), to_(t), cost_(c) {}
+};
+
+/* the neighbors of lsa and the cost of the best link up to each */
+static void lsCosts(LsLsa* lsa, LsMap<int, int>& costs)
+{
+	if (lsa == NULL)
+		return;
+	for (LsLinkStateList::const_iterator itr = lsa->links_.begin();
+	     itr != lsa->links_.end(); itr++) {
+		if ((*itr).status_ != LS_STATUS_UP)
+			continue;
+		int* c = costs.findPtr((*itr).neighborId_);
+		if (c == NULL)
+			costs.insert((*itr).neighborId_, (*itr).cost_);
+		else if ((*itr).cost_ < *c)
+			*c = (*itr).cost_;
+	}
+}
+
+int LsSpf::update(const LsTopoMap& db, int self, LsPaths& paths)
+{
+	const LsTopoMap::ChangeMap& changes = db.changes();
+	if (!valid_ || (self != self_))
+		return -1;
+	// a new topology map is cheaper to compute from scratch
+	if ((int)changes.size() * 4 > db.size())
+		return -1;
+	grow(db.size());
+
+	LsList<int> roots;	// reached over a link that got worse
+	LsList<LsSpfLink> better;	// links that got better
+	LsList<int> ends;	// far ends of changed links
+
+	// 1. what has changed, from the costs known before
+	for (LsTopoMap::ChangeMap::const_iterator citr = changes.begin();
+	     citr != changes.end(); citr++) {
+		int from = (*citr).first;
+		if (db.lsa(from) == (*citr).second)
+			continue;
+		LsMap<int, int> was, is;
+		lsCosts((*citr).second, was);
+		lsCosts(db.lsa(from), is);
+		LsMap<int, int>::iterator itr;
+		for (itr = was.begin(); itr != was.end(); itr++) {
+			int* c = is.findPtr((*itr).first);
+			int cost = (c == NULL) ? LS_SPF_INFINITY : *c;
+			if (cost == (*itr).second)
+				continue;
+			int to = (*itr).first;
+			grow(to + 1);
+			ends.push_back(to);
+			if (cost < (*itr).second)
+				better.push_back(LsSpfLink(from, to, cost));
+			else if ((dist_[from] < LS_SPF_INFINITY) &&
+				 (dist_[from] + (*itr).second == dist_[to]))
+				roots.push_back(to);
+		}
+		for (itr = is.begin(); itr != is.end(); itr++) 
+			if (was.findPtr((*itr).first) == NULL) {
+				grow((*itr).first + 1);
+				ends.push_back((*itr).first);
+				better.push_back(LsSpfLink(from, (*itr).first, 
+						      (*itr).second));
+			}
+	}
+
+	// 2. everything whose shortest paths went over a worse link,
+	// following the links as they were before
+	LsList<int> down;
+	for (LsList<int>::iterator itr = roots.begin(); itr != roots.end();
+	     itr++)
+		if ((*itr != self_) && !(flags_[*itr] & LS_SPF_DOWN)) {
+			mark(*itr, LS_SPF_DOWN);
+			down.push_back(*itr);
+		}
+	for (LsList<int>::iterator itr = down.begin(); itr != down.end();
+	     itr++) {
+		int node = *itr;
+		LsLsa* const* old = changes.findPtr(node);
+		LsLsa* lsa = (old != NULL) ? *old : db.lsa(node);
+		if (lsa == NULL)
+			continue;
+		for (LsLinkStateList::const_iterator litr = 
+			     lsa->links_.begin();
+		     litr != lsa->links_.end(); litr++) {
+			int nbr = (*litr).neighborId_;
+			if (((*litr).status_ != LS_STATUS_UP) ||
+			    (nbr == self_) || (nbr >= (int)dist_.size()) ||
+			    (flags_[nbr] & LS_SPF_DOWN) ||
+			    (dist_[node] + (*litr).cost_ != dist_[nbr]))
+				continue;
+			mark(nbr, LS_SPF_DOWN);
+			down.push_back(nbr);
+		}
+	}
+
+	// 3. forget their costs, and start them off from their best
+	// neighbor outside
+	int examined = down.size();
+	Heap heap;
+	LsList<int>::iterator itr;
+	for (itr = down.begin(); itr != down.end(); itr++) {
+		oldDist_[*itr] = dist_[*itr];
+		mark(*itr, LS_SPF_MOVED);
+		dist_[*itr] = LS_SPF_INFINITY;
+	}
+	for (itr = down.begin(); itr != down.end(); itr++) {
+		int node = *itr;
+		const LsLsaVector* in = LsLsaStore::instance().linksTo(node);
+		if (in == NULL)
+			continue;
+		for (LsLsaVector::const_iterator ritr = in->begin(); 
+		     ritr != in->end(); ritr++) {
+			LsLsa* lsa = *ritr;
+			int from = lsa->origin_;
+			if ((db.lsa(from) != lsa) || 
+			    (from >= (int)dist_.size()) ||
+			    (flags_[from] & LS_SPF_DOWN) ||
+			    (dist_[from] >= LS_SPF_INFINITY))
+				continue;
+			for (LsLinkStateList::const_iterator litr = 
+				     lsa->links_.begin();
+			     litr != lsa->links_.end(); litr++) {
+				int d = dist_[from] + (*litr).cost_;
+				if (((*litr).neighborId_ == node) &&
+				    ((*litr).status_ == LS_STATUS_UP) &&
+				    (d < dist_[node]))
+					lower(node, d, heap);
+			}
+		}
+	}
+	for (LsList<LsSpfLink>::iterator litr = better.begin(); 
+	     litr != better.end(); litr++) {
+		int from = (*litr).from_;
+		if ((flags_[from] & LS_SPF_DOWN) || 
+		    (dist_[from] >= LS_SPF_INFINITY))
+			continue;
+		int d = dist_[from] + (*litr).cost_;
+		if (d < dist_[(*litr).to_])
+			lower((*litr).to_, d, heap);
+	}
+
+	// 4. Dijkstra from there
+	while (!heap.empty()) {
+		HeapEntry e = heap.top();
+		heap.pop();
+		int node = e.second;
+		if ((e.first != dist_[node]) || (flags_[node] & LS_SPF_DONE))
+			continue;
+		mark(node, LS_SPF_DONE);
+		examined++;
+		relax(db, node, heap);
+	}
+
+	// 5. next hops of whatever may have changed
+	for (vector<int>::iterator vitr = touched_.begin(); 
+	     vitr != touched_.end(); vitr++)
+		if (flags_[*vitr] & LS_SPF_MOVED) {
+			flags_[*vitr] |= LS_SPF_QUEUED;
+			heap.push(HeapEntry(dist_[*vitr], *vitr));
+		}
+	for (itr = ends.begin(); itr != ends.end(); itr++)
+		if (!(flags_[*itr] & LS_SPF_QUEUED)) {
+			mark(*itr, LS_SPF_QUEUED);
+			heap.push(HeapEntry(dist_[*itr], *itr));
+		}
+	propagate(db, heap, paths);
+
+	for (vector<int>::iterator vitr = touched_.begin(); 
+	     vitr != touched_.end(); vitr++)
+		flags_[*vitr] = 0;
+	touched_.clear();
+	return examined;
+}
+
 // private _computeRoutes, called by public computeRoutes
 LsPaths* LsRouting::_computeRoutes () 
 {
@@ -856,7 +1340,7 @@ LsPaths* LsRouting::_computeRoutes ()
 	LsPath toSelf(myNodeId_, 0, myNodeId_); // zero cost, nextHop is myself
 	pPaths->insertPathNoChecking(toSelf);
 	int newNodeId = myNodeId_;
-	LsLinkStateList * ptrLSL = linkStateDatabase_.findPtr(newNodeId);
+	const LsLinkStateList * ptrLSL = linkStateDatabase_.findPtr(newNodeId);
 	if (ptrLSL == NULL )
 		// don't have my own linkState
 		return pPaths;
@@ -877,7 +1361,7 @@ LsPaths* LsRouting::_computeRoutes ()
 				ls_error("computeRoutes: nhlp == NULL \n");
 		}
 		// for each of it's links
-		for (LsLinkStateList::iterator itrLink = ptrLSL->begin();
+		for (LsLinkStateList::const_iterator itrLink = ptrLSL->begin();
 		     itrLink != ptrLSL->end(); itrLink++) {
 			if ((*itrLink).status_ != LS_STATUS_UP)
 				// link is not up, skip this link
@@ -67,6 +67,9 @@
 #include <sys/types.h> 
 #include <list>
 #include <map>
+#include <vector>
+#include <queue>
+#include <functional>
 #include <utility>
 
 #include "timer-handler.h"
@@ -127,6 +130,7 @@ public:
 
 	// this next typedef of iterator seems extraneous but is required by gcc-2.96
 	typedef typename map<Key, T, less<Key> >::iterator iterator;
+	typedef typename map<Key, T, less<Key> >::const_iterator const_iterator;
 	typedef pair<iterator, bool> pair_iterator_bool;
 	iterator insert(const Key & key, const T & item) {
 		typename baseMap::value_type v(key, item);
@@ -139,6 +143,10 @@ public:
 		iterator it = baseMap::find(key);
 		return (it == baseMap::end()) ? (T *)NULL : &((*it).second);
 	}
+	const T* findPtr(Key key) const {
+		const_iterator it = baseMap::find(key);
+		return (it == baseMap::end()) ? (const T *)NULL : &((*it).second);
+	}
 };
 
 /*
@@ -171,6 +179,11 @@ struct LsLinkState {
 		status_ = s;
 		cost_ =c;
 	}
+	bool operator== (const LsLinkState& x) const {
+		return ((neighborId_ == x.neighborId_) && 
+			(status_ == x.status_) && (cost_ == x.cost_) &&
+			(sequenceNumber_ == x.sequenceNumber_));
+	}
 } ;
 
 /* 
@@ -179,36 +192,107 @@ struct LsLinkState {
 typedef LsList<LsLinkState> LsLinkStateList;
 
 /* -------------------------------------------------------------------*/
+/*
+  LsLsa -- one node's link state list as held in the link state database.
+  Records are immutable and shared: every node whose database holds the
+  same link states for an origin points to the same record.
+*/
+struct LsLsa {
+	int origin_;
+	u_int32_t version_;	// order of creation, for debugging
+	int refs_;
+	LsLinkStateList links_;
+
+	LsLsa(int origin, u_int32_t v, const LsLinkStateList& lsl) :
+		origin_(origin), version_(v), refs_(0), links_(lsl) {}
+};
+typedef vector<LsLsa*> LsLsaVector;
+
+/*
+  LsLsaStore -- Global storage of LsLsa records.  intern() returns the
+  live record of an origin with the given content, making one only if
+  no node holds that content yet, so the databases of all nodes take
+  the space of one topology plus the LSAs still being flooded.  It also
+  indexes records by the neighbors they have links to, for the SPF.
+*/
+class LsLsaStore {
+public:
+	LsLsaStore() : version_(0), nrecords_(0), nlinks_(0) {}
+	LsLsa* intern(int origin, const LsLinkStateList& lsl);
+	void hold(LsLsa* lsa) { lsa->refs_++; }
+	void release(LsLsa* lsa) {
+		if (--lsa->refs_ <= 0)
+			free(lsa);
+	}
+	// records with a link to node, in any node's database
+	const LsLsaVector* linksTo(int node) const {
+		return (node < (int)in_.size()) ? &in_[node] : 
+			(const LsLsaVector *)NULL;
+	}
+	int nrecords() const { return nrecords_; }
+	int nlinks() const { return nlinks_; }
+	static LsLsaStore& instance() { return store_; }
+private:
+	static LsLsaStore store_;	// Singleton class
+
+	void free(LsLsa* lsa);
+	u_int32_t version_;
+	int nrecords_;
+	int nlinks_;
+	vector<LsLsaVector> byOrigin_;	// live records of each origin
+	vector<LsLsaVector> in_;	// records with a link to each node
+};
+
 /*
   LsTopoMap
   the Link State Database, the representation of the
-  topology within the protocol 
+  topology within the protocol.  It holds one shared LsLsa per origin,
+  indexed by node id; changing an origin's link states replaces its
+  record (copy on write).  The origins changed since the last
+  clearChanges() are remembered along with their earlier records so
+  that routes can be recomputed incrementally.
 */
-typedef LsMap<int, LsLinkStateList> LsLinkStateListMap;
-
-class LsTopoMap : public LsLinkStateListMap {
+class LsTopoMap {
 public:
-	// constructor / destructor 
-	// the default ones 
-	LsTopoMap() : LsLinkStateListMap() {}
-  
-	//   // map oeration
-	//   iterator begin() { return LsLinkStateListMap::begin();}
-	//   iterator end() { return LsLinkStateListMap::end();}
-	//  iterator begin() { return baseMap::begin();}
-	//   const_iterator begin() const { return  baseMap::begin();}
-	//   iterator end() { return baseMap::end();}
-	//   const_iterator end() const { return baseMap::end();}
+	LsTopoMap() : myNodeId_(LS_INVALID_NODE_ID), version_(0) {}
+	~LsTopoMap();
+
+	// one past the largest node id we have link states of
+	int size() const { return lsa_.size(); }
+	typedef LsMap<int, LsLsa*> ChangeMap; // origin -> earlier record
 
+	LsLsa* lsa(int nodeId) const {
+		return ((nodeId >= 0) && (nodeId < (int)lsa_.size())) ? 
+			lsa_[nodeId] : (LsLsa *)NULL;
+	}
+	const LsLinkStateList* findPtr(int nodeId) const {
+		LsLsa* l = lsa(nodeId);
+		return (l == NULL) ? (LsLinkStateList *)NULL : &l->links_;
+	}
+	// replace the link states of nodeId
+	void insert(int nodeId, const LsLinkStateList& lsl);
+	// take the record another database holds 
+	void share(int nodeId, LsLsa* lsa);
 	// insert one link state each time 
-	LsLinkStateList* insertLinkState(int nodeId, 
-					 const LsLinkState& linkState);
+	void insertLinkState(int nodeId, const LsLinkState& linkState);
 	// update returns true if there's change
 	bool update(int nodeId, const LsLinkStateList& linkStateList);
 	//   friend ostream & operator << ( ostream & os, LsTopoMap & x) ;
 	void setNodeId(int id) { myNodeId_ = id ;}
+	u_int32_t version() const { return version_; }
+
+	const ChangeMap& changes() const { return changes_; }
+	void clearChanges();
 private:
 	int myNodeId_; // for update()
+	u_int32_t version_; // bumped on every change
+	LsLsaVector lsa_;
+	ChangeMap changes_;
+
+	void set(int nodeId, LsLsa* lsa);
+	// not copyable, the records are reference counted
+	LsTopoMap(const LsTopoMap&);
+	LsTopoMap& operator= (const LsTopoMap&);
 };
 
 typedef LsTopoMap LsTopology;
@@ -343,6 +427,75 @@ private:
 	iterator findMinEqualPaths();
 };
 
+/*
+  LsSpfStats -- what the route computations of one node have cost
+*/
+struct LsSpfStats {
+	int full_;		// computations from scratch
+	int incremental_;	// incremental ones
+	double examined_;	// nodes examined, over all computations
+	int lastExamined_;
+	double time_;		// wall clock seconds, over all computations
+	double lastTime_;
+	double maxTime_;
+
+	LsSpfStats() : full_(0), incremental_(0), examined_(0), 
+		lastExamined_(0), time_(0), lastTime_(0), maxTime_(0) {}
+	void record(bool incremental, int examined, double t) {
+		if (incremental)
+			incremental_++;
+		else
+			full_++;
+		examined_ += examined;
+		lastExamined_ = examined;
+		time_ += t;
+		lastTime_ = t;
+		if (t > maxTime_)
+			maxTime_ = t;
+	}
+};
+
+/*
+  LsSpf -- a node's shortest path tree, kept up to date incrementally.
+  After a change only the nodes whose shortest paths went through the
+  changed links, and the nodes a cheaper link now reaches, are
+  re-examined.  Costs are those of LsRouting::_computeRoutes(); next 
+  hops of equal cost paths are kept in ascending order of node id.
+*/
+class LsSpf {
+public:
+	LsSpf() : self_(LS_INVALID_NODE_ID), valid_(false) {}
+	bool valid() const { return valid_; }
+	// both return the number of nodes examined 
+	int full(const LsTopoMap& db, int self, LsPaths& paths);
+	// -1 if the changes are too many to be worth it, call full()
+	int update(const LsTopoMap& db, int self, LsPaths& paths);
+private:
+	typedef vector<int> NextHops;	// sorted
+	typedef pair<int, int> HeapEntry;	// cost, node id
+	typedef priority_queue<HeapEntry, vector<HeapEntry>, 
+			       greater<HeapEntry> > Heap;
+	int self_;
+	bool valid_;
+	vector<int> dist_;
+	vector<int> oldDist_;
+	vector<NextHops> nh_;
+	vector<unsigned char> flags_;
+	vector<int> touched_;	// nodes with flags set
+
+	void mark(int node, unsigned char f) {
+		if (flags_[node] == 0)
+			touched_.push_back(node);
+		flags_[node] |= f;
+	}
+	void grow(int n);
+	void relax(const LsTopoMap& db, int node, Heap& heap);
+	void lower(int node, int d, Heap& heap);
+	void nextHops(const LsTopoMap& db, int node, NextHops& nh);
+	void propagate(const LsTopoMap& db, Heap& heap, LsPaths& paths);
+	void install(LsPaths& paths, int node);
+};
+
 /* 
    LsMessage 
 */
@@ -569,7 +722,7 @@ public:
 	// constructor and distructor
 	LsRouting() : myNodePtr_(NULL),  myNodeId_(LS_INVALID_NODE_ID), 
 		peerIdListPtr_(NULL), linkStateListPtr_(NULL),
-		routingTablePtr_(NULL),
+		routingTablePtr_(NULL), incremental_(false),
 		linkStateDatabase_(), lsaHistory_(), ackManager_(*this) {}
 	~LsRouting() {
 		//delete pLinkStateDatabase;
@@ -578,11 +731,10 @@ public:
 	}
 
 	bool init(LsNode* nodePtr);
-	void computeRoutes() {
-	        if (routingTablePtr_ != NULL)
-	                delete routingTablePtr_;
-	        routingTablePtr_ = _computeRoutes();
-	}
+	void computeRoutes();
+	// keep the shortest path tree and update it incrementally
+	void setIncremental(bool on) { incremental_ = on; }
+	const LsSpfStats& spfStats() const { return spfStats_; }
 	LsEqualPaths* lookup(int destId) {
 		return (routingTablePtr_ == NULL) ? 
 			(LsEqualPaths *)NULL : 
@@ -606,6 +758,9 @@ private:
 	LsLinkStateList* linkStateListPtr_; // My links
 	LsMessageCenter* messageCenterPtr_; // points to static messageCenter
 	LsPaths* routingTablePtr_; // the routing table
+	bool incremental_; // use spf_ rather than _computeRoutes()
+	LsSpf spf_;
+	LsSpfStats spfStats_;
 	LsTopoMap linkStateDatabase_; // topology;
 	LsMessageHistory lsaHistory_; // Remember what we've seen
 	LsMessageHistory tpmHistory_; 
@@ -144,6 +144,26 @@ int rtProtoLS::command(int argc, const char*const* argv)
 		computeRoutes();
 		return TCL_OK;
 	}
+	/*
+	 * $ls spf-stats: full and incremental route computations, nodes
+	 * examined in all and in the last, seconds spent in all, in the
+	 * last and in the longest
+	 */
+	if (strcmp(argv[1], "spf-stats") == 0) {
+		const LsSpfStats& st = routing_.spfStats();
+		Tcl::instance().resultf("%d %d %.0f %d %g %g %g", st.full_,
+					st.incremental_, st.examined_,
+					st.lastExamined_, st.time_,
+					st.lastTime_, st.maxTime_);
+		return TCL_OK;
+	}
+	/* $ls lsdb-stats: link state records held by all nodes, links */
+	if (strcmp(argv[1], "lsdb-stats") == 0) {
+		LsLsaStore& store = LsLsaStore::instance();
+		Tcl::instance().resultf("%d %d", store.nrecords(), 
+					store.nlinks());
+		return TCL_OK;
+	}
 	if (strcmp(argv[1], "intfChanged") == 0) {
 		intfChanged();
 		return TCL_OK;
@@ -252,6 +272,7 @@ void rtProtoLS::initialize() // init nodeState_ and routing_
 
 	// call routing.init(this); and computeRoutes
 	routing_.init(this);
+	routing_.setIncremental(incrementalSPF_ != 0);
 	routing_.computeRoutes();
 	// debug
 	tcl.evalf("%s set LS_ready", name());
@@ -75,6 +75,7 @@ class rtProtoLS : public Agent , public LsNode {
 public:
         rtProtoLS() : Agent(PT_RTPROTO_LS) { 
 		LS_ready_ = 0;
+		bind_bool("incrementalSPF_", &incrementalSPF_);
 	}
         int command(int argc, const char*const* argv);
         void sendpkt(ns_addr_t dst, u_int32_t z, u_int32_t mtvar);
@@ -111,6 +112,7 @@ private:
 	int nodeId_;
 	int LS_ready_;	// to differentiate fake and real LS, debug, 0 == no
 			// needed in recv and sendMessage;
+	int incrementalSPF_; // keep the SPF tree, update it incrementally
 
 	LsLinkStateList linkStateList_;
 	LsNodeIdList peerIdList_;
@@ -58,6 +58,7 @@ Channel:  a shared medium that supports contention and collision
 
 class Channel : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Channel(void);
 	virtual int command(int argc, const char*const* argv);
 	virtual void recv(Packet* p, Handler*);	
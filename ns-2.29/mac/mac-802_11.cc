@@ -153,32 +153,16 @@ public:
    Mac  and Phy MIB Class Functions
    ====================================================================== */
 
-PHY_MIB::PHY_MIB(Mac802_11 *parent)
+/*
+ * The phy and mac mib objects are bound to Mac/802_11 variables, in
+ * the table of Mac802_11.
+ */
+PHY_MIB::PHY_MIB(Mac802_11 *)
 {
-	/*
-	 * Bind the phy mib objects.  Note that these will be bound
-	 * to Mac/802_11 variables
-	 */
-
-	parent->bind("CWMin_", &CWMin);
-	parent->bind("CWMax_", &CWMax);
-	parent->bind("SlotTime_", &SlotTime);
-	parent->bind("SIFS_", &SIFSTime);
-	parent->bind("PreambleLength_", &PreambleLength);
-	parent->bind("PLCPHeaderLength_", &PLCPHeaderLength);
-	parent->bind_bw("PLCPDataRate_", &PLCPDataRate);
 }
 
-MAC_MIB::MAC_MIB(Mac802_11 *parent)
+MAC_MIB::MAC_MIB(Mac802_11 *)
 {
-	/*
-	 * Bind the phy mib objects.  Note that these will be bound
-	 * to Mac/802_11 variables
-	 */
-	
-	parent->bind("RTSThreshold_", &RTSThreshold);
-	parent->bind("ShortRetryLimit_", &ShortRetryLimit);
-	parent->bind("LongRetryLimit_", &LongRetryLimit);
 }
 
 /* ======================================================================
@@ -196,7 +180,6 @@ Mac802_11::Mac802_11() :
 	eotPacket_ = NULL;
 	pktRTS_ = 0;
 	pktCTRL_ = 0;		
-	cw_ = phymib_.getCWMin();
 	ssrc_ = slrc_ = 0;
 	// Added by Sushmita
         et_ = new EventTrace();
@@ -205,27 +188,39 @@ Mac802_11::Mac802_11() :
 	cache_ = 0;
 	cache_node_count_ = 0;
 	
-	// chk if basic/data rates are set
-	// otherwise use bandwidth_ as default;
-	
-	Tcl& tcl = Tcl::instance();
-	tcl.evalf("Mac/802_11 set basicRate_");
-	if (strcmp(tcl.result(), "0") != 0) 
-		bind_bw("basicRate_", &basicRate_);
-	else
-		basicRate_ = bandwidth_;
-
-	tcl.evalf("Mac/802_11 set dataRate_");
-	if (strcmp(tcl.result(), "0") != 0) 
-		bind_bw("dataRate_", &dataRate_);
-	else
-		dataRate_ = bandwidth_;
-
         EOTtarget_ = 0;
        	bss_id_ = IBSS_ID;
 	//printf("bssid in constructor %d\n",bss_id_);
 }
 
+DELAY_BIND_BEGIN(Mac802_11, Mac)
+	DELAY_BIND("CWMin_", phymib_.CWMin),
+	DELAY_BIND("CWMax_", phymib_.CWMax),
+	DELAY_BIND("SlotTime_", phymib_.SlotTime),
+	DELAY_BIND("SIFS_", phymib_.SIFSTime),
+	DELAY_BIND("PreambleLength_", phymib_.PreambleLength),
+	DELAY_BIND("PLCPHeaderLength_", phymib_.PLCPHeaderLength),
+	DELAY_BIND_BW("PLCPDataRate_", phymib_.PLCPDataRate),
+	DELAY_BIND("RTSThreshold_", macmib_.RTSThreshold),
+	DELAY_BIND("ShortRetryLimit_", macmib_.ShortRetryLimit),
+	DELAY_BIND("LongRetryLimit_", macmib_.LongRetryLimit),
+	DELAY_BIND_BW("basicRate_", basicRate_),
+	DELAY_BIND_BW("dataRate_", dataRate_),
+DELAY_BIND_END
+
+void
+Mac802_11::delay_bind_init_all()
+{
+	Mac::delay_bind_init_all();
+	cw_ = phymib_.getCWMin();
+
+	// basic/data rates of 0 mean bandwidth_
+	if (basicRate_ == 0)
+		basicRate_ = bandwidth_;
+	if (dataRate_ == 0)
+		dataRate_ = bandwidth_;
+}
+
 
 int
 Mac802_11::command(int argc, const char*const* argv)
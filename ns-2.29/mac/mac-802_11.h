@@ -131,6 +131,7 @@ struct hdr_mac802_11 {
 #define DSSS_MaxPropagationDelay        0.000002        // 2us   XXXX
 
 class PHY_MIB {
+	friend class Mac802_11;		// binds the fields
 public:
 	PHY_MIB(Mac802_11 *parent);
 
@@ -193,6 +194,7 @@ public:
 #define MAC_MaxReceiveLifetime		512		// time units
 
 class MAC_MIB {
+	friend class Mac802_11;		// binds the fields
 public:
 
 	MAC_MIB(Mac802_11 *parent);
@@ -237,6 +239,7 @@ class Mac802_11 : public Mac {
 	friend class TxTimer;
 public:
 	Mac802_11();
+	DELAY_BIND_TABLE
 	void		recv(Packet *p, Handler *h);
 	inline int	hdr_dst(char* hdr, int dst = -2);
 	inline int	hdr_src(char* hdr, int src = -2);
@@ -258,6 +261,7 @@ protected:
 
 private:
 	int		command(int argc, const char*const* argv);
+	void		delay_bind_init_all();
 
 	/*
 	 * Called by the timers.
@@ -39,6 +39,7 @@
 
 #include <stdlib.h>
 #include <object.h>
+#include "mem-account.h"
 
 
 //==================================================================
@@ -47,6 +48,7 @@
 
 class VARPTable : public TclObject {
  public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	VARPTable(void);
 	~VARPTable(void);
 	int command(int argc, const char*const* argv);
@@ -0,0 +1,466 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Prune and graft handling of dense mode multicast (DM.tcl) in C++.
+ *
+ * Agent/Mcast/Control/DM is the control agent of a DM instance.  With
+ * native_ set it handles received prunes and grafts itself, on the
+ * node's replicators (Classifier/Replicator/Demuxer), doing what DM
+ * instproc recv-prune and recv-graft do.  The prune state of each
+ * (S,G,oif) is a small record in a hash table, and instead of a
+ * Timer/Iface/Prune per record, the expiry times are kept in a timer
+ * wheel driven by a single TimerHandler.  Only sending a prune or graft
+ * upstream, which needs the topology, goes back to OTcl ("$proto
+ * send-ctrl").
+ *
+ * A message it can't handle (say, from a LAN, or for a source with no
+ * entry yet) is passed on to OTcl, as it would be with native_ 0.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "config.h"
+#include "tclcl.h"
+#include "timer-handler.h"
+#include "classifier-mcast.h"
+#include "replicator.h"
+#include "mcast_ctrl.h"
+
+class DMControlAgent;
+
+class DMPruneTimer : public TimerHandler {
+public:
+	DMPruneTimer(DMControlAgent* a) : a_(a) {}
+protected:
+	virtual void expire(Event*);
+	DMControlAgent* a_;
+};
+
+struct DMPrune {
+	DMPrune* hnext;		// hash chain
+	DMPrune* prev;		// wheel bucket, in order of expiry
+	DMPrune* next;
+	int src;
+	int group;
+	NsObject* oif;
+	double expire;
+	long tick;		// expire / tick_
+};
+
+class DMControlAgent : public mcastControlAgent {
+public:
+	DMControlAgent();
+	~DMControlAgent();
+	virtual void recv(Packet*, Handler*);
+	void expire_prunes();
+protected:
+	virtual int command(int argc, const char*const* argv);
+	int recv_prune(int src, int group, int iface);
+	int recv_graft(int src, int group, int iface);
+	Demuxer* rep(int src, int group) {
+		return ((Demuxer*)cls_->lookup_rep(src, group));
+	}
+	NsObject* iif2oif(int iface);
+	void send_ctrl(const char* which, int src, int group);
+
+	// (S,G,oif) prune state
+	DMPrune** find(int src, int group, NsObject* oif);
+	void schedule(int src, int group, NsObject* oif);
+	void cancel(int src, int group, NsObject* oif);
+	void remove(DMPrune*);
+	void grow();
+
+	// timer wheel
+	enum { NWHEEL = 256 };
+	void wheel_insert(DMPrune*);
+	void wheel_remove(DMPrune*);
+	DMPrune* earliest();
+	void arm();
+
+	int native_;
+	double timeout_;	// prune lifetime (DM PruneTimeout)
+	double tick_;		// width of a wheel bucket
+	int nodeid_;
+	char* node_;
+	char* proto_;
+	MCastClassifier* cls_;
+
+	NsObject** oif_;	// by incoming iface
+	int noif_;
+
+	DMPrune** htab_;
+	int hsize_;		// a power of 2
+	int nprune_;
+
+	DMPrune* head_[NWHEEL];
+	DMPrune* tail_[NWHEEL];
+	DMPruneTimer timer_;
+	double armed_;		// when timer_ fires, if pending
+};
+
+static class DMControlClass : public TclClass {
+public:
+	DMControlClass() : TclClass("Agent/Mcast/Control/DM") {}
+	TclObject* create(int, const char*const*) {
+		return (new DMControlAgent());
+	}
+} class_dm_ctrl;
+
+void DMPruneTimer::expire(Event*)
+{
+	a_->expire_prunes();
+}
+
+DMControlAgent::DMControlAgent() :
+	nodeid_(-1), node_(0), proto_(0), cls_(0), oif_(0), noif_(0),
+	hsize_(64), nprune_(0), timer_(this), armed_(0)
+{
+	bind_bool("native_", &native_);
+	bind_time("timeout_", &timeout_);
+	bind_time("tick_", &tick_);
+	htab_ = new DMPrune*[hsize_];
+	memset(htab_, 0, hsize_ * sizeof(DMPrune*));
+	memset(head_, 0, sizeof(head_));
+	memset(tail_, 0, sizeof(tail_));
+}
+
+DMControlAgent::~DMControlAgent()
+{
+	timer_.force_cancel();
+	for (int i = 0; i < hsize_; i++) {
+		DMPrune* p = htab_[i];
+		while (p != 0) {
+			DMPrune* n = p->hnext;
+			delete p;
+			p = n;
+		}
+	}
+	delete [] htab_;
+	delete [] oif_;
+	delete [] node_;
+	delete [] proto_;
+}
+
+void DMControlAgent::recv(Packet* pkt, Handler* h)
+{
+	hdr_mcast_ctrl* ph = hdr_mcast_ctrl::access(pkt);
+	if (native_ && cls_ != 0 && ph->src() >= 0) {
+		int iface = hdr_cmn::access(pkt)->iface();
+		int done = 0;
+		if (strcmp(ph->type(), "prune") == 0)
+			done = recv_prune(ph->src(), ph->group(), iface);
+		else if (strcmp(ph->type(), "graft") == 0)
+			done = recv_graft(ph->src(), ph->group(), iface);
+		if (done) {
+			Packet::free(pkt);
+			return;
+		}
+	}
+	mcastControlAgent::recv(pkt, h);
+}
+
+/*
+ * The oif back to the neighbor on an incoming iface ("$node iif2oif").
+ * Ifaces don't change once made, so the answer is kept.
+ */
+NsObject* DMControlAgent::iif2oif(int iface)
+{
+	if (iface < 0)
+		return (0);
+	if (iface < noif_ && oif_[iface] != 0)
+		return (oif_[iface]);
+	Tcl& tcl = Tcl::instance();
+	char buf[128];
+	sprintf(buf, "%.100s iif2oif %d", node_, iface);
+	if (Tcl_GlobalEval(tcl.interp(), buf) != TCL_OK)
+		return (0);
+	NsObject* o = (NsObject*)TclObject::lookup(tcl.result());
+	if (o == 0)
+		return (0);
+	if (iface >= noif_) {
+		int n = noif_ ? noif_ : 16;
+		while (n <= iface)
+			n *= 2;
+		NsObject** p = new NsObject*[n];
+		memset(p, 0, n * sizeof(NsObject*));
+		if (noif_ > 0)
+			memcpy(p, oif_, noif_ * sizeof(NsObject*));
+		delete [] oif_;
+		oif_ = p;
+		noif_ = n;
+	}
+	oif_[iface] = o;
+	return (o);
+}
+
+void DMControlAgent::send_ctrl(const char* which, int src, int group)
+{
+	Tcl::instance().evalf("%s send-ctrl %s %d %d", proto_, which,
+			      src, group);
+}
+
+/*
+ * DM instproc recv-prune
+ */
+int DMControlAgent::recv_prune(int src, int group, int iface)
+{
+	Demuxer* r = rep(src, group);
+	if (r == 0)
+		return (1);
+	NsObject* oif = iif2oif(iface);
+	if (oif == 0)
+		return (0);
+	if (r->is_active_target(oif)) {
+		r->disable(oif);
+		// propagate prune only if the disabled oif was the last one
+		if (!r->is_active() && src != nodeid_)
+			send_ctrl("prune", src, group);
+	}
+	schedule(src, group, oif);
+	return (1);
+}
+
+/*
+ * DM instproc recv-graft; one for a source that has no entry here
+ * yet is left to it.
+ */
+int DMControlAgent::recv_graft(int src, int group, int iface)
+{
+	Demuxer* r = rep(src, group);
+	if (r == 0)
+		return (0);
+	NsObject* oif = iif2oif(iface);
+	if (oif == 0)
+		return (0);
+	if (!r->is_active() && src != nodeid_)
+		send_ctrl("graft", src, group);
+	r->enable(oif);
+	cancel(src, group, oif);
+	return (1);
+}
+
+/*
+ * A prune that has timed out puts its oif back (DM instproc timeoutPrune).
+ */
+void DMControlAgent::expire_prunes()
+{
+	double now = Scheduler::instance().clock();
+	DMPrune* p;
+	while ((p = earliest()) != 0 && p->expire <= now) {
+		int src = p->src;
+		int group = p->group;
+		NsObject* oif = p->oif;
+		remove(p);
+		Demuxer* r = rep(src, group);
+		if (r != 0)
+			r->insert(oif);
+	}
+	arm();
+}
+
+DMPrune** DMControlAgent::find(int src, int group, NsObject* oif)
+{
+	unsigned long h = (unsigned long)src * 0x9e3779b1UL;
+	h ^= (unsigned long)group + (h << 6) + (h >> 2);
+	h ^= ((unsigned long)oif >> 4) + (h << 6) + (h >> 2);
+	DMPrune** pp = &htab_[h & (hsize_ - 1)];
+	for (; *pp != 0; pp = &(*pp)->hnext) {
+		DMPrune* p = *pp;
+		if (p->src == src && p->group == group && p->oif == oif)
+			break;
+	}
+	return (pp);
+}
+
+void DMControlAgent::grow()
+{
+	DMPrune** old = htab_;
+	int n = hsize_;
+	hsize_ *= 2;
+	htab_ = new DMPrune*[hsize_];
+	memset(htab_, 0, hsize_ * sizeof(DMPrune*));
+	for (int i = 0; i < n; i++) {
+		DMPrune* p = old[i];
+		while (p != 0) {
+			DMPrune* next = p->hnext;
+			DMPrune** pp = find(p->src, p->group, p->oif);
+			p->hnext = 0;
+			*pp = p;
+			p = next;
+		}
+	}
+	delete [] old;
+}
+
+/*
+ * (Re)start the prune of oif for (src,group): it runs out timeout_
+ * from now, as Timer/Iface/Prune does on "schedule".
+ */
+void DMControlAgent::schedule(int src, int group, NsObject* oif)
+{
+	DMPrune** pp = find(src, group, oif);
+	DMPrune* p = *pp;
+	if (p == 0) {
+		p = new DMPrune;
+		p->hnext = 0;
+		p->src = src;
+		p->group = group;
+		p->oif = oif;
+		*pp = p;
+		if (++nprune_ > hsize_)
+			grow();
+	} else
+		wheel_remove(p);
+	p->expire = Scheduler::instance().clock() + timeout_;
+	p->tick = (long)floor(p->expire / tick_);
+	wheel_insert(p);
+	if (timer_.status() != TIMER_PENDING ||
+	    p->expire < armed_)
+		arm();
+}
+
+void DMControlAgent::cancel(int src, int group, NsObject* oif)
+{
+	DMPrune* p = *find(src, group, oif);
+	if (p != 0)
+		remove(p);
+}
+
+void DMControlAgent::remove(DMPrune* p)
+{
+	DMPrune** pp = find(p->src, p->group, p->oif);
+	*pp = p->hnext;
+	--nprune_;
+	wheel_remove(p);
+	delete p;
+}
+
+/*
+ * Each bucket of the wheel holds the prunes that run out in the
+ * ticks equal to it modulo NWHEEL, in order of expiry.  Prunes all
+ * last the same time, so a new one nearly always goes at the tail.
+ */
+void DMControlAgent::wheel_insert(DMPrune* p)
+{
+	int b = p->tick & (NWHEEL - 1);
+	DMPrune* q = tail_[b];
+	while (q != 0 && q->expire > p->expire)
+		q = q->prev;
+	p->prev = q;
+	p->next = (q != 0) ? q->next : head_[b];
+	if (p->next != 0)
+		p->next->prev = p;
+	else
+		tail_[b] = p;
+	if (q != 0)
+		q->next = p;
+	else
+		head_[b] = p;
+}
+
+void DMControlAgent::wheel_remove(DMPrune* p)
+{
+	int b = p->tick & (NWHEEL - 1);
+	if (p->prev != 0)
+		p->prev->next = p->next;
+	else
+		head_[b] = p->next;
+	if (p->next != 0)
+		p->next->prev = p->prev;
+	else
+		tail_[b] = p->prev;
+}
+
+/*
+ * Walk the wheel from the current tick: the first bucket whose head
+ * runs out in this turn of the wheel has the earliest prune.  If
+ * none does, everything is at least a turn away, and the earliest
+ * is the least of the heads.
+ */
+DMPrune* DMControlAgent::earliest()
+{
+	if (nprune_ == 0)
+		return (0);
+	// from a tick back, for a prune the timer was a hair late for
+	long t = (long)floor(Scheduler::instance().clock() / tick_) - 1;
+	for (int i = 0; i < NWHEEL; i++, t++) {
+		DMPrune* p = head_[t & (NWHEEL - 1)];
+		if (p != 0 && p->tick <= t)
+			return (p);
+	}
+	DMPrune* best = 0;
+	for (int b = 0; b < NWHEEL; b++)
+		if (head_[b] != 0 &&
+		    (best == 0 || head_[b]->expire < best->expire))
+			best = head_[b];
+	return (best);
+}
+
+void DMControlAgent::arm()
+{
+	DMPrune* p = earliest();
+	if (p == 0) {
+		timer_.force_cancel();
+		return;
+	}
+	double delay = p->expire - Scheduler::instance().clock();
+	timer_.resched(delay > 0 ? delay : 0);
+	armed_ = p->expire;
+}
+
+int DMControlAgent::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		/*
+		 * $mctrl prunes
+		 * (a list of {src group oif expire})
+		 */
+		if (strcmp(argv[1], "prunes") == 0) {
+			tcl.result("");
+			for (int i = 0; i < hsize_; i++)
+				for (DMPrune* p = htab_[i]; p != 0;
+				     p = p->hnext)
+					tcl.resultf("%s {%d %d %s %.17g}",
+						    tcl.result(), p->src,
+						    p->group, p->oif->name(),
+						    p->expire);
+			return (TCL_OK);
+		}
+	} else if (argc == 5) {
+		/*
+		 * $mctrl dm-init $proto $node $nodeid
+		 */
+		if (strcmp(argv[1], "dm-init") == 0) {
+			char buf[128];
+			sprintf(buf, "%.100s set multiclassifier_", argv[3]);
+			if (Tcl_GlobalEval(tcl.interp(), buf) != TCL_OK ||
+			    TclObject::lookup(tcl.result()) == 0) {
+				tcl.resultf("%s: %s is not a multicast node",
+					    name(), argv[3]);
+				return (TCL_ERROR);
+			}
+			cls_ = (MCastClassifier*)TclObject::lookup(tcl.result());
+			delete [] proto_;
+			proto_ = new char[strlen(argv[2]) + 1];
+			strcpy(proto_, argv[2]);
+			delete [] node_;
+			node_ = new char[strlen(argv[3]) + 1];
+			strcpy(node_, argv[3]);
+			nodeid_ = atoi(argv[4]);
+			return (TCL_OK);
+		}
+		/*
+		 * $mctrl cancel-prune $src $group $oif
+		 */
+		if (strcmp(argv[1], "cancel-prune") == 0) {
+			NsObject* oif = (NsObject*)TclObject::lookup(argv[4]);
+			if (oif != 0)
+				cancel(strtol(argv[2], (char**)0, 0),
+				       strtol(argv[3], (char**)0, 0), oif);
+			return (TCL_OK);
+		}
+	}
+	return (mcastControlAgent::command(argc, argv));
+}
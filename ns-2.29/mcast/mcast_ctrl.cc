@@ -53,62 +53,64 @@ static const char rcsid[] =
     "@(#) $Header: /nfs/jade/vint/CVSROOT/ns-2/mcast/mcast_ctrl.cc,v 1.7 2005/08/25 18:58:07 johnh Exp $ (LBL)";
 #endif
 
-#include "agent.h"
-#include "packet.h"
 #include "mcast_ctrl.h"
 
-class mcastControlAgent : public Agent {
-public:
-	mcastControlAgent() : Agent(PT_NTYPE) {
-		bind("packetSize_", &size_);
-	}
+mcastControlAgent::mcastControlAgent() : Agent(PT_NTYPE)
+{
+	bind("packetSize_", &size_);
+}
 
-	void recv(Packet* pkt, Handler*) {
-		hdr_mcast_ctrl* ph = hdr_mcast_ctrl::access(pkt);
-		hdr_cmn* ch = hdr_cmn::access(pkt);
-		// Agent/Mcast/Control instproc recv type from src group iface
-		Tcl::instance().evalf("%s recv %s %d %d", name(),
-				      ph->type(), ch->iface(), ph->args());
-		Packet::free(pkt);
-	}
+void mcastControlAgent::recv(Packet* pkt, Handler*)
+{
+	hdr_mcast_ctrl* ph = hdr_mcast_ctrl::access(pkt);
+	hdr_cmn* ch = hdr_cmn::access(pkt);
+	// Agent/Mcast/Control instproc recv type from src group iface
+	Tcl::instance().evalf("%s recv %s %d %d", name(),
+			      ph->type(), ch->iface(), ph->args());
+	Packet::free(pkt);
+}
 
-	/*
- 	 * $proc send $type $src $group
- 	 */
+/*
+ * $proc send $type $m ?$from $src $group?
+ */
 
 #define	CASE(c,str,type)						\
-		case (c):	if (strcmp(argv[2], (str)) == 0) {	\
-			type_ = (type);					\
-			break;						\
-		} else {						\
-			/*FALLTHROUGH*/					\
-		}
+	case (c):	if (strcmp(argv[2], (str)) == 0) {		\
+		type_ = (type);						\
+		break;							\
+	} else {							\
+		/*FALLTHROUGH*/						\
+	}
 
-	int command(int argc, const char*const* argv) {
-		if (argc == 4) {
-			if (strcmp(argv[1], "send") == 0) {
-				switch (*argv[2]) {
-					CASE('p', "prune", PT_PRUNE);
-					CASE('g', "graft", PT_GRAFT);
-					CASE('X', "graftAck", PT_GRAFTACK);
-					CASE('j', "join",  PT_JOIN);
-					CASE('a', "assert", PT_ASSERT);
-				default:
-					Tcl& tcl = Tcl::instance();
-					tcl.result("invalid control message");
-					return (TCL_ERROR);
-				}
-				Packet* pkt = allocpkt();
-				hdr_mcast_ctrl* ph=hdr_mcast_ctrl::access(pkt);
-				strcpy(ph->type(), argv[2]);
-				ph->args()  = atoi(argv[3]);
-				send(pkt, 0);
-				return (TCL_OK);
-			}
+int mcastControlAgent::command(int argc, const char*const* argv)
+{
+	if ((argc == 4 || argc == 7) && strcmp(argv[1], "send") == 0) {
+		switch (*argv[2]) {
+			CASE('p', "prune", PT_PRUNE);
+			CASE('g', "graft", PT_GRAFT);
+			CASE('X', "graftAck", PT_GRAFTACK);
+			CASE('j', "join",  PT_JOIN);
+			CASE('a', "assert", PT_ASSERT);
+		default:
+			Tcl& tcl = Tcl::instance();
+			tcl.result("invalid control message");
+			return (TCL_ERROR);
 		}
-		return (Agent::command(argc, argv));
+		Packet* pkt = allocpkt();
+		hdr_mcast_ctrl* ph=hdr_mcast_ctrl::access(pkt);
+		strcpy(ph->type(), argv[2]);
+		ph->args()  = atoi(argv[3]);
+		if (argc == 7) {
+			ph->from() = strtol(argv[4], (char**)0, 0);
+			ph->src() = strtol(argv[5], (char**)0, 0);
+			ph->group() = strtol(argv[6], (char**)0, 0);
+		} else
+			ph->from() = ph->src() = ph->group() = -1;
+		send(pkt, 0);
+		return (TCL_OK);
 	}
-};
+	return (Agent::command(argc, argv));
+}
 
 //
 // Now put the standard OTcl linkage templates here
@@ -54,13 +54,23 @@
 #ifndef ns_mcast_ctrl_h
 #define ns_mcast_ctrl_h
 
+#include "agent.h"
+#include "packet.h"
+
 struct hdr_mcast_ctrl {
 	char           ptype_[15];
 	int	       args_;
+	// copies of the first message arguments, for agents in C++
+	int	       from_;
+	int	       src_;
+	int	       group_;
 
         /* per-field member functions */
         char*     type()  { return ptype_; }
 	int&	  args()  { return args_;  }
+	int&	  from()  { return from_;  }
+	int&	  src()   { return src_;   }
+	int&	  group() { return group_; }
 	int maxtype()     { return sizeof(ptype_); }
 
 	// Header access methods
@@ -71,6 +81,14 @@ struct hdr_mcast_ctrl {
 	}
 };
 
+class mcastControlAgent : public Agent {
+public:
+	mcastControlAgent();
+	virtual void recv(Packet* pkt, Handler*);
+protected:
+	virtual int command(int argc, const char*const* argv);
+};
+
 #endif
 
 
@@ -38,26 +38,9 @@ static const char rcsid[] =
     "@(#) $Header: /nfs/jade/vint/CVSROOT/ns-2/mcast/replicator.cc,v 1.21 2000/12/20 10:12:48 alefiyah Exp $";
 #endif
 
-#include "classifier.h"
 #include "packet.h"
 #include "ip.h"
-
-/*
- * A replicator is not really a packet classifier but
- * we simply find convenience in leveraging its slot table.
- * (this object used to implement fan-out on a multicast
- * router as well as broadcast LANs)
- */
-class Replicator : public Classifier {
-public:
-	Replicator();
-	void recv(Packet*, Handler* h = 0);
-	virtual int classify(Packet*) {/*NOTREACHED*/ return -1;};
-protected:
-	virtual int command(int argc, const char*const* argv);
-	int ignore_;
-	int direction_;
-};
+#include "replicator.h"
 
 static class ReplicatorClass : public TclClass {
 public:
@@ -79,7 +62,7 @@ void Replicator::recv(Packet* p, Handler*)
 	hdr_cmn* ch = hdr_cmn::access(p);
 	if (maxslot_ < 0) {
 		if (!ignore_) 
-			Tcl::instance().evalf("%s drop %ld %ld %d", name(), 
+			Tcl::instance().evalf("%s drop %d %d %d", name(), 
 				iph->saddr(), iph->daddr(), ch->iface());
 		Packet::free(p);
 		return;
@@ -131,3 +114,156 @@ int Replicator::command(int argc, const char*const* argv)
 
 
 
+
+static class DemuxerClass : public TclClass {
+public:
+	DemuxerClass() : TclClass("Classifier/Replicator/Demuxer") {}
+	TclObject* create(int, const char*const*) {
+		return (new Demuxer());
+	}
+} class_demuxer;
+
+Demuxer::Demuxer() : target_(0), ntarget_(0), maxtarget_(0), nactive_(0)
+{
+}
+
+Demuxer::~Demuxer()
+{
+	delete [] target_;
+}
+
+/*
+ * A router has a handful of oifs, so the targets are kept in a
+ * small array and searched linearly.
+ */
+Demuxer::Target* Demuxer::find(NsObject* o) const
+{
+	for (int i = 0; i < ntarget_; i++)
+		if (target_[i].obj == o)
+			return (&target_[i]);
+	return (0);
+}
+
+Demuxer::Target* Demuxer::add(NsObject* o)
+{
+	if (ntarget_ == maxtarget_) {
+		maxtarget_ = maxtarget_ ? 2 * maxtarget_ : 4;
+		Target* t = new Target[maxtarget_];
+		for (int i = 0; i < ntarget_; i++)
+			t[i] = target_[i];
+		delete [] target_;
+		target_ = t;
+	}
+	Target* t = &target_[ntarget_++];
+	t->obj = o;
+	t->slot = -1;
+	return (t);
+}
+
+void Demuxer::insert(NsObject* o)
+{
+	if (find(o) == 0)
+		add(o);
+	enable(o);
+}
+
+void Demuxer::enable(NsObject* o)
+{
+	Target* t = find(o);
+	if (t == 0)
+		t = add(o);
+	if (t->slot < 0) {
+		t->slot = install_next(o);
+		++nactive_;
+		ignore_ = 0;
+	}
+}
+
+void Demuxer::disable(NsObject* o)
+{
+	Target* t = find(o);
+	if (t != 0 && t->slot >= 0) {
+		clear(t->slot);
+		t->slot = -1;
+		--nactive_;
+	}
+}
+
+void Demuxer::reset()
+{
+	for (int i = 0; i < ntarget_; i++)
+		if (target_[i].slot >= 0)
+			clear(target_[i].slot);
+	ntarget_ = 0;
+	nactive_ = 0;
+}
+
+int Demuxer::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "is-active") == 0) {
+			tcl.result(is_active() ? "1" : "0");
+			return (TCL_OK);
+		}
+		/*
+		 * $demuxer active-targets
+		 * (the enabled targets, in no particular order)
+		 */
+		if (strcmp(argv[1], "active-targets") == 0) {
+			tcl.result("");
+			for (int i = 0; i < ntarget_; i++)
+				if (target_[i].slot >= 0)
+					tcl.resultf("%s %s", tcl.result(),
+						    target_[i].obj->name());
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "reset") == 0) {
+			reset();
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		int op;
+		if (strcmp(argv[1], "insert") == 0)
+			op = 0;
+		else if (strcmp(argv[1], "enable") == 0)
+			op = 1;
+		else if (strcmp(argv[1], "disable") == 0)
+			op = 2;
+		else if (strcmp(argv[1], "exists") == 0)
+			op = 3;
+		else if (strcmp(argv[1], "is-active-target") == 0)
+			op = 4;
+		else
+			return (Replicator::command(argc, argv));
+		NsObject* o = (NsObject*)TclObject::lookup(argv[2]);
+		if (o == 0) {
+			if (op >= 2) {
+				tcl.result(op > 2 ? "0" : "");
+				return (TCL_OK);
+			}
+			tcl.resultf("%s %s: no such object %s", name(),
+				    argv[1], argv[2]);
+			return (TCL_ERROR);
+		}
+		switch (op) {
+		case 0:
+			insert(o);
+			break;
+		case 1:
+			enable(o);
+			break;
+		case 2:
+			disable(o);
+			break;
+		case 3:
+			tcl.result(exists(o) ? "1" : "0");
+			break;
+		case 4:
+			tcl.result(is_active_target(o) ? "1" : "0");
+			break;
+		}
+		return (TCL_OK);
+	}
+	return (Replicator::command(argc, argv));
+}
@@ -0,0 +1,92 @@
+
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Copyright (c) 1996 Regents of the University of California.
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. All advertising materials mentioning features or use of this software
+ *    must display the following acknowledgement:
+ * 	This product includes software developed by the MASH Research
+ * 	Group at the University of California Berkeley.
+ * 4. Neither the name of the University nor of the Research Group may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef ns_replicator_h
+#define ns_replicator_h
+
+#include "classifier.h"
+
+/*
+ * A replicator is not really a packet classifier but
+ * we simply find convenience in leveraging its slot table.
+ * (this object used to implement fan-out on a multicast
+ * router as well as broadcast LANs)
+ */
+class Replicator : public Classifier {
+public:
+	Replicator();
+	void recv(Packet*, Handler* h = 0);
+	virtual int classify(Packet*) {/*NOTREACHED*/ return -1;};
+protected:
+	virtual int command(int argc, const char*const* argv);
+	int ignore_;
+	int direction_;
+};
+
+/*
+ * The (S,G) entry of a multicast router: a replicator that remembers
+ * each target (oif or local agent) it has been given and whether that
+ * target is enabled, i.e. installed in a slot.  A target that is
+ * disabled (pruned) keeps its entry so that "exists" still knows it.
+ */
+class Demuxer : public Replicator {
+public:
+	Demuxer();
+	~Demuxer();
+	int is_active() const { return (nactive_ > 0); }
+	int exists(NsObject* o) const { return (find(o) != 0); }
+	int is_active_target(NsObject* o) const {
+		Target* t = find(o);
+		return (t != 0 && t->slot >= 0);
+	}
+	void insert(NsObject*);
+	void enable(NsObject*);
+	void disable(NsObject*);
+	void reset();
+protected:
+	virtual int command(int argc, const char*const* argv);
+	struct Target {
+		NsObject* obj;
+		int slot;		// -1 if disabled
+	};
+	Target* find(NsObject*) const;
+	Target* add(NsObject*);
+	Target* target_;
+	int ntarget_;
+	int maxtarget_;
+	int nactive_;
+};
+
+#endif
@@ -156,6 +156,7 @@ class Topology *topology;
 
 class Topology : public TclObject {
  public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Topology(int nn, int src);
 	~Topology();
 	virtual void flood(int, int) = 0;
@@ -56,6 +56,7 @@ static const char rcsid[] =
 #endif
 
 #include <stdlib.h>
+#include <stdarg.h>
 #include <assert.h>
 
 #include "config.h"
@@ -64,6 +65,7 @@ static const char rcsid[] =
 #include "srm.h"
 #include "trace.h"
 #include "rtp.h"
+#include "rng.h"
 
 
 int hdr_srm::offset_;
@@ -105,18 +107,51 @@ public:
 
 SRMAgent::SRMAgent() 
 	: Agent(PT_SRM), dataCtr_(-1), sessCtr_(-1), siphash_(0), seqno_(-1),
-    app_type_(PT_NTYPE)
+    app_type_(PT_NTYPE), running_(0), ewma_(1), nid_(-1), trace_(0),
+    traceAll_(0), session_(this)
 {
 	sip_ = new SRMinfo(-1);
 
 	bind("packetSize_", &packetSize_);
 	bind("groupSize_", &groupSize_);
 	bind("app_fid_", &app_fid_);
+	bind_bool("native_", &native_);
+	bind("C1_", &C1_);
+	bind("C2_", &C2_);
+	bind("D1_", &D1_);
+	bind("D2_", &D2_);
+	bind("requestBackoffLimit_", &requestBackoffLimit_);
+	bind("sessionDelay_", &sessionDelay_);
+
+	Tcl_InitHashTable(&pending_, 2);
+	Tcl_InitHashTable(&old_, 2);
+	/* as initialised in Agent/SRM instproc init */
+	for (int i = 0; i < SRM_NSTATS; i++) {
+		stats_[i].v = -1;
+		stats_[i].isint = 1;
+	}
+	stats_[SRM_REQ_DELAY].v = stats_[SRM_REP_DELAY].v = 0.0;
+	stats_[SRM_REQ_DELAY].isint = stats_[SRM_REP_DELAY].isint = 0;
 }
 
 SRMAgent::~SRMAgent()
 {
 	cleanup();
+	Tcl_HashEntry* he;
+	Tcl_HashSearch hs;
+	for (he = Tcl_FirstHashEntry(&pending_, &hs); he != 0;
+	     he = Tcl_NextHashEntry(&hs)) {
+		SRMRecovery* r = (SRMRecovery*)Tcl_GetHashValue(he);
+		cancel(r, 0);
+		if (r->holdpending_)
+			Scheduler::instance().cancel(&r->holdev_);
+		delete r;
+	}
+	Tcl_DeleteHashTable(&pending_);
+	Tcl_DeleteHashTable(&old_);
+	session_.force_cancel();
+	delete [] trace_;
+	delete [] traceAll_;
 }
 
 int SRMAgent::command(int argc, const char*const* argv)
@@ -145,7 +180,31 @@ int SRMAgent::command(int argc, const char*const* argv)
 		tcl.resultf("%s: invalid send request %s", name_, argv[2]);
 		return TCL_ERROR;
 	}
+	if (strcmp(argv[1], "start-native") == 0 && argc == 6) {
+		/* $agent start-native nid ewma? trace traceAll */
+		nid_ = atoi(argv[2]);
+		ewma_ = atoi(argv[3]);
+		for (int i = 4; i < 6; i++) {
+			char*& t = (i == 4) ? trace_ : traceAll_;
+			delete [] t;
+			t = 0;
+			if (*argv[i] != 0) {
+				t = new char[strlen(argv[i]) + 1];
+				strcpy(t, argv[i]);
+			}
+		}
+		running_ = 1;
+		// SRM/session schedule
+		double fire = sessionDelay_ * uniform(0.9, 1.1);
+		double now = Scheduler::instance().clock();
+		session_.resched(now + fire - now);
+		return TCL_OK;
+	}
 	if (argc == 2) {
+		if (strcmp(argv[1], "native?") == 0) {
+			tcl.result(running_ ? "1" : "0");
+			return TCL_OK;
+		}
 		if (strcmp(argv[1], "distances?") == 0) {
 			tcl.result("");
 			if (sip_->sender_ >= 0) {  // i.e. this agent is active
@@ -163,6 +222,12 @@ int SRMAgent::command(int argc, const char*const* argv)
 		}
 	}
 	if (argc == 3) {
+		if (strcmp(argv[1], "native-trace") == 0) {
+			delete [] trace_;
+			trace_ = new char[strlen(argv[2]) + 1];
+			strcpy(trace_, argv[2]);
+			return TCL_OK;
+		}
 		if (strcmp(argv[1], "distance?") == 0) {
 			int sender = atoi(argv[2]);
 			SRMinfo* sp = get_state(sender);
@@ -282,6 +347,8 @@ void SRMAgent::recv_data(int sender, int msgid, u_char*)
 		(void) request(sp, msgid - 1);
 		sp->setReceived(msgid);
 		sp->ldata_ = msgid;
+	} else if (running_) {
+		native_recv_data(sender, msgid);
 	} else {
 		tcl.evalf("%s recv data %d %d", name_, sender, msgid);
 	}
@@ -294,6 +361,8 @@ void SRMAgent::recv_rqst(int requestor, int round, int sender, int msgid)
 	if (msgid > sp->ldata_) {
 		(void) request(sp, msgid);	// request upto msgid
 		sp->ldata_ = msgid;
+	} else if (running_) {
+		native_recv_rqst(requestor, round, sender, msgid);
 	} else {
 		tcl.evalf("%s recv request %d %d %d %d", name_,
 			  requestor, round, sender, msgid);
@@ -308,6 +377,8 @@ void SRMAgent::recv_repr(int round, int sender, int msgid, u_char*)
 		(void) request(sp, msgid - 1);	// request upto msgid - 1
 		sp->setReceived(msgid);
 		sp->ldata_ = msgid;
+	} else if (running_) {
+		native_recv_repr(round, sender, msgid);
 	} else {
 		tcl.evalf("%s recv repair %d %d %d", name_,
 			  round, sender, msgid);
@@ -407,3 +478,420 @@ void SRMAgent::recv_sess(Packet*, int sessCtr, int* data)
 			sp->ldata_ = dataCnt;
 	}
 }
+
+/*
+ * Native loss recovery.  The methods below do what the srm.tcl
+ * methods named in their comments do, in the same order, so that the
+ * same random numbers are drawn and the same events scheduled as
+ * with the OTcl timers.
+ */
+
+static const char* const srm_stat_names[SRM_NSTATS] = {
+	"dup-req", "ave-dup-req", "dup-rep", "ave-dup-rep",
+	"req-delay", "ave-req-delay", "rep-delay", "ave-rep-delay"
+};
+
+SRMRecovery::SRMRecovery(SRMAgent* a, int type, int sender, int msgid,
+			 int requestor) :
+	agent_(a), type_(type), sender_(sender), msgid_(msgid),
+	requestor_(requestor), round_(0), sent_(0), p1_(0), p2_(0),
+	backoff_(1), backoffCtr_(0), backoffLimit_(0), delay_(0),
+	ignore_(0), ignoring_(0),
+	startTime_(Scheduler::instance().clock()), serviceTime_(-1),
+	distance_(-1), rawdist_(0), scheduled_(0), dupRQST_(0),
+	dupREPR_(0), nsent_(0), nbackoff_(0), evpending_(0),
+	holdpending_(0)
+{
+}
+
+void SRMRecovery::handle(Event* e)
+{
+	if (e == &holdev_) {
+		holdpending_ = 0;
+		agent_->hold_down(this);	// deletes this
+	} else {
+		evpending_ = 0;
+		agent_->expire(this);
+	}
+}
+
+void SRMSessionTimer::expire(Event*)
+{
+	agent_->send_session();
+}
+
+char* SRMAgent::fmtdbl(char* buf, double d)
+{
+	Tcl_PrintDouble(Tcl::instance().interp(), d, buf);
+	return buf;
+}
+
+// the Tcl global alpha, for ewma
+double SRMAgent::alpha()
+{
+	const char* a = Tcl_GetVar(Tcl::instance().interp(), "alpha",
+				   TCL_GLOBAL_ONLY);
+	return (a != 0 ? atof(a) : 0.25);
+}
+
+// RNG instproc uniform
+double SRMAgent::uniform(double a, double b)
+{
+	RNG* rng = RNG::defaultrng();
+	return (a + (b - a) * (rng->uniform_positive_int() * 1.0 / 0x7fffffff));
+}
+
+void SRMAgent::set_stat(int i, double v, int isint)
+{
+	stats_[i].v = v;
+	stats_[i].isint = isint;
+	char buf[TCL_DOUBLE_SPACE];
+	if (isint)
+		sprintf(buf, "%d", (int)v);
+	else
+		fmtdbl(buf, v);
+	Tcl::instance().evalf("%s set stats_(%s) %s", name_,
+			      srm_stat_names[i], buf);
+}
+
+// compute-ave: stats_(ave-$var) is in the slot after stats_($var)
+void SRMAgent::compute_ave(int i)
+{
+	Stat& ave = stats_[i + 1];
+	if (ave.v < 0)
+		set_stat(i + 1, stats_[i].v, stats_[i].isint);
+	else {
+		double a = alpha();
+		set_stat(i + 1, (1 - a) * ave.v + a * stats_[i].v, 0);
+	}
+}
+
+// update-ave
+void SRMAgent::update_ave(int i, double delay)
+{
+	set_stat(i, delay, 0);
+	compute_ave(i);
+}
+
+void SRMAgent::evtrace(SRMRecovery* r, const char* fmt, ...)
+{
+	char body[256], line[512];
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(body, sizeof(body), fmt, ap);
+	va_end(ap);
+	Tcl_Interp* interp = Tcl::instance().interp();
+	double now = Scheduler::instance().clock();
+	Tcl_Channel ch;
+	if (traceAll_ != 0 &&
+	    (ch = Tcl_GetChannel(interp, traceAll_, 0)) != 0) {
+		snprintf(line, sizeof(line), "E %8.6f n %d m <%d:%d> r %d %s\n",
+			 now, nid_, r->sender_, r->msgid_, r->round_, body);
+		Tcl_WriteChars(ch, line, -1);
+	}
+	if (trace_ != 0 && (ch = Tcl_GetChannel(interp, trace_, 0)) != 0) {
+		snprintf(line, sizeof(line), "%7.4f n %d m <%d:%d> r %d %s\n",
+			 now, nid_, r->sender_, r->msgid_, r->round_, body);
+		Tcl_WriteChars(ch, line, -1);
+	}
+}
+
+SRMRecovery* SRMAgent::pending(int sender, int msgid)
+{
+	int key[2];
+	key[0] = sender;
+	key[1] = msgid;
+	Tcl_HashEntry* he = Tcl_FindHashEntry(&pending_, (char*)key);
+	return (he != 0 ? (SRMRecovery*)Tcl_GetHashValue(he) : 0);
+}
+
+// SRM distance?: smooth the distance to node into r's
+double SRMAgent::distance(SRMRecovery* r, int node)
+{
+	// what "$agent distance? node" gives
+	char buf[64];
+	sprintf(buf, "%lf", get_state(node)->distance_);
+	double cur = atof(buf);
+	if (ewma_ && r->distance_ >= 0) {
+		double a = alpha();
+		r->distance_ = (1 - a) * r->distance_ + a * cur;
+		r->rawdist_ = 0;
+	} else {
+		r->distance_ = cur;
+		r->rawdist_ = 1;
+	}
+	return (r->distance_);
+}
+
+char* SRMAgent::fmtdist(char* buf, SRMRecovery* r)
+{
+	if (r->rawdist_)
+		sprintf(buf, "%lf", r->distance_);
+	else
+		fmtdbl(buf, r->distance_);
+	return buf;
+}
+
+// SRM serviceTime
+double SRMAgent::service_time(SRMRecovery* r)
+{
+	r->serviceTime_ = (Scheduler::instance().clock() - r->startTime_) /
+		(2 * r->distance_);
+	return (r->serviceTime_);
+}
+
+// SRM/request and SRM/repair schedule
+void SRMAgent::schedule(SRMRecovery* r)
+{
+	char b1[TCL_DOUBLE_SPACE], b2[TCL_DOUBLE_SPACE], b3[64];
+	double now = Scheduler::instance().clock();
+	double fire;
+	r->round_++;
+	if (r->type_ == SRMRecovery::REQUEST) {
+		double rancomp = r->p1_ + r->p2_ * uniform(0, 1);
+		double dist = distance(r, r->sender_);
+		if (tracing())
+			evtrace(r, "Q INTERVALS C1 %.17g C2 %.17g d %s i %d",
+				r->p1_, r->p2_, fmtdist(b3, r), r->backoff_);
+		double delay = rancomp * dist;
+		// backoff?
+		int backoff = r->backoff_;
+		if (++r->backoffCtr_ <= r->backoffLimit_)
+			r->backoff_ += r->backoff_;
+		r->delay_ = delay * backoff;
+		fire = now + r->delay_;
+		if (tracing())
+			evtrace(r, "Q NTIMER at %s", fmtdbl(b1, fire));
+	} else {
+		double rancomp = r->p1_ + r->p2_ * uniform(0, 1);
+		double dist = distance(r, r->requestor_);
+		if (tracing())
+			evtrace(r, "P INTERVALS D1 %.17g D2 %.17g d %s",
+				r->p1_, r->p2_, fmtdist(b3, r));
+		fire = now + rancomp * dist;
+		if (tracing())
+			evtrace(r, "P RTIMER at %s", fmtdbl(b2, fire));
+	}
+	Scheduler::instance().schedule(r, &r->ev_, fire - now);
+	r->evpending_ = 1;
+	r->scheduled_ = 1;
+}
+
+// SRM/request and SRM/repair cancel; update for types REQUEST and REPAIR
+void SRMAgent::cancel(SRMRecovery* r, int update)
+{
+	if (r->scheduled_) {
+		if (r->evpending_) {
+			Scheduler::instance().cancel(&r->ev_);
+			r->evpending_ = 0;
+		}
+		r->scheduled_ = 0;
+	}
+	if (update && r->round_ == 1)
+		update_ave(r->type_ == SRMRecovery::REQUEST ?
+			   SRM_REQ_DELAY : SRM_REP_DELAY, service_time(r));
+}
+
+// forget r without remembering its round
+void SRMAgent::remove(SRMRecovery* r)
+{
+	int key[2];
+	key[0] = r->sender_;
+	key[1] = r->msgid_;
+	Tcl_HashEntry* he = Tcl_FindHashEntry(&pending_, (char*)key);
+	if (he != 0)
+		Tcl_DeleteHashEntry(he);
+	cancel(r, 0);
+	if (r->holdpending_)
+		Scheduler::instance().cancel(&r->holdev_);
+	delete r;
+}
+
+// Agent/SRM clear
+void SRMAgent::hold_down(SRMRecovery* r)
+{
+	int key[2], isnew;
+	key[0] = r->sender_;
+	key[1] = r->msgid_;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(&old_, (char*)key, &isnew);
+	Tcl_SetHashValue(he, (ClientData)(long)r->round_);
+	remove(r);
+}
+
+// Agent/SRM request, for one msgid
+void SRMAgent::native_request(int sender, int msgid)
+{
+	int key[2], isnew;
+	key[0] = sender;
+	key[1] = msgid;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(&pending_, (char*)key, &isnew);
+	if (!isnew) {
+		fprintf(stderr, "%s: duplicate loss detection in agent\n",
+			name_);
+		exit(1);
+	}
+	SRMRecovery* r = new SRMRecovery(this, SRMRecovery::REQUEST,
+					 sender, msgid, -1);
+	Tcl_SetHashValue(he, (ClientData)r);
+	// set-params
+	Tcl_HashEntry* oe = Tcl_FindHashEntry(&old_, (char*)key);
+	r->round_ = oe != 0 ? (int)(long)Tcl_GetHashValue(oe) : 0;
+	r->p1_ = C1_;
+	r->p2_ = C2_;
+	distance(r, sender);
+	r->backoffLimit_ = requestBackoffLimit_;
+	if (tracing())
+		evtrace(r, "Q DETECT");
+	schedule(r);
+}
+
+// Agent/SRM repair
+void SRMAgent::native_repair(int requestor, int sender, int msgid)
+{
+	int key[2], isnew;
+	key[0] = sender;
+	key[1] = msgid;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(&pending_, (char*)key, &isnew);
+	if (!isnew) {
+		fprintf(stderr, "%s: duplicate repair detection in agent\n",
+			name_);
+		exit(1);
+	}
+	SRMRecovery* r = new SRMRecovery(this, SRMRecovery::REPAIR,
+					 sender, msgid, requestor);
+	Tcl_SetHashValue(he, (ClientData)r);
+	Tcl_HashEntry* oe = Tcl_FindHashEntry(&old_, (char*)key);
+	r->round_ = oe != 0 ? (int)(long)Tcl_GetHashValue(oe) : 0;
+	r->p1_ = D1_;
+	r->p2_ = D2_;
+	distance(r, requestor);
+	if (tracing())
+		evtrace(r, "P NACK from %d", requestor);
+	schedule(r);
+	// mark-period dup-rep
+	compute_ave(SRM_DUP_REP);
+	set_stat(SRM_DUP_REP, 0, 1);
+}
+
+// SRM/request send-request, SRM/repair send-repair
+void SRMAgent::expire(SRMRecovery* r)
+{
+	if (r->type_ == SRMRecovery::REQUEST) {
+		if (tracing())
+			evtrace(r, "Q SENDNACK");
+		send_ctrl(SRM_RQST, r->round_, r->sender_, r->msgid_, 0);
+	} else {
+		if (tracing())
+			evtrace(r, "P SENDREP");
+		send_ctrl(SRM_REPR, r->round_, r->sender_, r->msgid_,
+			  packetSize_);
+	}
+	r->nsent_++;
+	r->sent_ = r->round_;
+}
+
+// SRM/request and SRM/repair recv-request
+void SRMAgent::heard_request(SRMRecovery* r)
+{
+	double now = Scheduler::instance().clock();
+	if (r->type_ == SRMRecovery::REPAIR ||
+	    (r->ignoring_ && now < r->ignore_)) {
+		r->dupRQST_++;
+		return;
+	}
+	cancel(r, 1);
+	schedule(r);
+	r->ignore_ = now + (r->delay_ / 2);
+	r->ignoring_ = 1;
+	r->nbackoff_++;
+	if (tracing()) {
+		char buf[TCL_DOUBLE_SPACE];
+		evtrace(r, "Q NACK IGNORE-BACKOFF %s", fmtdbl(buf, r->ignore_));
+	}
+}
+
+// SRM/request and SRM/repair recv-repair
+void SRMAgent::heard_repair(SRMRecovery* r)
+{
+	if (!r->scheduled_) {
+		// in the hold-down period
+		r->dupREPR_++;
+		return;
+	}
+	double now = Scheduler::instance().clock();
+	double hold;
+	if (r->type_ == SRMRecovery::REQUEST) {
+		service_time(r);
+		hold = r->ignore_ = now + 3 * distance(r, r->sender_);
+		r->ignoring_ = 1;
+	} else
+		hold = now + 3 * distance(r, r->requestor_);
+	if (r->holdpending_)
+		Scheduler::instance().cancel(&r->holdev_);
+	Scheduler::instance().schedule(r, &r->holdev_, hold - now);
+	r->holdpending_ = 1;
+	cancel(r, 1);
+	if (tracing()) {
+		char buf[TCL_DOUBLE_SPACE];
+		evtrace(r, "%s REPAIR IGNORES %s",
+			r->type_ == SRMRecovery::REQUEST ? "Q" : "P",
+			fmtdbl(buf, hold));
+	}
+}
+
+// Agent/SRM recv-data
+void SRMAgent::native_recv_data(int sender, int msgid)
+{
+	SRMRecovery* r = pending(sender, msgid);
+	if (r == 0) {
+		// a very late data of some weird sort
+		fprintf(stderr, "%s: data <%d:%d> with nothing pending\n",
+			name_, sender, msgid);
+		exit(1);
+	}
+	if (r->round_ == 1) {
+		cancel(r, 0);
+		if (tracing())
+			evtrace(r, "Q DATA");
+		remove(r);
+	} else
+		heard_repair(r);
+}
+
+// Agent/SRM recv-request
+void SRMAgent::native_recv_rqst(int requestor, int round, int sender,
+				int msgid)
+{
+	SRMRecovery* r = pending(sender, msgid);
+	if (r == 0) {
+		native_repair(requestor, sender, msgid);
+		return;
+	}
+	// dup-request?
+	if (round == 1 && r->type_ == SRMRecovery::REQUEST &&
+	    r->round_ == 2 && r->ignoring_ &&
+	    Scheduler::instance().clock() <= r->ignore_)
+		set_stat(SRM_DUP_REQ, stats_[SRM_DUP_REQ].v + 1, 1);
+	heard_request(r);
+}
+
+// Agent/SRM recv-repair
+void SRMAgent::native_recv_repr(int round, int sender, int msgid)
+{
+	SRMRecovery* r = pending(sender, msgid);
+	if (r == 0)
+		return;
+	// dup-repair?
+	if (round == 1 && r->type_ == SRMRecovery::REPAIR && r->round_ == 1)
+		set_stat(SRM_DUP_REP, stats_[SRM_DUP_REP].v + 1, 1);
+	heard_repair(r);
+}
+
+// SRM/session send-session and schedule
+void SRMAgent::send_session()
+{
+	send_sess();
+	double fire = sessionDelay_ * uniform(0.9, 1.1);
+	double now = Scheduler::instance().clock();
+	session_.resched(now + fire - now);
+}
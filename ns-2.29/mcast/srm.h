@@ -60,9 +60,67 @@
 
 #include "config.h"
 //#include "heap.h"
+#include "timer-handler.h"
 #include "srm-state.h"
 #include "srm-headers.h"
 
+class SRMAgent;
+
+/*
+ * A request or repair pending at an agent that runs its loss recovery
+ * natively (native_): the state of an SRM/request or SRM/repair object
+ * in srm.tcl, whose methods the agent implements.  ev_ is the request
+ * or repair timer (eventID_), holdev_ the end of the hold-down period
+ * after a repair, when the agent forgets it.
+ */
+class SRMRecovery : public Handler {
+public:
+	enum { REQUEST, REPAIR };
+	SRMRecovery(SRMAgent* a, int type, int sender, int msgid,
+		    int requestor);
+	void handle(Event* e);
+
+	SRMAgent* agent_;
+	int	type_;
+	int	sender_;
+	int	msgid_;
+	int	requestor_;
+	int	round_;
+	int	sent_;
+	double	p1_, p2_;		/* C1_ C2_, or D1_ D2_ */
+	int	backoff_;
+	int	backoffCtr_;
+	int	backoffLimit_;
+	double	delay_;
+	double	ignore_;
+	int	ignoring_;		/* ignore_ is set */
+	double	startTime_;
+	double	serviceTime_;
+	double	distance_;		/* smoothed distance; -1 at first */
+	int	rawdist_;		/* distance_ as "distance?" gave it */
+	int	scheduled_;		/* eventID_ exists */
+	int	dupRQST_, dupREPR_, nsent_, nbackoff_;
+	Event	ev_;
+	Event	holdev_;
+	int	evpending_;
+	int	holdpending_;
+};
+
+class SRMSessionTimer : public TimerHandler {
+public:
+	SRMSessionTimer(SRMAgent* a) : agent_(a) {}
+protected:
+	virtual void expire(Event*);
+	SRMAgent* agent_;
+};
+
+/* the counters of stats_ in srm.tcl */
+enum {
+	SRM_DUP_REQ, SRM_AVE_DUP_REQ, SRM_DUP_REP, SRM_AVE_DUP_REP,
+	SRM_REQ_DELAY, SRM_AVE_REQ_DELAY, SRM_REP_DELAY, SRM_AVE_REP_DELAY,
+	SRM_NSTATS
+};
+
 class SRMAgent : public Agent {
 protected:
 	int	dataCtr_;		/* # of data packets sent */
@@ -75,6 +133,57 @@ protected:
 	int app_fid_;
 	packet_t app_type_;
 
+	/*
+	 * Native loss recovery: the timers of srm.tcl run here instead of
+	 * in OTcl objects, for agents that use the stock request, repair
+	 * and session functions.  "start" in srm.tcl turns it on.
+	 */
+	int	native_;		/* set by Tcl, used at start */
+	int	running_;		/* native recovery is on */
+	double	C1_, C2_, D1_, D2_;
+	int	requestBackoffLimit_;
+	double	sessionDelay_;
+	int	ewma_;			/* distanceCompute_ is ewma */
+	int	nid_;
+	char*	trace_;			/* trace_ of the agent ... */
+	char*	traceAll_;		/* ... and of the simulator */
+	Tcl_HashTable pending_;		/* SRMRecovery by sender, msgid */
+	Tcl_HashTable old_;		/* round of those done with */
+	SRMSessionTimer session_;
+	struct Stat {
+		double	v;
+		int	isint;
+	} stats_[SRM_NSTATS];
+
+	SRMRecovery* pending(int sender, int msgid);
+	void native_request(int sender, int msgid);
+	void native_repair(int requestor, int sender, int msgid);
+	void native_recv_data(int sender, int msgid);
+	void native_recv_rqst(int requestor, int round, int sender,
+			      int msgid);
+	void native_recv_repr(int round, int sender, int msgid);
+	void heard_request(SRMRecovery* r);
+	void heard_repair(SRMRecovery* r);
+	void schedule(SRMRecovery* r);
+	void cancel(SRMRecovery* r, int update);
+	double distance(SRMRecovery* r, int node);
+	double service_time(SRMRecovery* r);
+	void remove(SRMRecovery* r);
+	void set_stat(int i, double v, int isint);
+	void compute_ave(int i);
+	void update_ave(int i, double delay);
+	double alpha();
+	double uniform(double a, double b);
+	inline int tracing() const { return (trace_ != 0 || traceAll_ != 0); }
+	void evtrace(SRMRecovery* r, const char* fmt, ...);
+	static char* fmtdbl(char* buf, double d);
+	char* fmtdist(char* buf, SRMRecovery* r);
+public:
+	void expire(SRMRecovery* r);
+	void hold_down(SRMRecovery* r);
+	void send_session();
+protected:
+
 	virtual void start() {
 		int new_entry = 0;
 		long key = addr();
@@ -118,6 +227,18 @@ protected:
 		int miss = 0;
 		if (sp->ldata_ >= hi)
 			return miss;
+		if (running_) {
+			for (int i = sp->ldata_ + 1; i <= hi; i++)
+				if (! sp->ifReceived(i)) {
+					native_request(sp->sender_, i);
+					miss++;
+				}
+			assert(miss);
+			// mark-period dup-req
+			compute_ave(SRM_DUP_REQ);
+			set_stat(SRM_DUP_REQ, 0, 1);
+			return miss;
+		}
 		
 		int maxsize = ((int)log10(hi + 1) + 2) * (hi - sp->ldata_);
 				// 1 + log10(msgid) bytes for the msgid
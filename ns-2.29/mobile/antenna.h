@@ -49,6 +49,7 @@ LIST_HEAD(an_head, Antenna);
 class Antenna : public TclObject {
 
 public:
+  MEM_ACCOUNT(MEM_OBJECT)
   Antenna();
   
   virtual double getTxGain(double /*dX*/, double /*dY*/, double /*dZ*/,
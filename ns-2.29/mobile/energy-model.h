@@ -47,6 +47,7 @@
 #include "config.h"
 #include "trace.h"
 #include "rng.h"
+#include "mem-account.h"
 
 const int CHECKFREQ = 1;
 const int MAX_WAITING_TIME = 11;
@@ -87,6 +88,7 @@ protected:
 class MobileNode;
 class EnergyModel : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	EnergyModel(MobileNode* n, double energy, double l1, double l2) :
 		energy_(energy), er_(0), et_(0),ei_(0), es_(0), 
 		initialenergy_(energy), 
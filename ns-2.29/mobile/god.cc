@@ -916,10 +916,10 @@ God::command(int argc, const char* const* argv)
 			
 			printf("num_nodes is set %d\n", num_nodes);
 			
-                        min_hops = new int[num_nodes * num_nodes];
+                        min_hops = mem_new<int>(MEM_ROUTE, num_nodes * num_nodes);
 			mb_node = new MobileNode*[num_nodes];
 			node_status = new NodeStatus[num_nodes];
-			next_hop = new int[num_nodes * num_nodes];
+			next_hop = mem_new<int>(MEM_ROUTE, num_nodes * num_nodes);
 
                         bzero((char*) min_hops,
                               sizeof(int) * num_nodes * num_nodes);
@@ -971,7 +971,7 @@ God::command(int argc, const char* const* argv)
                         // allow for 0 based to 1 based conversion
                         num_nodes = atoi(argv[2]) + 1;
 
-                        min_hops = new int[num_nodes * num_nodes];
+                        min_hops = mem_new<int>(MEM_ROUTE, num_nodes * num_nodes);
                         bzero((char*) min_hops,
                               sizeof(int) * num_nodes * num_nodes);
 
@@ -12,6 +12,7 @@
 
 
 #include "mobilenode.h"
+#include "mem-account.h"
 
 #define MIN(a,b) (((a)>(b))?(b):(a))
 #define MAX(a,b) (((a)<(b))?(b):(a))
@@ -27,6 +28,7 @@ class GridHandler : public Handler {
 class GridKeeper : public TclObject {
 
 public:
+  MEM_ACCOUNT(MEM_OBJECT)
   GridKeeper();
   ~GridKeeper();
   int command(int argc, const char*const* argv);
@@ -48,6 +48,7 @@
 #include <phy.h>
 #include <wireless-phy.h>
 #include <packet-stamp.h>
+#include "mem-account.h"
 
 class PacketStamp;
 class WirelessPhy;
@@ -67,6 +68,7 @@ class WirelessPhy;
 class Propagation : public TclObject {
 
 public:
+  MEM_ACCOUNT(MEM_OBJECT)
   Propagation() : name(NULL), topo(NULL) {}
 
   // calculate the Pr by which the receiver will get a packet sent by
@@ -42,10 +42,12 @@
 
 #include <object.h>
 #include "channel.h"
+#include "mem-account.h"
 
 class Topography : public TclObject {
 
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Topography() { maxX = maxY = grid_resolution = 0.0; grid = 0; }
 
 	/* List-keeper */
@@ -51,11 +51,12 @@ static const char rcsid[] =
 #include "config.h"   // for string.h
 #include <stdlib.h>
 #include "queue.h"
+#include "flowtable.h"
 
 class PacketDRR;
 class DRR;
 
-class PacketDRR : public PacketQueue {
+class PacketDRR : public FlowEntry {
 	PacketDRR(): pkts(0),src(-1),bcount(0),prev(0),next(0),deficitCounter(0),turn(0) {}
 	friend class DRR;
 	protected :
@@ -95,22 +96,27 @@ class PacketDRR : public PacketQueue {
 class DRR : public Queue {
 	public :
 	DRR();
+	~DRR();
 	virtual int command(int argc, const char*const* argv);
 	Packet *deque(void);
 	void enque(Packet *pkt);
 	int hash(Packet *pkt);
 	void clear();
 protected:
+	PacketDRR *flow(Packet *pkt);
 	int buckets_ ; //total number of flows allowed
 	int blimit_;    //total number of bytes allowed across all flows
 	int quantum_;  //total number of bytes that a flow can send
 	int mask_;     /*if set hashes on just the node address otherwise on 
 			 node+port address*/
+	int exact_;    /*if set, one queue per 5-tuple instead of buckets_*/
 	int bytecnt ; //cumulative sum of bytes across all flows
 	int pktcnt ; // cumulative sum of packets across all flows
 	int flwcnt ; //total number of active flows
 	PacketDRR *curr; //current active flow
 	PacketDRR *drr ; //pointer to the entire drr struct
+	QueueFlowTable *flows_; //flows by 5-tuple, when exact_
+	LongestQueue longest_; //backlogged flows by size, when exact_
 
 	inline PacketDRR *getMaxflow (PacketDRR *curr) { //returns flow with max pkts
 		int i;
@@ -153,10 +159,35 @@ DRR::DRR()
 	bytecnt=0;
 	pktcnt=0;
 	mask_=0;
+	exact_=0;
+	flows_=0;
 	bind("buckets_",&buckets_);
 	bind("blimit_",&blimit_);
 	bind("quantum_",&quantum_);
 	bind("mask_",&mask_);
+	bind_bool("exact_",&exact_);
+}
+
+DRR::~DRR()
+{
+	delete flows_;
+	delete[](drr);
+}
+
+/*
+ * The queue of pkt's flow when exact_ is set, created on first use.
+ */
+PacketDRR *DRR::flow(Packet *pkt)
+{
+	if (!flows_)
+		flows_=new QueueFlowTable;
+	PacketDRR *q=(PacketDRR *)flows_->lookup(pkt,mask_);
+	if (!q) {
+		q=new PacketDRR;
+		q->setkey(pkt,mask_);
+		flows_->insert(q);
+	}
+	return q;
 }
  
 void DRR::enque(Packet* pkt)
@@ -166,24 +197,34 @@ void DRR::enque(Packet* pkt)
 
 	hdr_cmn *ch= hdr_cmn::access(pkt);
 	hdr_ip *iph = hdr_ip::access(pkt);
-	if (!drr)
-		drr=new PacketDRR[buckets_];
-	which= hash(pkt) % buckets_;
-	q=&drr[which];
+	if (exact_)
+		q=flow(pkt);
+	else {
+		if (!drr)
+			drr=new PacketDRR[buckets_];
+		which= hash(pkt) % buckets_;
+		q=&drr[which];
 
-	/*detect collisions here */
-	int compare=(!mask_ ? ((int)iph->saddr()) : ((int)iph->saddr()&0xfff0));
-	if (q->src ==-1)
-		q->src=compare;
-	else
-		if (q->src != compare)
-			fprintf(stderr,"Collisions between %d and %d src addresses\n",q->src,(int)iph->saddr());      
+		/*detect collisions here */
+		int compare=(!mask_ ? ((int)iph->saddr()) : ((int)iph->saddr()&0xfff0));
+		if (q->src ==-1) {
+			q->src=compare;
+			q->setkey(pkt,mask_);
+		}
+		else
+			if (q->src != compare)
+				fprintf(stderr,"Collisions between %d and %d src addresses\n",q->src,(int)iph->saddr());      
+	}
 
 	q->enque(pkt);
 	++q->pkts;
 	++pktcnt;
 	q->bcount += ch->size();
 	bytecnt +=ch->size();
+	++q->arrivals_;
+	q->bytes_in_ += ch->size();
+	if (exact_)
+		longest_.update(q,q->bcount);
 
 
 	if (q->pkts==1)
@@ -191,23 +232,30 @@ void DRR::enque(Packet* pkt)
 			curr = q->activate(curr);
 			q->deficitCounter=0;
 			++flwcnt;
+			if (exact_)
+				flows_->busy(q);
 		}
 	while (bytecnt > blimit_) {
 		Packet *p;
 		hdr_cmn *remch;
 		hdr_ip *remiph;
-		remq=getMaxflow(curr);
+		remq=(exact_ ? (PacketDRR *)longest_.longest() : getMaxflow(curr));
 		p=remq->deque();
 		remch=hdr_cmn::access(p);
 		remiph=hdr_ip::access(p);
 		remq->bcount -= remch->size();
 		bytecnt -= remch->size();
+		++remq->drops_;
+		if (exact_)
+			longest_.update(remq,remq->bcount);
 		drop(p);
 		--remq->pkts;
 		--pktcnt;
 		if (remq->pkts==0) {
 			curr=remq->idle(curr);
 			--flwcnt;
+			if (exact_)
+				flows_->idle(remq);
 		}
 	}
 }
@@ -238,11 +286,17 @@ Packet *DRR::deque(void)
 			--curr->pkts;
 			--pktcnt;
 			bytecnt -= ch->size();
+			++curr->departures_;
+			if (exact_)
+				longest_.update(curr,curr->bcount);
 			if (curr->pkts == 0) {
+				PacketDRR *q=curr;
 				curr->turn=0;
 				--flwcnt;
 				curr->deficitCounter=0;
 				curr=curr->idle(curr);
+				if (exact_)
+					flows_->idle(q);
 			}
 			return pkt;
 		}
@@ -277,9 +331,45 @@ void DRR::clear()
  *Allows one to change blimit_ and bucket_ for a particular drrQ :
  *
  *
+ * $drr flow-stats returns one {src sport dst dport fid arrivals
+ * departures drops bytes} list per flow (per bucket unless exact_);
+ * $drr nflows the number of flows (buckets) held.
  */
 int DRR::command(int argc, const char*const* argv)
 {
+	Tcl& tcl = Tcl::instance();
+	if (argc==2) {
+		if (strcmp(argv[1], "flow-stats") == 0) {
+			char buf[128];
+			if (exact_) {
+				for (FlowEntry *f=(flows_ ? flows_->first() : 0); f;
+				     f=QueueFlowTable::next(f)) {
+					f->stats(buf);
+					Tcl_AppendElement(tcl.interp(), buf);
+				}
+			} else if (drr) {
+				for (int i=0; i < buckets_; i++) {
+					if (drr[i].arrivals_ == 0)
+						continue;
+					drr[i].stats(buf);
+					Tcl_AppendElement(tcl.interp(), buf);
+				}
+			}
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "nflows") == 0) {
+			int n=0;
+			if (exact_)
+				n=(flows_ ? flows_->nflows() : 0);
+			else if (drr) {
+				for (int i=0; i < buckets_; i++)
+					if (drr[i].arrivals_)
+						++n;
+			}
+			tcl.resultf("%d", n);
+			return (TCL_OK);
+		}
+	}
 	if (argc==3) {
 		if (strcmp(argv[1], "blimit") == 0) {
 			blimit_ = atoi(argv[2]);
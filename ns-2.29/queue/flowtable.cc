@@ -0,0 +1,321 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Exact per-flow state for the multi-queue schedulers; see flowtable.h.
+ */
+
+#ifndef lint
+static const char rcsid[] =
+    "@(#) $Header$";
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "flowtable.h"
+
+static inline u_int32_t
+keyhash(int src, int sport, int dst, int dport, int fid)
+{
+	u_int32_t h = (u_int32_t)src * 0x9e3779b1;
+	h = (h ^ (u_int32_t)sport) * 0x85ebca6b;
+	h = (h ^ (u_int32_t)dst) * 0xc2b2ae35;
+	h = (h ^ (u_int32_t)dport) * 0x9e3779b1;
+	h = (h ^ (u_int32_t)fid) * 0x85ebca6b;
+	return (h ^ (h >> 16));
+}
+
+/*
+ * With srconly set a flow is everything from one node, the source
+ * address with its port bits masked off as DRR's mask_ has always done.
+ */
+void FlowEntry::setkey(Packet* p, int srconly)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	if (srconly) {
+		src_ = (int)iph->saddr() & 0xfff0;
+		sport_ = dst_ = dport_ = fid_ = 0;
+	} else {
+		src_ = (int)iph->saddr();
+		sport_ = iph->sport();
+		dst_ = (int)iph->daddr();
+		dport_ = iph->dport();
+		fid_ = iph->flowid();
+	}
+	hash_ = keyhash(src_, sport_, dst_, dport_, fid_);
+}
+
+int FlowEntry::match(Packet* p, int srconly)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	if (srconly)
+		return (src_ == ((int)iph->saddr() & 0xfff0));
+	return (src_ == (int)iph->saddr() && sport_ == iph->sport() &&
+		dst_ == (int)iph->daddr() && dport_ == iph->dport() &&
+		fid_ == iph->flowid());
+}
+
+/*
+ * One "src sport dst dport fid arrivals departures drops bytes" line
+ * into buf, which must hold 128 bytes.
+ */
+int FlowEntry::stats(char* buf)
+{
+	return (sprintf(buf, "%d %d %d %d %d %d %d %d %.0f", src_, sport_,
+			dst_, dport_, fid_, arrivals_, departures_, drops_,
+			bytes_in_));
+}
+
+u_int32_t QueueFlowTable::hash(Packet* p, int srconly)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	if (srconly)
+		return (keyhash((int)iph->saddr() & 0xfff0, 0, 0, 0, 0));
+	return (keyhash((int)iph->saddr(), iph->sport(), (int)iph->daddr(),
+			iph->dport(), iph->flowid()));
+}
+
+QueueFlowTable::QueueFlowTable() : nbucket_(64), nflows_(0), head_(0),
+	tail_(0), idle_(0), nidle_(0)
+{
+	tab_ = new FlowEntry*[nbucket_];
+	memset(tab_, 0, nbucket_ * sizeof(FlowEntry*));
+}
+
+QueueFlowTable::~QueueFlowTable()
+{
+	FlowEntry* f = head_;
+	while (f != 0) {
+		FlowEntry* n = f->fnext_;
+		delete f;
+		f = n;
+	}
+	delete [] tab_;
+}
+
+FlowEntry* QueueFlowTable::lookup(Packet* p, int srconly)
+{
+	u_int32_t h = hash(p, srconly);
+	for (FlowEntry* f = tab_[h & (nbucket_ - 1)]; f != 0; f = f->hnext_)
+		if (f->hash_ == h && f->match(p, srconly))
+			return (f);
+	return (0);
+}
+
+/*
+ * Add a flow whose key has been set with setkey().  The table takes
+ * ownership of it.
+ */
+void QueueFlowTable::insert(FlowEntry* f)
+{
+	if (++nflows_ > nbucket_)
+		grow();
+	FlowEntry** b = &tab_[f->hash_ & (nbucket_ - 1)];
+	f->hnext_ = *b;
+	*b = f;
+	f->fnext_ = 0;
+	f->fprev_ = tail_;
+	if (tail_ != 0)
+		tail_->fnext_ = f;
+	else
+		head_ = f;
+	tail_ = f;
+}
+
+/*
+ * f has nothing queued: the table may delete it from now on, until
+ * busy(f) is called.  The scheduler must hold no pointer to it.
+ */
+void QueueFlowTable::idle(FlowEntry* f)
+{
+	if (f->idle_)
+		return;
+	f->idle_ = 1;
+	f->iprev_ = 0;
+	f->inext_ = idle_;
+	if (idle_ != 0)
+		idle_->iprev_ = f;
+	idle_ = f;
+	if (++nidle_ >= FLOW_SWEEP && 2 * nidle_ >= nflows_)
+		sweep();
+}
+
+void QueueFlowTable::busy(FlowEntry* f)
+{
+	if (!f->idle_)
+		return;
+	f->idle_ = 0;
+	if (f->iprev_ != 0)
+		f->iprev_->inext_ = f->inext_;
+	else
+		idle_ = f->inext_;
+	if (f->inext_ != 0)
+		f->inext_->iprev_ = f->iprev_;
+	--nidle_;
+}
+
+void QueueFlowTable::remove(FlowEntry* f)
+{
+	FlowEntry** b = &tab_[f->hash_ & (nbucket_ - 1)];
+	while (*b != f)
+		b = &(*b)->hnext_;
+	*b = f->hnext_;
+	if (f->fprev_ != 0)
+		f->fprev_->fnext_ = f->fnext_;
+	else
+		head_ = f->fnext_;
+	if (f->fnext_ != 0)
+		f->fnext_->fprev_ = f->fprev_;
+	else
+		tail_ = f->fprev_;
+	--nflows_;
+}
+
+/* Delete the idle flows. */
+void QueueFlowTable::sweep()
+{
+	while (idle_ != 0) {
+		FlowEntry* f = idle_;
+		idle_ = f->inext_;
+		remove(f);
+		delete f;
+	}
+	nidle_ = 0;
+}
+
+void QueueFlowTable::grow()
+{
+	int n = nbucket_ << 1;
+	FlowEntry** tab = new FlowEntry*[n];
+	memset(tab, 0, n * sizeof(FlowEntry*));
+	for (FlowEntry* f = head_; f != 0; f = f->fnext_) {
+		FlowEntry** b = &tab[f->hash_ & (n - 1)];
+		f->hnext_ = *b;
+		*b = f;
+	}
+	delete [] tab_;
+	tab_ = tab;
+	nbucket_ = n;
+}
+
+/* The highest bit set in w, which is not 0. */
+static inline int
+highbit(u_int32_t w)
+{
+	int b = 0;
+	if (w & 0xffff0000) { w >>= 16; b += 16; }
+	if (w & 0xff00) { w >>= 8; b += 8; }
+	if (w & 0xf0) { w >>= 4; b += 4; }
+	if (w & 0xc) { w >>= 2; b += 2; }
+	if (w & 0x2) b += 1;
+	return (b);
+}
+
+LongestQueue::LongestQueue() : nlevel_(32), depth_(1)
+{
+	level_ = new FlowEntry*[nlevel_];
+	memset(level_, 0, nlevel_ * sizeof(FlowEntry*));
+	map_[0] = new u_int32_t[1];
+	map_[0][0] = 0;
+}
+
+LongestQueue::~LongestQueue()
+{
+	delete [] level_;
+	for (int d = 0; d < depth_; d++)
+		delete [] map_[d];
+}
+
+/* Level l has just become non-empty. */
+void LongestQueue::mark(int l)
+{
+	for (int d = 0; d < depth_; d++) {
+		u_int32_t w = map_[d][l >> 5];
+		map_[d][l >> 5] = w | (1U << (l & 31));
+		if (w != 0)
+			break;
+		l >>= 5;
+	}
+}
+
+/* Level l has just emptied. */
+void LongestQueue::unmark(int l)
+{
+	for (int d = 0; d < depth_; d++) {
+		u_int32_t w = map_[d][l >> 5] & ~(1U << (l & 31));
+		map_[d][l >> 5] = w;
+		if (w != 0)
+			break;
+		l >>= 5;
+	}
+}
+
+/* Make room for level l, with 32 times as many levels at a time. */
+void LongestQueue::grow(int l)
+{
+	int n = nlevel_, depth = depth_;
+	while (n <= l && depth < LQ_MAXDEPTH) {
+		n <<= 5;
+		depth++;
+	}
+	FlowEntry** lv = new FlowEntry*[n];
+	memcpy(lv, level_, nlevel_ * sizeof(FlowEntry*));
+	memset(lv + nlevel_, 0, (n - nlevel_) * sizeof(FlowEntry*));
+	delete [] level_;
+	for (int d = 0; d < depth_; d++)
+		delete [] map_[d];
+	level_ = lv;
+	nlevel_ = n;
+	depth_ = depth;
+	for (int d = 0, w = n >> 5; d < depth_; d++, w >>= 5) {
+		map_[d] = new u_int32_t[w];
+		memset(map_[d], 0, w * sizeof(u_int32_t));
+	}
+	for (int i = 1; i < nlevel_; i++)
+		if (level_[i] != 0)
+			mark(i);
+}
+
+void LongestQueue::unlink(FlowEntry* f)
+{
+	if (f->bprev_ != 0)
+		f->bprev_->bnext_ = f->bnext_;
+	else if ((level_[f->level_] = f->bnext_) == 0)
+		unmark(f->level_);
+	if (f->bnext_ != 0)
+		f->bnext_->bprev_ = f->bprev_;
+	f->bprev_ = f->bnext_ = 0;
+	f->level_ = 0;
+}
+
+/* Record that flow f now holds bytes bytes. */
+void LongestQueue::update(FlowEntry* f, int bytes)
+{
+	int l = (bytes + FLOW_GRANULE - 1) >> FLOW_GRANULE_SHIFT;
+	if (l == f->level_)
+		return;
+	if (f->level_ != 0)
+		unlink(f);
+	if (l > 0) {
+		if (l >= nlevel_)
+			grow(l);
+		if (l >= nlevel_)
+			l = nlevel_ - 1;
+		f->level_ = l;
+		f->bnext_ = level_[l];
+		if (f->bnext_ != 0)
+			f->bnext_->bprev_ = f;
+		else
+			mark(l);
+		level_[l] = f;
+	}
+}
+
+/* A flow with (about) the largest backlog, or 0 if none is backlogged. */
+FlowEntry* LongestQueue::longest()
+{
+	int l = 0;
+	if (map_[depth_ - 1][0] == 0)
+		return (0);
+	for (int d = depth_ - 1; d >= 0; d--)
+		l = (l << 5) | highbit(map_[d][l]);
+	return (level_[l]);
+}
@@ -0,0 +1,116 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Exact per-flow state for the multi-queue schedulers (DRR, SFQ).
+ *
+ * A QueueFlowTable maps the 5-tuple of a packet (source and destination
+ * address and port, flow id) to a FlowEntry, the per-flow packet queue
+ * of the scheduler.  The table is an open hash that doubles whenever
+ * it holds more flows than buckets, so lookups stay constant time as
+ * the number of flows grows and distinct flows never share a queue.
+ * The scheduler reports flows that empty with idle(); once there are
+ * as many of them as other flows (and at least FLOW_SWEEP), they are
+ * deleted, counters included.
+ *
+ * A LongestQueue keeps the backlogged flows in lists indexed by their
+ * backlog in FLOW_GRANULE byte units, with a bitmap of the non-empty
+ * lists and a bitmap of the non-zero words above it, and so on up to a
+ * single word.  The flow to drop from when a shared buffer overflows
+ * is found by following the highest bits down, without looking at
+ * every flow or level.  It is within FLOW_GRANULE bytes of the longest.
+ */
+
+#ifndef ns_flowtable_h
+#define ns_flowtable_h
+
+#include "queue.h"
+
+#define FLOW_GRANULE_SHIFT 6
+#define FLOW_GRANULE (1 << FLOW_GRANULE_SHIFT)
+#define FLOW_SWEEP 64
+#define LQ_MAXDEPTH 6		/* 32^6 levels, more than any buffer */
+
+class QueueFlowTable;
+class LongestQueue;
+
+class FlowEntry : public PacketQueue {
+	friend class QueueFlowTable;
+	friend class LongestQueue;
+public:
+	FlowEntry() : src_(-1), dst_(-1), sport_(-1), dport_(-1), fid_(-1),
+		arrivals_(0), departures_(0), drops_(0), bytes_in_(0),
+		hash_(0), hnext_(0), fnext_(0), fprev_(0),
+		idle_(0), iprev_(0), inext_(0),
+		level_(0), bprev_(0), bnext_(0) {}
+	void setkey(Packet* p, int srconly);
+	int match(Packet* p, int srconly);
+	int stats(char* buf);
+
+	/* identity */
+	int src_;
+	int dst_;
+	int sport_;
+	int dport_;
+	int fid_;
+
+	/* counters */
+	int arrivals_;
+	int departures_;
+	int drops_;
+	double bytes_in_;
+protected:
+	u_int32_t hash_;
+	FlowEntry* hnext_;		/* hash chain */
+	FlowEntry* fnext_;		/* every flow, in order of creation */
+	FlowEntry* fprev_;
+	int idle_;			/* on the idle list */
+	FlowEntry* iprev_;
+	FlowEntry* inext_;
+	int level_;			/* backlog list we are on, 0 if none */
+	FlowEntry* bprev_;
+	FlowEntry* bnext_;
+};
+
+class QueueFlowTable {
+public:
+	QueueFlowTable();
+	~QueueFlowTable();
+	FlowEntry* lookup(Packet* p, int srconly);
+	void insert(FlowEntry* f);
+	void idle(FlowEntry* f);
+	void busy(FlowEntry* f);
+	int nflows() const { return (nflows_); }
+	FlowEntry* first() const { return (head_); }
+	static FlowEntry* next(FlowEntry* f) { return (f->fnext_); }
+	static u_int32_t hash(Packet* p, int srconly);
+protected:
+	void grow();
+	void remove(FlowEntry* f);
+	void sweep();
+	FlowEntry** tab_;
+	int nbucket_;			/* power of two */
+	int nflows_;
+	FlowEntry* head_;
+	FlowEntry* tail_;
+	FlowEntry* idle_;		/* flows with nothing queued */
+	int nidle_;
+};
+
+class LongestQueue {
+public:
+	LongestQueue();
+	~LongestQueue();
+	void update(FlowEntry* f, int bytes);
+	FlowEntry* longest();
+protected:
+	void unlink(FlowEntry* f);
+	void mark(int l);
+	void unmark(int l);
+	void grow(int l);
+	FlowEntry** level_;		/* level_[i]: flows with i granules */
+	int nlevel_;			/* 32^depth_ */
+	int depth_;
+	u_int32_t* map_[LQ_MAXDEPTH];	/* map_[0]: a bit per level, map_[d]:
+					   a bit per word of map_[d-1] */
+};
+
+#endif
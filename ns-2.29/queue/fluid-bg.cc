@@ -0,0 +1,199 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Fluid model of background traffic on a link; see fluid-bg.h.
+ */
+
+#ifndef lint
+static const char rcsid[] =
+    "@(#) $Header$";
+#endif
+
+#include <math.h>
+#include "fluid-bg.h"
+
+static class FluidBackgroundClass : public TclClass {
+public:
+	FluidBackgroundClass() : TclClass("FluidBackground") {}
+	TclObject* create(int, const char*const*) {
+		return (new FluidBackground);
+	}
+} class_fluid_background;
+
+void FluidUpdateTimer::expire(Event*)
+{
+	fb_->update();
+}
+
+FluidBackground::FluidBackground() : W_(1), qbg_(0), avg_(0), p_(0),
+	bgrate_(0), served_(0), fgrate_(0), slot_(0), fgbytes_(0), fgdrops_(0),
+	updates_(0), last_(0), lastarr_(0), queue_(0), timer_(this)
+{
+	rng_ = ownrng_ = new RNG;
+	bind("nflows_", &nflows_);
+	bind_time("rtt_", &rtt_);
+	bind("pktsize_", &pktsize_);
+	bind("window_", &window_);
+	bind_bw("rate_", &rate_);
+	bind_time("dt_", &dt_);
+	bind_bw("bandwidth_", &bandwidth_);
+	bind("limit_", &limit_);
+	bind_bool("red_", &red_);
+	bind("thresh_", &thresh_);
+	bind("maxthresh_", &maxthresh_);
+	bind("max_p_", &max_p_);
+	bind("q_weight_", &q_weight_);
+	bind_bool("gentle_", &gentle_);
+	for (int i = 0; i < FLUID_HIST; i++)
+		hist_[i] = 0;
+}
+
+FluidBackground::~FluidBackground()
+{
+	delete ownrng_;
+}
+
+int FluidBackground::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "start") == 0) {
+			timer_.resched(dt_);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "stop") == 0) {
+			timer_.force_cancel();
+			qbg_ = 0;
+			p_ = 0;
+			return (TCL_OK);
+		}
+		/*
+		 * $fb stats: window, backlog (bytes), loss probability,
+		 * background and foreground rates (bps), foreground drops
+		 * and the number of fluid updates done so far.
+		 */
+		if (strcmp(argv[1], "stats") == 0) {
+			tcl.resultf("%g %g %g %g %g %d %d", W_, qbg_, p_,
+				    bgrate_, fgrate_, fgdrops_, updates_);
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "attach-queue") == 0) {
+			Queue* q = (Queue*)TclObject::lookup(argv[2]);
+			if (q == 0) {
+				tcl.resultf("%s: no such queue %s",
+					    name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			if (q->pq() == 0) {
+				tcl.resultf("%s: %s is not a FIFO queue",
+					    name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			queue_ = q;
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "use-rng") == 0) {
+			RNG* rng = (RNG*)TclObject::lookup(argv[2]);
+			if (rng == 0) {
+				tcl.resultf("no such RNG %s", argv[2]);
+				return (TCL_ERROR);
+			}
+			rng_ = rng;
+			return (TCL_OK);
+		}
+	}
+	return (Connector::command(argc, argv));
+}
+
+/*
+ * Loss probability of a queue of q bytes with total input rate in.
+ */
+double FluidBackground::lossProb(double q, double in)
+{
+	if (!red_ || maxthresh_ <= thresh_) {
+		// drop-tail: a full buffer sheds the excess input
+		if (q >= limit_ * pktsize_ - pktsize_ && in > bandwidth_)
+			return (1 - bandwidth_ / in);
+		return (0);
+	}
+	// RED: about one sample of the average per packet time
+	double n = bandwidth_ * dt_ / (8. * pktsize_);
+	double w = (q_weight_ > 0) ? 1 - pow(1 - q_weight_, n) : 1;
+	avg_ += w * (q / pktsize_ - avg_);
+	if (avg_ < thresh_)
+		return (0);
+	if (avg_ < maxthresh_)
+		return (max_p_ * (avg_ - thresh_) / (maxthresh_ - thresh_));
+	if (gentle_ && avg_ < 2 * maxthresh_)
+		return (max_p_ + (1 - max_p_) * (avg_ - maxthresh_) /
+			maxthresh_);
+	return (1);
+}
+
+void FluidBackground::update()
+{
+	double C = bandwidth_;
+	double qfg = (queue_ != 0) ? queue_->byteLength() : 0;
+	double R = rtt_ + 8. * (qbg_ + qfg) / C;
+
+	fgrate_ = 8. * fgbytes_ / dt_;
+	fgbytes_ = 0;
+
+	// window: additive increase, decrease on losses seen one RTT ago
+	int lag = (int)(R / dt_);
+	if (lag >= FLUID_HIST)
+		lag = FLUID_HIST - 1;
+	double fb = hist_[(slot_ - lag + FLUID_HIST) % FLUID_HIST];
+	W_ += dt_ * (1 / R - W_ / 2 * fb);
+	if (W_ < 1)
+		W_ = 1;
+	if (W_ > window_)
+		W_ = window_;
+	bgrate_ = nflows_ * W_ * 8. * pktsize_ / R + rate_;
+
+	// backlog: in congestion FIFO service is shared by input rate
+	double in = bgrate_ + fgrate_;
+	double served = bgrate_;
+	if ((qbg_ + qfg > 0 || in > C) && in > 0)
+		served = C * bgrate_ / in;
+	served_ = served;
+	qbg_ += dt_ * (bgrate_ * (1 - p_) - served) / 8.;
+	double room = limit_ * pktsize_ - qfg;
+	if (qbg_ > room)
+		qbg_ = room;
+	if (qbg_ < 0)
+		qbg_ = 0;
+
+	p_ = lossProb(qbg_ + qfg, in);
+	slot_ = (slot_ + 1) % FLUID_HIST;
+	hist_[slot_] = W_ / R * p_;
+	updates_++;
+	timer_.resched(dt_);
+}
+
+void FluidBackground::recv(Packet* p, Handler* h)
+{
+	Scheduler& s = Scheduler::instance();
+	double now = s.clock();
+	int size = hdr_cmn::access(p)->size();
+
+	fgbytes_ += size;
+	if (p_ > 0 && rng_->uniform() < p_) {
+		fgdrops_++;
+		drop(p);
+		return;
+	}
+	// wait for the background backlog ahead, and for the previous
+	// packet and the background served since it arrived to be sent
+	double t = now + 8. * qbg_ / bandwidth_;
+	double after = last_ + served_ * (now - lastarr_) / bandwidth_;
+	if (t < after)
+		t = after;
+	lastarr_ = now;
+	last_ = ((t > now) ? t : now) + 8. * size / bandwidth_;
+	if (t <= now) {
+		target_->recv(p, h);
+		return;
+	}
+	s.schedule(target_, p, t - now);
+}
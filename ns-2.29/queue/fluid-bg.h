@@ -0,0 +1,102 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Fluid model of background traffic on a link.
+ *
+ * A FluidBackground sits in front of a link's queue (see
+ * "SimpleLink attach-fluid" in tcl/lib/ns-link.tcl) and stands in for
+ * nflows_ long-lived TCP flows plus an optional constant rate_.  Their
+ * aggregate window, rate and the backlog they build in the queue are
+ * advanced by a fluid model every dt_ seconds instead of being
+ * simulated packet by packet.  Foreground packets passing through see
+ * the background's effect:
+ *
+ *  - they are dropped with the loss probability of the fluid queue
+ *    (buffer overflow for DropTail, the RED curve with red_ set);
+ *  - they are delayed by the time needed to drain the background
+ *    backlog ahead of them, as they would be in the FIFO;
+ *  - they leave the background its share of the link: a packet is
+ *    held until the one before it has been sent and so has the
+ *    background that the FIFO served since that one arrived.
+ *
+ * Drops are drawn from the FluidBackground's own RNG stream, so they
+ * do not shift the random numbers of the rest of the simulation;
+ * "$fb use-rng $rng" draws them from $rng instead.
+ *
+ * The queue must keep its packets in a single FIFO (a PacketQueue):
+ * one that schedules per-flow queues (FQ, DRR, SFQ, WFQ) is refused.
+ *
+ * The TCP model is the fluid model of Misra, Gong and Towsley
+ * (SIGCOMM 2000), with the loss feedback delayed by one round trip.
+ */
+
+#ifndef ns_fluid_bg_h
+#define ns_fluid_bg_h
+
+#include "connector.h"
+#include "queue.h"
+#include "rng.h"
+#include "timer-handler.h"
+
+class FluidBackground;
+
+class FluidUpdateTimer : public TimerHandler {
+public:
+	FluidUpdateTimer(FluidBackground* fb) : fb_(fb) {}
+protected:
+	virtual void expire(Event*);
+	FluidBackground* fb_;
+};
+
+#define FLUID_HIST 1024		/* slots of delayed loss feedback */
+
+class FluidBackground : public Connector {
+public:
+	FluidBackground();
+	~FluidBackground();
+	void recv(Packet*, Handler*);
+	void update();
+protected:
+	int command(int argc, const char*const* argv);
+	double lossProb(double q, double in);
+
+	/* configuration (bound) */
+	int nflows_;		/* background TCP flows */
+	double rtt_;		/* their round-trip propagation delay */
+	int pktsize_;		/* their packet size, bytes */
+	int window_;		/* their maximum window, packets */
+	double rate_;		/* additional constant-rate traffic, bps */
+	double dt_;		/* update interval */
+	double bandwidth_;	/* link capacity, bps */
+	int limit_;		/* queue limit, packets */
+	int red_;		/* RED rather than drop-tail loss */
+	double thresh_;		/* RED parameters, packets */
+	double maxthresh_;
+	double max_p_;
+	double q_weight_;
+	int gentle_;
+
+	/* fluid state */
+	double W_;		/* per-flow window, packets */
+	double qbg_;		/* background backlog, bytes */
+	double avg_;		/* RED average queue, packets */
+	double p_;		/* current loss probability */
+	double bgrate_;		/* background arrival rate, bps */
+	double served_;		/* background service rate, bps */
+	double fgrate_;		/* foreground arrival rate, bps */
+	double hist_[FLUID_HIST]; /* W/R * p, one slot per update */
+	int slot_;
+
+	/* foreground accounting */
+	double fgbytes_;	/* bytes arrived since the last update */
+	int fgdrops_;
+	int updates_;
+	double last_;		/* when the latest packet will have been sent */
+	double lastarr_;	/* when it arrived */
+
+	RNG* rng_;		/* draws foreground drops */
+	RNG* ownrng_;		/* our own stream, unless "use-rng" */
+	Queue* queue_;		/* the queue we feed */
+	FluidUpdateTimer timer_;
+};
+
+#endif
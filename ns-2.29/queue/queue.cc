@@ -86,6 +86,7 @@ void QueueHandler::handle(Event*)
 }
 
 Queue::~Queue() {
+	delete [] util_buf_;
 }
 
 Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
@@ -94,25 +95,17 @@ Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
 		 old_util_(0), period_begin_(0), cur_util_(0), buf_slot_(0),
 		 util_buf_(NULL)
 {
-	bind("limit_", &qlim_);
-	bind("util_weight_", &util_weight_);
-	bind_bool("blocked_", &blocked_);
-	bind_bool("unblock_on_resume_", &unblock_on_resume_);
-	bind("util_check_intv_", &util_check_intv_);
-	bind("util_records_", &util_records_);
-
-	if (util_records_ > 0) {
-		util_buf_ = new double[util_records_];
-		if (util_buf_ == NULL) {
-			printf("Error allocating util_bufs!");
-			util_records_ = 0;
-		}
-		for (int i = 0; i < util_records_; i++) {
-			util_buf_[i] = 0;
-		}
-	}
 }
 
+DELAY_BIND_BEGIN(Queue, Connector)
+	DELAY_BIND("limit_", qlim_),
+	DELAY_BIND("util_weight_", util_weight_),
+	DELAY_BIND_BOOL("blocked_", blocked_),
+	DELAY_BIND_BOOL("unblock_on_resume_", unblock_on_resume_),
+	DELAY_BIND("util_check_intv_", util_check_intv_),
+	DELAY_BIND("util_records_", util_records_),
+DELAY_BIND_END
+
 void Queue::recv(Packet* p, Handler*)
 {
 	double now = Scheduler::instance().clock();
@@ -143,6 +136,11 @@ double decay;
 	// PS: measuring peak utilization
 	if (util_records_ == 0)
 		return; // We don't track peak utilization
+	if (util_buf_ == NULL) {
+		util_buf_ = new double[util_records_];
+		for (int i = 0; i < util_records_; i++)
+			util_buf_[i] = 0;
+	}
 
 	double intv = int_end - int_begin;
 	double tot_intv = int_begin - period_begin_;
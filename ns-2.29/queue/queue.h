@@ -44,6 +44,7 @@ class Packet;
 
 class PacketQueue : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_QUEUE)
 	PacketQueue() : head_(0), tail_(0), len_(0), bytes_(0) {}
 	virtual int length() const { return (len_); }
 	virtual int byteLength() const { return (bytes_); }
@@ -121,6 +122,7 @@ private:
 
 class Queue : public Connector {
 public:
+	MEM_ACCOUNT(MEM_QUEUE)
 	virtual void enque(Packet*) = 0;
 	virtual Packet* deque() = 0;
 	virtual void recv(Packet*, Handler*);
@@ -141,7 +143,11 @@ public:
 	/* max utilization over recent time period.
 	   Returns the maximum of recent measurements stored in util_buf_*/
 	double peak_utilization(void);
+	/* the FIFO the packets are kept in, 0 for queues that schedule
+	   per-flow queues of their own (FQ, DRR, SFQ, ...) */
+	PacketQueue* pq() { return pq_; }
 	virtual ~Queue();
+	DELAY_BIND_TABLE
 protected:
 	Queue();
 	void reset();
@@ -166,7 +172,8 @@ protected:
 				   measurement */
 	double cur_util_;	/* utilization during current time period */
 	int buf_slot_;		/* Currently active utilization buffer */
-	double *util_buf_;    /* Buffer for recent utilization measurements */
+	double *util_buf_;    /* Buffer for recent utilization measurements,
+				 made on first use */
 	int util_records_;	/* Number of recent utilization measurements
 				   stored in memory. One slot in buffer holds
 				   period of util_check_intv_ seconds. */
@@ -103,48 +103,8 @@ REDQueue::REDQueue(const char * trace) : link_(NULL), de_drop_(NULL), EDTrace(NU
 		exit(0);
 	}
 	strcpy(traceType, trace);
-	bind_bool("bytes_", &edp_.bytes);	    // boolean: use bytes?
-	bind_bool("queue_in_bytes_", &qib_);	    // boolean: q in bytes?
-	//	_RENAMED("queue-in-bytes_", "queue_in_bytes_");
-
-	bind("thresh_", &edp_.th_min_pkts);		    // minthresh
-	bind("thresh_queue_", &edp_.th_min);
-	bind("maxthresh_", &edp_.th_max_pkts);	    // maxthresh
-	bind("minthresh_queue_", &edp_.th_max);
-	bind("mean_pktsize_", &edp_.mean_pktsize);  // avg pkt size
-	bind("idle_pktsize_", &edp_.idle_pktsize);  // avg pkt size for idles
-	bind("q_weight_", &edp_.q_w);		    // for EWMA
-	bind("adaptive_", &edp_.adaptive);          // 1 for adaptive red
-	bind("cautious_", &edp_.cautious);          // 1 for cautious marking
-	bind("alpha_", &edp_.alpha); 	  	    // adaptive red param
-	bind("beta_", &edp_.beta);                  // adaptive red param
-	bind("interval_", &edp_.interval);	    // adaptive red param
-	bind("feng_adaptive_",&edp_.feng_adaptive); // adaptive red variant
-	bind("targetdelay_", &edp_.targetdelay);    // target delay
-	bind("top_", &edp_.top);		    // maximum for max_p	
-	bind("bottom_", &edp_.bottom);		    // minimum for max_p	
-	bind_bool("wait_", &edp_.wait);
-	bind("linterm_", &edp_.max_p_inv);
-	bind("mark_p_", &edp_.mark_p);
-	bind_bool("setbit_", &edp_.setbit);	    // mark instead of drop
-	bind_bool("gentle_", &edp_.gentle);         // increase the packet
-						    // drop prob. slowly
-						    // when ave queue
-						    // exceeds maxthresh
-
-	bind_bool("summarystats_", &summarystats_);
-	bind_bool("drop_tail_", &drop_tail_);	    // drop last pkt
-	//	_RENAMED("drop-tail_", "drop_tail_");
-
-	bind_bool("drop_front_", &drop_front_);	    // drop first pkt
-	//	_RENAMED("drop-front_", "drop_front_");
-	
-	bind_bool("drop_rand_", &drop_rand_);	    // drop pkt at random
-	//	_RENAMED("drop-rand_", "drop_rand_");
-
-	bind_bool("ns1_compat_", &ns1_compat_);	    // ns-1 compatibility
-	//	_RENAMED("ns1-compat_", "ns1_compat_");
 
+	// the traced variables are bound here, the rest in the table
 	bind("ave_", &edv_.v_ave);		    // average queue sie
 	bind("prob1_", &edv_.v_prob1);		    // dropping probability
 	bind("curq_", &curq_);			    // current queue size
@@ -161,6 +121,50 @@ REDQueue::REDQueue(const char * trace) : link_(NULL), de_drop_(NULL), EDTrace(NU
 	
 }
 
+DELAY_BIND_BEGIN(REDQueue, Queue)
+	DELAY_BIND_BOOL("bytes_", edp_.bytes),	    // boolean: use bytes?
+	DELAY_BIND_BOOL("queue_in_bytes_", qib_),   // boolean: q in bytes?
+	//	_RENAMED("queue-in-bytes_", "queue_in_bytes_");
+
+	DELAY_BIND("thresh_", edp_.th_min_pkts),    // minthresh
+	DELAY_BIND("thresh_queue_", edp_.th_min),
+	DELAY_BIND("maxthresh_", edp_.th_max_pkts), // maxthresh
+	DELAY_BIND("minthresh_queue_", edp_.th_max),
+	DELAY_BIND("mean_pktsize_", edp_.mean_pktsize), // avg pkt size
+	DELAY_BIND("idle_pktsize_", edp_.idle_pktsize), // avg pkt size for idles
+	DELAY_BIND("q_weight_", edp_.q_w),	    // for EWMA
+	DELAY_BIND("adaptive_", edp_.adaptive),	    // 1 for adaptive red
+	DELAY_BIND("cautious_", edp_.cautious),	    // 1 for cautious marking
+	DELAY_BIND("alpha_", edp_.alpha),	    // adaptive red param
+	DELAY_BIND("beta_", edp_.beta),		    // adaptive red param
+	DELAY_BIND("interval_", edp_.interval),	    // adaptive red param
+	DELAY_BIND("feng_adaptive_", edp_.feng_adaptive), // adaptive red variant
+	DELAY_BIND("targetdelay_", edp_.targetdelay), // target delay
+	DELAY_BIND("top_", edp_.top),		    // maximum for max_p
+	DELAY_BIND("bottom_", edp_.bottom),	    // minimum for max_p
+	DELAY_BIND_BOOL("wait_", edp_.wait),
+	DELAY_BIND("linterm_", edp_.max_p_inv),
+	DELAY_BIND("mark_p_", edp_.mark_p),
+	DELAY_BIND_BOOL("setbit_", edp_.setbit),    // mark instead of drop
+	DELAY_BIND_BOOL("gentle_", edp_.gentle),    // increase the packet
+						    // drop prob. slowly
+						    // when ave queue
+						    // exceeds maxthresh
+
+	DELAY_BIND_BOOL("summarystats_", summarystats_),
+	DELAY_BIND_BOOL("drop_tail_", drop_tail_),  // drop last pkt
+	//	_RENAMED("drop-tail_", "drop_tail_");
+
+	DELAY_BIND_BOOL("drop_front_", drop_front_), // drop first pkt
+	//	_RENAMED("drop-front_", "drop_front_");
+
+	DELAY_BIND_BOOL("drop_rand_", drop_rand_),  // drop pkt at random
+	//	_RENAMED("drop-rand_", "drop_rand_");
+
+	DELAY_BIND_BOOL("ns1_compat_", ns1_compat_), // ns-1 compatibility
+	//	_RENAMED("ns1-compat_", "ns1_compat_");
+DELAY_BIND_END
+
 
 /*
  * Note: if the link bandwidth changes in the course of the
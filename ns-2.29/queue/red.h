@@ -138,6 +138,7 @@ class REDQueue : public Queue {
  public:	
 	/*	REDQueue();*/
 	REDQueue(const char * = "Drop");
+	DELAY_BIND_TABLE
  protected:
 	void initParams();
 	int command(int argc, const char*const* argv);
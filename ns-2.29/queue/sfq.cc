@@ -43,11 +43,12 @@ static const char rcsid[] =
 
 #include "config.h"
 #include "queue.h"
+#include "flowtable.h"
 
 class PacketSFQ;		// one queue
 class SFQ;			// a set of SFQ queues
 
-class PacketSFQ : public PacketQueue {
+class PacketSFQ : public FlowEntry {
   PacketSFQ() : pkts(0), prev(0), next(0) {}
   friend class SFQ;
 protected:
@@ -82,19 +83,24 @@ protected:
 class SFQ : public Queue {
 public: 
   SFQ();
+  ~SFQ();
   virtual int command(int argc, const char*const* argv);
   Packet *deque(void);
   void enque(Packet *pkt);
 protected:
   int maxqueue_;		// max queue size in packets
   int buckets_;			// number of queues
+  int exact_;			// one queue per 5-tuple instead of buckets_
   PacketSFQ *bucket;
+  QueueFlowTable *flows_;		// flows by 5-tuple, when exact_
   void initsfq();
   void clear();
   int hash(Packet *);
+  PacketSFQ *flow(Packet *);
   PacketSFQ *active;
   int occupied;
   int fairshare;
+  int nactive;			// flows with packets queued
 };
 
 static class SFQClass : public TclClass {
@@ -110,9 +116,35 @@ SFQ::SFQ()
   maxqueue_ = 40;
   buckets_ = 16;
   bucket = 0;
+  flows_ = 0;
   active = 0;
+  nactive = 0;
+  exact_ = 0;
   bind("maxqueue_", &maxqueue_);
   bind("buckets_", &buckets_);
+  bind_bool("exact_", &exact_);
+}
+
+SFQ::~SFQ()
+{
+  delete flows_;
+  delete[](bucket);
+}
+
+/*
+ * The queue of pkt's flow when exact_ is set, created on first use.
+ */
+PacketSFQ *SFQ::flow(Packet* pkt)
+{
+  if (!flows_)
+    flows_ = new QueueFlowTable;
+  PacketSFQ *q = (PacketSFQ *)flows_->lookup(pkt, 0);
+  if (!q) {
+    q = new PacketSFQ;
+    q->setkey(pkt, 0);
+    flows_->insert(q);
+  }
+  return q;
 }
 
 void SFQ::clear()
@@ -122,7 +154,7 @@ void SFQ::clear()
 
   if (!q)
     return;
-  while (i) {
+  while (i--) {
     if (q->pkts) {
       fprintf(stderr, "SFQ changed while queue occupied\n");
       exit(1);
@@ -138,6 +170,7 @@ void SFQ::initsfq()
   bucket = new PacketSFQ[buckets_];
   active = 0;
   occupied = 0;
+  nactive = 0;
   fairshare = maxqueue_ / buckets_;
   // fprintf(stderr, "SFQ initsfq: %d %d\n", maxqueue_, buckets_);
 }
@@ -146,9 +179,46 @@ void SFQ::initsfq()
  * This implements the following tcl commands:
  *  $sfq limit $size
  *  $sfq buckets $num
+ *  $sfq flow-stats	(one {src sport dst dport fid arrivals departures
+ *			 drops bytes} list per flow, or per bucket unless
+ *			 exact_ is set)
+ *  $sfq nflows	(flows, or buckets, held)
  */
 int SFQ::command(int argc, const char*const* argv)
 {
+  Tcl& tcl = Tcl::instance();
+  if (argc == 2) {
+    if (strcmp(argv[1], "flow-stats") == 0) {
+      char buf[128];
+      if (exact_) {
+	for (FlowEntry *f = (flows_ ? flows_->first() : 0); f;
+	     f = QueueFlowTable::next(f)) {
+	  f->stats(buf);
+	  Tcl_AppendElement(tcl.interp(), buf);
+	}
+      } else if (bucket) {
+	for (int i = 0; i < buckets_; i++) {
+	  if (bucket[i].arrivals_ == 0)
+	    continue;
+	  bucket[i].stats(buf);
+	  Tcl_AppendElement(tcl.interp(), buf);
+	}
+      }
+      return (TCL_OK);
+    }
+    if (strcmp(argv[1], "nflows") == 0) {
+      int n = 0;
+      if (exact_)
+	n = (flows_ ? flows_->nflows() : 0);
+      else if (bucket) {
+	for (int i = 0; i < buckets_; i++)
+	  if (bucket[i].arrivals_)
+	    ++n;
+      }
+      tcl.resultf("%d", n);
+      return (TCL_OK);
+    }
+  }
   if (argc == 3) {
     if (strcmp(argv[1], "limit") == 0) {
       maxqueue_ = atoi(argv[2]);
@@ -190,12 +260,17 @@ Packet* SFQ::deque(void)
   --active->pkts;
   --occupied;
   pkt = active->deque();
+  ++active->departures_;
   // fprintf(stderr, "dequeue 0x%x(%d): 0x%x\n",
   //	  (int)active, active->pkts, (int)pkt);
   // active->sfqdebug();
-  if (active->pkts == 0)
+  if (active->pkts == 0) {
+    PacketSFQ *q = active;
+    --nactive;
     active = active->idle(active);
-  else
+    if (exact_)
+      flows_->idle(q);
+  } else
     active = active->next;
   return pkt;
 }
@@ -205,28 +280,49 @@ void SFQ::enque(Packet* pkt)
   int which;
   PacketSFQ *q;
   int used, left;
+  int nq, share;
 
   if (!bucket)
     initsfq();
-  which = hash(pkt) % buckets_;
-  q = &bucket[which];
+  if (exact_) {
+    q = flow(pkt);
+    // the flows sharing the buffer are the active ones, not buckets_
+    nq = nactive + (q->pkts == 0);
+    share = maxqueue_ / nq;
+  } else {
+    which = hash(pkt) % buckets_;
+    q = &bucket[which];
+    if (q->arrivals_ == 0)
+      q->setkey(pkt, 0);
+    nq = buckets_;
+    share = fairshare;
+  }
   // log_packet_arrival(pkt);
+  ++q->arrivals_;
+  q->bytes_in_ += hdr_cmn::access(pkt)->size();
   used = q->pkts;
   left = maxqueue_ - occupied;
   // note: if maxqueue_ is changed while running left can be < 0
   if ((used >= (left >> 1))
-      || (left < buckets_ && used > fairshare)
+      || (left < nq && used > share)
       || (left <= 0)) {
     // log_packet_drop(pkt);
+    ++q->drops_;
     drop(pkt);
     // fprintf(stderr, "    drop: 0x%x\n", (int)pkt);
+    if (exact_ && q->pkts == 0)
+      flows_->idle(q);
     return;
   }
   q->enque(pkt);
   ++occupied;
   ++q->pkts;
-  if (q->pkts == 1)
+  if (q->pkts == 1) {
+    ++nactive;
     active = q->activate(active);
+    if (exact_)
+      flows_->busy(q);
+  }
   // fprintf(stderr, "    enqueue(%d=%d): 0x%x\n", which, q->pkts, (int)pkt);
   // active->sfqdebug();
 }
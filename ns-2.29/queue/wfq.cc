@@ -0,0 +1,602 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Weighted fair queueing with a heap of finish tags.
+ *
+ * Queue/WFQ keeps a FIFO for each flow (packets with the same IP flow
+ * id) and serves the flows in the order of the finish tags of their
+ * head-of-line packets:
+ *
+ *  - with wf2q_ false it is WFQ, or packet-by-packet GPS (Demers,
+ *    Keshav and Shenker; Parekh and Gallager): the next packet sent is
+ *    the one a fluid GPS server would finish first.  The GPS virtual
+ *    clock is emulated exactly, which needs the link bandwidth
+ *    ("$q link $link", done by Simulator simplex-link).  Without it the
+ *    virtual time is the finish tag of the packet last sent (SCFQ);
+ *  - with wf2q_ true it is WF2Q+ (Bennett and Zhang): only flows whose
+ *    start tag is not ahead of the system virtual time are eligible,
+ *    which keeps service within a packet of GPS in both directions.
+ *
+ * Flows are created as their first packet arrives (or by "weight"),
+ * so there is no limit on their number, and each arrival and
+ * departure costs O(log n) in the number of backlogged flows.  Each
+ * flow may hold up to limit_ packets; arrivals beyond that are
+ * dropped, as with the per-flow queues of Queue/FQ.  A flow that has
+ * emptied is freed once the virtual time passes its last finish tag,
+ * when a new one with the same id would be indistinguishable from it,
+ * unless it was given its weight with "weight".
+ */
+
+#ifndef lint
+static const char rcsid[] =
+    "@(#) $Header$";
+#endif
+
+#include "config.h"
+#include <stdlib.h>
+#include "queue.h"
+#include "delay.h"
+
+#define WFQ_SCHED	0	/* flows by finish tag (WF2Q+: eligible) */
+#define WFQ_INELIG	1	/* WF2Q+: flows by start tag, not eligible */
+#define WFQ_GPS		2	/* WFQ: flows backlogged in GPS, by finish */
+#define WFQ_NHEAP	3
+
+class WFQFlow {
+public:
+	WFQFlow(int fid, double weight);
+	~WFQFlow() { delete[] tags_; }
+	void pushtag(double F);
+	double poptag();
+	double headtag() const { return tags_[thead_]; }
+	void retag(double weight);
+
+	int fid_;
+	double weight_;
+	PacketQueue q_;
+	double S_;		/* start and finish tags of the hol packet */
+	double F_;
+	double lastF_;		/* finish tag of the latest arrival */
+	int idx_[WFQ_NHEAP];	/* positions in the heaps, -1 if absent */
+	int arrivals_;
+	int departures_;
+	int drops_;
+	double bytes_;		/* bytes sent */
+	int pinned_;		/* weight set by "weight": never freed */
+	WFQFlow* prev_;		/* all flows, in order of creation */
+	WFQFlow* next_;
+	WFQFlow* iprev_;	/* idle flows not yet freed */
+	WFQFlow* inext_;
+protected:
+	double* tags_;		/* WFQ: finish tags of queued packets */
+	int thead_;
+	int ntags_;
+	int tsize_;
+};
+
+WFQFlow::WFQFlow(int fid, double weight) : fid_(fid), weight_(weight),
+	S_(0), F_(0), lastF_(0), arrivals_(0), departures_(0), drops_(0),
+	bytes_(0), pinned_(0), prev_(0), next_(0), iprev_(0), inext_(0),
+	tags_(0), thead_(0), ntags_(0), tsize_(0)
+{
+	for (int i = 0; i < WFQ_NHEAP; i++)
+		idx_[i] = -1;
+}
+
+void WFQFlow::pushtag(double F)
+{
+	if (ntags_ == tsize_) {
+		int size = tsize_ ? 2 * tsize_ : 8;
+		double* tags = new double[size];
+		for (int i = 0; i < ntags_; i++)
+			tags[i] = tags_[(thead_ + i) % tsize_];
+		delete[] tags_;
+		tags_ = tags;
+		tsize_ = size;
+		thead_ = 0;
+	}
+	tags_[(thead_ + ntags_++) % tsize_] = F;
+}
+
+double WFQFlow::poptag()
+{
+	double F = tags_[thead_];
+	thead_ = (thead_ + 1) % tsize_;
+	--ntags_;
+	return (F);
+}
+
+/*
+ * Change the weight to w, and the finish tags of the queued packets
+ * with it: each keeps its start tag, or starts when the packet ahead
+ * of it now finishes if that is later.
+ */
+void WFQFlow::retag(double w)
+{
+	double F = 0;
+	int i = 0;
+	for (Packet* p = q_.head(); p != 0 && i < ntags_; p = p->next_, i++) {
+		int size = hdr_cmn::access(p)->size();
+		double* tag = &tags_[(thead_ + i) % tsize_];
+		double S = *tag - size / weight_;
+		if (i > 0 && F > S)
+			S = F;
+		F = *tag = S + size / w;
+	}
+	if (i > 0)
+		lastF_ = F;
+	/* WF2Q+ keeps only the head-of-line tags */
+	if (ntags_ == 0 && q_.length() > 0)
+		F_ = S_ + hdr_cmn::access(q_.head())->size() / w;
+	weight_ = w;
+}
+
+/*
+ * Binary min-heap of flows with their keys; each flow records its
+ * position so that it can be moved or removed in O(log n).  Ties go
+ * to the lower flow id, as in Queue/FQ's scan.
+ */
+class WFQHeap {
+public:
+	WFQHeap(int which) : which_(which), n_(0), size_(0), key_(0),
+		flow_(0) {}
+	~WFQHeap() { delete[] key_; delete[] flow_; }
+	int empty() const { return (n_ == 0); }
+	WFQFlow* top() const { return (flow_[0]); }
+	double topkey() const { return (key_[0]); }
+	void insert(WFQFlow* f, double key);
+	void update(WFQFlow* f, double key);
+	void remove(WFQFlow* f);
+	WFQFlow* extract() {
+		WFQFlow* f = flow_[0];
+		remove(f);
+		return (f);
+	}
+protected:
+	int less(int i, int j) const {
+		return (key_[i] < key_[j] ||
+			(key_[i] == key_[j] && flow_[i]->fid_ < flow_[j]->fid_));
+	}
+	void swap(int i, int j);
+	void up(int i);
+	void down(int i);
+
+	int which_;		/* index into WFQFlow::idx_ */
+	int n_;
+	int size_;
+	double* key_;
+	WFQFlow** flow_;
+};
+
+void WFQHeap::swap(int i, int j)
+{
+	double k = key_[i];
+	WFQFlow* f = flow_[i];
+	key_[i] = key_[j];
+	flow_[i] = flow_[j];
+	key_[j] = k;
+	flow_[j] = f;
+	flow_[i]->idx_[which_] = i;
+	flow_[j]->idx_[which_] = j;
+}
+
+void WFQHeap::up(int i)
+{
+	while (i > 0 && less(i, (i - 1) / 2)) {
+		swap(i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+void WFQHeap::down(int i)
+{
+	for (;;) {
+		int c = 2 * i + 1;
+		if (c >= n_)
+			break;
+		if (c + 1 < n_ && less(c + 1, c))
+			c++;
+		if (!less(c, i))
+			break;
+		swap(i, c);
+		i = c;
+	}
+}
+
+void WFQHeap::insert(WFQFlow* f, double key)
+{
+	if (n_ == size_) {
+		int size = size_ ? 2 * size_ : 16;
+		double* k = new double[size];
+		WFQFlow** fl = new WFQFlow*[size];
+		for (int i = 0; i < n_; i++) {
+			k[i] = key_[i];
+			fl[i] = flow_[i];
+		}
+		delete[] key_;
+		delete[] flow_;
+		key_ = k;
+		flow_ = fl;
+		size_ = size;
+	}
+	key_[n_] = key;
+	flow_[n_] = f;
+	f->idx_[which_] = n_;
+	up(n_++);
+}
+
+void WFQHeap::update(WFQFlow* f, double key)
+{
+	int i = f->idx_[which_];
+	double old = key_[i];
+	key_[i] = key;
+	if (key < old)
+		up(i);
+	else
+		down(i);
+}
+
+void WFQHeap::remove(WFQFlow* f)
+{
+	int i = f->idx_[which_];
+	f->idx_[which_] = -1;
+	if (i != --n_) {
+		key_[i] = key_[n_];
+		flow_[i] = flow_[n_];
+		flow_[i]->idx_[which_] = i;
+		if (i > 0 && less(i, (i - 1) / 2))
+			up(i);
+		else
+			down(i);
+	}
+}
+
+class WFQ : public Queue {
+public:
+	WFQ();
+	~WFQ();
+	void enque(Packet*);
+	Packet* deque();
+protected:
+	int command(int argc, const char*const* argv);
+	WFQFlow* flow(int fid);
+	void idle(WFQFlow* f);
+	void busy(WFQFlow* f);
+	void sweep();
+	void advance(double now);
+	void schedule(WFQFlow* f);
+
+	int wf2q_;		/* WF2Q+ rather than WFQ */
+	double weight_;		/* weight of new flows */
+	LinkDelay* link_;	/* for the GPS service rate */
+
+	double V_;		/* system virtual time, bytes per weight */
+	double lastT_;		/* real time V_ was last brought up to date */
+	double wsum_;		/* weights of the flows backlogged in GPS */
+	double bsum_;		/* weights of the flows with packets queued */
+
+	Tcl_HashTable flows_;	/* flow id -> WFQFlow */
+	WFQFlow* head_;		/* all flows, in order of creation */
+	WFQFlow* tail_;
+	int nflows_;
+	WFQFlow* idle_;		/* flows that have emptied, to be freed */
+	int nidle_;
+	int sweepat_;		/* sweep idle_ when nidle_ reaches this */
+	WFQHeap sched_;
+	WFQHeap inelig_;
+	WFQHeap gps_;
+};
+
+static class WFQClass : public TclClass {
+public:
+	WFQClass() : TclClass("Queue/WFQ") {}
+	TclObject* create(int, const char*const*) {
+		return (new WFQ);
+	}
+} class_wfq;
+
+WFQ::WFQ() : link_(0), V_(0), lastT_(0), wsum_(0), bsum_(0), head_(0),
+	tail_(0), nflows_(0), idle_(0), nidle_(0), sweepat_(64),
+	sched_(WFQ_SCHED), inelig_(WFQ_INELIG), gps_(WFQ_GPS)
+{
+	bind_bool("wf2q_", &wf2q_);
+	bind("weight_", &weight_);
+	Tcl_InitHashTable(&flows_, TCL_ONE_WORD_KEYS);
+}
+
+WFQ::~WFQ()
+{
+	WFQFlow* f = head_;
+	while (f != 0) {
+		WFQFlow* next = f->next_;
+		Packet* p;
+		while ((p = f->q_.deque()) != 0)
+			Packet::free(p);
+		delete f;
+		f = next;
+	}
+	Tcl_DeleteHashTable(&flows_);
+}
+
+/*
+ * Return the state of flow fid, creating it if need be.
+ */
+WFQFlow* WFQ::flow(int fid)
+{
+	int isnew;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(&flows_, (char*)(long)fid,
+						&isnew);
+	if (!isnew)
+		return ((WFQFlow*)Tcl_GetHashValue(he));
+	WFQFlow* f = new WFQFlow(fid, weight_);
+	Tcl_SetHashValue(he, (ClientData)f);
+	f->prev_ = tail_;
+	if (tail_ != 0)
+		tail_->next_ = f;
+	else
+		head_ = f;
+	tail_ = f;
+	nflows_++;
+	return (f);
+}
+
+/*
+ * Flow f has sent its last queued packet: keep it until the virtual
+ * time has caught up with it, then free it (see sweep).
+ */
+void WFQ::idle(WFQFlow* f)
+{
+	if (f->pinned_)
+		return;
+	f->iprev_ = 0;
+	f->inext_ = idle_;
+	if (idle_ != 0)
+		idle_->iprev_ = f;
+	idle_ = f;
+	if (++nidle_ >= sweepat_)
+		sweep();
+}
+
+/* A packet has arrived for f: it is no longer idle. */
+void WFQ::busy(WFQFlow* f)
+{
+	if (f->pinned_ || (f->iprev_ == 0 && idle_ != f))
+		return;
+	if (f->iprev_ != 0)
+		f->iprev_->inext_ = f->inext_;
+	else
+		idle_ = f->inext_;
+	if (f->inext_ != 0)
+		f->inext_->iprev_ = f->iprev_;
+	f->iprev_ = f->inext_ = 0;
+	--nidle_;
+}
+
+/*
+ * Free the idle flows that are done in GPS (WFQ) and whose finish tag
+ * the virtual time has reached, so that a flow created afresh would
+ * start where they would.  The list is swept when it has doubled since
+ * the last sweep, which keeps the cost per packet constant.
+ */
+void WFQ::sweep()
+{
+	WFQFlow* f = idle_;
+	while (f != 0) {
+		WFQFlow* next = f->inext_;
+		double F = wf2q_ ? f->F_ : f->lastF_;
+		if (f->idx_[WFQ_GPS] < 0 && F <= V_) {
+			busy(f);
+			if (f->prev_ != 0)
+				f->prev_->next_ = f->next_;
+			else
+				head_ = f->next_;
+			if (f->next_ != 0)
+				f->next_->prev_ = f->prev_;
+			else
+				tail_ = f->prev_;
+			Tcl_DeleteHashEntry(Tcl_FindHashEntry(&flows_,
+						(char*)(long)f->fid_));
+			delete f;
+			nflows_--;
+		}
+		f = next;
+	}
+	sweepat_ = (2 * nidle_ > 64) ? 2 * nidle_ : 64;
+}
+
+/*
+ * Bring the GPS virtual time up to the real time now.  V_ grows at
+ * the link rate divided by the weights of the flows GPS is serving;
+ * a flow leaves that set when V_ reaches the finish tag of its last
+ * packet.
+ */
+void WFQ::advance(double now)
+{
+	double C = (link_ != 0) ? link_->bandwidth() / 8. : 0;
+	if (C <= 0)
+		return;
+	while (!gps_.empty()) {
+		double Fmin = gps_.topkey();
+		double t = lastT_ + (Fmin - V_) * wsum_ / C;
+		if (t > now) {
+			V_ += (now - lastT_) * C / wsum_;
+			break;
+		}
+		V_ = Fmin;
+		lastT_ = t;
+		WFQFlow* f = gps_.extract();
+		wsum_ -= f->weight_;
+	}
+	if (gps_.empty())
+		wsum_ = 0;
+	lastT_ = now;
+}
+
+/*
+ * WF2Q+: file a flow whose head-of-line tags have just been set as
+ * eligible or not.
+ */
+void WFQ::schedule(WFQFlow* f)
+{
+	if (f->S_ <= V_)
+		sched_.insert(f, f->F_);
+	else
+		inelig_.insert(f, f->S_);
+}
+
+void WFQ::enque(Packet* p)
+{
+	WFQFlow* f = flow(hdr_ip::access(p)->flowid());
+	int size = hdr_cmn::access(p)->size();
+
+	if (f->q_.length() >= qlim_) {
+		f->drops_++;
+		drop(p);
+		return;
+	}
+	f->arrivals_++;
+	if (f->q_.length() == 0)
+		busy(f);
+	f->q_.enque(p);
+
+	if (wf2q_) {
+		if (f->q_.length() == 1) {
+			/* newly backlogged */
+			f->S_ = (f->F_ > V_) ? f->F_ : V_;
+			f->F_ = f->S_ + size / f->weight_;
+			bsum_ += f->weight_;
+			schedule(f);
+		}
+		return;
+	}
+
+	/*
+	 * WFQ: the packet starts in GPS when the flow's previous packet
+	 * finishes there, or now if GPS has already finished the flow.
+	 */
+	double S;
+	if (link_ != 0 && link_->bandwidth() > 0) {
+		advance(Scheduler::instance().clock());
+		if (f->idx_[WFQ_GPS] < 0) {
+			S = V_;
+			wsum_ += f->weight_;
+		} else
+			S = f->lastF_;
+	} else
+		S = (f->lastF_ > V_) ? f->lastF_ : V_;
+	f->lastF_ = S + size / f->weight_;
+	if (link_ != 0 && link_->bandwidth() > 0) {
+		if (f->idx_[WFQ_GPS] < 0)
+			gps_.insert(f, f->lastF_);
+		else
+			gps_.update(f, f->lastF_);
+	}
+	f->pushtag(f->lastF_);
+	if (f->q_.length() == 1)
+		sched_.insert(f, f->lastF_);
+}
+
+Packet* WFQ::deque()
+{
+	WFQFlow* f;
+	Packet* p;
+
+	if (!wf2q_) {
+		if (sched_.empty())
+			return (0);
+		f = sched_.extract();
+		p = f->q_.deque();
+		double F = f->poptag();
+		if (link_ == 0 || link_->bandwidth() <= 0)
+			V_ = F;		/* self-clocked */
+		if (f->q_.length() > 0)
+			sched_.insert(f, f->headtag());
+	} else {
+		if (sched_.empty() && inelig_.empty())
+			return (0);
+		/* V(t) = max(V + work, min S over the backlogged flows) */
+		if (sched_.empty() && inelig_.topkey() > V_)
+			V_ = inelig_.topkey();
+		while (!inelig_.empty() && inelig_.topkey() <= V_) {
+			WFQFlow* g = inelig_.extract();
+			sched_.insert(g, g->F_);
+		}
+		f = sched_.extract();
+		p = f->q_.deque();
+		V_ += hdr_cmn::access(p)->size() / bsum_;
+		if (f->q_.length() > 0) {
+			f->S_ = f->F_;
+			f->F_ = f->S_ + hdr_cmn::access(f->q_.head())->size() /
+				f->weight_;
+			schedule(f);
+		} else {
+			bsum_ -= f->weight_;
+			if (sched_.empty() && inelig_.empty())
+				bsum_ = 0;
+		}
+	}
+	f->departures_++;
+	f->bytes_ += hdr_cmn::access(p)->size();
+	if (f->q_.length() == 0)
+		idle(f);
+	return (p);
+}
+
+int WFQ::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "nflows") == 0) {
+			tcl.resultf("%d", nflows_);
+			return (TCL_OK);
+		}
+		/*
+		 * $q flow-stats: one {fid weight arrivals departures
+		 * drops bytes} list per flow
+		 */
+		if (strcmp(argv[1], "flow-stats") == 0) {
+			for (WFQFlow* f = head_; f != 0; f = f->next_) {
+				char buf[128];
+				sprintf(buf, "%d %g %d %d %d %.0f", f->fid_,
+					f->weight_, f->arrivals_,
+					f->departures_, f->drops_, f->bytes_);
+				Tcl_AppendElement(tcl.interp(), buf);
+			}
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "link") == 0) {
+			link_ = (LinkDelay*)TclObject::lookup(argv[2]);
+			if (link_ == 0) {
+				tcl.resultf("WFQ: no LinkDelay object %s",
+					    argv[2]);
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
+	} else if (argc == 4) {
+		/* $q weight fid w */
+		if (strcmp(argv[1], "weight") == 0) {
+			double w = atof(argv[3]);
+			if (w <= 0) {
+				tcl.resultf("WFQ: bad weight %s", argv[3]);
+				return (TCL_ERROR);
+			}
+			WFQFlow* f = flow(atoi(argv[2]));
+			if (!wf2q_)
+				advance(Scheduler::instance().clock());
+			busy(f);
+			f->pinned_ = 1;
+			if (f->idx_[WFQ_GPS] >= 0)
+				wsum_ += w - f->weight_;
+			if (wf2q_ && f->q_.length() > 0)
+				bsum_ += w - f->weight_;
+			f->retag(w);
+			if (f->idx_[WFQ_SCHED] >= 0)
+				sched_.update(f, wf2q_ ? f->F_ : f->headtag());
+			if (f->idx_[WFQ_GPS] >= 0)
+				gps_.update(f, f->lastF_);
+			return (TCL_OK);
+		}
+	}
+	return (Queue::command(argc, argv));
+}
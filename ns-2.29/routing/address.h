@@ -36,10 +36,12 @@
 #define ns_addr_params
 
 #include "config.h"
+#include "mem-account.h"
 
 
 class Address : public TclObject {
  public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	static Address& instance() { return (*instance_); }
 	Address();
 	~Address();
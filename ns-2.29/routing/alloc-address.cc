@@ -40,10 +40,12 @@
 #include <assert.h>
 #include "config.h"
 #include <tclcl.h>
+#include "mem-account.h"
 
 
 class AllocAddr : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	AllocAddr();
 	~AllocAddr();
 	int command(int argc, const char*const* argv);
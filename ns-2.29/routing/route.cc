@@ -47,6 +47,7 @@ static const char rcsid[] =
 #include "config.h"
 #include "route.h"
 #include "address.h"
+#include "mem-account.h"
 
 class RouteLogicClass : public TclClass {
 public:
@@ -58,11 +59,12 @@ public:
 
 void RouteLogic::reset_all()
 {
-	delete[] adj_;
-	delete[] route_;
+	mem_delete(adj_);
+	mem_delete(route_);
 	adj_ = 0; 
 	route_ = 0;
 	size_ = 0;
+	sp_reset_all();
 }
 
 int RouteLogic::command(int argc, const char*const* argv)
@@ -70,6 +72,11 @@ int RouteLogic::command(int argc, const char*const* argv)
 	Tcl& tcl = Tcl::instance();
 	if (argc == 2) {
 		if (strcmp(argv[1], "compute") == 0) {
+			if (mpath_) {
+				sp_computed_ = 1;
+				sp_src_ = 0;
+				return (TCL_OK);
+			}
 			if (adj_ == 0)
 				return (TCL_OK);
 			compute_routes();
@@ -91,6 +98,66 @@ int RouteLogic::command(int argc, const char*const* argv)
 			return (TCL_OK);
 		}
 	} else if (argc > 2) {
+		/*
+		 * $r multipath k ?classifier?: keep to the sparse form and
+		 * find up to k equal-cost next hops for each destination;
+		 * where there are several, the simulator forwards with a
+		 * classifier of the given class (Classifier/MultiPath/Hash
+		 * by default).  It must come before any links are inserted.
+		 */
+		if (strcmp(argv[1], "multipath") == 0 && argc <= 4) {
+			int k = atoi(argv[2]);
+			if (k < 1) {
+				tcl.result("multipath: need at least one path");
+				return (TCL_ERROR);
+			}
+			if (mpath_ != 0) {
+				tcl.result("multipath: already set");
+				return (TCL_ERROR);
+			}
+			if (adj_ != 0 || sp_size_ != 0) {
+				tcl.result("multipath: links already inserted");
+				return (TCL_ERROR);
+			}
+			const char* cl = argc == 4 ? argv[3] :
+				"Classifier/MultiPath/Hash";
+			delete [] mpath_class_;
+			mpath_class_ = new char[strlen(cl) + 1];
+			strcpy(mpath_class_, cl);
+			mpath_ = k;
+			return (TCL_OK);
+		}
+		/*
+		 * $r lookup-all src dst: the list of next hops, which has
+		 * only the one unless multipath is on.
+		 */
+		if (strcmp(argv[1], "lookup-all") == 0 && argc == 4) {
+			if (!mpath_) {
+				int nh;
+				int res = lookup_flat((char*)argv[2],
+						      (char*)argv[3], nh);
+				if (res == TCL_OK && nh >= 0)
+					tcl.resultf("%d", nh);
+				else if (res == TCL_OK)
+					tcl.result("");
+				return (res);
+			}
+			int* nh = new int[mpath_];
+			int n = lookup_multi(atoi(argv[2]), atoi(argv[3]), nh);
+			if (n < 0) {
+				delete [] nh;
+				tcl.result(sp_computed_ ? "node out of range" :
+					   "routes not yet computed");
+				return (TCL_ERROR);
+			}
+			Tcl_Obj* l = Tcl_NewListObj(0, 0);
+			for (int i = 0; i < n; i++)
+				Tcl_ListObjAppendElement(0, l,
+							 Tcl_NewIntObj(nh[i]));
+			delete [] nh;
+			tcl.result(l);
+			return (TCL_OK);
+		}
 		if (strcmp(argv[1], "insert") == 0) {
 			int src = atoi(argv[2]) + 1;
 			int dst = atoi(argv[3]) + 1;
@@ -207,6 +274,19 @@ int RouteLogic::lookup_flat(char* asrc, char* adst, int& result) {
 	int src = atoi(asrc) + 1;
 	int dst = atoi(adst) + 1;
 
+	if (mpath_) {
+		if (!sp_computed_) {
+			tcl.result("routes not yet computed");
+			return (TCL_ERROR);
+		}
+		int n = sp_lookup(src, dst);
+		if (n < 0) {
+			tcl.result("node out of range");
+			return (TCL_ERROR);
+		}
+		result = n > 0 ? sp_nh_[dst * mpath_] - 1 : -1;
+		return TCL_OK;
+	}
 	if (route_ == 0) {
 		// routes are computed only after the simulator is running
 		// ($ns run).
@@ -226,6 +306,18 @@ int RouteLogic::lookup_flat(char* asrc, char* adst, int& result) {
 int RouteLogic::lookup_flat(int sid, int did) {
 	int src = sid+1;
 	int dst = did+1;
+	if (mpath_) {
+		if (!sp_computed_) {
+			printf("routes not yet computed\n");
+			return (-1);
+		}
+		int n = sp_lookup(src, dst);
+		if (n < 0) {
+			printf("node out of range\n");
+			return (-2);
+		}
+		return (n > 0 ? sp_nh_[dst * mpath_] - 1 : -1);
+	}
 	if (route_ == 0) {
 		// routes are computed only after the simulator is running
 		// ($ns run).
@@ -322,12 +414,26 @@ RouteLogic::RouteLogic()
 	hroute_ = 0;
 	hconnect_ = 0;
 	cluster_size_ = 0;
+	/* sparse form */
+	mpath_ = 0;
+	mpath_class_ = 0;
+	sp_size_ = 0;
+	sp_nadj_ = 0;
+	sp_maxadj_ = 0;
+	sp_adj_ = 0;
+	sp_computed_ = 0;
+	sp_src_ = 0;
+	sp_dist_ = 0;
+	sp_nnh_ = 0;
+	sp_nh_ = 0;
 }
 	
 RouteLogic::~RouteLogic()
 {
-	delete[] adj_;
-	delete[] route_;
+	mem_delete(adj_);
+	mem_delete(route_);
+	sp_reset_all();
+	delete [] mpath_class_;
 
 	for (int i = 0; i < (Cmax_ * D_); i++) {
 		for (int j = 0; j < (Cmax_ + D_) * (cluster_size_[i]+1); j++) {
@@ -356,7 +462,7 @@ void RouteLogic::alloc(int n)
 {
 	size_ = n;
 	n *= n;
-	adj_ = new adj_entry[n];
+	adj_ = mem_new<adj_entry>(MEM_ROUTE, n);
 	for (int i = 0; i < n; ++i) {
 		adj_[i].cost = INFINITY;
 		adj_[i].entry = 0;
@@ -386,17 +492,25 @@ void RouteLogic::check(int n)
 			adj_[INDEX(i, j, m)].cost =old[INDEX(i, j, osize)].cost;
 	}
 	size_ = m;
-	delete[] old;
+	mem_delete(old);
 }
 
 void RouteLogic::insert(int src, int dst, double cost)
 {
+	if (mpath_) {
+		sp_insert(src, dst, cost);
+		return;
+	}
 	check(src);
 	check(dst);
 	adj_[INDEX(src, dst, size_)].cost = cost;
 }
 void RouteLogic::insert(int src, int dst, double cost, void* entry_)
 {
+	if (mpath_) {
+		sp_insert(src, dst, cost);
+		return;
+	}
 	check(src);
 	check(dst);
 	adj_[INDEX(src, dst, size_)].cost = cost;
@@ -405,6 +519,10 @@ void RouteLogic::insert(int src, int dst, double cost, void* entry_)
 
 void RouteLogic::reset(int src, int dst)
 {
+	if (mpath_) {
+		sp_insert(src, dst, INFINITY);
+		return;
+	}
 	assert(src < size_);
 	assert(dst < size_);
 	adj_[INDEX(src, dst, size_)].cost = INFINITY;
@@ -419,8 +537,8 @@ void RouteLogic::compute_routes()
 #define ADJ_ENTRY(i, j) adj_[INDEX(i, j, size_)].entry
 #define ROUTE(i, j) route_[INDEX(i, j, size_)].next_hop
 #define ROUTE_ENTRY(i, j) route_[INDEX(i, j, size_)].entry
-	delete[] route_;
-	route_ = new route_entry[n * n];
+	mem_delete(route_);
+	route_ = mem_new<route_entry>(MEM_ROUTE, n * n);
 	memset((char *)route_, 0, n * n * sizeof(route_[0]));
 
 	/* do for all the sources */
@@ -482,6 +600,225 @@ void RouteLogic::compute_routes()
 	delete[] parent;
 }
 
+/* sparse form, for multipath */
+
+void RouteLogic::sp_reset_all()
+{
+	for (int i = 0; i < sp_size_; i++)
+		mem_delete(sp_adj_[i]);
+	delete [] sp_adj_;
+	delete [] sp_nadj_;
+	delete [] sp_maxadj_;
+	mem_delete(sp_dist_);
+	mem_delete(sp_nnh_);
+	mem_delete(sp_nh_);
+	sp_adj_ = 0;
+	sp_nadj_ = 0;
+	sp_maxadj_ = 0;
+	sp_dist_ = 0;
+	sp_nnh_ = 0;
+	sp_nh_ = 0;
+	sp_size_ = 0;
+	sp_computed_ = 0;
+	sp_src_ = 0;
+}
+
+/* Make room for node n, like check() */
+void RouteLogic::sp_check(int n)
+{
+	if (n < sp_size_)
+		return;
+	int m = sp_size_ == 0 ? 16 : sp_size_;
+	while (m <= n)
+		m <<= 1;
+	int* nadj = new int[m];
+	int* maxadj = new int[m];
+	sp_link** adj = new sp_link*[m];
+	int i;
+	for (i = 0; i < m; i++) {
+		nadj[i] = i < sp_size_ ? sp_nadj_[i] : 0;
+		maxadj[i] = i < sp_size_ ? sp_maxadj_[i] : 0;
+		adj[i] = i < sp_size_ ? sp_adj_[i] : 0;
+	}
+	delete [] sp_nadj_;
+	delete [] sp_maxadj_;
+	delete [] sp_adj_;
+	sp_nadj_ = nadj;
+	sp_maxadj_ = maxadj;
+	sp_adj_ = adj;
+	mem_delete(sp_dist_);
+	mem_delete(sp_nnh_);
+	mem_delete(sp_nh_);
+	sp_dist_ = mem_new<double>(MEM_ROUTE, m);
+	sp_nnh_ = mem_new<int>(MEM_ROUTE, m);
+	sp_nh_ = mem_new<int>(MEM_ROUTE, m * mpath_);
+	sp_size_ = m;
+	sp_src_ = 0;
+}
+
+void RouteLogic::sp_insert(int src, int dst, double cost)
+{
+	sp_check(src);
+	sp_check(dst);
+	sp_link* l = sp_adj_[src];
+	int n = sp_nadj_[src];
+	for (int i = 0; i < n; i++)
+		if (l[i].dst == dst) {
+			l[i].cost = cost;
+			sp_src_ = 0;
+			return;
+		}
+	if (cost >= INFINITY)
+		return;
+	if (n == sp_maxadj_[src]) {
+		int m = n == 0 ? 4 : 2 * n;
+		sp_link* nl = mem_new<sp_link>(MEM_ROUTE, m);
+		for (int i = 0; i < n; i++)
+			nl[i] = l[i];
+		mem_delete(l);
+		sp_adj_[src] = l = nl;
+		sp_maxadj_[src] = m;
+	}
+	l[n].dst = dst;
+	l[n].cost = cost;
+	sp_nadj_[src] = n + 1;
+	sp_src_ = 0;
+}
+
+struct sp_heap_entry {
+	double dist;
+	int node;
+};
+
+static void sp_heap_push(sp_heap_entry* h, int& n, double dist, int node)
+{
+	int i = n++;
+	while (i > 0) {
+		int p = (i - 1) / 2;
+		if (h[p].dist <= dist)
+			break;
+		h[i] = h[p];
+		i = p;
+	}
+	h[i].dist = dist;
+	h[i].node = node;
+}
+
+static sp_heap_entry sp_heap_pop(sp_heap_entry* h, int& n)
+{
+	sp_heap_entry top = h[0];
+	sp_heap_entry last = h[--n];
+	int i = 0;
+	for (;;) {
+		int c = 2 * i + 1;
+		if (c >= n)
+			break;
+		if (c + 1 < n && h[c + 1].dist < h[c].dist)
+			c++;
+		if (last.dist <= h[c].dist)
+			break;
+		h[i] = h[c];
+		i = c;
+	}
+	h[i] = last;
+	return (top);
+}
+
+/*
+ * Routes from src to everywhere: the next hops of a destination are
+ * those of the nodes it is reached through at the least cost.  Each
+ * node is done (its next hops final) when it leaves the heap, and only
+ * done nodes pass their next hops on, so every set is complete.
+ */
+void RouteLogic::sp_compute(int src)
+{
+	int n = sp_size_;
+	int k = mpath_;
+	int nlinks = 1;
+	int v;
+	for (v = 0; v < n; v++) {
+		sp_dist_[v] = INFINITY;
+		sp_nnh_[v] = 0;
+		nlinks += sp_nadj_[v];
+	}
+	char* done = new char[n];
+	memset(done, 0, n);
+	sp_heap_entry* heap = new sp_heap_entry[nlinks];
+	int nheap = 0;
+
+	sp_dist_[src] = 0;
+	sp_nnh_[src] = 1;
+	sp_nh_[src * k] = src;
+	sp_heap_push(heap, nheap, 0, src);
+	while (nheap > 0) {
+		sp_heap_entry e = sp_heap_pop(heap, nheap);
+		int u = e.node;
+		if (done[u])
+			continue;
+		done[u] = 1;
+		sp_link* l = sp_adj_[u];
+		for (int i = sp_nadj_[u]; --i >= 0; ) {
+			v = l[i].dst;
+			double d = e.dist + l[i].cost;
+			if (done[v] || l[i].cost >= INFINITY || d > sp_dist_[v])
+				continue;
+			// next hops through u: v itself if u is the source
+			int nu = u == src ? 1 : sp_nnh_[u];
+			int* hu = u == src ? &v : &sp_nh_[u * k];
+			int* hv = &sp_nh_[v * k];
+			if (d < sp_dist_[v]) {
+				sp_dist_[v] = d;
+				sp_nnh_[v] = 0;
+				sp_heap_push(heap, nheap, d, v);
+			}
+			// merge, keeping the k lowest in order
+			for (int j = 0; j < nu; j++) {
+				int h = hu[j];
+				int nv = sp_nnh_[v];
+				int m = 0;
+				while (m < nv && hv[m] < h)
+					m++;
+				if ((m < nv && hv[m] == h) || m == k)
+					continue;
+				if (nv == k)
+					nv--;
+				for (int q = nv; q > m; q--)
+					hv[q] = hv[q - 1];
+				hv[m] = h;
+				sp_nnh_[v] = nv + 1;
+			}
+		}
+	}
+	delete [] heap;
+	delete [] done;
+	sp_src_ = src;
+}
+
+/*
+ * Next hops from sid to did, numbered from 0 as in the "insert"
+ * command, into nh: how many (0 if there is no route), or -1 if
+ * routes have not been computed or a node is out of range.
+ */
+int RouteLogic::lookup_multi(int sid, int did, int* nh)
+{
+	int dst = did + 1;
+	int n = sp_lookup(sid + 1, dst);
+	for (int i = 0; i < n; i++)
+		nh[i] = sp_nh_[dst * mpath_ + i] - 1;
+	return (n);
+}
+
+/* The same, numbered from 1, leaving the next hops in sp_nh_ */
+int RouteLogic::sp_lookup(int src, int dst)
+{
+	if (!sp_computed_ || src <= 0 || dst <= 0 || src >= sp_size_ ||
+	    dst >= sp_size_)
+		return (-1);
+	if (sp_src_ != src)
+		sp_compute(src);
+	return (sp_nnh_[dst]);
+}
+
 /* hierarchical routing support */
 
 /*
@@ -710,8 +1047,8 @@ void RouteLogic::hier_compute_routes(int i, int j)
 	double* hopcnt = new double[n];
 #define HADJ(i, j) adj_[INDEX(i, j, size)].cost
 #define HROUTE(i, j) route_[INDEX(i, j, size)].next_hop
-	delete[] route_;
-	route_ = new route_entry[n * n];
+	mem_delete(route_);
+	route_ = mem_new<route_entry>(MEM_ROUTE, n * n);
 	int* parent = new int[n];
 	memset((char *)route_, 0, n * n * sizeof(route_[0]));
 
@@ -805,7 +1142,7 @@ void RouteLogic::hier_compute()
 		for (k=1; k < C_[j]; k++) {
 			i = INDEX(j, k, Cmax_);
 			int s = (cluster_size_[i] + C_[j] + D_);
-			adj_ = new adj_entry[(s * s)];
+			adj_ = mem_new<adj_entry>(MEM_ROUTE, s * s);
 			memset((char *)adj_, 0, s * s * sizeof(adj_[0]));
 			for (n=0; n < s; n++)
 				for(m=0; m < s; m++)
@@ -815,7 +1152,8 @@ void RouteLogic::hier_compute()
 			for (n=0; n < s; n++)
 				for(m=0; m < s; m++)
 					hroute_[i][INDEX(n, m, s)] = route_[INDEX(n, m, s)].next_hop;
-			delete [] adj_;
+			mem_delete(adj_);
+			adj_ = 0;
 		}
 }
 
@@ -43,6 +43,8 @@
 #ifndef ns_route_h
 #define ns_route_h
 
+#include "mem-account.h"
+
 #undef INFINITY
 #define INFINITY	0x3fff
 #define INDEX(i, j, N) ((N) * (i) + (j))
@@ -70,8 +72,22 @@ public:
 	void* entry;
 };
 
+/*
+ * The sparse form, for equal-cost multipath ("$r multipath k"): links
+ * are kept in adjacency lists rather than an n x n matrix, and the
+ * routes from a source are found, with Dijkstra's algorithm, when it
+ * is first looked up.  Each destination gets up to k next hops, the
+ * lowest numbered of those on shortest paths.
+ */
+struct sp_link {
+	int dst;
+	double cost;
+};
+
 class RouteLogic : public TclObject {
+	friend class BulkTopology;
 public:
+	MEM_ACCOUNT(MEM_ROUTE)
 	RouteLogic();
 	~RouteLogic();
 	int command(int argc, const char*const* argv);
@@ -83,6 +99,10 @@ public:
 	inline int domains(){ return (D_-1); }
 	inline int domain_size(int domain);
 	inline int cluster_size(int domain, int cluster);
+	// next hops of sid for did, up to mpath() of them: how many
+	int lookup_multi(int sid, int did, int* nh);
+	inline int mpath() const { return (mpath_); }
+	inline const char* mpath_class() const { return (mpath_class_); }
 protected:
 
 	void check(int);
@@ -97,6 +117,25 @@ protected:
 	int size_,
 		maxnode_;
 
+	/**** Sparse form, for multipath ****/
+
+	void sp_check(int n);
+	void sp_insert(int src, int dst, double cost);
+	void sp_compute(int src);
+	int sp_lookup(int src, int dst);
+	void sp_reset_all();
+	int	mpath_;			/* max next hops, 0 if not sparse */
+	char	*mpath_class_;		/* classifier for several of them */
+	int	sp_size_;
+	int	*sp_nadj_;		/* links out of each node */
+	int	*sp_maxadj_;
+	sp_link	**sp_adj_;
+	int	sp_computed_;
+	int	sp_src_;		/* source of sp_nh_, or 0 */
+	double	*sp_dist_;
+	int	*sp_nnh_;		/* next hops of each destination */
+	int	*sp_nh_;		/* mpath_ per destination */
+
 	/**** Hierarchical routing support ****/
 
 	void hier_check(int index);
@@ -60,6 +60,7 @@
 #include "classifier.h"
 #include "classifier-hash.h"
 #include "classifier-hier.h"
+#include "mem-account.h"
 
 
 
@@ -71,6 +72,7 @@ class DestHashClassifier;
 
 class RoutingModule : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_ROUTE)
 	RoutingModule(); 
 	/*
 	 * Returns the node to which this module is attached.
@@ -19,6 +19,7 @@
 
 class CapacityFunctor : public TclObject {
  public:
+  MEM_ACCOUNT(MEM_OBJECT)
   virtual double capacity() = 0;
 };
 
@@ -20,6 +20,7 @@
  */
 class QLenFunctor : public TclObject {
  public:
+  MEM_ACCOUNT(MEM_OBJECT)
   virtual int length() = 0;
 };
 
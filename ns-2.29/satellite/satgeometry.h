@@ -70,6 +70,7 @@ struct coordinate {
 // Library of routines involving satellite geometry
 class SatGeometry : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	SatGeometry() { printf("Started\n");}
 	static double distance(coordinate, coordinate);              
 	static void spherical_to_cartesian(double, double, double,
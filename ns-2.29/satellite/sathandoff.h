@@ -43,6 +43,7 @@
 #include "rng.h"
 #include "node.h"
 #include <math.h>
+#include "mem-account.h"
 
 // Handoff manager types
 #define LINKHANDOFFMGR_SAT 1
@@ -73,6 +74,7 @@ class SatNode;
 
 class LinkHandoffMgr : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	LinkHandoffMgr();
 	void start() { handoff(); }
 	Node* node() { return node_; } // backpointer to node
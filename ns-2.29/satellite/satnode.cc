@@ -152,7 +152,7 @@ int SatNode::addNode(int nodenum)
 {
 	if (maxsatnodelist_ == 0) {
 		satnodelist_ = new int[MAXSATNODELIST];
-		memset(satnodelist_, 0, MAXSATNODELIST * sizeof(satnodelist_));
+		memset(satnodelist_, 0, MAXSATNODELIST * sizeof(int));
 		maxsatnodelist_ = MAXSATNODELIST;
 	}
 	assert(nodenum < 2*maxsatnodelist_);
@@ -160,7 +160,7 @@ int SatNode::addNode(int nodenum)
 		// Double size of array
 		int i;
 		int* temp = new int[2 * maxsatnodelist_];
-		memset(temp, 0, 2 * maxsatnodelist_ * sizeof(temp));
+		memset(temp, 0, 2 * maxsatnodelist_ * sizeof(int));
 		for (i = 0; i < maxsatnodelist_; i++) {
 			temp[i] = satnodelist_[i];
 		}
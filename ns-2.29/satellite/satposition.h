@@ -56,6 +56,7 @@
 
 class SatPosition : public TclObject {
  public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	SatPosition();
 	int type() { return type_; }
 	double period() { return period_; }
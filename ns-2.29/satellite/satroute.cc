@@ -466,8 +466,8 @@ void SatRouteObject::node_compute_routes(int node)
 #define ADJ_ENTRY(i, j) adj_[INDEX(i, j, size_)].entry
 #define ROUTE(i, j) route_[INDEX(i, j, size_)].next_hop
 #define ROUTE_ENTRY(i, j) route_[INDEX(i, j, size_)].entry
-        delete[] route_;
-        route_ = new route_entry[n * n];
+        mem_delete(route_);
+        route_ = mem_new<route_entry>(MEM_ROUTE, n * n);
         memset((char *)route_, 0, n * n * sizeof(route_[0]));
         /* compute routes only for node "node" */
         int k = node + 1; // must add one to get the right offset in tables  
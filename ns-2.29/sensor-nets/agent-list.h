@@ -13,9 +13,11 @@
 #include <trace.h>
 #include <rng.h>
 #include <agent.h>
+#include "mem-account.h"
 
 class AgentList : public TclObject {
 public:
+  MEM_ACCOUNT(MEM_OBJECT)
   AgentList() {
     agents_ = NULL;
     num_agents_ = 0;
@@ -12,6 +12,7 @@
 #include <tclcl.h>
 #include <trace.h>
 #include <rng.h>
+#include "mem-account.h"
 
 #define NUM_RECTANGLES 10 // Divide into 10 rectangles at each level
 #define TRUE 1
@@ -90,6 +91,7 @@ public:
 
 class tags_database : public TclObject {
 public:
+  MEM_ACCOUNT(MEM_OBJECT)
   tags_database() : tags_db_(NULL) { 
      num_tags_ = 0;
      num_sensed_tags_ = 0;
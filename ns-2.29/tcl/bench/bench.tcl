@@ -0,0 +1,182 @@
+#
+# Run an ns script and measure it.
+#
+# usage: ns bench.tcl ?-name name? ?-tag tag? ?-out file? ?-stop time?
+#	?-profile 0|1? script ?arg ...?
+#
+# The script runs as it would on its own, with argv set to the args,
+# except that:
+#  - a file it sources that isn't in the current directory is looked
+#    for in the script's directory;
+#  - seeding an RNG with 0, which asks for a different stream on each
+#    run, seeds it with 1 instead, so runs can be compared;
+#  - with -stop, the run ends after that much simulated time.
+#
+# When the run ends (the script calls exit, $ns run returns, or the
+# -stop time comes) a line of JSON is appended to the -out file
+# (default bench.json) and ns exits.  It gives:
+#	name, tag, script, args, date (seconds since the epoch)
+#	setup_s		wall seconds from start to $ns run
+#	run_s		wall seconds in $ns run
+#	cpu_s		user and system CPU seconds, setup included
+#	sim_s		simulated seconds
+#	sim_per_wall	sim_s / run_s
+#	events, events_per_s		events dispatched in the run
+#	packets, packets_per_s		packets allocated in the run
+#	peak_rss	peak resident set size, in bytes
+#	memory		peak bytes of each tag of $ns mem-usage
+#	profile		events and CPU time by handler type, from
+#			$ns profile-events (unless -profile 0)
+#
+
+set bench(t0) [clock clicks -milliseconds]
+set bench(name) ""
+set bench(tag) ""
+set bench(out) bench.json
+set bench(stop) ""
+set bench(profile) 1
+set bench(done) 0
+
+while {[llength $argv] > 0} {
+	set o [lindex $argv 0]
+	if {[string index $o 0] != "-"} {
+		break
+	}
+	set k [string range $o 1 end]
+	if {[lsearch {name tag out stop profile} $k] < 0 ||
+	    [llength $argv] < 2} {
+		puts stderr "usage: ns bench.tcl ?-name name? ?-tag tag?\
+			?-out file? ?-stop time? ?-profile 0|1? script ?arg ...?"
+		exit 1
+	}
+	set bench($k) [lindex $argv 1]
+	set argv [lrange $argv 2 end]
+}
+if {[llength $argv] == 0} {
+	puts stderr "usage: ns bench.tcl ?-name name? ?-tag tag?\
+		?-out file? ?-stop time? ?-profile 0|1? script ?arg ...?"
+	exit 1
+}
+set bench(script) [lindex $argv 0]
+set bench(dir) [file dirname $bench(script)]
+set bench(args) [lrange $argv 1 end]
+if {$bench(name) == ""} {
+	set bench(name) [file rootname [file tail $bench(script)]]
+}
+set bench(out) [file join [pwd] $bench(out)]
+set bench(prof) [file join [pwd] .bench-profile.[pid]]
+set argv0 $bench(script)
+set argv $bench(args)
+set argc [llength $argv]
+
+rename source bench-source
+proc source args {
+	global bench
+	set f [lindex $args end]
+	if {![file exists $f] && [file pathtype $f] == "relative" &&
+	    [file exists [file join $bench(dir) $f]]} {
+		set args [lreplace $args end end [file join $bench(dir) $f]]
+	}
+	uplevel 1 bench-source $args
+}
+
+RNG instproc seed args {
+	if {$args == "0"} {
+		set args 1
+	}
+	eval $self cmd seed $args
+}
+
+Simulator instproc bench-run [Simulator info instargs run] \
+	[Simulator info instbody run]
+
+Simulator instproc run {} {
+	global bench
+	if ![info exists bench(run)] {
+		set bench(ns) $self
+		set bench(run) [clock clicks -milliseconds]
+		array set s [$self run-stats]
+		set bench(events) $s(events)
+		set bench(packets) $s(packets)
+		if $bench(profile) {
+			$self profile-events output -json $bench(prof)
+			$self profile-events on
+		}
+		if {$bench(stop) != ""} {
+			$self at $bench(stop) "bench-report; bench-exit 0"
+		}
+	}
+	set r [$self bench-run]
+	bench-report
+	return $r
+}
+
+rename exit bench-exit
+proc exit {{code 0}} {
+	bench-report
+	bench-exit $code
+}
+
+proc bench-json-string s {
+	regsub -all {[\\"]} $s {\\&} s
+	return "\"$s\""
+}
+
+proc bench-report {} {
+	global bench
+	if {$bench(done) || ![info exists bench(run)]} {
+		return
+	}
+	set bench(done) 1
+	set t [clock clicks -milliseconds]
+	set ns $bench(ns)
+	array set s [$ns run-stats]
+	set run [expr ($t - $bench(run)) / 1000.0]
+	set setup [expr ($bench(run) - $bench(t0)) / 1000.0]
+	set sim [$ns now]
+	set events [expr $s(events) - $bench(events)]
+	set packets [expr $s(packets) - $bench(packets)]
+	set per [expr $run > 0 ? 1.0 / $run : 0]
+
+	set l "\{\"name\": [bench-json-string $bench(name)]"
+	append l ", \"tag\": [bench-json-string $bench(tag)]"
+	append l ", \"script\": [bench-json-string $bench(script)]"
+	append l ", \"args\": [bench-json-string $bench(args)]"
+	append l ", \"date\": [clock seconds]"
+	append l [format ", \"setup_s\": %.3f, \"run_s\": %.3f" $setup $run]
+	append l [format ", \"cpu_s\": %.3f" [expr $s(utime) + $s(stime)]]
+	append l [format ", \"sim_s\": %.6g, \"sim_per_wall\": %.6g" \
+		$sim [expr $sim * $per]]
+	append l [format ", \"events\": %.0f, \"events_per_s\": %.0f" \
+		$events [expr $events * $per]]
+	append l [format ", \"packets\": %.0f, \"packets_per_s\": %.0f" \
+		$packets [expr $packets * $per]]
+	append l [format ", \"peak_rss\": %.0f" $s(maxrss)]
+	append l ", \"memory\": \{"
+	set sep ""
+	foreach u [$ns mem-usage] {
+		append l "$sep\"[lindex $u 0]\": [lindex $u 2]"
+		set sep ", "
+	}
+	append l "\}"
+	if $bench(profile) {
+		set f $bench(prof)
+		$ns profile-events off
+		$ns profile-events dump -json $f
+		set fd [open $f]
+		regsub -all "\n" [string trim [read $fd]] "" p
+		close $fd
+		file delete $f
+		append l ", \"profile\": $p"
+	}
+	append l "\}"
+
+	set fd [open $bench(out) a]
+	puts $fd $l
+	close $fd
+	puts stderr [format "bench: %s: setup %.2f s, run %.2f s, %.0f events/s,\
+		%.3g sim s per s" $bench(name) $setup $run \
+		[expr $events * $per] [expr $sim * $per]]
+}
+
+bench-source $bench(script)
@@ -0,0 +1,127 @@
+#
+# Benchmark scenario: a large 802.11 ad hoc network.
+#
+# usage: ns mobile.tcl ?-rp AODV|DSR|Directed_Diffusion? ?-nn nodes?
+#	?-flows n? ?-stop time? ?-speed m/s? ?-seed n? ?-trace file?
+#
+# nn nodes are placed at random on a square about 100 m per node on a
+# side, so a node has some 20 others in range whatever nn is, and move
+# by random waypoint at up to speed m/s, without pauses.  With AODV or
+# DSR there are flows CBR/UDP flows of 4 512-byte packets a second
+# between random pairs of nodes; with Directed_Diffusion, flows
+# two-phase-pull ping senders and receivers and the nodes stay put.
+# Wireless nodes need a trace file; it is /dev/null unless -trace is
+# given, and only the traces that can't be turned off go to it.
+#
+
+set opt(rp)	AODV
+set opt(nn)	1000
+set opt(flows)	50
+set opt(stop)	20
+set opt(speed)	5
+set opt(seed)	1
+set opt(trace)	/dev/null
+
+foreach {o v} $argv {
+	set k [string range $o 1 end]
+	if {[string index $o 0] != "-" || ![info exists opt($k)]} {
+		puts stderr "mobile.tcl: unknown option $o"
+		exit 1
+	}
+	set opt($k) $v
+}
+
+set side [expr int(sqrt($opt(nn)) * 100)]
+set ns [new Simulator]
+set rng [new RNG]
+$rng seed $opt(seed)
+
+set tracefd [open $opt(trace) w]
+$ns trace-all $tracefd
+set topo [new Topography]
+$topo load_flatgrid $side $side
+create-god $opt(nn)
+
+if {$opt(rp) == "DSR"} {
+	set ifq CMUPriQueue
+} else {
+	set ifq Queue/DropTail/PriQueue
+}
+set config [list -adhocRouting $opt(rp) \
+	-llType LL \
+	-macType Mac/802_11 \
+	-ifqType $ifq \
+	-ifqLen 50 \
+	-antType Antenna/OmniAntenna \
+	-propType Propagation/TwoRayGround \
+	-phyType Phy/WirelessPhy \
+	-channelType Channel/WirelessChannel \
+	-topoInstance $topo \
+	-agentTrace OFF \
+	-routerTrace OFF \
+	-macTrace OFF \
+	-movementTrace OFF]
+if {$opt(rp) == "Directed_Diffusion"} {
+	lappend config -diffusionFilter GradientFilter
+	set opt(speed) 0
+}
+eval $ns node-config $config
+
+for {set i 0} {$i < $opt(nn)} {incr i} {
+	# diffusion wants the address
+	set node($i) [$ns node $i]
+	$node($i) random-motion 0
+	$node($i) set X_ [$rng uniform 1 [expr $side - 1]]
+	$node($i) set Y_ [$rng uniform 1 [expr $side - 1]]
+	$node($i) set Z_ 0
+}
+
+# random waypoint: head for a new point on arriving at the last one
+# (setdest refuses points on the edge)
+proc move i {
+	global ns node rng side opt
+	set x [$rng uniform 1 [expr $side - 1]]
+	set y [$rng uniform 1 [expr $side - 1]]
+	set v [$rng uniform [expr $opt(speed) / 10.0] $opt(speed)]
+	set dx [expr $x - [$node($i) set X_]]
+	set dy [expr $y - [$node($i) set Y_]]
+	$node($i) setdest $x $y $v
+	$ns at [expr [$ns now] + sqrt($dx * $dx + $dy * $dy) / $v] "move $i"
+}
+if {$opt(speed) > 0} {
+	for {set i 0} {$i < $opt(nn)} {incr i} {
+		$ns at [$rng uniform 0 1] "move $i"
+	}
+}
+
+for {set f 0} {$f < $opt(flows)} {incr f} {
+	set s [$rng integer $opt(nn)]
+	set d [expr ($s + 1 + [$rng integer [expr $opt(nn) - 1]]) % $opt(nn)]
+	if {$opt(rp) == "Directed_Diffusion"} {
+		set src [new Application/DiffApp/PingSender/TPP]
+		$ns attach-diffapp $node($s) $src
+		$ns at [expr 1 + [$rng uniform 0 1]] "$src publish"
+		set snk [new Application/DiffApp/PingReceiver/TPP]
+		$ns attach-diffapp $node($d) $snk
+		$ns at [expr 1.5 + [$rng uniform 0 1]] "$snk subscribe"
+		continue
+	}
+	set udp [new Agent/UDP]
+	$ns attach-agent $node($s) $udp
+	set null [new Agent/Null]
+	$ns attach-agent $node($d) $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr attach-agent $udp
+	$cbr set packetSize_ 512
+	$cbr set interval_ 0.25
+	$ns at [expr 1 + [$rng uniform 0 1]] "$cbr start"
+}
+
+proc finish {} {
+	global ns
+	$ns flush-trace
+	exit 0
+}
+$ns at $opt(stop) "finish"
+$ns run
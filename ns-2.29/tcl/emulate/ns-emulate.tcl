@@ -14,10 +14,12 @@ if [TclObject is-class Network/Pcap/Live] {
 
 if [TclObject is-class Agent/Tap] {
     Agent/Tap set maxpkt_ 1600
+    Agent/Tap set maxbatch_ 1; # packets per system call
 }
 
 if [TclObject is-class Agent/TCPTap] {
     Agent/TCPTap set maxpkt_ 1600
+    Agent/TCPTap set maxbatch_ 1
 }
 
 if [TclObject is-class Agent/IcmpAgent] {
@@ -26,6 +28,7 @@ if [TclObject is-class Agent/IcmpAgent] {
 
 if [TclObject is-class Agent/IPTap] {
     Agent/IPTap set maxpkt_ 1600
+    Agent/IPTap set maxbatch_ 1
 }
 
 if [TclObject is-class ArpAgent] {
@@ -0,0 +1,88 @@
+#
+# Flow-hashed equal-cost multipath on a k-ary fat-tree.
+#
+# usage: ns ecmp-fattree.tcl [k] [flows] [seed]
+#
+# Builds a fat-tree of k pods (k even, default 4: k^3/4 hosts), turns
+# on multipath routing and sends CBR flows between random pairs of
+# hosts in different pods.  At the end it prints, for each switch
+# with more than one path to somewhere, the bytes sent up each of
+# them, and the ratio of the busiest to the mean.
+#
+
+set k 4
+set nflows 64
+set seed 1
+if {$argc > 0} { set k [lindex $argv 0] }
+if {$argc > 1} { set nflows [lindex $argv 1] }
+if {$argc > 2} { set seed [lindex $argv 2] }
+set h [expr $k / 2]
+
+set ns [new Simulator]
+$ns multipath-routing $h
+set rng [new RNG]
+$rng seed $seed
+
+for {set i 0} {$i < $h * $h} {incr i} {
+	set core($i) [$ns node]
+}
+for {set p 0} {$p < $k} {incr p} {
+	for {set i 0} {$i < $h} {incr i} {
+		set agg($p,$i) [$ns node]
+		set edge($p,$i) [$ns node]
+	}
+	for {set i 0} {$i < $h} {incr i} {
+		for {set j 0} {$j < $h} {incr j} {
+			$ns duplex-link $agg($p,$i) $core([expr $i * $h + $j]) \
+				1Gb 10us DropTail
+			$ns duplex-link $agg($p,$i) $edge($p,$j) 1Gb 10us DropTail
+			set host($p,[expr $i * $h + $j]) [$ns node]
+			$ns duplex-link $edge($p,$i) $host($p,[expr $i * $h + $j]) \
+				1Gb 10us DropTail
+		}
+	}
+}
+
+set nhosts [expr $h * $h]
+for {set f 0} {$f < $nflows} {incr f} {
+	set sp [$rng integer $k]
+	set dp [expr ($sp + 1 + [$rng integer [expr $k - 1]]) % $k]
+	set src $host($sp,[$rng integer $nhosts])
+	set dst $host($dp,[$rng integer $nhosts])
+	set udp [new Agent/UDP]
+	$ns attach-agent $src $udp
+	set null [new Agent/Null]
+	$ns attach-agent $dst $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr attach-agent $udp
+	$cbr set packetSize_ 1000
+	$cbr set rate_ 10Mb
+	$ns at 0.1 "$cbr start"
+}
+
+proc finish {} {
+	set worst 0
+	foreach c [Classifier/MultiPath/Hash info instances] {
+		set tot 0
+		set max 0
+		set n 0
+		set line ""
+		foreach {slot b} [$c bytes] {
+			append line [format " %d:%.0f" $slot $b]
+			set tot [expr $tot + $b]
+			if {$b > $max} { set max $b }
+			incr n
+		}
+		if {$tot == 0} { continue }
+		set r [expr $max * $n / $tot]
+		if {$r > $worst} { set worst $r }
+		puts [format "%s seed %d:%s  max/mean %.2f" $c [$c set seed_] \
+			$line $r]
+	}
+	puts [format "worst max/mean %.2f" $worst]
+	exit 0
+}
+
+$ns at 1.1 "finish"
+$ns run
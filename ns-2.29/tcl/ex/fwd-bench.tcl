@@ -0,0 +1,65 @@
+#
+# Cost of forwarding a packet one hop.
+#
+# usage: ns fwd-bench.tcl [direct] [nodes] [packets]
+#
+# Sends packets down a line of nodes and reports the wall-clock time
+# per packet per hop.  "direct" (default 1) sets Classifier/Hash/Dest
+# direct_: run once with 0 and once with 1 to compare the hash table
+# lookup with the direct-indexed routing table.  The time includes
+# the links, queues and scheduler, which are the same in both runs.
+#
+
+set direct 1
+set nnodes 20
+set npkts 200000
+if {$argc > 0} { set direct [lindex $argv 0] }
+if {$argc > 1} { set nnodes [lindex $argv 1] }
+if {$argc > 2} { set npkts [lindex $argv 2] }
+
+Classifier/Hash/Dest set direct_ $direct
+
+set ns [new Simulator]
+for {set i 0} {$i < $nnodes} {incr i} {
+	set n($i) [$ns node]
+}
+for {set i 1} {$i < $nnodes} {incr i} {
+	$ns duplex-link $n([expr $i - 1]) $n($i) 1Gb 1ms DropTail
+}
+
+set udp [new Agent/UDP]
+$ns attach-agent $n(0) $udp
+set sink [new Agent/LossMonitor]
+$ns attach-agent $n([expr $nnodes - 1]) $sink
+$ns connect $udp $sink
+
+# 100 bytes every 10us never queues on a 1Gb link
+set cbr [new Application/Traffic/CBR]
+$cbr attach-agent $udp
+$cbr set packetSize_ 100
+$cbr set interval_ 0.00001
+$cbr set maxpkts_ $npkts
+
+proc start {} {
+	global t0 cbr
+	set t0 [clock clicks -milliseconds]
+	$cbr start
+}
+
+proc finish {} {
+	global t0 sink nnodes direct
+	set ms [expr [clock clicks -milliseconds] - $t0]
+	set pkts [$sink set npkts_]
+	set hops [expr $pkts * ($nnodes - 1)]
+	if {$hops == 0} {
+		puts "no packets received"
+		exit 1
+	}
+	puts [format "direct_ %s: %d packets, %d hops, %d ms, %.3f us/hop" \
+		$direct $pkts $hops $ms [expr $ms * 1000.0 / $hops]]
+	exit 0
+}
+
+$ns at 0.0 "start"
+$ns at [expr $npkts * 0.00001 + 1.0] "finish"
+$ns run
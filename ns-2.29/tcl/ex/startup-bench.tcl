@@ -0,0 +1,47 @@
+#
+# Cost of building a large topology.
+#
+# usage: ns startup-bench.tcl [nodes]
+#
+# Builds a line of nodes (default 100000) joined by duplex links, with
+# a UDP agent on each node, and reports the wall-clock time of each
+# step per object made.  Nothing is simulated.  Most of the time goes
+# to the split objects (classifiers, queues, links, agents) and their
+# bound variables, which are delay-bound from tables: compare against
+# a tree without them to see what that saves.
+#
+
+set nnodes 100000
+if {$argc > 0} { set nnodes [lindex $argv 0] }
+
+proc step {name n script} {
+	set t0 [clock clicks -milliseconds]
+	uplevel 1 $script
+	set ms [expr [clock clicks -milliseconds] - $t0]
+	puts [format "%-8s %7d in %6d ms, %.1f us each" $name $n $ms \
+		[expr $n > 0 ? $ms * 1000.0 / $n : 0]]
+	return $ms
+}
+
+set total 0
+set total [expr $total + [step simulator 1 {
+	set ns [new Simulator]
+}]]
+set total [expr $total + [step nodes $nnodes {
+	for {set i 0} {$i < $nnodes} {incr i} {
+		set n($i) [$ns node]
+	}
+}]]
+set total [expr $total + [step links [expr $nnodes - 1] {
+	for {set i 1} {$i < $nnodes} {incr i} {
+		$ns duplex-link $n([expr $i - 1]) $n($i) 10Mb 1ms DropTail
+	}
+}]]
+set total [expr $total + [step agents $nnodes {
+	for {set i 0} {$i < $nnodes} {incr i} {
+		$ns attach-agent $n($i) [new Agent/UDP]
+	}
+}]]
+puts [format "total    %d ms, %s objects" $total \
+	[lindex [$ns mem-usage object] 2]]
+exit 0
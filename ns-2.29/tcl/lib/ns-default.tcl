@@ -71,6 +71,9 @@ CMUTrace set radius_scaling_factor_ 1.0
 CMUTrace set duration_scaling_factor_ 3.0e4
 
 Scheduler/RealTime set maxslop_ 0.010; # max allowed slop b4 error (sec)
+Scheduler/RealTime/HighRes set maxslop_ 0.001
+Scheduler/RealTime/HighRes set spin_ 50us; # busy-poll when next event is this close
+Scheduler/RealTime/HighRes set maxio_ 64; # I/O events handled per pass
 
 #
 # Queues and associated
@@ -91,8 +94,11 @@ Queue set debug_ false
 
 Queue/SFQ set maxqueue_ 40
 Queue/SFQ set buckets_ 16
+Queue/SFQ set exact_ false
 
 Queue/FQ set secsPerByte_ 0
+Queue/WFQ set wf2q_ false
+Queue/WFQ set weight_ 1
 # change DropTail to RED for RED on individual queues
 FQLink set queueManagement_ DropTail
 
@@ -296,6 +302,7 @@ Queue/DRR set buckets_ 10
 Queue/DRR set blimit_ 25000
 Queue/DRR set quantum_ 250
 Queue/DRR set mask_ 0
+Queue/DRR set exact_ false
 
 # Integrated SRR (1/20/2002, xuanc)
 Queue/SRR set maxqueuenumber_ 16
@@ -417,6 +424,8 @@ Classifier set mask_ 0xffffffff
 Classifier set debug_ false
 
 Classifier/Hash set default_ -1; # none
+Classifier/Hash/Dest set direct_ 1
+Classifier/MultiPath/Hash set seed_ 0
 Classifier/Replicator set ignore_ 0
 
 # MPLS Classifier
@@ -544,6 +553,22 @@ Application/SctpApp1 set numStreams_ 1
 Application/SctpApp1 set numUnreliable_ 0
 Application/SctpApp1 set reliability_ 0
 
+FluidBackground set debug_ false
+FluidBackground set nflows_ 0
+FluidBackground set rtt_ 100ms
+FluidBackground set pktsize_ 1000
+FluidBackground set window_ 20
+FluidBackground set rate_ 0
+FluidBackground set dt_ 10ms
+FluidBackground set bandwidth_ 1.5Mb
+FluidBackground set limit_ 50
+FluidBackground set red_ false
+FluidBackground set thresh_ 5
+FluidBackground set maxthresh_ 15
+FluidBackground set max_p_ 0.1
+FluidBackground set q_weight_ 0.002
+FluidBackground set gentle_ true
+
 RandomVariable/Uniform set min_ 0.0
 RandomVariable/Uniform set max_ 1.0
 RandomVariable/Exponential set avg_ 1.0
@@ -558,6 +583,7 @@ RandomVariable/Empirical set minCDF_ 0
 RandomVariable/Empirical set maxCDF_ 1
 RandomVariable/Empirical set interpolation_ 0
 RandomVariable/Empirical set maxEntry_ 32
+RandomVariable/Empirical set guide_ 1
 RandomVariable/Normal set avg_ 0.0
 RandomVariable/Normal set std_ 1.0
 RandomVariable/LogNormal set avg_ 1.0
@@ -1286,6 +1312,9 @@ Agent/RAP instproc done {} { }
 
 # Routing protocol agents
 Agent/Mcast/Control set packetSize_ 80
+Agent/Mcast/Control/DM set native_ 1
+Agent/Mcast/Control/DM set timeout_ 0.5
+Agent/Mcast/Control/DM set tick_ 0.01
 
 # Dynamic routing defaults
 Agent/rtProto set preference_ 200		;# global default preference
@@ -917,6 +917,7 @@ Simulator instproc run {} {
 	# set runstart [clock seconds]
 	$self check-smac                      ;# print warning if in sleep/wakeup cycle
 	$self check-node-num
+	$self finish-packetformat		;# auto-packet-headers
 	$self rtmodel-configure			;# in case there are any
 	[$self get-routelogic] configure
 	$self instvar scheduler_ Node_ link_ started_ 
@@ -967,6 +968,210 @@ Simulator instproc halt {} {
 	$scheduler_ halt
 }
 
+# on ?-objects? | off | output ?-json? ?file? | dump ?-json? ?file?
+Simulator instproc profile-events args {
+	$self instvar scheduler_
+	return [eval $scheduler_ profile-events $args]
+}
+
+# [$ns mem-usage] is a list of {tag bytes peak objects peak}, one per
+# subsystem; [$ns mem-usage tag] is {bytes peak objects peak} of one.
+Simulator instproc mem-usage args {
+	$self instvar scheduler_
+	return [eval $scheduler_ mem-usage $args]
+}
+
+# [$ns run-stats] is a list of names and values: events dispatched and
+# packets allocated so far, user and system CPU seconds, and the peak
+# resident set size in bytes (0 where the system doesn't say).
+Simulator instproc run-stats {} {
+	$self instvar scheduler_
+	return [$scheduler_ run-stats]
+}
+
+# Write [$ns mem-usage] to file every interval of simulated time, a line
+# per sample: the time, then the bytes and objects of each tag.  The
+# sampling event stays queued, so end the run with $ns halt or exit.
+Simulator instproc mem-log { file interval } {
+	$self instvar memlog_
+	set memlog_ [open $file w]
+	set line "# time"
+	foreach u [$self mem-usage] {
+		set tag [lindex $u 0]
+		append line " $tag $tag-objects"
+	}
+	puts $memlog_ $line
+	$self mem-log-sample $interval
+}
+
+Simulator instproc mem-log-sample interval {
+	$self instvar memlog_
+	set line [$self now]
+	foreach u [$self mem-usage] {
+		append line " [lindex $u 1] [lindex $u 3]"
+	}
+	puts $memlog_ $line
+	flush $memlog_
+	$self at [expr [$self now] + $interval] "$self mem-log-sample $interval"
+}
+
+# Keep the simulation as it stands for "ns --restore file ?arg ...?".
+# Returns 0 here and 1 in each restored run, whose argv are those
+# given to --restore.  The checkpoint is a process, not a file: it
+# dies with that process and can't be moved (see common/checkpoint.h).
+Simulator instproc checkpoint file {
+	$self instvar scheduler_
+	if [$scheduler_ info class Scheduler/RealTime] {
+		error "checkpoint: [$scheduler_ info class] can't be\
+			checkpointed"
+	}
+	set shared ""
+	foreach c [file channels] {
+		catch { flush $c }
+		if { [lsearch -exact {stdin stdout stderr} $c] < 0 } {
+			lappend shared $c
+		}
+	}
+	if { $shared != "" } {
+		puts stderr "warning: checkpoint $file: channels $shared\
+			stay open and are shared by every restored run"
+	}
+	return [ns-checkpoint $file]
+}
+
+# Run the simulation n times in place of "$ns run", at most jobs at
+# once, each in a process forked from this one after the topology is
+# built.  In replication r (from 0) every RNG is moved on r substreams.
+# Each replication ends when the simulation halts or the script exits,
+# and reports a list of name value pairs: what "-stats proc" returns,
+# or else the counters of each QueueMonitor (FlowMon included) and
+# LossMonitor that exists when replicate is called.  Returns
+# {name n mean stddev ci95}, one per name, where ci95 is the half
+# width of the 95% confidence interval of the mean; the reports of the
+# replications, in order, are left in replications_.  Channels open at
+# the time (trace files, say) are shared by all the replications,
+# which write to them in no particular order.
+Simulator instproc replicate { n args } {
+	$self instvar replications_
+	set jobs 1
+	set stats ""
+	foreach {opt val} $args {
+		switch -- $opt {
+			-jobs { set jobs $val }
+			-stats { set stats $val }
+			default {
+				error "usage: $self replicate n ?-jobs k?\
+					?-stats proc?"
+			}
+		}
+	}
+	if { $stats == "" } {
+		set stats [list $self replicate-monitors \
+			[$self instances-of QueueMonitor] \
+			[$self instances-of Agent/LossMonitor]]
+	}
+	set shared ""
+	foreach c [file channels] {
+		catch { flush $c }
+		if { [lsearch -exact {stdin stdout stderr} $c] < 0 } {
+			lappend shared $c
+		}
+	}
+	if { $shared != "" } {
+		puts stderr "warning: replicate: channels $shared stay\
+			open and are shared by every replication"
+	}
+	set replications_ [ns-replicate $n $jobs \
+		[list $self replication $stats]]
+	return [$self replicate-summary $replications_]
+}
+
+Simulator instproc replication { stats r } {
+	foreach rng [$self instances-of RNG] {
+		for { set i 0 } { $i < $r } { incr i } {
+			$rng next-substream
+		}
+	}
+	rename ::exit ::ns-replicate-exit
+	proc ::exit args "ns-replicate-report \[$stats\]
+		eval ns-replicate-exit \$args"
+	$self run
+	return [eval $stats]
+}
+
+Simulator instproc instances-of cl {
+	set l [$cl info instances]
+	foreach sub [$cl info subclass] {
+		eval lappend l [$self instances-of $sub]
+	}
+	return $l
+}
+
+Simulator instproc replicate-monitors { qmons lmons } {
+	set l ""
+	foreach m $qmons {
+		foreach v { parrivals_ pdepartures_ pdrops_ \
+			    barrivals_ bdepartures_ bdrops_ } {
+			lappend l $m.$v [$m set $v]
+		}
+	}
+	foreach m $lmons {
+		foreach v { npkts_ nlost_ bytes_ } {
+			lappend l $m.$v [$m set $v]
+		}
+	}
+	return $l
+}
+
+Simulator instproc replicate-summary reports {
+	# two-sided 95% quantiles of Student's t, by degrees of freedom
+	set t95 { 12.706 4.303 3.182 2.776 2.571 2.447 2.365 2.306 2.262
+		2.228 2.201 2.179 2.160 2.145 2.131 2.120 2.110 2.101 2.093
+		2.086 2.080 2.074 2.069 2.064 2.060 2.056 2.052 2.048 2.045
+		2.042 }
+	# running mean and sum of squared deviations (Welford), which
+	# unlike the sum of squares doesn't cancel for large counters
+	set names ""
+	foreach rep $reports {
+		foreach { name v } $rep {
+			if ![info exists cnt($name)] {
+				lappend names $name
+				set cnt($name) 0
+				set avg($name) 0.0
+				set m2($name) 0.0
+			}
+			set k [incr cnt($name)]
+			set d [expr $v - $avg($name)]
+			set avg($name) [expr $avg($name) + $d / $k]
+			set m2($name) [expr $m2($name) + \
+				$d * ($v - $avg($name))]
+		}
+	}
+	set l ""
+	foreach name $names {
+		set k $cnt($name)
+		set mean $avg($name)
+		set sd 0.0
+		set ci 0.0
+		if { $k > 1 } {
+			set var [expr $m2($name) / ($k - 1)]
+			if { $var > 0 } {
+				set sd [expr sqrt($var)]
+			}
+			if { $k <= [llength $t95] + 1 } {
+				set t [lindex $t95 [expr $k - 2]]
+			} elseif { $k <= 61 } {
+				set t 2.000
+			} else {
+				set t 1.960
+			}
+			set ci [expr $t * $sd / sqrt($k)]
+		}
+		lappend l [list $name $k $mean $sd $ci]
+	}
+	return $l
+}
+
 Simulator instproc dumpq {} {
 	$self instvar scheduler_
 	$scheduler_ dumpq
@@ -1064,6 +1269,7 @@ Simulator instproc simplex-link { n1 n2 bw delay qtype args } {
 	    [string first "REM" $qtype] != -1 ||  
 	    [string first "GK" $qtype] != -1 ||  
 	    [string first "RIO" $qtype] != -1 ||
+	    [string first "WFQ" $qtype] != -1 ||
 	    [string first "XCP" $qtype] != -1} {
 		$q link [$link_($sid:$did) set link_]
 	}
@@ -1472,6 +1678,15 @@ Simulator instproc queue-limit { n1 n2 limit } {
 	}
 }
 
+#
+# Represent background traffic on link n1->n2 by the fluid model fb
+# (a FluidBackground) rather than by packets.
+#
+Simulator instproc fluid-background { n1 n2 fb } {
+	$self instvar link_
+	$link_([$n1 id]:[$n2 id]) attach-fluid $fb
+}
+
 Simulator instproc drop-trace { n1 n2 trace } {
 	$self instvar link_
 	[$link_([$n1 id]:[$n2 id]) queue] drop-target $trace
@@ -1733,19 +1948,62 @@ Simulator instproc all-nodes-list {} {
 }
 
 Simulator instproc link { n1 n2 } {
-        $self instvar Node_ link_
+        $self instvar Node_ link_ bulkTopo_
         if { ![catch "$n1 info class Node"] } {
 		set n1 [$n1 id]
 	}
         if { ![catch "$n2 info class Node"] } {
 		set n2 [$n2 id]
 	}
+	if [info exists bulkTopo_] {
+		$self bulk-link $n1 $n2
+	}
 	if [info exists link_($n1:$n2)] {
 		return $link_($n1:$n2)
 	}
 	return ""
 }
 
+#
+# Build the duplex links listed in file, one "src dst bw delay
+# [qtype [limit]]" per line, creating any nodes up to the highest id
+# named.  DropTail links are built in C++ (see BulkTopology) and get
+# an OTcl SimpleLink only when a script first refers to link_(src:dst).
+#
+Simulator instproc load-topology file {
+	$self instvar bulkTopo_ link_
+	if ![info exists bulkTopo_] {
+		set bulkTopo_ [new BulkTopology]
+		trace variable link_ r "$self bulk-link-trace"
+	}
+	set maxid [$bulkTopo_ load $file]
+	while { [Node set nn_] <= $maxid } {
+		$self node
+	}
+	$bulkTopo_ build $self
+}
+
+Simulator instproc bulk-link-trace { name1 name2 op } {
+	$self instvar link_
+	if { $name2 != "" && ![info exists link_($name2)] } {
+		set L [split $name2 :]
+		$self bulk-link [lindex $L 0] [lindex $L 1]
+	}
+}
+
+# Replace the C++ link from sid to did, if there is one, by a SimpleLink.
+Simulator instproc bulk-link { sid did } {
+	$self instvar bulkTopo_ Node_ link_
+	set spec [$bulkTopo_ spec $sid $did]
+	if { $spec == "" } {
+		return
+	}
+	$self simplex-link $Node_($sid) $Node_($did) [lindex $spec 0] \
+		[lindex $spec 1] DropTail
+	[$link_($sid:$did) queue] set limit_ [lindex $spec 2]
+	$bulkTopo_ shadow $sid $did [$link_($sid:$did) head]
+}
+
 # Creates connection. First creates a source agent of type s_type and binds
 # it to source.  Next creates a destination agent of type d_type and binds
 # it to dest.  Finally creates bindings for the source and destination agents,
@@ -555,6 +555,36 @@ SimpleLink instproc errormodule args {
 	$em drop-target $drophead_
 }
 
+#
+# Insert a FluidBackground BEFORE the queue, so that the background
+# flows it models share the queue with the packets on this link.
+# Link and queue parameters are copied when it starts, after RED has
+# configured its automatic thresholds.
+#
+SimpleLink instproc attach-fluid fb {
+	$self instvar fluid_ queue_ drophead_
+	set ns [Simulator instance]
+	set fluid_ $fb
+	$fb attach-queue $queue_
+	$fb drop-target $drophead_
+	$self add-to-head $fb
+	$ns at [$ns now] "$self start-fluid"
+}
+
+SimpleLink instproc start-fluid {} {
+	$self instvar fluid_ queue_ link_
+	$fluid_ set bandwidth_ [$link_ set bandwidth_]
+	$fluid_ set limit_ [$queue_ set limit_]
+	if [$queue_ info class Queue/RED] {
+		$fluid_ set red_ true
+		foreach v { thresh_ maxthresh_ q_weight_ gentle_ } {
+			$fluid_ set $v [$queue_ set $v]
+		}
+		$fluid_ set max_p_ [expr 1.0 / [$queue_ set linterm_]]
+	}
+	$fluid_ start
+}
+
 #
 # Insert a loss module AFTER the queue. 
 #
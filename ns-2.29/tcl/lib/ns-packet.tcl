@@ -68,8 +68,25 @@
 # IMPORTANT: You MUST never remove common header from your simulation. 
 # As you can see, this is also enforced by these header manipulation procs.
 #
+# Alternatively, headers that belong to a single protocol (see users_
+# below) can be left out automatically when the protocol is not used:
+#
+#   auto-packet-headers
+#   set ns [new Simulator]
+#
+# Their offsets are then assigned when "$ns run" is called, so no
+# packets may be created before that.  To print the final layout at
+# startup, "PacketHeaderManager set report_ 1".
+#
 
 PacketHeaderManager set hdrlen_ 0
+PacketHeaderManager set auto_ 0
+PacketHeaderManager set report_ 0
+
+# Headers touched on the forwarding path of nearly every packet.  They
+# are laid out first, from offset 0 of the cache-line aligned header
+# block, and the remaining headers start on the next cache line.
+PacketHeaderManager set hot_ { Common IP TCP Mac }
 
 # XXX Common header should ALWAYS be present
 PacketHeaderManager set tab_(Common) 1
@@ -99,6 +116,10 @@ proc remove-packet-header args {
 	}
 }
 
+proc auto-packet-headers {} {
+	PacketHeaderManager set auto_ 1
+}
+
 proc remove-all-packet-headers {} {
 	PacketHeaderManager instvar tab_
 	foreach cl [PacketHeader info subclass] {
@@ -174,6 +195,41 @@ foreach prot {
 	add-packet-header $prot
 }
 
+# Headers accessed only by the listed classes (and their subclasses).
+# Only headers whose every user is listed here may appear: one left
+# out while some other class writes to it would overwrite the common
+# header.
+foreach entry {
+	{ AODV Agent/AODV }
+	{ GAF Agent/GAF }
+	{ IMEP Agent/TORA }
+	{ LRWPAN Mac/802_15_4 Phy/WirelessPhy/802_15_4 }
+	{ MIP Agent/MIPBS Agent/MIPMH }
+	{ Pushback Agent/Pushback }
+	{ SCTP Agent/SCTP }
+	{ Smac Mac/SMAC }
+	{ SRMEXT Agent/SRM/SSM }
+	{ TORA Agent/TORA }
+} {
+	PacketHeaderManager set users_(PacketHeader/[lindex $entry 0]) \
+		[lrange $entry 1 end]
+}
+
+PacketHeaderManager proc class-in-use cl {
+	if [catch "$cl info instances" objs] {
+		return 0
+	}
+	if { $objs != "" } {
+		return 1
+	}
+	foreach sub [$cl info subclass] {
+		if [PacketHeaderManager class-in-use $sub] {
+			return 1
+		}
+	}
+	return 0
+}
+
 proc PktHdr_offset { hdrName {field ""} } {
 	set offset [$hdrName offset]
 	if { $field != "" } {
@@ -187,31 +243,103 @@ proc PktHdr_offset { hdrName {field ""} } {
 }
 
 Simulator instproc create_packetformat { } {
-	PacketHeaderManager instvar tab_
+	PacketHeaderManager instvar tab_ hot_ auto_ users_
 	set pm [new PacketHeaderManager]
-	foreach cl [PacketHeader info subclass] {
+	set hot ""
+	foreach h $hot_ {
+		set cl PacketHeader/$h
 		if [info exists tab_($cl)] {
-			set off [$pm allochdr $cl]
-			$cl offset $off
+			$cl offset [$pm allochdr $cl]
+			lappend hot $cl
+		}
+	}
+	$pm align-hdr 64	;# NS_CACHELINE in packet.h
+	set deferred ""
+	foreach cl [PacketHeader info subclass] {
+		if { ![info exists tab_($cl)] || [lsearch $hot $cl] >= 0 } {
+			continue
+		}
+		if { $auto_ && [info exists users_($cl)] } {
+			lappend deferred $cl
+			continue
 		}
+		$cl offset [$pm allochdr $cl]
 	}
+	$pm set deferred_ $deferred
 	$self set packetManager_ $pm
 }
 
+#
+# Called from "$ns run": allocate the headers left out by
+# auto-packet-headers whose users have been instantiated.
+#
+Simulator instproc finish-packetformat {} {
+	$self instvar packetManager_
+	PacketHeaderManager instvar users_ report_
+	set pm $packetManager_
+	set need ""
+	foreach cl [$pm set deferred_] {
+		foreach u $users_($cl) {
+			if [PacketHeaderManager class-in-use $u] {
+				lappend need $cl
+				break
+			}
+		}
+	}
+	if { $need != "" && [$pm packets-allocated] } {
+		error "auto-packet-headers: packets were created before\
+			\"\$ns run\", cannot add $need"
+	}
+	foreach cl $need {
+		$cl offset [$pm allochdr $cl]
+	}
+	$pm set deferred_ ""
+	if $report_ {
+		puts -nonewline [$pm report]
+	}
+}
+
+Simulator instproc packet-header-report {} {
+	$self instvar packetManager_
+	return [$packetManager_ report]
+}
+
 PacketHeaderManager instproc allochdr cl {
 	set size [$cl set hdrlen_]
 
-	$self instvar hdrlen_
+	$self instvar hdrlen_ hdrs_
 	set NS_ALIGN 8
 	# round up to nearest NS_ALIGN bytes
 	# (needed on sparc/solaris)
 	set incr [expr ($size + ($NS_ALIGN-1)) & ~($NS_ALIGN-1)]
 	set base $hdrlen_
 	incr hdrlen_ $incr
+	lappend hdrs_ [list $base $size $cl]
 
 	return $base
 }
 
+PacketHeaderManager instproc align-hdr n {
+	$self instvar hdrlen_
+	set hdrlen_ [expr ($hdrlen_ + ($n-1)) & ~($n-1)]
+}
+
+#
+# The header layout: total length, then offset, size and name of
+# each header in offset order.
+#
+PacketHeaderManager instproc report {} {
+	$self instvar hdrlen_ hdrs_
+	set s "packet header length $hdrlen_ bytes\n"
+	if [info exists hdrs_] {
+		foreach h [lsort -integer -index 0 $hdrs_] {
+			append s [format "%6d %6d %s\n" [lindex $h 0] \
+				[lindex $h 1] [lindex $h 2]]
+		}
+	}
+	return $s
+}
+
 # XXX Old code. Do NOT delete for now. - Aug 30, 2000
 
 # Initialization
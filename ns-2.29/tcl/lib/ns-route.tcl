@@ -139,6 +139,16 @@ Simulator instproc get-routelogic {} {
 	return $routingTable_
 }
 
+#
+# Equal-cost multipath for static routing: up to maxpaths next hops
+# for each destination, with flows spread over them by a classifier
+# of class cl at each node (one per set of next hops, seeded with the
+# node id).  Call it before $ns run.
+#
+Simulator instproc multipath-routing {maxpaths {cl Classifier/MultiPath/Hash}} {
+	[$self get-routelogic] multipath $maxpaths $cl
+}
+
 # Debo
 Simulator instproc dump-approx-sim-data {} {
 
@@ -343,6 +353,11 @@ Simulator instproc compute-flat-routes {} {
 			$r reset $srcID $dstID
 		}
 	}
+	# links built by load-topology that have no SimpleLink yet
+	$self instvar bulkTopo_
+	if [info exists bulkTopo_] {
+		$bulkTopo_ routes $r
+	}
 	#puts "Completed reading link_ array.."
 	#puts " and starting route-compute at \
 	#	time: [clock format [clock seconds] -format %X]"
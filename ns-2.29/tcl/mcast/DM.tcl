@@ -27,10 +27,13 @@ DM set CacheMissMode pimdm ;#or dvmrp (lowercase)
 
 DM instproc init { sim node } {
 	$self instvar mctrl_
-	set mctrl_ [new Agent/Mcast/Control $self]
+	set mctrl_ [new Agent/Mcast/Control/DM $self]
 	$node attach $mctrl_
 	Timer/Iface/Prune set timeout [[$self info class] set PruneTimeout]
 	$self next $sim $node
+	# with native_ set, mctrl_ handles prunes and grafts; see mcast/dm.cc
+	$mctrl_ set timeout_ [[$self info class] set PruneTimeout]
+	$mctrl_ dm-init $self $node [$node id]
 }
 
 DM instproc join-group  { group } {
@@ -215,10 +218,13 @@ DM instproc recv-graft { from src group iface} {
         }
 	set tmpoif [$node_ iif2oif $iface]
         $r enable $tmpoif
-	if [info exists PruneTimer_($src:$group:$tmpoif)] {
-		delete $PruneTimer_($src:$group:$tmpoif)
-		unset  PruneTimer_($src:$group:$tmpoif)
-	}
+	$self cancel-prune $src $group $tmpoif
+}
+
+DM instproc cancel-prune { src group oif } {
+	$self instvar mctrl_
+	$mctrl_ cancel-prune $src $group $oif
+	$self next $src $group $oif
 }
 
 # send a graft/prune for src/group up to the source or towards $to
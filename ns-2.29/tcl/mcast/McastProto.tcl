@@ -88,7 +88,7 @@ McastProtocol instproc trace { f src {op ""} } {
 }
 # This method is called when a change in routing occurs.
 McastProtocol instproc notify { dummy } {
-        $self instvar ns_ node_ PruneTimer_
+        $self instvar ns_ node_
 
 	#build list of current sources
         foreach r [$node_ getReps "*" "*"] {
@@ -141,10 +141,7 @@ McastProtocol instproc notify { dummy } {
 				set idx [lsearch $newoifs $old]
 				if { $idx < 0} {
 					$r disable $old
-					if [info exists PruneTimer_($src_id:$grp:$old)] {
-						delete $PruneTimer_($src_id:$grp:$old)
-						unset PruneTimer_($src_id:$grp:$old)
-					}
+					$self cancel-prune $src_id $grp $old
 				} else {
 					set newoifs [lreplace $newoifs $idx $idx]
 				}
@@ -158,6 +155,15 @@ McastProtocol instproc notify { dummy } {
 	}
 }
 
+# Forget the prune of oif for src and group, if there is one.
+McastProtocol instproc cancel-prune { src group oif } {
+	$self instvar PruneTimer_
+	if [info exists PruneTimer_($src:$group:$oif)] {
+		delete $PruneTimer_($src:$group:$oif)
+		unset PruneTimer_($src:$group:$oif)
+	}
+}
+
 McastProtocol instproc dump-routes {chan {grp ""} {src ""}} {
 	$self instvar ns_ node_
 	if { $grp == "" } {
@@ -107,6 +107,10 @@ Node proc allocaddr {} {
 	# return a unique mcast address
 	set addr [Simulator set McastAddr_]
 	Simulator set McastAddr_ [expr $addr + 1]
+	# as C++ prints it, a signed 32-bit number, on 64-bit hosts too
+	if { $addr > 0x7fffffff } {
+		set addr [expr $addr - 0x100000000]
+	}
 	return $addr
 }
 
@@ -303,73 +307,12 @@ Classifier/Multicast/Replicator instproc add-rep { rep src group iif } {
 }
 
 ###################### Class Classifier/Replicator/Demuxer ##############
-Class Classifier/Replicator/Demuxer -superclass Classifier/Replicator
+# The target table (insert, enable, disable, exists, is-active,
+# is-active-target, reset) is in C++; see mcast/replicator.cc.
 Classifier/Replicator/Demuxer set ignore_ 0
-Classifier/Replicator/Demuxer instproc init args {
-	eval $self next $args
-	$self instvar nslot_ nactive_
-	set nactive_ 0
-}
-
-Classifier/Replicator/Demuxer instproc is-active {} {
-	$self instvar nactive_
-	expr $nactive_ > 0
-}
-
-Classifier/Replicator/Demuxer instproc insert target {
-	$self instvar nactive_ active_ 
-
-	if ![info exists active_($target)] {
-		set active_($target) -1
-	}
-	if {$active_($target) < 0} {
-		$self enable $target
-	}
-}
 
 Classifier/Replicator/Demuxer instproc dump-oifs {} {
-	set oifs ""
-	if [$self is-active] {
-		$self instvar active_
-		foreach target [array names active_] {
-			if { $active_($target) >= 0 } {
-				lappend oifs [$self slot $active_($target)]
-			}
-		}
-	}
-	return [lsort $oifs]
-}
-
-Classifier/Replicator/Demuxer instproc disable target {
-	$self instvar nactive_ active_
-	if {[info exists active_($target)] && $active_($target) >= 0} {
-		$self clear $active_($target)
-		set active_($target) -1
-		incr nactive_ -1
-	}
-}
-
-Classifier/Replicator/Demuxer instproc enable target {
-	$self instvar nactive_ active_ ignore_
-	if {$active_($target) < 0} {
-		set active_($target) [$self installNext $target]
-		incr nactive_
-		set ignore_ 0
-	}
-}
-
-Classifier/Replicator/Demuxer instproc exists target {
-	$self instvar active_
-	info exists active_($target)
-}
-
-Classifier/Replicator/Demuxer instproc is-active-target target {
-	$self instvar active_
-	if { [info exists active_($target)] && $active_($target) >= 0 } {
-		return 1
-	} else {
-		return 0
-	}
+	lsort [$self active-targets]
 }
 
 Classifier/Replicator/Demuxer instproc drop { src dst {iface -1} } {
@@ -387,15 +330,6 @@ Node instproc lookup-iface { src dst } {
         $multiclassifier_ lookup-iface $src $dst
 }
 
-Classifier/Replicator/Demuxer instproc reset {} {
-	$self instvar nactive_ active_
-	foreach { target slot } [array get active_] {
-		$self clear $slot
-	}
-	set nactive_ 0
-	unset active_
-}
-
 Agent/Mcast/Control instproc init { protocol } {
 	 $self next
 	 $self instvar proto_
@@ -408,7 +342,7 @@ Agent/Mcast/Control set mcounter 0
 Agent/Mcast/Control instproc send {type from src group args} {
 	Agent/Mcast/Control instvar mcounter messages
 	set messages($mcounter) [concat [list $from $src $group] $args]
-	$self cmd send $type $mcounter
+	$self cmd send $type $mcounter $from $src $group
 	incr mcounter
 }
 
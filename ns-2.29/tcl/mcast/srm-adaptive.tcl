@@ -47,6 +47,7 @@
 
 Agent/SRM/Adaptive set pdistance_	0.0	;# bound instance variables
 Agent/SRM/Adaptive set requestor_ 0
+Agent/SRM/Adaptive set native_ 0
 
 Agent/SRM/Adaptive set C1_	2.0
 Agent/SRM/Adaptive set MinC1_	0.5
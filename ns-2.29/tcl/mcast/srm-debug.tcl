@@ -45,6 +45,9 @@
 # @(#) $Header: /nfs/jade/vint/CVSROOT/ns-2/tcl/mcast/srm-debug.tcl,v 1.4 2005/09/16 03:05:44 tomh Exp $ (USC/ISI)
 #
 
+# The probes are in the OTcl timers, so don't run them in C++.
+Agent/SRM set native_ 0
+
 SRM/request instproc compute-delay {} {
 	$self instvar C1_ C2_ agent_ sender_ backoff_
 	set unif [uniform 0 1]
@@ -53,6 +53,9 @@ set sessFid [incr ctrlFid]
 set rqstFid [incr ctrlFid]
 set reprFid [incr ctrlFid]
 
+# send is not called by the C++ timers
+Agent/SRM set native_ 0
+
 Agent/SRM instproc send {type args} {
 #    eval $self evTrace $proc $type $args
     global sessFid rqstFid reprFid
@@ -8,6 +8,7 @@ Agent/SRM/SSM set repthresh_low_ 7
 Agent/SRM/SSM set Z1_ 1.5
 Agent/SRM/SSM set S1_ 0.0
 Agent/SRM/SSM set S2_ 3.0
+Agent/SRM/SSM set native_ 0
 
 Agent/SRM/SSM instproc init {} {
 	$self next
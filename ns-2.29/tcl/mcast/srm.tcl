@@ -78,6 +78,10 @@ Agent/SRM set repairFunction_	"SRM/repair"
 Agent/SRM set sessionDelay_ 1.0
 Agent/SRM set sessionFunction_	"SRM/session"
 
+# Run the request, repair and session timers in C++ when the agent uses
+# the three functions above; see Agent/SRM instproc start.
+Agent/SRM set native_ 1
+
 Class Agent/SRM/Deterministic -superclass Agent/SRM
 Agent/SRM/Deterministic set C2_ 0.0
 Agent/SRM/Deterministic set D2_ 0.0
@@ -87,6 +91,7 @@ Agent/SRM/Probabilistic set C1_ 0.0
 Agent/SRM/Probabilistic set D1_ 0.0
 
 Class Agent/SRM/Fixed -superclass Agent/SRM
+Agent/SRM/Fixed set native_ 0	;# overrides repair
 
 Class SRM
 Class SRM/request -superclass SRM
@@ -128,7 +133,9 @@ Agent/SRM instproc delete {} {
 		delete $pending_($i)
 	}
 	$self cleanup
-	delete $session_
+	if [info exists session_] {
+		delete $session_
+	}
 	if [info exists tg_] {
 		delete $tg_
 	}
@@ -142,10 +149,40 @@ Agent/SRM instproc start {} {
 	$node_ join-group $self $dst_addr_
 
 	$self instvar ns_ session_ sessionFunction_
+	if [$self use-native?] {
+		$self instvar trace_ distanceCompute_
+		$ns_ instvar eventTraceAll_ traceAllFile_
+		set t ""
+		if [info exists trace_] {
+			set t $trace_
+		}
+		set all ""
+		if {[info exists eventTraceAll_] && $eventTraceAll_ == 1 && \
+				[info exists traceAllFile_]} {
+			set all $traceAllFile_
+		}
+		$self cmd start-native [$node_ id] \
+			[expr {$distanceCompute_ == "ewma"}] $t $all
+		return
+	}
 	set session_ [new $sessionFunction_ $ns_ $self]
 	$session_ schedule
 }
 
+# The C++ agent runs the timers of SRM/request, SRM/repair and
+# SRM/session itself, drawing the same random numbers, unless native_
+# is off or the agent has other functions, or logs (see log), or
+# distances are computed by a procedure of the script's.
+Agent/SRM instproc use-native? {} {
+	$self instvar native_ requestFunction_ repairFunction_ \
+		sessionFunction_ distanceCompute_ logfile_
+	return [expr {$native_ && $requestFunction_ == "SRM/request" && \
+		$repairFunction_ == "SRM/repair" && \
+		$sessionFunction_ == "SRM/session" && \
+		[lsearch {ewma instantaneous} $distanceCompute_] >= 0 && \
+		![info exists logfile_]}]
+}
+
 Agent/SRM instproc start-source {} {
 	$self instvar tg_
 	if ![info exists tg_] {
@@ -347,8 +384,12 @@ Agent/SRM instproc cleanup {} {
 
 Agent/SRM instproc trace file {
 	$self set trace_ $file
+	if [$self cmd native?] {
+		$self cmd native-trace $file
+	}
 }
 
+# Only before start: the per-loss statistics are kept by the OTcl timers.
 Agent/SRM instproc log file {
 	$self set logfile_ $file
 }
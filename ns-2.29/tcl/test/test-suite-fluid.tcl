@@ -0,0 +1,197 @@
+#
+# Copyright (c) 1995 The Regents of the University of California.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 3. All advertising materials mentioning features or use of this software
+#    must display the following acknowledgement:
+#	This product includes software developed by the Computer Systems
+#	Engineering Group at Lawrence Berkeley Laboratory.
+# 4. Neither the name of the University nor of the Laboratory may be used
+#    to endorse or promote products derived from this software without
+#    specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS ``AS IS'' AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED.  IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE
+# FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+# DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+# OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+# OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+#
+#
+# To view a list of available tests to run with this script:
+# ns test-suite-fluid.tcl
+#
+# Two TCP connections share the 800Kb link r1->k1 with background
+# traffic represented by a FluidBackground (see queue/fluid-bg.h).
+#
+
+set quiet false
+
+source misc_simple.tcl
+remove-all-packet-headers       ; # removes all except common
+add-packet-header Flags IP TCP  ; # hdrs reqd for validation test
+ 
+# FOR UPDATING GLOBAL DEFAULTS:
+
+Agent/TCP set syn_ false
+Agent/TCP set delay_growth_ false
+# In preparation for changing the default values for syn_ and delay_growth_.
+Agent/TCP set tcpTick_ 0.1
+# The default for tcpTick_ is being changed to reflect a changing reality.
+Agent/TCP set rfc2988_ false
+# The default for rfc2988_ is being changed to true.
+Agent/TCP set minrto_ 1
+# default changed on 10/14/2004.
+Queue/RED set bytes_ false              
+# default changed on 10/11/2004.
+Queue/RED set queue_in_bytes_ false
+# default changed on 10/11/2004.
+Queue/RED set q_weight_ 0.002
+Queue/RED set thresh_ 5 
+Queue/RED set maxthresh_ 15
+# The RED parameter defaults are being changed for automatic configuration.
+Agent/TCP set useHeaders_ false
+# The default is being changed to useHeaders_ true.
+Agent/TCP set windowInit_ 1
+# The default is being changed to 2.
+Agent/TCP set singledup_ 0
+# The default is being changed to 1
+
+Class Topology
+
+Topology instproc node? num {
+	 $self instvar node_
+	 return $node_($num)
+}
+
+Topology instproc makeNet1 { ns scheduler } {
+	$self instvar node_
+    	set node_(s1) [$ns node]
+    	set node_(s2) [$ns node]
+    	set node_(r1) [$ns node]
+    	set node_(k1) [$ns node]
+
+        $ns duplex-link $node_(s1) $node_(r1) 8Mb 2ms DropTail
+        $ns duplex-link $node_(s2) $node_(r1) 8Mb 10ms DropTail
+        $ns duplex-link $node_(r1) $node_(k1) 800Kb 2ms $scheduler
+        $ns queue-limit $node_(r1) $node_(k1) 25 
+        $ns queue-limit $node_(k1) $node_(r1) 25 
+}
+
+Class Topology/netDT -superclass Topology
+Topology/netDT instproc init ns {
+	$self instvar node_
+	$self makeNet1 $ns DropTail
+}
+
+Class Topology/netRED -superclass Topology
+Topology/netRED instproc init ns {
+	$self instvar node_
+	$self makeNet1 $ns RED
+}
+
+TestSuite instproc finish file {
+	global quiet PERL
+        exec $PERL ../../bin/getrc -s 2 -d 3 all.tr | \
+          $PERL ../../bin/raw2xg -s 0.01 -m 90 -t $file > temp.rands
+	if {$quiet == "false"} {
+		exec xgraph -bb -tk -nl -m -x time -y packets temp.rands &
+	}
+        exit 0
+}
+
+# Put the background fb on r1->k1.
+TestSuite instproc background fb {
+	global quiet
+	$self instvar ns_ node_
+	$ns_ fluid-background $node_(r1) $node_(k1) $fb
+	if {$quiet == "false"} {
+		$ns_ at 9.99 "puts \"$fb stats: \[$fb stats\]\""
+	}
+}
+
+TestSuite instproc runDetailed {} {
+	global quiet
+	$self instvar ns_ node_ testName_
+
+	# Set up TCP connection
+	set tcp1 [$ns_ create-connection TCP $node_(s1) TCPSink $node_(k1) 0]
+	$tcp1 set window_ 20
+	set ftp1 [$tcp1 attach-app FTP]
+	$ns_ at 0.1 "$ftp1 start"
+
+	# Set up TCP connection
+	set tcp2 [$ns_ create-connection TCP $node_(s2) TCPSink $node_(k1) 1]
+	$tcp2 set window_ 20
+	set ftp2 [$tcp2 attach-app FTP]
+	$ns_ at 0.4 "$ftp2 start"
+
+        $self tcpDump $tcp1 5.0
+        $self tcpDump $tcp2 5.0
+
+	$ns_ at 10.0 "$self cleanupAll $testName_"
+        $ns_ run
+}
+
+# Ten background TCP flows, drop-tail loss.
+Class Test/droptail -superclass TestSuite
+Test/droptail instproc init {} {
+        $self instvar net_ test_
+        set net_        netDT
+        set test_       droptail
+        $self next
+}
+Test/droptail instproc run {} {
+	$self setTopo
+	set fb [new FluidBackground]
+	$fb set nflows_ 10
+	$self background $fb
+	$self runDetailed
+}
+
+# The same, with the RED queue's drop curve.
+Class Test/red -superclass TestSuite
+Test/red instproc init {} {
+        $self instvar net_ test_
+        set net_        netRED
+        set test_       red
+        $self next
+}
+Test/red instproc run {} {
+	$self setTopo
+	set fb [new FluidBackground]
+	$fb set nflows_ 10
+	$self background $fb
+	$self runDetailed
+}
+
+# Only a constant 400Kb of background: half the link, no backoff.
+Class Test/cbr -superclass TestSuite
+Test/cbr instproc init {} {
+        $self instvar net_ test_
+        set net_        netDT
+        set test_       cbr
+        $self next
+}
+Test/cbr instproc run {} {
+	$self setTopo
+	set fb [new FluidBackground]
+	$fb set rate_ 400Kb
+	$self background $fb
+	$self runDetailed
+}
+
+TestSuite runTest
@@ -162,6 +162,34 @@ Test/eqp instproc run {} {
 	$ns run
 }
 
+# eqp with incremental SPF: the routes, and so the trace, must be
+# the same as with a full SPF run (eqp_incremental.Z is eqp.Z).
+Class Test/eqp_incremental -superclass Test/eqp
+
+Test/eqp_incremental instproc init {} {
+	Agent/rtProto/LS set incrementalSPF_ true
+	$self next
+}
+
+Test/eqp_incremental instproc finish {} {
+	$self instvar ns
+	# the link going down and up must have been handled incrementally
+	set n 0
+	foreach node [$ns all-nodes-list] {
+		set ls [[$node rtObject?] rtProto? LS]
+		incr n [lindex [$ls cmd spf-stats] 1]
+	}
+	if {$n == 0} {
+		$ns flush-trace
+		set f [open temp.rands a]
+		puts $f "no incremental SPF computations"
+		close $f
+		puts stderr "eqp_incremental: no incremental SPF computations"
+		exit 1
+	}
+	$self next
+}
+
 proc usage {} {
 	global argv0
 	puts stderr "usage: ns $argv0 <tests>"
@@ -714,6 +714,73 @@ Test/DM4 instproc run {} {
 	
 	$ns_ run
 }
+# Prunes, grafts and prune timeouts, with two sources and groups.  The
+# groups are written as signed 32-bit numbers, so that they read the
+# same in OTcl and C++ on 32- and 64-bit hosts.  DM6 handles prunes and
+# grafts in OTcl, DM6-native in C++ (Agent/Mcast/Control/DM native_);
+# the two must give the same trace.
+Class Test/DM6 -superclass TestSuite
+Test/DM6 set native_ 0
+Test/DM6 instproc init topo {
+	source ../mcast/DM.tcl
+	Agent/Mcast/Control/DM set native_ [[$self info class] set native_]
+	$self instvar net_ defNet_ test_
+	set net_	$topo
+	set defNet_	net6a
+	set test_	DM6
+	$self next
+}
+Test/DM6 instproc run {} {
+	$self instvar ns_ node_ testName_
+
+	### Start multicast configuration
+	DM set PruneTimeout 0.3
+	set mproto DM
+	set mrthandle [$ns_ mrtproto $mproto  {}]
+	### End of multicast  config
+
+	set grp0 -2147483648
+	set udp0 [new Agent/UDP]
+	$ns_ attach-agent $node_(n0) $udp0
+	$udp0 set dst_addr_ $grp0
+	$udp0 set dst_port_ 0
+	set cbr0 [new Application/Traffic/CBR]
+	$cbr0 attach-agent $udp0
+
+	set grp1 -2147483647
+	set udp1 [new Agent/UDP]
+	$ns_ attach-agent $node_(n5) $udp1
+	$udp1 set dst_addr_ $grp1
+	$udp1 set dst_port_ 0
+	$udp1 set class_ 1
+	set cbr1 [new Application/Traffic/CBR]
+	$cbr1 attach-agent $udp1
+
+	set rcvr [new Agent/LossMonitor]
+	$ns_ attach-agent $node_(n3) $rcvr
+	$ns_ attach-agent $node_(n4) $rcvr
+	$ns_ attach-agent $node_(n5) $rcvr
+
+	$ns_ at 0.2 "$node_(n3) join-group $rcvr $grp0"
+	$ns_ at 0.4 "$node_(n4) join-group $rcvr $grp0"
+	$ns_ at 0.45 "$node_(n3) join-group $rcvr $grp1"
+	$ns_ at 0.6 "$node_(n3) leave-group $rcvr $grp0"
+	$ns_ at 0.7 "$node_(n5) join-group $rcvr $grp0"
+	$ns_ at 0.9 "$node_(n3) leave-group $rcvr $grp1"
+	$ns_ at 0.95 "$node_(n3) join-group $rcvr $grp0"
+	$ns_ at 1.1 "$node_(n4) leave-group $rcvr $grp0"
+	$ns_ at 1.2 "$node_(n4) join-group $rcvr $grp1"
+
+	$ns_ at 0.3 "$cbr0 start"
+	$ns_ at 0.35 "$cbr1 start"
+	$ns_ at 1.6 "$self finish 6a-nam"
+
+	$ns_ run
+}
+
+Class Test/DM6-native -superclass Test/DM6
+Test/DM6-native set native_ 1
+
 # testing lan topologies
 #Class Test/DM5 -superclass TestSuite
 #Test/DM5 instproc init topo {
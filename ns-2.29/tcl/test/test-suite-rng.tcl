@@ -17,10 +17,68 @@ Test/rngtest instproc init {} {
     $rng test
 }
 
+#
+# Batched variates must be exactly the values the same variable gives
+# one at a time.  Each batchable variable is drawn plain and with
+# "batch 8" from two RNGs seeded alike, and a Normal variable on a
+# third RNG is drawn in between, to check that batching does not
+# disturb other streams.
+#
+Class Test/batch -superclass TestSuite
+
+Test/batch instproc draw { spec n batch } {
+	set type [lindex $spec 0]
+	set r1 [new RNG]
+	$r1 seed 12345
+	set r2 [new RNG]
+	$r2 seed 54321
+	set v [new RandomVariable/$type]
+	foreach {var val} [lrange $spec 1 end] {
+		$v set $var $val
+	}
+	$v use-rng $r1
+	set nv [new RandomVariable/Normal]
+	$nv use-rng $r2
+	if {$batch > 0} {
+		$v batch $batch
+	}
+	set l {}
+	for {set i 0} {$i < $n} {incr i} {
+		lappend l [$v value] [$nv value]
+	}
+	delete $v
+	delete $nv
+	delete $r1
+	delete $r2
+	return $l
+}
+
+Test/batch instproc init {} {
+	set f [open temp.rands w]
+	foreach spec {
+		{Uniform min_ 1 max_ 5}
+		{Exponential avg_ 2}
+		{Pareto avg_ 2 shape_ 1.5}
+		{ParetoII avg_ 2 shape_ 1.5}
+		{LogNormal avg_ 1 std_ 0.5}
+	} {
+		set plain [$self draw $spec 20 0]
+		set batched [$self draw $spec 20 8]
+		if {$plain != $batched} {
+			puts stderr "batch: [lindex $spec 0]: batched values differ"
+			puts stderr "plain:   $plain"
+			puts stderr "batched: $batched"
+			exit 1
+		}
+		puts $f "[lindex $spec 0]: $batched"
+	}
+	close $f
+}
+
 proc usage {} {
     global argv
     puts stderr "usage: ns $argv0 <tests> "
-    puts "Valid tests: rngtest"
+    puts "Valid tests: rngtest batch"
     exit 1
 }
     
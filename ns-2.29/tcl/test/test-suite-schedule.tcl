@@ -105,6 +105,12 @@ Topology/netFQ instproc init ns {
 	$self makeNet1 $ns FQ 20ms
 }
 
+Class Topology/netWFQ -superclass Topology
+Topology/netWFQ instproc init ns {
+	$self instvar node_
+	$self makeNet1 $ns WFQ 20ms
+}
+
 Class Topology/netDRR -superclass Topology
 Topology/netDRR instproc init ns {
 	$self instvar node_
@@ -127,6 +133,7 @@ TestSuite instproc finish file {
 	global quiet PERL
         exec $PERL ../../bin/getrc -s 2 -d 3 all.tr | \
           $PERL ../../bin/raw2xg -s 0.01 -m 90 -t $file > temp.rands
+	$self check
 	if {$quiet == "false"} {
 		exec xgraph -bb -tk -nl -m -x time -y packets temp.rands &
 	}
@@ -135,6 +142,65 @@ TestSuite instproc finish file {
         exit 0
 }
 
+# Hook for tests that check temp.rands beyond comparing it to their
+# own recorded output.
+TestSuite instproc check {} {
+}
+
+# The departure times in the "packets" series of an xgraph file, as
+# an array keyed by the packet's y value (flow + seqno mod 90).
+TestSuite instproc departures { chan arr } {
+	upvar $arr dep
+	set on 0
+	while {[gets $chan line] >= 0} {
+		if {[string index $line 0] == "\""} {
+			set on [expr {$line == "\"packets"}]
+		} elseif {$on && [llength $line] == 2} {
+			lappend dep([lindex $line 1]) [lindex $line 0]
+		}
+	}
+}
+
+# Exit 1 unless the packets in temp.rands get through as in the FQ
+# reference, each within two packet times (1000 bytes at 800Kb) of
+# its FQ departure.  Only a packet that would leave after the
+# simulation ends (10s) may be missing from one of the two runs.
+# test-all ignores the exit status, so a failure is also appended
+# to temp.rands.
+TestSuite instproc checkFQ {} {
+	set slack 0.0201
+	set f [open "|gzip -dc test-output-schedule/fq.Z"]
+	$self departures $f fq
+	close $f
+	set f [open temp.rands]
+	$self departures $f us
+	close $f
+	foreach y [lsort -unique [concat [array names fq] [array names us]]] {
+		if {![info exists fq($y)]} { set fq($y) {} }
+		if {![info exists us($y)]} { set us($y) {} }
+		set n [llength $fq($y)]
+		if {[llength $us($y)] > $n} { set n [llength $us($y)] }
+		for {set i 0} {$i < $n} {incr i} {
+			set a [lindex $fq($y) $i]
+			set b [lindex $us($y) $i]
+			if {$a == "" || $b == ""} {
+				set t [expr {$a == "" ? $b : $a}]
+				set ok [expr {$t > 10.0 - $slack}]
+			} else {
+				set ok [expr {abs($a - $b) <= $slack}]
+			}
+			if {!$ok} {
+				set msg "packet $y: fq departs at $a, [$self set test_] at $b"
+				puts stderr $msg
+				set f [open temp.rands a]
+				puts $f $msg
+				close $f
+				exit 1
+			}
+		}
+	}
+}
+
 TestSuite instproc printtimers { tcp time} {
 	global quiet
 	if {$quiet == "false"} {
@@ -254,6 +320,55 @@ Test/drr instproc run {} {
 	$self runDetailed
 }
 
+# WFQ with equal weights on the fq topology: the same packets get
+# through as with FQ, each within two packet times of its FQ departure.
+Class Test/wfq -superclass TestSuite
+Test/wfq instproc init {} {
+        $self instvar net_ test_
+        set net_        netWFQ
+        set test_       wfq
+        $self next
+}
+Test/wfq instproc run {} {
+	$self setTopo
+	$self runDetailed
+}
+Test/wfq instproc check {} {
+	$self checkFQ
+}
+
+# WF2Q+ with equal weights: also within two packet times of FQ.
+Class Test/wf2q -superclass TestSuite
+Test/wf2q instproc init {} {
+        $self instvar net_ test_
+        set net_        netWFQ
+        set test_       wf2q
+        $self next
+}
+Test/wf2q instproc run {} {
+	Queue/WFQ set wf2q_ true
+	$self setTopo
+	$self runDetailed
+}
+Test/wf2q instproc check {} {
+	$self checkFQ
+}
+
+# The second connection's weight goes to 3 with packets queued.
+Class Test/wfq_weight -superclass TestSuite
+Test/wfq_weight instproc init {} {
+        $self instvar net_ test_
+        set net_        netWFQ
+        set test_       wfq_weight
+        $self next
+}
+Test/wfq_weight instproc run {} {
+	$self instvar ns_ node_
+	$self setTopo
+	set q [[$ns_ link $node_(r1) $node_(k1)] queue]
+	$ns_ at 5.0 "$q weight 1 3"
+	$self runDetailed
+}
 
 TestSuite runTest
 
@@ -50,9 +50,11 @@
 #define ns_ack_recons_h
 
 #include "semantic-packetqueue.h"
+#include "mem-account.h"
 
 class AckReconsController : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	AckReconsController() : spq_(0) {}
 	void recv(Packet *p, Handler *h=0);
 	SemanticPacketQueue *spq_;
@@ -39,6 +39,7 @@
 #include <math.h>
 #include "agent.h"
 #include "tcp.h"
+#include "mem-account.h"
 
 /* max window size */
 // #define MWS 1024  
@@ -84,6 +85,7 @@ public:
 class SackStack;
 class Sacker : public Acker, public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 	Sacker() : base_nblocks_(-1), sf_(0) { };
 	~Sacker();
 	void append_ack(hdr_cmn*, hdr_tcp*, int oldSeqno) const;
@@ -107,224 +107,118 @@ TcpAgent::TcpAgent()
 
 }
 
+DELAY_BIND_BEGIN(TcpAgent, Agent)
+	DELAY_BIND("window_", wnd_),
+	DELAY_BIND("windowInit_", wnd_init_),
+	DELAY_BIND("windowInitOption_", wnd_init_option_),
+	DELAY_BIND_BOOL("syn_", syn_),
+	DELAY_BIND("windowOption_", wnd_option_),
+	DELAY_BIND("windowConstant_", wnd_const_),
+	DELAY_BIND("windowThresh_", wnd_th_),
+	DELAY_BIND_BOOL("delay_growth_", delay_growth_),
+	DELAY_BIND("overhead_", overhead_),
+	DELAY_BIND("tcpTick_", tcp_tick_),
+	DELAY_BIND_BOOL("ecn_", ecn_),
+	DELAY_BIND_BOOL("SetCWRonRetransmit_", SetCWRonRetransmit_),
+	DELAY_BIND_BOOL("old_ecn_", old_ecn_),
+	DELAY_BIND("eln_", eln_),
+	DELAY_BIND("eln_rxmit_thresh_", eln_rxmit_thresh_),
+	DELAY_BIND("packetSize_", size_),
+	DELAY_BIND("tcpip_base_hdr_size_", tcpip_base_hdr_size_),
+	DELAY_BIND("ts_option_size_", ts_option_size_),
+	DELAY_BIND_BOOL("bugFix_", bug_fix_),
+	DELAY_BIND_BOOL("bugFix_ack_", bugfix_ack_),
+	DELAY_BIND_BOOL("bugFix_ts_", bugfix_ts_),
+	DELAY_BIND_BOOL("lessCareful_", less_careful_),
+	DELAY_BIND_BOOL("timestamps_", ts_option_),
+	DELAY_BIND_BOOL("ts_resetRTO_", ts_resetRTO_),
+	DELAY_BIND_BOOL("slow_start_restart_", slow_start_restart_),
+	DELAY_BIND_BOOL("restart_bugfix_", restart_bugfix_),
+	DELAY_BIND("maxburst_", maxburst_),
+	DELAY_BIND_BOOL("aggressive_maxburst_", aggressive_maxburst_),
+	DELAY_BIND("maxcwnd_", maxcwnd_),
+	DELAY_BIND("numdupacks_", numdupacks_),
+	DELAY_BIND("numdupacksFrac_", numdupacksFrac_),
+	DELAY_BIND_BOOL("exitFastRetrans_", exitFastRetrans_),
+	DELAY_BIND("maxrto_", maxrto_),
+	DELAY_BIND("minrto_", minrto_),
+	DELAY_BIND("srtt_init_", srtt_init_),
+	DELAY_BIND("rttvar_init_", rttvar_init_),
+	DELAY_BIND("rtxcur_init_", rtxcur_init_),
+	DELAY_BIND("T_SRTT_BITS", T_SRTT_BITS),
+	DELAY_BIND("T_RTTVAR_BITS", T_RTTVAR_BITS),
+	DELAY_BIND("rttvar_exp_", rttvar_exp_),
+	DELAY_BIND("awnd_", awnd_),
+	DELAY_BIND("decrease_num_", decrease_num_),
+	DELAY_BIND("increase_num_", increase_num_),
+	DELAY_BIND("k_parameter_", k_parameter_),
+	DELAY_BIND("l_parameter_", l_parameter_),
+
+	DELAY_BIND_BOOL("trace_all_oneline_", trace_all_oneline_),
+	DELAY_BIND_BOOL("nam_tracevar_", nam_tracevar_),
+	DELAY_BIND("QOption_", QOption_),
+	DELAY_BIND("EnblRTTCtr_", EnblRTTCtr_),
+	DELAY_BIND("control_increase_", control_increase_),
+	DELAY_BIND_BOOL("noFastRetrans_", noFastRetrans_),
+	DELAY_BIND_BOOL("precisionReduce_", precision_reduce_),
+	DELAY_BIND_BOOL("oldCode_", oldCode_),
+	DELAY_BIND_BOOL("useHeaders_", useHeaders_),
+	DELAY_BIND("low_window_", low_window_),
+	DELAY_BIND("high_window_", high_window_),
+	DELAY_BIND("high_p_", high_p_),
+	DELAY_BIND("high_decrease_", high_decrease_),
+	DELAY_BIND("max_ssthresh_", max_ssthresh_),
+	DELAY_BIND("cwnd_range_", cwnd_range_),
+	DELAY_BIND_BOOL("timerfix_", timerfix_),
+	DELAY_BIND_BOOL("rfc2988_", rfc2988_),
+	DELAY_BIND("singledup_", singledup_),
+	DELAY_BIND_BOOL("LimTransmitFix_", LimTransmitFix_),
+	DELAY_BIND("rate_request_", rate_request_),
+	DELAY_BIND_BOOL("qs_enabled_", qs_enabled_),
+	DELAY_BIND_BOOL("tcp_qs_recovery_", tcp_qs_recovery_),
+
+	DELAY_BIND_BOOL("frto_enabled_", frto_enabled_),
+	DELAY_BIND_BOOL("sfrto_enabled_", sfrto_enabled_),
+	DELAY_BIND_BOOL("spurious_response_", spurious_response_),
+#ifdef TCP_DELAY_BIND_ALL
+	DELAY_BIND("t_seqno_", t_seqno_),
+	DELAY_BIND("rtt_", t_rtt_),
+	DELAY_BIND("srtt_", t_srtt_),
+	DELAY_BIND("rttvar_", t_rttvar_),
+	DELAY_BIND("backoff_", t_backoff_),
+
+	DELAY_BIND("dupacks_", dupacks_),
+	DELAY_BIND("seqno_", curseq_),
+	DELAY_BIND("ack_", highest_ack_),
+	DELAY_BIND("cwnd_", cwnd_),
+	DELAY_BIND("ssthresh_", ssthresh_),
+	DELAY_BIND("maxseq_", maxseq_),
+	DELAY_BIND("ndatapack_", ndatapack_),
+	DELAY_BIND("ndatabytes_", ndatabytes_),
+	DELAY_BIND("nackpack_", nackpack_),
+	DELAY_BIND("nrexmit_", nrexmit_),
+	DELAY_BIND("nrexmitpack_", nrexmitpack_),
+	DELAY_BIND("nrexmitbytes_", nrexmitbytes_),
+	DELAY_BIND("necnresponses_", necnresponses_),
+	DELAY_BIND("ncwndcuts_", ncwndcuts_),
+	DELAY_BIND("ncwndcuts1_", ncwndcuts1_),
+#endif
+DELAY_BIND_END
+
 void
 TcpAgent::delay_bind_init_all()
 {
-
         // Defaults for bound variables should be set in ns-default.tcl.
-        delay_bind_init_one("window_");
-        delay_bind_init_one("windowInit_");
-        delay_bind_init_one("windowInitOption_");
-
-        delay_bind_init_one("syn_");
-        delay_bind_init_one("windowOption_");
-        delay_bind_init_one("windowConstant_");
-        delay_bind_init_one("windowThresh_");
-        delay_bind_init_one("delay_growth_");
-        delay_bind_init_one("overhead_");
-        delay_bind_init_one("tcpTick_");
-        delay_bind_init_one("ecn_");
-        delay_bind_init_one("SetCWRonRetransmit_");
-        delay_bind_init_one("old_ecn_");
-        delay_bind_init_one("eln_");
-        delay_bind_init_one("eln_rxmit_thresh_");
-        delay_bind_init_one("packetSize_");
-        delay_bind_init_one("tcpip_base_hdr_size_");
-	delay_bind_init_one("ts_option_size_");
-        delay_bind_init_one("bugFix_");
-	delay_bind_init_one("bugFix_ack_");
-	delay_bind_init_one("bugFix_ts_");
-	delay_bind_init_one("lessCareful_");
-        delay_bind_init_one("slow_start_restart_");
-        delay_bind_init_one("restart_bugfix_");
-        delay_bind_init_one("timestamps_");
-	delay_bind_init_one("ts_resetRTO_");
-        delay_bind_init_one("maxburst_");
-	delay_bind_init_one("aggressive_maxburst_");
-        delay_bind_init_one("maxcwnd_");
-	delay_bind_init_one("numdupacks_");
-	delay_bind_init_one("numdupacksFrac_");
-	delay_bind_init_one("exitFastRetrans_");
-        delay_bind_init_one("maxrto_");
-	delay_bind_init_one("minrto_");
-        delay_bind_init_one("srtt_init_");
-        delay_bind_init_one("rttvar_init_");
-        delay_bind_init_one("rtxcur_init_");
-        delay_bind_init_one("T_SRTT_BITS");
-        delay_bind_init_one("T_RTTVAR_BITS");
-        delay_bind_init_one("rttvar_exp_");
-        delay_bind_init_one("awnd_");
-        delay_bind_init_one("decrease_num_");
-        delay_bind_init_one("increase_num_");
-	delay_bind_init_one("k_parameter_");
-	delay_bind_init_one("l_parameter_");
-        delay_bind_init_one("trace_all_oneline_");
-        delay_bind_init_one("nam_tracevar_");
-
-        delay_bind_init_one("QOption_");
-        delay_bind_init_one("EnblRTTCtr_");
-        delay_bind_init_one("control_increase_");
-	delay_bind_init_one("noFastRetrans_");
-	delay_bind_init_one("precisionReduce_");
-	delay_bind_init_one("oldCode_");
-	delay_bind_init_one("useHeaders_");
-	delay_bind_init_one("low_window_");
-	delay_bind_init_one("high_window_");
-	delay_bind_init_one("high_p_");
-	delay_bind_init_one("high_decrease_");
-	delay_bind_init_one("max_ssthresh_");
-	delay_bind_init_one("cwnd_range_");
-	delay_bind_init_one("timerfix_");
-	delay_bind_init_one("rfc2988_");
-	delay_bind_init_one("singledup_");
-	delay_bind_init_one("LimTransmitFix_");
-	delay_bind_init_one("rate_request_");
-	delay_bind_init_one("qs_enabled_");
-	delay_bind_init_one("tcp_qs_recovery_");
+	Agent::delay_bind_init_all();
+
+	// these have defaults, but no C++ variable is bound to them
 	delay_bind_init_one("qs_request_mode_");
 	delay_bind_init_one("qs_thresh_");
 	delay_bind_init_one("qs_rtt_");
 
-	delay_bind_init_one("frto_enabled_");
-	delay_bind_init_one("sfrto_enabled_");
-	delay_bind_init_one("spurious_response_");
-
-#ifdef TCP_DELAY_BIND_ALL
-	// out because delay-bound tracevars aren't yet supported
-        delay_bind_init_one("t_seqno_");
-        delay_bind_init_one("rtt_");
-        delay_bind_init_one("srtt_");
-        delay_bind_init_one("rttvar_");
-        delay_bind_init_one("backoff_");
-        delay_bind_init_one("dupacks_");
-        delay_bind_init_one("seqno_");
-        delay_bind_init_one("ack_");
-        delay_bind_init_one("cwnd_");
-        delay_bind_init_one("ssthresh_");
-        delay_bind_init_one("maxseq_");
-        delay_bind_init_one("ndatapack_");
-        delay_bind_init_one("ndatabytes_");
-        delay_bind_init_one("nackpack_");
-        delay_bind_init_one("nrexmit_");
-        delay_bind_init_one("nrexmitpack_");
-        delay_bind_init_one("nrexmitbytes_");
-        delay_bind_init_one("necnresponses_");
-        delay_bind_init_one("ncwndcuts_");
-	delay_bind_init_one("ncwndcuts1_");
-#endif /* TCP_DELAY_BIND_ALL */
-
-	Agent::delay_bind_init_all();
-
         reset();
 }
 
-int
-TcpAgent::delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer)
-{
-        if (delay_bind(varName, localName, "window_", &wnd_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "windowInit_", &wnd_init_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "windowInitOption_", &wnd_init_option_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "syn_", &syn_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "windowOption_", &wnd_option_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "windowConstant_",  &wnd_const_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "windowThresh_", &wnd_th_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "delay_growth_", &delay_growth_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "overhead_", &overhead_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "tcpTick_", &tcp_tick_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "ecn_", &ecn_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "SetCWRonRetransmit_", &SetCWRonRetransmit_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "old_ecn_", &old_ecn_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "eln_", &eln_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "eln_rxmit_thresh_", &eln_rxmit_thresh_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "packetSize_", &size_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "tcpip_base_hdr_size_", &tcpip_base_hdr_size_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "ts_option_size_", &ts_option_size_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "bugFix_", &bug_fix_ , tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "bugFix_ack_", &bugfix_ack_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "bugFix_ts_", &bugfix_ts_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "lessCareful_", &less_careful_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "timestamps_", &ts_option_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "ts_resetRTO_", &ts_resetRTO_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "slow_start_restart_", &slow_start_restart_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "restart_bugfix_", &restart_bugfix_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "maxburst_", &maxburst_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "aggressive_maxburst_", &aggressive_maxburst_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "maxcwnd_", &maxcwnd_ , tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "numdupacks_", &numdupacks_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "numdupacksFrac_", &numdupacksFrac_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "exitFastRetrans_", &exitFastRetrans_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "maxrto_", &maxrto_ , tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "minrto_", &minrto_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "srtt_init_", &srtt_init_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "rttvar_init_", &rttvar_init_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "rtxcur_init_", &rtxcur_init_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "T_SRTT_BITS", &T_SRTT_BITS , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "T_RTTVAR_BITS", &T_RTTVAR_BITS , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "rttvar_exp_", &rttvar_exp_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "awnd_", &awnd_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "decrease_num_", &decrease_num_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "increase_num_", &increase_num_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "k_parameter_", &k_parameter_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "l_parameter_", &l_parameter_, tracer)) return TCL_OK;
-
-
-        if (delay_bind_bool(varName, localName, "trace_all_oneline_", &trace_all_oneline_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "nam_tracevar_", &nam_tracevar_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "QOption_", &QOption_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "EnblRTTCtr_", &EnblRTTCtr_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "control_increase_", &control_increase_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "noFastRetrans_", &noFastRetrans_, tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "precisionReduce_", &precision_reduce_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "oldCode_", &oldCode_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "useHeaders_", &useHeaders_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "low_window_", &low_window_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "high_window_", &high_window_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "high_p_", &high_p_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "high_decrease_", &high_decrease_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "max_ssthresh_", &max_ssthresh_, tracer)) return TCL_OK;
-	if (delay_bind(varName, localName, "cwnd_range_", &cwnd_range_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "timerfix_", &timerfix_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "rfc2988_", &rfc2988_, tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "singledup_", &singledup_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "LimTransmitFix_", &LimTransmitFix_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "rate_request_", &rate_request_ , tracer)) return TCL_OK;
-        if (delay_bind_bool(varName, localName, "qs_enabled_", &qs_enabled_ , tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "tcp_qs_recovery_", &tcp_qs_recovery_, tracer)) return TCL_OK;
-
-	if (delay_bind_bool(varName, localName, "frto_enabled_", &frto_enabled_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "sfrto_enabled_", &sfrto_enabled_, tracer)) return TCL_OK;
-	if (delay_bind_bool(varName, localName, "spurious_response_", &spurious_response_, tracer)) return TCL_OK;
-
-
-#ifdef TCP_DELAY_BIND_ALL
-	// not if (delay-bound delay-bound tracevars aren't yet supported
-        if (delay_bind(varName, localName, "t_seqno_", &t_seqno_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "rtt_", &t_rtt_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "srtt_", &t_srtt_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "rttvar_", &t_rttvar_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "backoff_", &t_backoff_ , tracer)) return TCL_OK;
-
-        if (delay_bind(varName, localName, "dupacks_", &dupacks_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "seqno_", &curseq_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "ack_", &highest_ack_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "cwnd_", &cwnd_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "ssthresh_", &ssthresh_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "maxseq_", &maxseq_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "ndatapack_", &ndatapack_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "ndatabytes_", &ndatabytes_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "nackpack_", &nackpack_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "nrexmit_", &nrexmit_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "nrexmitpack_", &nrexmitpack_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "nrexmitbytes_", &nrexmitbytes_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "necnresponses_", &necnresponses_ , tracer)) return TCL_OK;
-        if (delay_bind(varName, localName, "ncwndcuts_", &ncwndcuts_ , tracer)) return TCL_OK;
- 	if (delay_bind(varName, localName, "ncwndcuts1_", &ncwndcuts1_ , tracer)) return TCL_OK;
-
-#endif
-
-        return Agent::delay_bind_dispatch(varName, localName, tracer);
-}
-
 #define TCP_WRK_SIZE		512
 /* Print out all the traced variables whenever any one is changed */
 void
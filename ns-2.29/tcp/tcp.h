@@ -192,7 +192,7 @@ protected:
 	virtual int headersize();   // a tcp header
 
 	virtual void delay_bind_init_all();
-	virtual int delay_bind_dispatch(const char *varName, const char *localName, TclObject *tracer);
+	DELAY_BIND_TABLE
 
 	TracedInt t_seqno_;	/* sequence number */
 	/*
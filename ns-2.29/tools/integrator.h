@@ -38,9 +38,11 @@
 #define ns_integrator_h
 
 #include "config.h"
+#include "mem-account.h"
 
 class Integrator : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Integrator();
 	void set(double x, double y);
 	void newPoint(double x, double y);
@@ -54,6 +56,7 @@ protected:
 // a set of statistical samples
 class Samples : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	Samples() : cnt_(0), sum_(0.0), sqsum_(0.0) { }
 	void newPoint(double val) {
 		cnt_++;
@@ -0,0 +1,77 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Memory accounting by subsystem; see mem-account.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem-account.h"
+
+MemAccount::Usage MemAccount::usage_[MEM_NTAGS];
+
+static const char* const tag_names[MEM_NTAGS] = {
+	"packet", "header", "pool", "event", "route", "queue", "trace",
+	"object"
+};
+
+const char*
+MemAccount::name(int tag)
+{
+	return (tag_names[tag]);
+}
+
+int
+MemAccount::lookup(const char* name)
+{
+	for (int i = 0; i < MEM_NTAGS; i++)
+		if (strcmp(name, tag_names[i]) == 0)
+			return (i);
+	return (-1);
+}
+
+void
+MemAccount::print(FILE* f)
+{
+	fprintf(f, "%-8s %12s %12s %10s %10s\n", "tag", "bytes", "peak",
+		"objects", "peak");
+	for (int i = 0; i < MEM_NTAGS; i++) {
+		const Usage& u = usage_[i];
+		fprintf(f, "%-8s %12ld %12ld %10ld %10ld\n", tag_names[i],
+			u.bytes, u.peak, u.objects, u.maxobjects);
+	}
+}
+
+/*
+ * The block starts with its size and tag, padded so that what the
+ * caller gets is as well aligned as what malloc() returns.
+ */
+union MemHeader {
+	struct {
+		size_t size;
+		int tag;
+	} h;
+	double align_[2];
+};
+
+void*
+MemAccount::tagged_alloc(int tag, size_t n)
+{
+	MemHeader* mh = (MemHeader*)malloc(sizeof(MemHeader) + n);
+	if (mh == 0)
+		abort();
+	mh->h.size = n;
+	mh->h.tag = tag;
+	alloc(tag, n);
+	return (mh + 1);
+}
+
+void
+MemAccount::tagged_free(void* p)
+{
+	if (p == 0)
+		return;
+	MemHeader* mh = (MemHeader*)p - 1;
+	release(mh->h.tag, mh->h.size);
+	free(mh);
+}
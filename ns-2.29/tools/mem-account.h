@@ -0,0 +1,109 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Memory accounting by subsystem.
+ *
+ * Allocations of the big object families are charged to a tag, which
+ * keeps the bytes and objects currently allocated and the peak of
+ * each.  Scripts read the counters with "$ns mem-usage" and log them
+ * over simulated time with "$ns mem-log"; "$ns clearMemTrace" prints
+ * them with the sbrk and rusage figures of MemTrace.
+ *
+ * There are three ways to charge memory:
+ *   - MEM_ACCOUNT(tag) in the public part of a class gives it an
+ *     operator new and delete that charge every instance, of it and
+ *     of the classes derived from it, to tag (a derived class may
+ *     name a tag of its own);
+ *   - mem_new<T>(tag, n) and mem_delete(p) for plain arrays;
+ *   - MemAccount::alloc() and release() by hand.
+ *
+ * Every ns class derived directly from TclObject names a tag, so all
+ * split objects are charged.  A pending event is charged sizeof(Event)
+ * while it is scheduled; since a packet is an event, the bytes of a
+ * packet in flight show under both "packet" and "event".
+ *
+ * The counters are only as complete as the code that charges them:
+ * memory allocated by other code (OTcl, zlib) is not seen here.
+ */
+
+#ifndef ns_mem_account_h
+#define ns_mem_account_h
+
+#include <stddef.h>
+#include <stdio.h>
+
+enum MemTag {
+	MEM_PACKET,	// packets in use
+	MEM_HEADER,	// their header blocks
+	MEM_POOL,	// free packets kept for reuse, and their headers
+	MEM_EVENT,	// pending events, the event queue and schedulers
+	MEM_ROUTE,	// routing tables and caches
+	MEM_QUEUE,	// queues
+	MEM_TRACE,	// trace objects and buffers
+	MEM_OBJECT,	// other simulator objects (TclObject)
+	MEM_NTAGS
+};
+
+class MemAccount {
+public:
+	struct Usage {
+		long bytes;
+		long peak;
+		long objects;
+		long maxobjects;
+		long total;	// objects ever allocated
+	};
+
+	static inline void alloc(int tag, size_t n, long objects = 1) {
+		Usage& u = usage_[tag];
+		u.bytes += n;
+		if (u.bytes > u.peak)
+			u.peak = u.bytes;
+		u.objects += objects;
+		if (u.objects > u.maxobjects)
+			u.maxobjects = u.objects;
+		if (objects > 0)
+			u.total += objects;
+	}
+	static inline void release(int tag, size_t n, long objects = 1) {
+		Usage& u = usage_[tag];
+		u.bytes -= n;
+		u.objects -= objects;
+	}
+	static const Usage& usage(int tag) { return usage_[tag]; }
+	static const char* name(int tag);
+	static int lookup(const char* name);	// -1 if no such tag
+	static void print(FILE* f);
+
+	// n bytes charged to tag, remembered with the block
+	static void* tagged_alloc(int tag, size_t n);
+	static void tagged_free(void* p);
+
+private:
+	static Usage usage_[MEM_NTAGS];
+};
+
+template <class T> inline T*
+mem_new(int tag, size_t n)
+{
+	return ((T*)MemAccount::tagged_alloc(tag, n * sizeof(T)));
+}
+
+inline void
+mem_delete(void* p)
+{
+	MemAccount::tagged_free(p);
+}
+
+#define MEM_ACCOUNT(tag) \
+	static void* operator new(size_t n) { \
+		MemAccount::alloc(tag, n); \
+		return (::operator new(n)); \
+	} \
+	static void operator delete(void* p, size_t n) { \
+		if (p == 0) \
+			return; \
+		MemAccount::release(tag, n); \
+		::operator delete(p); \
+	}
+
+#endif
@@ -46,6 +46,7 @@
 
 #include "config.h"
 #include <stdio.h>
+#include "mem-account.h"
 
 /* Unix platforms should get these from configure */
 #ifdef WIN32
@@ -121,6 +122,7 @@ public:
 			 normalize(now_.utime_) - normalize(start_.utime_), 
 			 normalize(now_.stime_) - normalize(start_.stime_), 
 			 fDIFF(stack_), fDIFF(heap_));
+		MemAccount::print(stdout);
 		start_.checkpoint();
 	}
 };
@@ -42,9 +42,11 @@
 #include "connector.h"
 #include "packet.h"
 #include "flags.h"
+#include "mem-account.h"
 
 class QueueMonitor : public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 	QueueMonitor() : bytesInt_(NULL), pktsInt_(NULL), delaySamp_(NULL),
 		size_(0), pkts_(0),
 		parrivals_(0), barrivals_(0),
@@ -45,13 +45,46 @@ static const char rcsid[] =
 #endif
 
 #include <stdio.h>
+#include <string.h>
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "ranvar.h"
 
-RandomVariable::RandomVariable()
+RandomVariable::RandomVariable() : bsize_(0), bnext_(0), ubuf_(0), xbuf_(0)
 {
 	rng_ = RNG::defaultrng(); 
 }
 
+RandomVariable::~RandomVariable()
+{
+	delete [] ubuf_;
+	delete [] xbuf_;
+}
+
+/*
+ * Switch batched generation on with a buffer of n variates, or off
+ * with n = 0.  Variates already drawn into the buffer are discarded.
+ */
+int RandomVariable::batch(int n)
+{
+	if (n < 0 || (n > 0 && !batchable()))
+		return (TCL_ERROR);
+	delete [] ubuf_;
+	delete [] xbuf_;
+	ubuf_ = xbuf_ = 0;
+	if (n > 0) {
+		ubuf_ = new double[n];
+		xbuf_ = new double[n];
+	}
+	bsize_ = bnext_ = n;
+	return (TCL_OK);
+}
+
 int RandomVariable::command(int argc, const char*const* argv)
 {
 	Tcl& tcl = Tcl::instance();
@@ -69,6 +102,15 @@ int RandomVariable::command(int argc, const char*const* argv)
 				tcl.resultf("no such RNG %s", argv[2]);
 				return(TCL_ERROR);
 			}
+			flush();
+			return(TCL_OK);
+		}
+		if (strcmp(argv[1], "batch") == 0) {
+			if (batch(atoi(argv[2])) != TCL_OK) {
+				tcl.resultf("%s: cannot batch %s variates",
+					    name(), argv[2]);
+				return(TCL_ERROR);
+			}
 			return(TCL_OK);
 		}
 	}
@@ -89,6 +131,7 @@ int  RandomVariable::seed(char *x){
                         tcl.resultf("no such RNG %s", x);
                         return(TCL_ERROR);
                 }
+                flush();
                 return(TCL_OK);
  
 }
@@ -116,9 +159,19 @@ UniformRandomVariable::UniformRandomVariable(double min, double max)
 
 double UniformRandomVariable::value()
 {
+	if (bsize_)
+		return(batched());
 	return(rng_->uniform(min_, max_));
 }
 
+void UniformRandomVariable::transform(double* x, const double* u, int n)
+{
+	bmin_ = min_;
+	bmax_ = max_;
+	memcpy(x, u, n * sizeof(double));
+	RNG::to_uniform(x, n, min_, max_);
+}
+
 
 static class ExponentialRandomVariableClass : public TclClass {
 public:
@@ -140,9 +193,18 @@ ExponentialRandomVariable::ExponentialRandomVariable(double avg)
 
 double ExponentialRandomVariable::value()
 {
+	if (bsize_)
+		return(batched());
 	return(rng_->exponential(avg_));
 }
 
+void ExponentialRandomVariable::transform(double* x, const double* u, int n)
+{
+	bavg_ = avg_;
+	memcpy(x, u, n * sizeof(double));
+	RNG::to_exponential(x, n, avg_);
+}
+
 
 static class ParetoRandomVariableClass : public TclClass {
  public:
@@ -173,9 +235,19 @@ double ParetoRandomVariable::value()
 	 * can update the scale everytime the user updates shape
 	 * or avg.
 	 */
+	if (bsize_)
+		return(batched());
 	return(rng_->pareto(avg_ * (shape_ -1)/shape_, shape_));
 }
 
+void ParetoRandomVariable::transform(double* x, const double* u, int n)
+{
+	bavg_ = avg_;
+	bshape_ = shape_;
+	memcpy(x, u, n * sizeof(double));
+	RNG::to_pareto(x, n, avg_ * (shape_ -1)/shape_, shape_);
+}
+
 /* Pareto distribution of the second kind, aka. Lomax distribution */
 static class ParetoIIRandomVariableClass : public TclClass {
  public:
@@ -199,9 +271,19 @@ ParetoIIRandomVariable::ParetoIIRandomVariable(double avg, double shape)
 
 double ParetoIIRandomVariable::value()
 {
+        if (bsize_)
+                return(batched());
         return(rng_->paretoII(avg_ * (shape_ - 1), shape_));
 }
 
+void ParetoIIRandomVariable::transform(double* x, const double* u, int n)
+{
+        bavg_ = avg_;
+        bshape_ = shape_;
+        memcpy(x, u, n * sizeof(double));
+        RNG::to_paretoII(x, n, avg_ * (shape_ - 1), shape_);
+}
+
 static class NormalRandomVariableClass : public TclClass {
  public:
         NormalRandomVariableClass() : TclClass("RandomVariable/Normal") {}
@@ -237,9 +319,28 @@ LogNormalRandomVariable::LogNormalRandomVariable()
  
 double LogNormalRandomVariable::value()
 {
+        // RNG::normal() draws nothing when std_ is 0, so neither do we
+        if (bsize_ && std_ != 0)
+                return(batched());
         return(rng_->lognormal(avg_, std_));
 }
 
+void LogNormalRandomVariable::draw(double* z, int n)
+{
+        // normal(0, 1) gives the same sam * rad that normal(avg_, std_)
+        // would scale, so transform() reproduces the scalar values
+        for (int i = 0; i < n; i++)
+                z[i] = rng_->normal(0.0, 1.0);
+}
+
+void LogNormalRandomVariable::transform(double* x, const double* z, int n)
+{
+        bavg_ = avg_;
+        bstd_ = std_;
+        for (int i = 0; i < n; i++)
+                x[i] = exp(z[i] * std_ + avg_);
+}
+
 static class ConstantRandomVariableClass : public TclClass {
  public:
 	ConstantRandomVariableClass() : TclClass("RandomVariable/Constant"){}
@@ -321,12 +422,34 @@ public:
 	}
 } class_empiricalranvar;
 
-EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), maxEntry_(32), table_(0)
+EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), numEntry_(0), maxEntry_(32), table_(0), map_(0), mapLen_(0), guide_(1), guideTab_(0), numGuide_(0)
 {
 	bind("minCDF_", &minCDF_);
 	bind("maxCDF_", &maxCDF_);
 	bind("interpolation_", &interpolation_);
 	bind("maxEntry_", &maxEntry_);
+	bind("guide_", &guide_);
+}
+
+EmpiricalRandomVariable::~EmpiricalRandomVariable()
+{
+	freeTable();
+}
+
+void EmpiricalRandomVariable::freeTable()
+{
+#ifndef WIN32
+	if (map_ != 0) {
+		munmap(map_, mapLen_);
+		map_ = 0;
+		table_ = 0;
+	}
+#endif
+	delete [] table_;
+	table_ = 0;
+	delete [] guideTab_;
+	guideTab_ = 0;
+	numGuide_ = 0;
 }
 
 int EmpiricalRandomVariable::command(int argc, const char*const* argv)
@@ -341,21 +464,102 @@ int EmpiricalRandomVariable::command(int argc, const char*const* argv)
 			}
 			return (TCL_OK);
 		}
+		if (strcmp(argv[1], "saveCDF") == 0) {
+			if (saveCDF(argv[2]) == 0) {
+				tcl.resultf("%s saveCDF %s: cannot write file",
+					    name(), argv[2]);
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
 	}
 	return RandomVariable::command(argc, argv);
 }
 
+/*
+ * Write the loaded table as a binary CDF file for loadCDF to map.
+ */
+int EmpiricalRandomVariable::saveCDF(const char* filename)
+{
+	CDFfileHdr h;
+	FILE* fp;
+
+	if (numEntry_ <= 0 || (fp = fopen(filename, "wb")) == 0)
+		return 0;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic_, CDF_MAGIC, sizeof(h.magic_));
+	h.order_ = CDF_BYTE_ORDER;
+	h.numEntry_ = numEntry_;
+	int ok = (fwrite(&h, sizeof(h), 1, fp) == 1 &&
+		  fwrite(table_, sizeof(CDFentry), numEntry_, fp) ==
+		  (size_t)numEntry_);
+	if (fclose(fp) != 0)
+		ok = 0;
+	return ok ? numEntry_ : 0;
+}
+
+/*
+ * Map a binary CDF file.  Returns the number of entries, 0 if the
+ * file is not a valid binary CDF file for this host, or -1 if it is
+ * not a binary CDF file at all.
+ */
+int EmpiricalRandomVariable::loadBinaryCDF(const char* filename)
+{
+	CDFfileHdr h;
+	FILE* fp = fopen(filename, "rb");
+	if (fp == 0)
+		return 0;
+	int n = fread(&h, sizeof(h), 1, fp);
+	fclose(fp);
+	if (n != 1 || memcmp(h.magic_, CDF_MAGIC, sizeof(h.magic_)) != 0)
+		return -1;
+#ifdef WIN32
+	return 0;
+#else
+	if (h.order_ != CDF_BYTE_ORDER || h.numEntry_ <= 0) {
+		fprintf(stderr, "%s: %s written on a host of different "
+			"byte order or empty\n", name(), filename);
+		return 0;
+	}
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return 0;
+	struct stat st;
+	long len = sizeof(h) + (long)h.numEntry_ * sizeof(CDFentry);
+	if (fstat(fd, &st) < 0 || st.st_size < len) {
+		close(fd);
+		return 0;
+	}
+	void* p = mmap(0, len, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED)
+		return 0;
+	freeTable();
+	map_ = p;
+	mapLen_ = len;
+	table_ = (CDFentry*)((char*)p + sizeof(h));
+	numEntry_ = h.numEntry_;
+	return numEntry_;
+#endif
+}
+
 int EmpiricalRandomVariable::loadCDF(const char* filename)
 {
 	FILE* fp;
 	char line[256];
 	CDFentry* e;
 
+	int n = loadBinaryCDF(filename);
+	if (n >= 0)
+		return n;
+
 	fp = fopen(filename, "r");
 	if (fp == 0) 
 		return 0;
 
-
+	// a previously mapped or guided table cannot be reused
+	if (map_ != 0 || guideTab_ != 0)
+		freeTable();
 	if (table_ == 0)
 		table_ = new CDFentry[maxEntry_];
 	for (numEntry_=0;  fgets(line, 256, fp);  numEntry_++) {
@@ -364,7 +568,7 @@ int EmpiricalRandomVariable::loadCDF(const char* filename)
 			e = new CDFentry[maxEntry_];
 			for (int i=numEntry_-1; i >= 0; i--)
 				e[i] = table_[i];
-			delete table_;
+			delete [] table_;
 			table_ = e;
 		}
 		e = &table_[numEntry_];
@@ -395,12 +599,37 @@ double EmpiricalRandomVariable::interpolate(double x, double x1, double y1, doub
 	return value;
 }
 
+void EmpiricalRandomVariable::buildGuide()
+{
+	double range = table_[numEntry_-1].cdf_ - table_[0].cdf_;
+	numGuide_ = numEntry_;
+	guideTab_ = new int[numGuide_];
+	guideLo_ = table_[0].cdf_;
+	guideScale_ = (range > 0) ? numGuide_ / range : 0;
+	// bucket() is monotone in u, so the first entry of a bucket is
+	// never past the entry that any u in the bucket maps to
+	int i = (numEntry_ > 1) ? 1 : 0;
+	for (int j = 0; j < numGuide_; j++) {
+		while (i < numEntry_ - 1 && bucket(table_[i].cdf_) < j)
+			i++;
+		guideTab_[j] = i;
+	}
+}
+
 int EmpiricalRandomVariable::lookup(double u)
 {
 	// always return an index whose value is >= u
 	int lo, hi, mid;
 	if (u <= table_[0].cdf_)
 		return 0;
+	if (guide_) {
+		if (guideTab_ == 0)
+			buildGuide();
+		for (lo = guideTab_[bucket(u)];
+		     lo < numEntry_-1 && u > table_[lo].cdf_; lo++)
+			;
+		return lo;
+	}
 	for (lo=1, hi=numEntry_-1;  lo < hi; ) {
 		mid = (lo + hi) / 2;
 		if (u > table_[mid].cdf_)
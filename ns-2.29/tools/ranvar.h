@@ -51,17 +51,50 @@
 
 #include "random.h"
 #include "rng.h"
+#include "mem-account.h"
 
 class RandomVariable : public TclObject {
  public:
+	MEM_ACCOUNT(MEM_OBJECT)
 	virtual double value() = 0;
 	virtual double avg() = 0;
 	int command(int argc, const char*const* argv);
 	RandomVariable();
+	virtual ~RandomVariable();
 	// This is added by Debojyoti Dutta 12th Oct 2000
 	int seed(char *);
+	int batch(int n);
  protected:
 	RNG* rng_;
+
+	/*
+	 * Batched generation ("$rv batch N").  Variables that support it
+	 * draw N raw variates from rng_ at a time into ubuf_ and map the
+	 * whole buffer to values in xbuf_ with transform().  Values come
+	 * out in exactly the order unbatched value() calls would produce,
+	 * provided nobody else draws from rng_ meanwhile, so batching
+	 * should be used with a private RNG (see "use-rng").  If the
+	 * parameters change, the unused part of the buffer is
+	 * re-transformed from the saved raw variates.
+	 */
+	virtual int batchable() { return 0; }
+	virtual void draw(double* u, int n) { rng_->uniform_batch(u, n); }
+	virtual void transform(double*, const double*, int) {}
+	virtual int changed() { return 0; }
+	inline double batched() {
+		if (bnext_ >= bsize_) {
+			draw(ubuf_, bsize_);
+			transform(xbuf_, ubuf_, bsize_);
+			bnext_ = 0;
+		} else if (changed())
+			transform(xbuf_ + bnext_, ubuf_ + bnext_, bsize_ - bnext_);
+		return xbuf_[bnext_++];
+	}
+	inline void flush() { bnext_ = bsize_; }
+	int bsize_;		// batch size, 0 if not batching
+	int bnext_;		// next unused entry in xbuf_
+	double* ubuf_;		// raw variates from rng_
+	double* xbuf_;		// transformed values
 };
 
 class UniformRandomVariable : public RandomVariable {
@@ -76,9 +109,14 @@ class UniformRandomVariable : public RandomVariable {
 	double max()	{ return max_; };
 	void setmin(double d)	{ min_ = d; };
 	void setmax(double d)	{ max_ = d; };
+ protected:
+	virtual int batchable() { return 1; }
+	virtual void transform(double* x, const double* u, int n);
+	virtual int changed() { return (min_ != bmin_ || max_ != bmax_); }
  private:
 	double min_;
 	double max_;
+	double bmin_, bmax_;	// parameters of the current batch
 };
 
 class ExponentialRandomVariable : public RandomVariable {
@@ -89,8 +127,13 @@ class ExponentialRandomVariable : public RandomVariable {
 	double* avgp() { return &avg_; };
 	virtual inline double avg() { return avg_; };
 	void setavg(double d) { avg_ = d; };
+ protected:
+	virtual int batchable() { return 1; }
+	virtual void transform(double* x, const double* u, int n);
+	virtual int changed() { return (avg_ != bavg_); }
  private:
 	double avg_;
+	double bavg_;
 };
 
 class ParetoRandomVariable : public RandomVariable {
@@ -104,10 +147,15 @@ class ParetoRandomVariable : public RandomVariable {
 	double shape()	{ return shape_; };
 	void setavg(double d)	{ avg_ = d; };
 	void setshape(double d)	{ shape_ = d; };
+ protected:
+	virtual int batchable() { return 1; }
+	virtual void transform(double* x, const double* u, int n);
+	virtual int changed() { return (avg_ != bavg_ || shape_ != bshape_); }
  private:
 	double avg_;
 	double shape_;
 	double scale_;
+	double bavg_, bshape_;
 };
 
 class ParetoIIRandomVariable : public RandomVariable {
@@ -121,10 +169,15 @@ class ParetoIIRandomVariable : public RandomVariable {
         double shape()   { return shape_; };
         void setavg(double d)  { avg_ = d; };
         void setshape(double d)  { shape_ = d; };
+ protected:
+        virtual int batchable() { return 1; }
+        virtual void transform(double* x, const double* u, int n);
+        virtual int changed() { return (avg_ != bavg_ || shape_ != bshape_); }
  private:
         double avg_;
         double shape_;
         double scale_;
+        double bavg_, bshape_;
 };
 
 class NormalRandomVariable : public RandomVariable {
@@ -152,9 +205,16 @@ public:
         inline double std()     { return std_; };
         inline void setavg(double d)    { avg_ = d; };
         inline void setstd(double d)    { std_ = d; };
+protected:
+        // raw variates are standard normals rather than uniforms
+        virtual int batchable() { return 1; }
+        virtual void draw(double* z, int n);
+        virtual void transform(double* x, const double* z, int n);
+        virtual int changed() { return (avg_ != bavg_ || std_ != bstd_); }
 private:
         double avg_;
         double std_;
+        double bavg_, bstd_;
 };
 
 class ConstantRandomVariable : public RandomVariable {
@@ -197,6 +257,21 @@ struct CDFentry {
 	double val_;
 };
 
+/*
+ * Binary CDF file (see saveCDF): this header followed by numEntry_
+ * CDFentry records, in host byte order.  loadCDF() maps such files
+ * read-only, so a large table loads without parsing and its pages are
+ * shared by every simulation that uses the same file.
+ */
+#define CDF_MAGIC "NSCDF01\n"
+#define CDF_BYTE_ORDER 0x01020304
+
+struct CDFfileHdr {
+	char magic_[8];		// CDF_MAGIC
+	int order_;		// CDF_BYTE_ORDER as written by the host
+	int numEntry_;
+};
+
 class EmpiricalRandomVariable : public RandomVariable {
 public:
 	virtual double value();
@@ -206,10 +281,15 @@ public:
 	double& minCDF() { return minCDF_; }
 	double& maxCDF() { return maxCDF_; }
 	int loadCDF(const char* filename);
+	int saveCDF(const char* filename);
+	virtual ~EmpiricalRandomVariable();
 
 protected:
 	int command(int argc, const char*const* argv);
 	int lookup(double u);
+	int loadBinaryCDF(const char* filename);
+	void freeTable();
+	void buildGuide();
 
 	double minCDF_;		// min value of the CDF (default to 0)
 	double maxCDF_;		// max value of the CDF (default to 1)
@@ -217,6 +297,25 @@ protected:
 	int numEntry_;		// number of entries in the CDF table
 	int maxEntry_;		// size of the CDF table (mem allocation)
 	CDFentry* table_;	// CDF table of (val_, cdf_)
+	void* map_;		// mapping of a binary CDF file, if table_ is in it
+	long mapLen_;		// length of map_
+
+	/*
+	 * Guide table (Chen and Asau): guideTab_[j] is the first entry
+	 * whose cdf_ falls in bucket j or later of numGuide_ equal-width
+	 * buckets over [table_[0].cdf_, table_[numEntry_-1].cdf_].
+	 * lookup() starts there and steps forward, which is O(1) on
+	 * average and returns the same index as the binary search.
+	 */
+	int guide_;		// use the guide table (bound)
+	int* guideTab_;
+	int numGuide_;
+	double guideLo_;	// cdf_ of the first entry
+	double guideScale_;	// buckets per unit of cdf
+	inline int bucket(double u) {
+		int j = (int)((u - guideLo_) * guideScale_);
+		return (j < numGuide_) ? j : numGuide_ - 1;
+	}
 };
 
 #endif
@@ -70,6 +70,7 @@
 
 #ifndef stand_alone
 #include "config.h"
+#include "mem-account.h"
 #endif   /* stand_alone */
 
 #ifndef MAXINT
@@ -104,10 +105,13 @@ class RNG
 {
 
 public:
+#ifndef stand_alone
+	MEM_ACCOUNT(MEM_OBJECT)
+#endif
 	enum RNGSources { RAW_SEED_SOURCE, PREDEF_SEED_SOURCE, HEURISTIC_SEED_SOURCE };
 
 #ifdef OLD_RNG
-	RNG() : stream_(1L) {};
+	RNG() : stream_(1L), parity_(0) {};
 	inline int seed() { return stream_.seed(); }
 #else
 	RNG(const char* name = "");
@@ -119,7 +123,9 @@ public:
 	double next_double();
 #endif /* OLD_RNG */
 
-	RNG(RNGSources source, int seed = 1) { set_seed(source, seed); };
+	RNG(RNGSources source, int seed = 1) : parity_(0) {
+		set_seed(source, seed);
+	};
 	void set_seed(RNGSources source, int seed = 1);
 	inline static RNG* defaultrng() { return (default_); }
 
@@ -288,10 +294,36 @@ public:
 		return (exp (normal(avg, std))); 
 	}
 
+	/*
+	 * Batched generation.  Each of these fills x[0..n-1] with exactly
+	 * the values that n successive calls to the scalar version above
+	 * would have returned, and leaves the stream in the same state,
+	 * so seeded runs stay reproducible.  The uniforms are produced by
+	 * one tight MRG32k3a loop with the state held in locals, and the
+	 * inverse-CDF transforms are separate loops over the whole buffer
+	 * that the compiler is free to vectorize.
+	 */
+	void uniform_batch(double* x, int n);
+	void uniform_batch(double* x, int n, double a, double b);
+	void exponential_batch(double* x, int n, double r);
+	void pareto_batch(double* x, int n, double scale, double shape);
+	void paretoII_batch(double* x, int n, double scale, double shape);
+
+	// In-place transforms of a buffer of uniforms from uniform_batch().
+	static void to_uniform(double* x, int n, double a, double b);
+	static void to_exponential(double* x, int n, double r);
+	static void to_pareto(double* x, int n, double scale, double shape);
+	static void to_paretoII(double* x, int n, double scale, double shape);
+
 protected:   // need to be public?
 #ifdef OLD_RNG
 	RNGImplementation stream_;
-#else
+#endif
+	// normal() makes variates in pairs; the second waits here, so
+	// each stream's sequence does not depend on any other stream
+	int parity_;
+	double nextresult_;
+#ifndef OLD_RNG
 	double Cg_[6], Bg_[6], Ig_[6]; 
 	/*
 	  Vectors to store the current seed, the beginning of the current block
@@ -341,6 +373,7 @@ public:
 	void verbose_mil();
 	void first_n(RNG::RNGSources source, long seed, int n);
 	void first_n_mil(RNG::RNGSources source, long seed, int n, FILE *out);
+	void benchmark(int n);
 };
 #endif /* rng_test */
 
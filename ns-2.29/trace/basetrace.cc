@@ -57,14 +57,14 @@ public:
 BaseTrace::BaseTrace() 
   : channel_(0), namChan_(0), tagged_(0) 
 {
-  wrk_ = new char[1026];
-  nwrk_ = new char[256];
+  wrk_ = mem_new<char>(MEM_TRACE, 1026);
+  nwrk_ = mem_new<char>(MEM_TRACE, 256);
 }
 
 BaseTrace::~BaseTrace()
 {
-  delete wrk_;
-  delete nwrk_;
+  mem_delete(wrk_);
+  mem_delete(nwrk_);
 }
 
 void BaseTrace::dump()
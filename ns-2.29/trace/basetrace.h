@@ -42,6 +42,7 @@
 
 class BaseTrace : public TclObject {
 public:
+	MEM_ACCOUNT(MEM_TRACE)
 	BaseTrace();
 	~BaseTrace();
 	virtual int command(int argc, const char*const* argv);
@@ -0,0 +1,116 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * A Tcl channel type that gzip-compresses what is written to it; see
+ * gzchan.h.
+ */
+
+#ifndef lint
+static const char rcsid[] =
+    "@(#) $Header$";
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include "gzchan.h"
+
+/* zlib.h alone is not enough: -lz must be on the link line too */
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+#include <zlib.h>
+
+#ifndef CONST84
+#define CONST84
+#endif
+
+#define GZCHAN_BUFSIZE 65536
+
+static int
+gzchanClose(ClientData instanceData, Tcl_Interp*)
+{
+	return (gzclose((gzFile)instanceData) == Z_OK ? 0 : EIO);
+}
+
+static int
+gzchanInput(ClientData, char*, int, int* errorCodePtr)
+{
+	*errorCodePtr = EINVAL;
+	return (-1);
+}
+
+static int
+gzchanOutput(ClientData instanceData, CONST84 char* buf, int toWrite,
+	     int* errorCodePtr)
+{
+	if (toWrite == 0)
+		return (0);
+	int n = gzwrite((gzFile)instanceData, (voidp)buf, toWrite);
+	if (n <= 0) {
+		*errorCodePtr = EIO;
+		return (-1);
+	}
+	return (n);
+}
+
+static void
+gzchanWatch(ClientData, int)
+{
+}
+
+static int
+gzchanGetHandle(ClientData, int, ClientData*)
+{
+	return (TCL_ERROR);
+}
+
+static Tcl_ChannelType gzchanType = {
+	(char *)"gzip",			/* typeName */
+	TCL_CHANNEL_VERSION_2,		/* version */
+	gzchanClose,			/* closeProc */
+	gzchanInput,			/* inputProc */
+	gzchanOutput,			/* outputProc */
+	NULL,				/* seekProc */
+	NULL,				/* setOptionProc */
+	NULL,				/* getOptionProc */
+	gzchanWatch,			/* watchProc */
+	gzchanGetHandle,		/* getHandleProc */
+};
+#endif /* HAVE_ZLIB_H && HAVE_LIBZ */
+
+/*
+ * ns-gzopen file ?level?
+ */
+int GzOpenCommand::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc < 2 || argc > 3) {
+		tcl.add_error("ns-gzopen: usage: ns-gzopen file ?level?");
+		return (TCL_ERROR);
+	}
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+	int level = 6;
+	if (argc == 3 && (sscanf(argv[2], "%d", &level) != 1 ||
+			  level < 1 || level > 9)) {
+		tcl.resultf("ns-gzopen: bad compression level \"%s\"", argv[2]);
+		return (TCL_ERROR);
+	}
+	char mode[4];
+	sprintf(mode, "wb%d", level);
+	gzFile gz = gzopen(argv[1], mode);
+	if (gz == NULL) {
+		tcl.resultf("ns-gzopen: can't open %s for writing", argv[1]);
+		return (TCL_ERROR);
+	}
+
+	static int nchan = 0;
+	char name[32];
+	sprintf(name, "gzip%d", nchan++);
+	Tcl_Channel chan = Tcl_CreateChannel(&gzchanType, name,
+					     (ClientData)gz, TCL_WRITABLE);
+	Tcl_SetChannelBufferSize(chan, GZCHAN_BUFSIZE);
+	Tcl_RegisterChannel(tcl.interp(), chan);
+	tcl.result(Tcl_GetChannelName(chan));
+	return (TCL_OK);
+#else
+	tcl.resultf("ns-gzopen: ns was built without zlib");
+	return (TCL_ERROR);
+#endif
+}
@@ -0,0 +1,25 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * gzip-compressed trace files.
+ *
+ * "ns-gzopen file ?level?" opens file for writing and returns a Tcl
+ * channel whose output is gzip-compressed on its way to the file.
+ * The channel can be handed to trace-all, namtrace-all, a BaseTrace's
+ * attach or namattach, or written with puts, as any file opened with
+ * "open file w" can; "close" finishes the gzip stream.
+ *
+ * nam reads such traces directly (see nam's gzindex.h).
+ */
+
+#ifndef ns_gzchan_h
+#define ns_gzchan_h
+
+#include <tclcl.h>
+
+class GzOpenCommand : public TclCommand {
+public:
+	GzOpenCommand() : TclCommand("ns-gzopen") {}
+	virtual int command(int argc, const char*const* argv);
+};
+
+#endif
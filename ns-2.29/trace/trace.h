@@ -64,6 +64,7 @@ protected:
 	int show_sctphdr_; // bool flags; backward compat
 	void callback();
 public:
+	MEM_ACCOUNT(MEM_TRACE)
 	Trace(int type);
         ~Trace();
 
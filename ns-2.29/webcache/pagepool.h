@@ -53,6 +53,7 @@
 #include <ranvar.h>
 #include <tclcl.h>
 #include "config.h"
+#include "mem-account.h"
 
 enum WebPageType { HTML, MEDIA };
 
@@ -260,6 +261,7 @@ protected:
 // Abstract page pool, used for interface only
 class PagePool : public TclObject {
 public: 
+	MEM_ACCOUNT(MEM_OBJECT)
 	PagePool() : num_pages_(0), start_time_(INT_MAX), end_time_(INT_MIN) {}
 	int num_pages() const { return num_pages_; }
 protected:
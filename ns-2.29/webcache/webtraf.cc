@@ -360,10 +360,10 @@ void WebTrafPool::launchReq(Node *src_, void* ClntData, int obj, int size) {
 	WebPage* pg = (WebPage*)ClntData;
 
 	// Setup TCP connection and done
-	Tcl::instance().evalf("%s launch-req %d %d %s %s %s %s %d %d", 
+	Tcl::instance().evalf("%s launch-req %d %d %s %s %s %s %d %ld", 
 			      name(), obj, pg->id(),
 			      src_->name(), pg->dst()->name(),
-			      ctcp->name(), csnk->name(), size, ClntData);
+			      ctcp->name(), csnk->name(), size, (long)ClntData);
 
 	// Debug only
 	// $numPacket_ $objectId_ $pageId_ $sessionId_ [$ns_ now] src dst
@@ -387,9 +387,9 @@ void WebTrafPool::launchResp(int obj_id, Node *svr_, Node *clnt_, Agent *tcp, Ag
 	}
 
 	// Setup TCP connection and done
-	Tcl::instance().evalf("%s launch-resp %d %d %s %s %s %s %d %d", 
+	Tcl::instance().evalf("%s launch-resp %d %d %s %s %s %s %d %ld", 
 			      name(), obj_id, pid, svr_->name(), clnt_->name(),
-			      tcp->name(), snk->name(), size, ClntData);
+			      tcp->name(), snk->name(), size, (long)ClntData);
 
 	// Debug only
 	// $numPacket_ $objectId_ $pageId_ $sessionId_ [$ns_ now] src dst
@@ -881,25 +881,24 @@ class InstVarInt64 : public InstVar {
 };
 #endif	
 
+static int bool_atoi(const char* s)
+{
+	if (isdigit(*s))
+		return (atoi(s));
+	switch (*s) {
+	case 't':
+	case 'T':
+		return (1);
+	default:
+		return (0);
+	}
+}
+
 class InstVarBool : public InstVarInt {
  public:
 	InstVarBool(const char* var, int* val) : InstVarInt(var, val) {}
 	void set(const char* s) {
-		int v;
-
-		if (isdigit(*s))
-			v = atoi(s);
-		else switch (*s) {
-		case 't':
-		case 'T':
-			v =  1;
-			break;
-		default:
-			v = 0;
-			break;
-		}
-
-		*val_ = v;
+		*val_ = bool_atoi(s);
 	}
 };
 
@@ -1014,6 +1013,16 @@ double InstVar::time_atof(const char* s)
 	return (v);
 }
 
+double TclObject::bw_atof(const char* s)
+{
+	return (InstVar::bw_atof(s));
+}
+
+double TclObject::time_atof(const char* s)
+{
+	return (InstVar::time_atof(s));
+}
+
 
 void TclObject::init(InstVar* v, const char* var)
 {
@@ -1047,9 +1056,57 @@ void TclObject::bind_error(const char* name, const char* errmsg) {
 TOB(bind, int64_t, InstVarInt64, )
 #endif
 
+/*
+ * The end of every delay_bind_dispatch() chain: look in the
+ * DELAY_BIND_TABLEs of this object's class and its parents.
+ */
 int
-TclObject::delay_bind_dispatch(const char* /*varName*/, const char* /*localName*/, TclObject * /*tracer*/)
-{
+TclObject::delay_bind_dispatch(const char* varName, const char* localName, TclObject* tracer)
+{
+	const DelayBindTable* t;
+	for (t = delay_bind_table(); t != 0; t = t->parent()) {
+		for (const DelayBindVar* v = t->vars; v->name != 0; v++) {
+			if (strcmp(v->name, varName) != 0)
+				continue;
+			char* p = t->base(this) + v->offset;
+			const char* n = v->name;
+			switch (v->type) {
+			case DB_DOUBLE:
+				delay_bind(varName, localName, n, (double*)p, tracer);
+				break;
+			case DB_BW:
+				delay_bind_bw(varName, localName, n, (double*)p, tracer);
+				break;
+			case DB_TIME:
+				delay_bind_time(varName, localName, n, (double*)p, tracer);
+				break;
+			case DB_INT:
+				delay_bind(varName, localName, n, (int*)p, tracer);
+				break;
+			case DB_UINT:
+				delay_bind(varName, localName, n, (unsigned int*)p, tracer);
+				break;
+			case DB_BOOL:
+				delay_bind_bool(varName, localName, n, (int*)p, tracer);
+				break;
+			case DB_TRACED_INT:
+				delay_bind(varName, localName, n, (TracedInt*)p, tracer);
+				break;
+			case DB_TRACED_DOUBLE:
+				delay_bind(varName, localName, n, (TracedDouble*)p, tracer);
+				break;
+#if defined(HAVE_INT64)
+			case DB_INT64:
+				delay_bind(varName, localName, n, (int64_t*)p, tracer);
+				break;
+#endif
+			default:
+				msg_abort("TclObject: %s has a bad delay-bind type",
+					  varName);
+			}
+			return (TCL_OK);
+		}
+	}
 	return TCL_ERROR;  // terminate search
 }
 
@@ -1057,6 +1114,146 @@ TclObject::delay_bind_dispatch(const char* /*varName*/, const char* /*localName*
 void
 TclObject::delay_bind_init_all()
 {
+	const DelayBindTable* t = delay_bind_table();
+	if (t != 0)
+		delay_bind_init_table(t);
+}
+
+/*
+ * The classes init-instvar looks in for a default, most specific
+ * first, for each OTcl class with instances that use a delay-bind
+ * table.  The class hierarchy is taken to be fixed once it has them.
+ */
+struct DelayBindClasses {
+	int n;
+	char** names;
+	OTclObject** objs;	// of the names, for the object at hand
+};
+
+static DelayBindClasses* delay_bind_classes(const char* cl)
+{
+	static Tcl_HashTable* classes = 0;
+	if (classes == 0) {
+		classes = new Tcl_HashTable;
+		Tcl_InitHashTable(classes, TCL_STRING_KEYS);
+	}
+	int isnew;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(classes, cl, &isnew);
+	if (!isnew)
+		return ((DelayBindClasses*)Tcl_GetHashValue(he));
+
+	Tcl& tcl = Tcl::instance();
+	Tcl_Interp* in = tcl.interp();
+	Tcl_Obj* order = Tcl_NewListObj(0, 0);
+	Tcl_Obj* level = Tcl_NewStringObj(cl, -1);
+	Tcl_IncrRefCount(order);
+	Tcl_IncrRefCount(level);
+	for (;;) {
+		int lc, i;
+		Tcl_Obj** lv;
+		if (Tcl_ListObjGetElements(in, level, &lc, &lv) != TCL_OK ||
+		    lc == 0)
+			break;
+		Tcl_Obj* next = Tcl_NewListObj(0, 0);
+		Tcl_IncrRefCount(next);
+		for (i = 0; i < lc; i++) {
+			const char* c = Tcl_GetString(lv[i]);
+			if (strcmp(c, "SplitObject") == 0 ||
+			    strcmp(c, "Object") == 0)
+				continue;
+			Tcl_ListObjAppendElement(0, order, lv[i]);
+			tcl.evalf("%s info superclass", c);
+			Tcl_ListObjAppendList(0, next, Tcl_GetObjResult(in));
+		}
+		Tcl_DecrRefCount(level);
+		level = next;
+	}
+	int oc;
+	Tcl_Obj** ov;
+	Tcl_ListObjGetElements(0, order, &oc, &ov);
+	DelayBindClasses* dc = new DelayBindClasses;
+	dc->n = oc;
+	dc->names = new char*[oc];
+	dc->objs = new OTclObject*[oc];
+	for (int i = 0; i < oc; i++) {
+		const char* c = Tcl_GetString(ov[i]);
+		dc->names[i] = new char[strlen(c) + 1];
+		strcpy(dc->names[i], c);
+	}
+	Tcl_DecrRefCount(level);
+	Tcl_DecrRefCount(order);
+	Tcl_ResetResult(in);
+	Tcl_SetHashValue(he, (ClientData)dc);
+	return (dc);
+}
+
+static void delay_bind_set(char* p, int type, const char* s)
+{
+	switch (type) {
+	case DB_DOUBLE:
+		*(double*)p = atof(s);
+		break;
+	case DB_BW:
+		*(double*)p = InstVar::bw_atof(s);
+		break;
+	case DB_TIME:
+		*(double*)p = InstVar::time_atof(s);
+		break;
+	case DB_INT:
+		*(int*)p = strtol(s, (char**)0, 0);
+		break;
+	case DB_UINT:
+		*(unsigned int*)p = strtoul(s, (char**)0, 0);
+		break;
+	case DB_BOOL:
+		*(int*)p = bool_atoi(s);
+		break;
+	case DB_TRACED_INT:
+		*(TracedInt*)p = strtol(s, (char**)0, 0);
+		break;
+	case DB_TRACED_DOUBLE:
+		*(TracedDouble*)p = atof(s);
+		break;
+#if defined(HAVE_INT64)
+	case DB_INT64:
+		*(int64_t*)p = STRTOI64(s, (char**)0, 0);
+		break;
+#endif
+	}
+}
+
+/*
+ * Set every variable in table t and its parents from its class
+ * default, as delay_bind_init_one() would, but reading the defaults
+ * straight out of the classes rather than through "$self set".
+ */
+void
+TclObject::delay_bind_init_table(const DelayBindTable* t)
+{
+	Tcl& tcl = Tcl::instance();
+	Tcl_Interp* in = tcl.interp();
+	tcl.evalf("%s info class", name_);
+	DelayBindClasses* dc = delay_bind_classes(tcl.result());
+	int i;
+	for (i = 0; i < dc->n; i++)
+		dc->objs[i] = OTclGetObject(in, dc->names[i]);
+	for (; t != 0; t = t->parent()) {
+		for (const DelayBindVar* v = t->vars; v->name != 0; v++) {
+			const char* val = 0;
+			for (i = 0; i < dc->n && val == 0; i++)
+				if (dc->objs[i] != 0)
+					val = OTclGetInstVar(dc->objs[i], in,
+							     v->name, 0);
+			if (val == 0) {
+				tcl.evalf("%s warn-instvar %s::%s", name_,
+					  dc->n > 0 ? dc->names[0] : "",
+					  v->name);
+				continue;
+			}
+			delay_bind_set(t->base(this) + v->offset, v->type,
+				       val);
+		}
+	}
 }
 
 /*
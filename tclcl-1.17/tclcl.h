@@ -161,6 +161,7 @@ class Tcl {
 #include "tclcl-mappings.h"
 
 class InstVar;
+struct DelayBindTable;
 
 class TclObject {
     public:
@@ -187,6 +188,9 @@ class TclObject {
 #if defined(HAVE_INT64)
 	void bind(const char* var, int64_t* val);
 #endif
+	/* the parsers behind bind_bw() and bind_time() ("10Mb", "2ms") */
+	static double bw_atof(const char* s);
+	static double time_atof(const char* s);
 	/* give an error message and exit if the old variable 
 	   name is used either for read or write */
 #define _RENAMED(oldname, newname) \
@@ -229,6 +233,10 @@ class TclObject {
 	virtual void delay_bind_init_all();
 	void delay_bind_init_one(const char *varName);
 
+	// see DELAY_BIND_TABLE below
+	static const DelayBindTable* delay_bind_class_table() { return (0); }
+	virtual const DelayBindTable* delay_bind_table() const { return (0); }
+
 	// Common interface for all the 'fprintf(stderr,...); abort();' stuff
 	static void msg_abort(const char* fmt = NULL, ...);
 
@@ -240,6 +248,7 @@ protected:
 	void not_a_TracedVar(const char *name);
 	void handle_TracedVar(const char *name, TracedVar *tv, TclObject *tracer);
 	int traceVar(const char* varName, TclObject* tracer);
+	void delay_bind_init_table(const DelayBindTable*);
 
 	// Enumerate through traced vars, and call their corresponding 
 	// handlers. 
@@ -256,6 +265,104 @@ protected:
 	TracedVar* tracedvar_;
 };
 
+/*
+ * Table-driven delay binding.  Rather than bind() its variables in
+ * its constructor, or delay_bind() them by hand, a class can list them
+ * in a table:
+ *
+ *	class FooAgent : public Agent {
+ *	public:
+ *		...
+ *		DELAY_BIND_TABLE
+ *	protected:
+ *		double rate_;
+ *		int verbose_;
+ *	};
+ *
+ *	DELAY_BIND_BEGIN(FooAgent, Agent)
+ *		DELAY_BIND_BW("rate_", rate_),
+ *		DELAY_BIND_BOOL("verbose_", verbose_),
+ *	DELAY_BIND_END
+ *
+ * When an object is created, each variable in its table and those of
+ * its parents is set straight from the class default, found as
+ * init-instvar would find it; no Tcl variable or trace is made for it
+ * until a script reads, writes or traces it.  Tables and hand-written
+ * delay binding can be mixed in one hierarchy as long as every
+ * delay_bind_dispatch() and delay_bind_init_all() calls its parent's.
+ */
+enum DelayBindType {
+	DB_DOUBLE, DB_BW, DB_TIME, DB_INT, DB_UINT, DB_BOOL,
+	DB_TRACED_INT, DB_TRACED_DOUBLE, DB_INT64
+};
+
+struct DelayBindVar {
+	const char* name;
+	long offset;		// from the class's this
+	int type;
+};
+
+struct DelayBindTable {
+	const DelayBindVar* vars;	// ends with a null name
+	char* (*base)(TclObject*);	// this of the class
+	const DelayBindTable* (*parent)();
+};
+
+// check that a field has the type its entry says
+inline int delay_bind_type(double*) { return (DB_DOUBLE); }
+inline int delay_bind_type(int*) { return (DB_INT); }
+inline int delay_bind_type(unsigned int*) { return (DB_UINT); }
+inline int delay_bind_type(TracedInt*) { return (DB_TRACED_INT); }
+inline int delay_bind_type(TracedDouble*) { return (DB_TRACED_DOUBLE); }
+#if defined(HAVE_INT64)
+inline int delay_bind_type(int64_t*) { return (DB_INT64); }
+#endif
+inline int delay_bind_type_bw(double*) { return (DB_BW); }
+inline int delay_bind_type_time(double*) { return (DB_TIME); }
+inline int delay_bind_type_bool(int*) { return (DB_BOOL); }
+
+#define DELAY_BIND_TABLE \
+	static const DelayBindTable* delay_bind_class_table(); \
+	virtual const DelayBindTable* delay_bind_table() const { \
+		return (delay_bind_class_table()); \
+	}
+
+#define DELAY_BIND_BEGIN(CLASS, PARENT) \
+const DelayBindTable* CLASS::delay_bind_class_table() \
+{ \
+	typedef CLASS DelayBindClass; \
+	typedef PARENT DelayBindParent; \
+	struct Base { \
+		static char* base(TclObject* o) { \
+			return ((char*)static_cast<DelayBindClass*>(o)); \
+		} \
+	}; \
+	static const DelayBindVar vars[] = {
+
+#define DELAY_BIND_FIELD(FIELD) (&((DelayBindClass*)64)->FIELD)
+#define DELAY_BIND_ENTRY(NAME, FIELD, TYPE) \
+	{ NAME, (long)((char*)DELAY_BIND_FIELD(FIELD) - (char*)64), TYPE }
+
+#define DELAY_BIND(NAME, FIELD) \
+	DELAY_BIND_ENTRY(NAME, FIELD, delay_bind_type(DELAY_BIND_FIELD(FIELD)))
+#define DELAY_BIND_BW(NAME, FIELD) \
+	DELAY_BIND_ENTRY(NAME, FIELD, delay_bind_type_bw(DELAY_BIND_FIELD(FIELD)))
+#define DELAY_BIND_TIME(NAME, FIELD) \
+	DELAY_BIND_ENTRY(NAME, FIELD, \
+			 delay_bind_type_time(DELAY_BIND_FIELD(FIELD)))
+#define DELAY_BIND_BOOL(NAME, FIELD) \
+	DELAY_BIND_ENTRY(NAME, FIELD, \
+			 delay_bind_type_bool(DELAY_BIND_FIELD(FIELD)))
+
+#define DELAY_BIND_END \
+		{ 0, 0, 0 } \
+	}; \
+	static const DelayBindTable table = { \
+		vars, Base::base, DelayBindParent::delay_bind_class_table \
+	}; \
+	return (&table); \
+}
+
 /*
  * johnh xxx: delete this
  * #define DELAY_BIND_DISPATCH(VARNAME_P, LOCALNAME_P, VARNAME_STRING, BIND_FUNCTION, PTR_TO_FIELD) \